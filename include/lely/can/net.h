@@ -2,7 +2,7 @@
  * This header file is part of the CAN library; it contains the CAN network
  * interface declarations.
  *
- * @copyright 2015-2020 Lely Industries N.V.
+ * @copyright 2015-2021 Lely Industries N.V.
  *
  * @author J. S. Seldenthuis <jseldenthuis@lely.com>
  *
@@ -25,6 +25,43 @@
 #include <lely/can/msg.h>
 #include <lely/libc/time.h>
 
+/**
+ * The flag specifying that a CAN network interface stores the receivers of CAN
+ * frames with an 11-bit identifier (and no other flags) in a direct-indexed
+ * table instead of a tree. This makes dispatching those frames an O(1)
+ * operation, at the cost of a table of 2048 pointers.
+ */
+#define CAN_NET_RECV_TABLE 0x01
+
+/**
+ * The flag specifying that a CAN network interface stores its timers in a
+ * hierarchical timer wheel with a resolution of 1 ms instead of a pairing heap.
+ * This makes starting and stopping a timer an O(1) operation, which pays off
+ * when many timers are frequently restarted (e.g., heartbeat consumers and SDO
+ * timeouts). Timers still trigger at their exact time, but timers that trigger
+ * within the same millisecond are processed in an unspecified order.
+ * Additionally, the callback function set with can_net_set_next_func() is only
+ * invoked when a timer is started that triggers before the currently scheduled
+ * time, not when a timer is stopped. The user therefore MAY observe spurious
+ * wakeups, in which case can_net_set_time() does not invoke any timers.
+ */
+#define CAN_NET_TIMER_WHEEL 0x02
+
+/**
+ * A CAN identifier filter. A CAN frame matches the filter if the bits of its
+ * identifier selected by the mask are equal to those of the filter, and if the
+ * #CAN_FLAG_IDE flag of the frame and the filter are equal. All other flags are
+ * ignored.
+ */
+struct can_net_filter {
+	/// The CAN identifier.
+	uint_least32_t id;
+	/// The mask specifying which bits of #id MUST match.
+	uint_least32_t mask;
+	/// The flags (only #CAN_FLAG_IDE is used).
+	uint_least8_t flags;
+};
+
 struct __can_net;
 #if !defined(__cplusplus) || LELY_NO_CXX
 /// An opaque CAN network interface type.
@@ -84,17 +121,56 @@ typedef int can_recv_func_t(const struct can_msg *msg, void *data);
  */
 typedef int can_send_func_t(const struct can_msg *msg, void *data);
 
+/**
+ * The type of a CAN filter callback function, invoked by a CAN network
+ * interface when the set of CAN identifiers for which receivers are registered
+ * changes, i.e., when the result of can_net_get_filter() may have changed.
+ *
+ * @param filter a pointer to the filter matching the CAN identifier(s) of the
+ *               receiver that was registered or unregistered.
+ * @param add    1 if the filter was added, and 0 if it was removed.
+ * @param data   a pointer to user-specified data.
+ */
+typedef void can_filter_func_t(
+		const struct can_net_filter *filter, int add, void *data);
+
 void *__can_net_alloc(void);
 void __can_net_free(void *ptr);
 struct __can_net *__can_net_init(struct __can_net *net);
+struct __can_net *__can_net_init_with_flags(struct __can_net *net, int flags);
 void __can_net_fini(struct __can_net *net);
 
-/// Creates a new CAN network interface. @see can_net_destroy()
+/**
+ * Creates a new CAN network interface. This is equivalent to
+ * `can_net_create_with_flags(0)`.
+ *
+ * @see can_net_destroy()
+ */
 can_net_t *can_net_create(void);
 
+/**
+ * Creates a new CAN network interface.
+ *
+ * @param flags any combination of #CAN_NET_RECV_TABLE and
+ *              #CAN_NET_TIMER_WHEEL.
+ *
+ * @returns a pointer to a new CAN network interface, or NULL on error. In the
+ * latter case, the error number can be obtained with get_errc().
+ *
+ * @see can_net_destroy()
+ */
+can_net_t *can_net_create_with_flags(int flags);
+
 /// Destroys a CAN network interface. @see can_net_create()
 void can_net_destroy(can_net_t *net);
 
+/**
+ * Returns the flags specified when a CAN network interface was created.
+ *
+ * @see can_net_create_with_flags()
+ */
+int can_net_get_flags(const can_net_t *net);
+
 /**
  * Retrieves the current time of a CAN network interface.
  *
@@ -162,6 +238,43 @@ void can_net_set_next_func(can_net_t *net, can_timer_func_t *func, void *data);
  */
 int can_net_recv(can_net_t *net, const struct can_msg *msg);
 
+/**
+ * Receives a CAN frame with a network interface and processes it with the
+ * corresponding receiver(s). This function is equivalent to can_net_recv(),
+ * except that it also specifies the time at which the frame was received. This
+ * time can be obtained by the receivers with can_net_get_recv_time().
+ *
+ * @param net a pointer to a CAN network interface.
+ * @param msg a pointer to the CAN frame to be processed.
+ * @param tp  a pointer to the time at which the frame was received, with
+ *            respect to the same clock as the one used for can_net_set_time()
+ *            (can be NULL). If <b>tp</b> is NULL, the current time of the
+ *            network interface is used.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * set by the first failed CAN frame receiver callback function can be obtained
+ * with get_errc().
+ */
+int can_net_recv_at(can_net_t *net, const struct can_msg *msg,
+		const struct timespec *tp);
+
+/**
+ * Retrieves the time at which the CAN frame currently being processed by a
+ * network interface was received. If this function is not invoked from a CAN
+ * frame receiver callback function, it returns the current time, as obtained
+ * with can_net_get_time().
+ *
+ * Since the receive time is typically provided by the CAN driver or kernel, it
+ * is unaffected by the latency with which frames are processed and MAY be
+ * earlier than the current time.
+ *
+ * @param net a pointer to a CAN network interface.
+ * @param tp  the address at which to store the receive time (can be NULL).
+ *
+ * @see can_net_recv_at()
+ */
+void can_net_get_recv_time(const can_net_t *net, struct timespec *tp);
+
 /**
  * Sends a CAN frame from a network interface. This function invokes the
  * callback function set by can_net_set_send_func().
@@ -201,6 +314,83 @@ void can_net_get_send_func(
  */
 void can_net_set_send_func(can_net_t *net, can_send_func_t *func, void *data);
 
+/**
+ * Retrieves the callback function invoked when the set of CAN identifiers for
+ * which receivers are registered with a network interface changes.
+ *
+ * @param net   a pointer to a CAN network interface.
+ * @param pfunc the address at which to store a pointer to the callback function
+ *              (can be NULL).
+ * @param pdata the address at which to store a pointer to user-specified data
+ *              (can be NULL).
+ *
+ * @see can_net_set_filter_func()
+ */
+void can_net_get_filter_func(
+		const can_net_t *net, can_filter_func_t **pfunc, void **pdata);
+
+/**
+ * Sets the callback function invoked when the set of CAN identifiers for which
+ * receivers are registered with a network interface changes. The function is
+ * invoked by can_recv_start() and can_recv_stop(), but only when the first
+ * receiver for a CAN identifier is registered, or the last one is unregistered.
+ *
+ * @param net  a pointer to a CAN network interface.
+ * @param func a pointer to the function to be invoked.
+ * @param data a pointer to user-specified data (can be NULL). <b>data</b> is
+ *             passed as the last parameter to <b>func</b>.
+ *
+ * @see can_net_get_filter_func()
+ */
+void can_net_set_filter_func(
+		can_net_t *net, can_filter_func_t *func, void *data);
+
+/**
+ * Retrieves the CAN identifiers for which receivers are registered with a
+ * network interface, as a list of exact-match filters, one for each distinct
+ * combination of identifier and flags, sorted by flags and identifier,
+ * followed by a masked filter for each receiver registered with
+ * can_recv_start_mask(). Use can_net_filter_merge() to reduce the number of
+ * filters.
+ *
+ * @param net     a pointer to a CAN network interface.
+ * @param filters the address at which to store the filters (can be NULL if
+ *                <b>n</b> is 0).
+ * @param n       the maximum number of filters to store at <b>filters</b>.
+ *
+ * @returns the total number of filters. If this number is larger than
+ * <b>n</b>, only the first <b>n</b> filters have been stored.
+ */
+size_t can_net_get_filter(const can_net_t *net, struct can_net_filter *filters,
+		size_t n);
+
+/**
+ * Reduces the number of CAN identifier filters in a list by merging filters.
+ * The filters are sorted and duplicates are removed, after which adjacent
+ * filters with the same #CAN_FLAG_IDE flag are merged, choosing, in each step,
+ * the pair whose merged filter accepts the fewest identifiers. Filters covered
+ * by a merged filter are removed. The resulting filters accept at least all
+ * identifiers accepted by the original ones.
+ *
+ * @param filters a pointer to an array of filters. On exit, the array contains
+ *                the merged filters.
+ * @param n       the number of filters at <b>filters</b>.
+ * @param nmax    the maximum number of filters after merging. If
+ *                <b>nmax</b> is smaller than 2, it is treated as 2, since
+ *                filters for 11-bit and 29-bit identifiers are never merged.
+ *
+ * @returns the number of filters after merging.
+ */
+size_t can_net_filter_merge(
+		struct can_net_filter *filters, size_t n, size_t nmax);
+
+/**
+ * Returns 1 if a CAN frame with the specified identifier and flags matches one
+ * of the filters in a list, and 0 if not.
+ */
+int can_net_filter_match(const struct can_net_filter *filters, size_t n,
+		uint_least32_t id, uint_least8_t flags);
+
 void *__can_timer_alloc(void);
 void __can_timer_free(void *ptr);
 struct __can_timer *__can_timer_init(struct __can_timer *timer);
@@ -329,11 +519,32 @@ void can_recv_set_func(can_recv_t *recv, can_recv_func_t *func, void *data);
 void can_recv_start(can_recv_t *recv, can_net_t *net, uint_least32_t id,
 		uint_least8_t flags);
 
+/**
+ * Registers a CAN frame receiver with a network interface for a range of CAN
+ * identifiers and starts processing frames. The receiver is invoked for every
+ * frame with the specified flags for which `(msg->id & mask) == (id & mask)`,
+ * in addition to the receivers registered for the exact identifier. Masked
+ * receivers are checked in a linear scan for every frame, so this function is
+ * intended for a few receivers covering many identifiers, such as all
+ * heartbeat (0x700 + node-ID) or EMCY (0x080 + node-ID) messages.
+ *
+ * @param recv  a pointer to a CAN frame receiver.
+ * @param net   a pointer to a CAN network interface.
+ * @param id    the CAN identifier to match.
+ * @param mask  the mask specifying which bits of <b>id</b> must match. If all
+ *              bits are set, this function is equivalent to can_recv_start().
+ * @param flags the flags that should be set in every accepted frame.
+ *
+ * @see can_recv_stop()
+ */
+void can_recv_start_mask(can_recv_t *recv, can_net_t *net, uint_least32_t id,
+		uint_least32_t mask, uint_least8_t flags);
+
 /**
  * Stops a CAN frame receiver from processing frames and unregisters it with the
  * network interface.
  *
- * @see can_recv_start()
+ * @see can_recv_start(), can_recv_start_mask()
  */
 void can_recv_stop(can_recv_t *recv);
 
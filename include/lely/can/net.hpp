@@ -75,6 +75,11 @@ struct c_type_traits<__can_net> {
     return __can_net_init(p);
   }
 
+  static pointer
+  init(pointer p, int flags) noexcept {
+    return __can_net_init_with_flags(p, flags);
+  }
+
   static void
   fini(pointer p) noexcept {
     __can_net_fini(p);
@@ -88,6 +93,13 @@ class CANNet : public incomplete_c_type<__can_net> {
  public:
   CANNet() : c_base() {}
 
+  explicit CANNet(int flags) : c_base(flags) {}
+
+  int
+  getFlags() const noexcept {
+    return can_net_get_flags(this);
+  }
+
   void
   getTime(timespec* tp) const noexcept {
     can_net_get_time(this, tp);
@@ -127,6 +139,16 @@ class CANNet : public incomplete_c_type<__can_net> {
     return can_net_recv(this, &msg);
   }
 
+  int
+  recv(const can_msg& msg, const timespec& tp) noexcept {
+    return can_net_recv_at(this, &msg, &tp);
+  }
+
+  void
+  getRecvTime(timespec* tp) const noexcept {
+    can_net_get_recv_time(this, tp);
+  }
+
   int
   send(const can_msg& msg) noexcept {
     return can_net_send(this, &msg);
@@ -301,6 +323,12 @@ class CANRecv : public incomplete_c_type<__can_recv> {
     can_recv_start(this, &net, id, flags);
   }
 
+  void
+  startMask(CANNet& net, uint_least32_t id, uint_least32_t mask,
+            uint_least8_t flags = 0) noexcept {
+    can_recv_start_mask(this, &net, id, mask, flags);
+  }
+
   void
   stop() noexcept {
     can_recv_stop(this);
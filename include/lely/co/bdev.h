@@ -0,0 +1,200 @@
+/**@file
+ * This header file is part of the CANopen library; it contains the binary
+ * device description declarations.
+ *
+ * A binary device description is a precompiled, versioned image of the object
+ * dictionary of a CANopen device, including the device description, the object
+ * and sub-object names and the value limits. Unlike an EDS/DCF file, it can be
+ * loaded without lexing or parsing; unlike a static device description (see
+ * lely/co/sdev.h), it does not require the application to be recompiled.
+ *
+ * The image consists of a 16-byte header, followed by the device description,
+ * the objects and their sub-objects, in order of increasing (sub-)index. All
+ * integers are stored in little-endian byte order. The header contains the
+ * magic number (#CO_BDEV_MAGIC), the version of the format (#CO_BDEV_VERSION),
+ * the optional features present in the image (#CO_BDEV_NAME, #CO_BDEV_LIMITS,
+ * #CO_BDEV_DEFAULT), the total size of the image and a CRC (see co_crc()) of
+ * the bytes following the header.
+ *
+ * @copyright 2021 Lely Industries N.V.
+ *
+ * @author J. S. Seldenthuis <jseldenthuis@lely.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LELY_CO_BDEV_H_
+#define LELY_CO_BDEV_H_
+
+#include <lely/co/dev.h>
+
+/// The magic number of a binary device description ("CODB").
+#define CO_BDEV_MAGIC 0x42444f43u
+
+/// The version of the binary device description format.
+#define CO_BDEV_VERSION 1
+
+/// The size (in bytes) of the header of a binary device description.
+#define CO_BDEV_HDR_SIZE 16
+
+/// The flag indicating that a binary device description contains names.
+#define CO_BDEV_NAME 0x0001
+
+/**
+ * The flag indicating that a binary device description contains the lower and
+ * upper limits of the sub-object values.
+ */
+#define CO_BDEV_LIMITS 0x0002
+
+/**
+ * The flag indicating that a binary device description contains the default
+ * values of the sub-objects.
+ */
+#define CO_BDEV_DEFAULT 0x0004
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct __co_dev *__co_dev_init_from_bin(
+		struct __co_dev *dev, const void *ptr, size_t n);
+
+/**
+ * Creates a CANopen device from a binary device description. The image is only
+ * accessed during the call; all names and values are copied to the device.
+ *
+ * @param ptr a pointer to the binary device description.
+ * @param n   the number of bytes at <b>ptr</b>.
+ *
+ * @returns a pointer to a new device, or NULL on error. In the latter case, the
+ * error number can be obtained with get_errc(). If the image is truncated or
+ * corrupt, or has an unsupported version, the error number is
+ * #ERRNUM_BADMSG.
+ *
+ * @see co_dev_write_bin()
+ */
+co_dev_t *co_dev_create_from_bin(const void *ptr, size_t n);
+
+/**
+ * Creates a CANopen device from a binary device description and allocates its
+ * objects and sub-objects from an arena (see co_dev_set_arena_size()).
+ *
+ * @param ptr        a pointer to the binary device description.
+ * @param n          the number of bytes at <b>ptr</b>.
+ * @param arena_size the size (in bytes) of the blocks of the arena. If 0, the
+ *                   arena is disabled and this function is equivalent to
+ *                   co_dev_create_from_bin().
+ *
+ * @returns a pointer to a new device, or NULL on error. In the latter case, the
+ * error number can be obtained with get_errc().
+ */
+co_dev_t *co_dev_create_from_bin_arena(
+		const void *ptr, size_t n, size_t arena_size);
+
+struct __co_dev *__co_dev_init_from_bin_ref(
+		struct __co_dev *dev, const void *ptr, size_t n);
+
+/**
+ * Creates a CANopen device from a binary device description without copying
+ * the object and sub-object names. The names are referenced in place (see
+ * co_obj_set_name_ref() and co_sub_set_name_ref()), which saves memory when
+ * many devices are loaded but their names are rarely needed, for example, when
+ * the image is a memory-mapped file. All values are still copied.
+ *
+ * @param ptr a pointer to the binary device description. The image MUST remain
+ *            valid, and unmodified, for the lifetime of the device.
+ * @param n   the number of bytes at <b>ptr</b>.
+ *
+ * @returns a pointer to a new device, or NULL on error. In the latter case, the
+ * error number can be obtained with get_errc().
+ *
+ * @see co_dev_create_from_bin()
+ */
+co_dev_t *co_dev_create_from_bin_ref(const void *ptr, size_t n);
+
+#if !LELY_NO_STDIO
+/**
+ * Creates a CANopen device from a binary device description file. The file is
+ * mapped into memory, if possible, and unmapped once the device is created.
+ *
+ * @param filename a pointer to the name of the file.
+ *
+ * @returns a pointer to a new device, or NULL on error. In the latter case, the
+ * error number can be obtained with get_errc().
+ *
+ * @see co_dev_create_from_bin(), co_dev_write_bin_file()
+ */
+co_dev_t *co_dev_create_from_bin_file(const char *filename);
+
+/**
+ * Creates a CANopen device from a binary device description file and allocates
+ * its objects and sub-objects from an arena (see co_dev_set_arena_size()).
+ *
+ * @see co_dev_create_from_bin_file(), co_dev_create_from_bin_arena()
+ */
+co_dev_t *co_dev_create_from_bin_file_arena(
+		const char *filename, size_t arena_size);
+
+/**
+ * Creates a CANopen device from a binary device description file without
+ * copying the object and sub-object names (see co_dev_create_from_bin_ref()).
+ * The file is mapped into memory, if possible, and remains mapped, and open,
+ * until the device is destroyed with co_dev_destroy().
+ *
+ * @param filename a pointer to the name of the file.
+ *
+ * @returns a pointer to a new device, or NULL on error. In the latter case, the
+ * error number can be obtained with get_errc().
+ *
+ * @see co_dev_create_from_bin_file()
+ */
+co_dev_t *co_dev_create_from_bin_file_ref(const char *filename);
+#endif
+
+/**
+ * Writes a binary device description of a CANopen device to a memory buffer.
+ * The image contains all features supported by the library (see
+ * #CO_BDEV_NAME, #CO_BDEV_LIMITS and #CO_BDEV_DEFAULT).
+ *
+ * @param dev   a pointer to a CANopen device.
+ * @param begin a pointer to the start of the buffer. If <b>begin</b> is NULL,
+ *              nothing is written.
+ * @param end   a pointer to the end of the buffer. If the buffer is too small,
+ *              nothing is written.
+ *
+ * @returns the number of bytes that would have been written had the buffer been
+ * sufficiently large, or 0 on error. In the latter case, the error number can
+ * be obtained with get_errc().
+ *
+ * @see co_dev_create_from_bin()
+ */
+size_t co_dev_write_bin(
+		const co_dev_t *dev, uint_least8_t *begin, uint_least8_t *end);
+
+#if !LELY_NO_STDIO
+/**
+ * Writes a binary device description of a CANopen device to a file.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ *
+ * @see co_dev_write_bin(), co_dev_create_from_bin_file()
+ */
+int co_dev_write_bin_file(const co_dev_t *dev, const char *filename);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !LELY_CO_BDEV_H_
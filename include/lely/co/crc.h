@@ -33,8 +33,8 @@ extern "C" {
 
 /**
  * Computes a CRC-16 checksum. This is an implementation of the CRC16-CCITT
- * specification based on the 0x1021 generator polynomial. It uses a table with
- * precomputed values for efficiency.
+ * specification based on the 0x1021 generator polynomial. It uses tables with
+ * precomputed values to process up to 8 bytes at once.
  *
  * As per section 7.2.4.3.16 in CiA 301 version 4.2.0, the CRC of "123456789"
  * (with an initial value of 0x0000) is 0x31c3.
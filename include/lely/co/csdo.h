@@ -43,6 +43,28 @@ extern "C" {
 typedef void co_csdo_dn_con_t(co_csdo_t *sdo, co_unsigned16_t idx,
 		co_unsigned8_t subidx, co_unsigned32_t ac, void *data);
 
+/**
+ * The type of a CANopen Client-SDO download read function, invoked by
+ * co_csdo_dn_src_req() and co_csdo_blk_dn_src_req() whenever the next segment
+ * is not in the user-specified buffer. The same bytes may be requested more
+ * than once if segments have to be resent during a block download.
+ *
+ * @param sdo    a pointer to a Client-SDO service.
+ * @param idx    the object index.
+ * @param subidx the object sub-index.
+ * @param offset the offset (in bytes) of the first byte to be read with respect
+ *               to the start of the value.
+ * @param ptr    the address at which to store the bytes.
+ * @param n      the number of bytes to read.
+ * @param data   a pointer to user-specified data.
+ *
+ * @returns 0 on success, or an SDO abort code on error. In the latter case the
+ * transfer is aborted.
+ */
+typedef co_unsigned32_t co_csdo_dn_read_t(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t offset, void *ptr, size_t n,
+		void *data);
+
 /**
  * The type of a CANopen Client-SDO upload confirmation callback function,
  * invoked when an upload request completes (with success or failure).
@@ -60,6 +82,29 @@ typedef void co_csdo_up_con_t(co_csdo_t *sdo, co_unsigned16_t idx,
 		co_unsigned8_t subidx, co_unsigned32_t ac, const void *ptr,
 		size_t n, void *data);
 
+/**
+ * The type of a CANopen Client-SDO upload chunk function, invoked by
+ * co_csdo_up_buf_req() and co_csdo_blk_up_buf_req() whenever the user-specified
+ * buffer is full, and once more with the remaining bytes before the upload
+ * confirmation.
+ *
+ * @param sdo    a pointer to a Client-SDO service.
+ * @param idx    the object index.
+ * @param subidx the object sub-index.
+ * @param offset the offset (in bytes) of the chunk with respect to the start of
+ *               the value.
+ * @param ptr    a pointer to the bytes in the chunk. The bytes are only valid
+ *               for the duration of the call.
+ * @param n      the number of bytes at <b>ptr</b>.
+ * @param data   a pointer to user-specified data.
+ *
+ * @returns 0 on success, or an SDO abort code on error. In the latter case the
+ * transfer is aborted.
+ */
+typedef co_unsigned32_t co_csdo_up_chunk_t(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t offset, const void *ptr, size_t n,
+		void *data);
+
 /**
  * The type of a CANopen Client-SDO request progress indication function, used
  * to notify the user of the progress of the current upload/download request.
@@ -343,6 +388,32 @@ void co_csdo_abort_req(co_csdo_t *sdo, co_unsigned32_t ac);
 int co_csdo_dn_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		const void *ptr, size_t n, co_csdo_dn_con_t *con, void *data);
 
+/**
+ * Submits a download request to a remote Server-SDO, where the value is read
+ * incrementally from a user-specified source. This function is equivalent to
+ * co_csdo_dn_req(), except that the value does not have to be resident in
+ * memory. The bytes are read with <b>read</b> into the buffer at <b>ptr</b>,
+ * at most <b>n</b> bytes at a time, just before they are sent.
+ *
+ * @param sdo    a pointer to a Client-SDO service.
+ * @param idx    the remote object index.
+ * @param subidx the remote object sub-index.
+ * @param size   the total size (in bytes) of the value.
+ * @param ptr    a pointer to the buffer used to hold the bytes being sent.
+ * @param n      the size (in bytes) of the buffer at <b>ptr</b>. This MUST be
+ *               at least 7 (the size of a single segment).
+ * @param read   a pointer to the download read function.
+ * @param con    a pointer to the confirmation function (can be NULL).
+ * @param data   a pointer to user-specified data (can be NULL). <b>data</b> is
+ *               passed as the last parameter to <b>read</b> and <b>con</b>.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ */
+int co_csdo_dn_src_req(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t size, void *ptr, size_t n,
+		co_csdo_dn_read_t *read, co_csdo_dn_con_t *con, void *data);
+
 /**
  * Submits a download request to a remote Server-SDO. This requests the server
  * to download the value and is equivalent to a write operation into a remote
@@ -405,6 +476,39 @@ int co_csdo_dn_dcf_req(co_csdo_t *sdo, const uint_least8_t *begin,
 int co_csdo_up_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		co_csdo_up_con_t *con, void *data);
 
+/**
+ * Submits an upload request to a remote Server-SDO and stores the received
+ * segments directly in a user-specified buffer. This function is equivalent to
+ * co_csdo_up_req(), except that the internal buffer of the Client-SDO is not
+ * used, so large values are not copied or reallocated.
+ *
+ * If <b>chunk</b> is NULL, the value has to fit in the buffer at <b>ptr</b>,
+ * otherwise the transfer is aborted with #CO_SDO_AC_NO_MEM. The buffer is then
+ * passed to the confirmation function. If <b>chunk</b> is not NULL, the buffer
+ * is passed to <b>chunk</b> whenever it is full, and once more when the
+ * transfer completes, so values larger than the buffer can be streamed. In that
+ * case the confirmation function receives a NULL pointer and the total number
+ * of bytes uploaded.
+ *
+ * @param sdo    a pointer to a Client-SDO service.
+ * @param idx    the remote object index.
+ * @param subidx the remote object sub-index.
+ * @param ptr    a pointer to the buffer in which to store the uploaded bytes
+ *               (can be NULL if <b>chunk</b> is NULL, in which case this
+ *               function is equivalent to co_csdo_up_req()).
+ * @param n      the size (in bytes) of the buffer at <b>ptr</b>.
+ * @param chunk  a pointer to the upload chunk function (can be NULL).
+ * @param con    a pointer to the confirmation function (can be NULL).
+ * @param data   a pointer to user-specified data (can be NULL). <b>data</b> is
+ *               passed as the last parameter to <b>chunk</b> and <b>con</b>.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ */
+int co_csdo_up_buf_req(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, void *ptr, size_t n,
+		co_csdo_up_chunk_t *chunk, co_csdo_up_con_t *con, void *data);
+
 /**
  * Submits a block download request to a remote Server-SDO. This requests the
  * server to download the value and is equivalent to a write operation into a
@@ -427,6 +531,19 @@ int co_csdo_blk_dn_req(co_csdo_t *sdo, co_unsigned16_t idx,
 		co_unsigned8_t subidx, const void *ptr, size_t n,
 		co_csdo_dn_con_t *con, void *data);
 
+/**
+ * Submits a block download request to a remote Server-SDO, where the value is
+ * read incrementally from a user-specified source. This function is equivalent
+ * to co_csdo_blk_dn_req(), except for the way the value is obtained, which is
+ * described in co_csdo_dn_src_req(). A buffer of at least 127 * 7 bytes
+ * allows each block to be read at once.
+ *
+ * @see co_csdo_dn_src_req()
+ */
+int co_csdo_blk_dn_src_req(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t size, void *ptr, size_t n,
+		co_csdo_dn_read_t *read, co_csdo_dn_con_t *con, void *data);
+
 /**
  * Submits a block download request to a remote Server-SDO. This requests the
  * server to download the value and is equivalent to a write operation into a
@@ -474,6 +591,19 @@ int co_csdo_blk_up_req(co_csdo_t *sdo, co_unsigned16_t idx,
 		co_unsigned8_t subidx, co_unsigned8_t pst,
 		co_csdo_up_con_t *con, void *data);
 
+/**
+ * Submits a block upload request to a remote Server-SDO and stores the received
+ * segments directly in a user-specified buffer. This function is equivalent to
+ * co_csdo_blk_up_req(), except for the handling of the uploaded bytes, which is
+ * described in co_csdo_up_buf_req(). If a CRC is generated, it is computed
+ * incrementally over the chunks.
+ *
+ * @see co_csdo_up_buf_req()
+ */
+int co_csdo_blk_up_buf_req(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, co_unsigned8_t pst, void *ptr, size_t n,
+		co_csdo_up_chunk_t *chunk, co_csdo_up_con_t *con, void *data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,22 @@
 // The file location struct from <lely/util/diag.h>.
 struct floc;
 
+/// An EDS or DCF file loaded by co_dev_create_from_dcf_files().
+struct co_dcf_file {
+	/// A pointer to the name of the file.
+	const char *filename;
+	/// A pointer to the device created from the file, or NULL on error.
+	co_dev_t *dev;
+	/// The error number, if #dev is NULL.
+	int errc;
+	/**
+	 * A pointer to the diagnostic messages emitted while loading the file,
+	 * each terminated by a newline, or NULL if there were none. The string
+	 * is allocated with malloc() and MUST be freed by the caller.
+	 */
+	char *diag;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +57,49 @@ struct __co_dev *__co_dev_init_from_dcf_file(
  */
 co_dev_t *co_dev_create_from_dcf_file(const char *filename);
 
+/**
+ * Creates a CANopen device from an EDS or DCF file and allocates its objects
+ * and sub-objects from an arena (see co_dev_set_arena_size()).
+ *
+ * @param filename   the name of the EDS or DCF file.
+ * @param arena_size the size (in bytes) of the blocks of the arena. If 0, the
+ *                   arena is disabled and this function is equivalent to
+ *                   co_dev_create_from_dcf_file().
+ *
+ * @returns a pointer to a new CANopen device, or NULL on error.
+ */
+co_dev_t *co_dev_create_from_dcf_file_arena(
+		const char *filename, size_t arena_size);
+
+/**
+ * Creates a CANopen device for each of a set of EDS or DCF files. The files are
+ * parsed concurrently, by the calling thread and at most <b>nthrd</b> - 1
+ * additional threads, and this function returns once all devices have been
+ * created. The parsers do not share any state, so each file results in an
+ * independent device.
+ *
+ * The diagnostic messages emitted while loading a file are not passed to the
+ * global handler (see diag_set_handler()), but are collected in the
+ * <b>diag</b> member of the corresponding #co_dcf_file struct.
+ *
+ * If multithreading support is disabled, or if the threads cannot be created,
+ * the files are loaded sequentially by the calling thread.
+ *
+ * @param files a pointer to an array of <b>n</b> files. On entry, only the
+ *              <b>filename</b> member of each struct needs to be set. On exit,
+ *              the <b>dev</b>, <b>errc</b> and <b>diag</b> members contain
+ *              the result for each file.
+ * @param n     the number of files at <b>files</b>.
+ * @param nthrd the maximum number of threads used to load the files. If
+ *              <b>nthrd</b> is 0 or 1, the files are loaded sequentially.
+ *
+ * @returns 0 if all devices were created, or -1 if at least one file could not
+ * be loaded. In the latter case, the error number of the first file that
+ * failed can be obtained with get_errc().
+ */
+int co_dev_create_from_dcf_files(
+		struct co_dcf_file *files, size_t n, size_t nthrd);
+
 struct __co_dev *__co_dev_init_from_dcf_text(struct __co_dev *dev,
 		const char *begin, const char *end, struct floc *at);
 
@@ -34,6 +34,54 @@ struct __co_dev {
 	co_unsigned8_t id;
 	/// The tree containing the object dictionary.
 	struct rbtree tree;
+#if !LELY_NO_MALLOC
+	/**
+	 * A pointer to the sorted array of objects in the frozen object
+	 * dictionary, or NULL if the object dictionary is not frozen (see
+	 * co_dev_freeze()).
+	 */
+	co_obj_t **objs;
+	/**
+	 * A pointer to the sorted array of object indices corresponding to
+	 * #objs. The indices are stored separately to speed up the search.
+	 */
+	co_unsigned16_t *keys;
+	/// The number of objects at #objs (and indices at #keys).
+	size_t nobjs;
+	/**
+	 * A pointer to the array of sub-objects in the frozen object
+	 * dictionary, sorted by object index and sub-index. Each object refers
+	 * to the slice containing its sub-objects.
+	 */
+	co_sub_t **subs;
+	/// The number of sub-objects at #subs.
+	size_t nsubs;
+	/**
+	 * A pointer to the most recently allocated block of the arena, or
+	 * NULL if no memory has been allocated from the arena.
+	 */
+	struct co_dev_arena *arena;
+	/// The size (in bytes) of the arena blocks, or 0 if disabled.
+	size_t arena_size;
+	/**
+	 * The modification counter, incremented whenever a sub-object value or
+	 * the structure of the object dictionary changes (see co_dev_touch()).
+	 */
+	co_unsigned32_t gen;
+	/**
+	 * The layout counter, incremented whenever the structure of the object
+	 * dictionary or the node-ID changes.
+	 */
+	co_unsigned32_t layout;
+#if !LELY_NO_STDIO
+	/**
+	 * A pointer to the read file buffer containing the memory-mapped binary
+	 * device description referenced by the objects, or NULL (see
+	 * co_dev_create_from_bin_file_ref()).
+	 */
+	struct __frbuf *image;
+#endif
+#endif
 #if !LELY_NO_CO_OBJ_NAME
 	/// A pointer to the name of the device.
 	char *name;
@@ -43,6 +43,28 @@ struct __co_obj {
 #endif
 	/// The tree containing all the sub-objects.
 	struct rbtree tree;
+#if !LELY_NO_MALLOC
+	/**
+	 * A pointer to the sorted array of sub-objects in the frozen object
+	 * dictionary (see co_dev_freeze()), or NULL if the object dictionary
+	 * is not frozen. The array is part of the array owned by the device.
+	 */
+	co_sub_t **subs;
+	/// The number of sub-objects at #subs.
+	size_t nsubs;
+	/**
+	 * A flag indicating whether this object was allocated from the arena
+	 * of a device (see co_dev_set_arena_size()).
+	 */
+	unsigned arena : 1;
+	/// A flag indicating whether #name was allocated from an arena.
+	unsigned arena_name : 1;
+	/**
+	 * A flag indicating whether #name is owned by the caller (see
+	 * co_obj_set_name_ref()).
+	 */
+	unsigned ref_name : 1;
+#endif
 	/// A pointer to the object value.
 	void *val;
 	/// The size (in bytes) of the value at #val.
@@ -91,6 +113,25 @@ struct __co_sub {
 	/// A pointer to user-specified data for #up_ind.
 	void *up_data;
 #endif
+#if !LELY_NO_MALLOC
+	/**
+	 * A flag indicating whether this sub-object was allocated from the
+	 * arena of a device (see co_dev_set_arena_size()).
+	 */
+	unsigned arena : 1;
+	/// A flag indicating whether #name was allocated from an arena.
+	unsigned arena_name : 1;
+	/**
+	 * A flag indicating whether #name is owned by the caller (see
+	 * co_sub_set_name_ref()).
+	 */
+	unsigned ref_name : 1;
+	/**
+	 * The value of the modification counter of the device at the time the
+	 * value of this sub-object was last changed (see co_dev_touch()).
+	 */
+	co_unsigned32_t gen;
+#endif
 };
 
 #ifdef __cplusplus
@@ -82,6 +82,11 @@ struct co_id {
 /// Automatic bit rate detection.
 #define CO_BAUD_AUTO 0x0200
 
+#if !LELY_NO_MALLOC
+/// An opaque concise DCF cache type.
+typedef struct co_dcf_cache co_dcf_cache_t;
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -255,6 +260,82 @@ co_obj_t *co_dev_first_obj(const co_dev_t *dev);
  */
 co_obj_t *co_dev_last_obj(const co_dev_t *dev);
 
+#if !LELY_NO_MALLOC
+
+/**
+ * Freezes the object dictionary of a CANopen device. This function builds a
+ * compact index of the objects and sub-objects: sorted, contiguous arrays of
+ * pointers which are searched with a binary search (or direct indexing, if
+ * the sub-indices of an object are contiguous), instead of two tree walks.
+ * co_dev_find_obj(), co_dev_find_sub() and co_obj_find_sub() use this index
+ * while the object dictionary is frozen. This function SHOULD be invoked after
+ * the object dictionary has been loaded (e.g., from a DCF file).
+ *
+ * Inserting or removing objects or sub-objects is still allowed, but it thaws
+ * the object dictionary (see co_dev_thaw()). Modifying sub-object values does
+ * not.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ *
+ * @see co_dev_thaw(), co_dev_is_frozen()
+ */
+int co_dev_freeze(co_dev_t *dev);
+
+/**
+ * Thaws the object dictionary of a CANopen device by discarding the index
+ * created by co_dev_freeze(). This function has no effect if the object
+ * dictionary is not frozen.
+ */
+void co_dev_thaw(co_dev_t *dev);
+
+/**
+ * Returns 1 if the object dictionary of a CANopen device is frozen, and 0 if
+ * not.
+ *
+ * @see co_dev_freeze()
+ */
+int co_dev_is_frozen(const co_dev_t *dev);
+
+/**
+ * Returns the size (in bytes) of the blocks of the arena used for the objects
+ * of a CANopen device, or 0 if the arena is disabled.
+ *
+ * @see co_dev_set_arena_size()
+ */
+size_t co_dev_get_arena_size(const co_dev_t *dev);
+
+/**
+ * Sets the size (in bytes) of the blocks of the arena used for the objects of
+ * a CANopen device. Objects and sub-objects created for this device with
+ * co_obj_create_in() and co_sub_create_in(), and their first names, are
+ * allocated from this arena instead of with separate calls to malloc(). The
+ * arena is released in one go when the device is destroyed. The arena is
+ * disabled by default.
+ *
+ * Objects allocated from the arena can still be removed from the object
+ * dictionary and destroyed, but their memory is only reclaimed once the device
+ * is destroyed. They MUST NOT outlive the device.
+ *
+ * @param dev  a pointer to a CANopen device.
+ * @param size the size (in bytes) of each block. If 0, the arena is disabled
+ *             for subsequently loaded objects, but memory already allocated
+ *             from it remains valid until the device is destroyed.
+ *
+ * @see co_dev_get_arena_size()
+ */
+void co_dev_set_arena_size(co_dev_t *dev, size_t size);
+
+/**
+ * Returns 1 if <b>ptr</b> points to memory allocated from the arena of a
+ * CANopen device, and 0 if not.
+ *
+ * @see co_dev_set_arena_size()
+ */
+int co_dev_in_arena(const co_dev_t *dev, const void *ptr);
+
+#endif // !LELY_NO_MALLOC
+
 #if !LELY_NO_CO_OBJ_NAME
 
 /// Returns the name of a CANopen device. @see co_dev_set_name()
@@ -568,6 +649,50 @@ int co_dev_write_dcf(const co_dev_t *dev, co_unsigned16_t min,
 int co_dev_write_dcf_file(const co_dev_t *dev, co_unsigned16_t min,
 		co_unsigned16_t max, const char *filename);
 
+#if !LELY_NO_MALLOC
+
+/**
+ * Creates a cache for the concise DCF of a range of objects in the object
+ * dictionary of a CANopen device. The cache records the location of each
+ * sub-object in the concise DCF, so subsequent calls to co_dcf_cache_get() only
+ * re-serialize the sub-objects whose value changed (through co_sub_set_val() or
+ * an SDO download) since the previous call. A change in the structure of the
+ * object dictionary or the node-ID causes the concise DCF to be rebuilt. Note
+ * that changes made through the pointers returned by co_sub_addressof_val() are
+ * _not_ detected.
+ *
+ * @param dev a pointer to a CANopen device. The device MUST outlive the cache.
+ * @param min the minimum object index.
+ * @param max the maximum object index.
+ *
+ * @returns a pointer to a new cache, or NULL on error. In the latter case, the
+ * error number can be obtained with get_errc().
+ *
+ * @see co_dcf_cache_destroy(), co_dev_write_dcf()
+ */
+co_dcf_cache_t *co_dcf_cache_create(
+		const co_dev_t *dev, co_unsigned16_t min, co_unsigned16_t max);
+
+/// Destroys a concise DCF cache. @see co_dcf_cache_create()
+void co_dcf_cache_destroy(co_dcf_cache_t *cache);
+
+/**
+ * Brings a concise DCF cache up to date with its device and returns the
+ * concise DCF. The result is identical to the DOMAIN value produced by
+ * co_dev_write_dcf().
+ *
+ * @param cache a pointer to a concise DCF cache.
+ * @param psize the address at which to store the size (in bytes) of the concise
+ *              DCF (can be NULL).
+ *
+ * @returns a pointer to the concise DCF, or NULL on error. In the latter case,
+ * the error number can be obtained with get_errc(). The pointer remains valid
+ * until the next call to co_dcf_cache_get() or co_dcf_cache_destroy().
+ */
+const void *co_dcf_cache_get(co_dcf_cache_t *cache, size_t *psize);
+
+#endif // !LELY_NO_MALLOC
+
 /**
  * Retrieves the indication function invoked by co_dev_tpdo_event() when an
  * event is indicated for (a sub-object mapped into) an acyclic or event-driven
@@ -24,6 +24,9 @@
 
 #include <lely/can/net.h>
 #include <lely/co/type.h>
+#include <lely/libc/time.h>
+
+#include <stddef.h>
 
 /// The bit in the EMCY COB-ID specifying whether the EMCY exists and is valid.
 #define CO_EMCY_COBID_VALID UINT32_C(0x80000000)
@@ -34,6 +37,23 @@
  */
 #define CO_EMCY_COBID_FRAME UINT32_C(0x20000000)
 
+/// The CAN identifier used for the pre-defined EMCY COB-ID of a node.
+#define CO_EMCY_CANID(id) (0x080 + ((id)&0x7f))
+
+/// An EMCY message received by the EMCY consumer service.
+struct co_emcy_event {
+	/// The time at which the message was received.
+	struct timespec time;
+	/// The node-ID of the producer.
+	co_unsigned8_t id;
+	/// The error register.
+	co_unsigned8_t er;
+	/// The emergency error code.
+	co_unsigned16_t eec;
+	/// The manufacturer-specific error code.
+	co_unsigned8_t msef[5];
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -196,6 +216,58 @@ void co_emcy_get_ind(const co_emcy_t *emcy, co_emcy_ind_t **pind, void **pdata);
  */
 void co_emcy_set_ind(co_emcy_t *emcy, co_emcy_ind_t *ind, void *data);
 
+/**
+ * Returns the capacity of the EMCY event ring of an EMCY consumer service, or 0
+ * if the ring is disabled.
+ *
+ * @see co_emcy_set_ring_size()
+ */
+size_t co_emcy_get_ring_size(const co_emcy_t *emcy);
+
+/**
+ * Sets the capacity of the EMCY event ring of an EMCY consumer service. When
+ * enabled, every received EMCY message is stored in the ring, together with
+ * the node-ID of the producer and the time of reception, before the indication
+ * function is invoked. The ring is a lock-free single-producer,
+ * single-consumer queue; the events can be read with co_emcy_read_ring() from
+ * a thread other than the one processing CAN frames. Messages received while
+ * the ring is full are dropped (see co_emcy_get_ring_dropped()). The ring
+ * never allocates memory after this function returns.
+ *
+ * This function discards any events in the ring. It MUST NOT be invoked
+ * concurrently with co_emcy_read_ring() or the processing of CAN frames.
+ *
+ * @param emcy a pointer to an EMCY consumer service.
+ * @param n    the maximum number of events in the ring (0 to disable the ring).
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ *
+ * @see co_emcy_get_ring_size()
+ */
+int co_emcy_set_ring_size(co_emcy_t *emcy, size_t n);
+
+/**
+ * Reads, and removes, EMCY events from the EMCY event ring of an EMCY consumer
+ * service. The events are returned in the order in which they were received.
+ *
+ * @param emcy   a pointer to an EMCY consumer service.
+ * @param events the address of an array of at least <b>n</b> events.
+ * @param n      the maximum number of events to read.
+ *
+ * @returns the number of events read.
+ *
+ * @see co_emcy_set_ring_size()
+ */
+size_t co_emcy_read_ring(
+		co_emcy_t *emcy, struct co_emcy_event *events, size_t n);
+
+/**
+ * Returns the total number of EMCY messages dropped because the EMCY event ring
+ * of an EMCY consumer service was full.
+ */
+size_t co_emcy_get_ring_dropped(const co_emcy_t *emcy);
+
 #ifdef __cplusplus
 }
 #endif
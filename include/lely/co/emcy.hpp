@@ -133,6 +133,26 @@ class COEmcy : public incomplete_c_type<__co_emcy> {
            static_cast<void*>(obj));
   }
 
+  size_t
+  getRingSize() const noexcept {
+    return co_emcy_get_ring_size(this);
+  }
+
+  int
+  setRingSize(size_t n) noexcept {
+    return co_emcy_set_ring_size(this, n);
+  }
+
+  size_t
+  readRing(co_emcy_event* events, size_t n) noexcept {
+    return co_emcy_read_ring(this, events, n);
+  }
+
+  size_t
+  getRingDropped() const noexcept {
+    return co_emcy_get_ring_dropped(this);
+  }
+
  protected:
   ~COEmcy() = default;
 };
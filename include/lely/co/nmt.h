@@ -89,6 +89,39 @@ enum {
 	CO_NMT_EC_STATE
 };
 
+/// The phases of the NMT 'boot slave' process, as reported in its statistics.
+enum {
+	/// Checking the identity (objects 1000 and 1018) of the slave.
+	CO_NMT_BOOT_PHASE_ID,
+	/// Checking and, if necessary, updating the software of the slave.
+	CO_NMT_BOOT_PHASE_SW,
+	/// Checking and, if necessary, updating the configuration of the slave.
+	CO_NMT_BOOT_PHASE_CFG,
+	/// Starting the error control service.
+	CO_NMT_BOOT_PHASE_EC,
+	/// The number of phases.
+	CO_NMT_BOOT_NUM_PHASES
+};
+
+/// The statistics of the last NMT 'boot slave' process of a slave.
+struct co_nmt_boot_stats {
+	/**
+	 * The time (in milliseconds) the request was queued because the
+	 * maximum number of concurrent 'boot slave' processes was reached.
+	 */
+	co_unsigned32_t wait;
+	/// The total duration (in milliseconds) of the process.
+	co_unsigned32_t total;
+	/// The time (in milliseconds) spent in each phase of the process.
+	co_unsigned32_t phase[CO_NMT_BOOT_NUM_PHASES];
+	/**
+	 * A flag indicating whether the 'update configuration' step was skipped
+	 * because the configuration hash stored on the slave matched (see
+	 * co_nmt_set_cfg_hash()).
+	 */
+	unsigned cfg_skipped : 1;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -200,6 +233,26 @@ typedef void co_nmt_lss_req_t(co_nmt_t *nmt, co_lss_t *lss, void *data);
 typedef void co_nmt_boot_ind_t(co_nmt_t *nmt, co_unsigned8_t id,
 		co_unsigned8_t st, char es, void *data);
 
+/**
+ * The type of a CANopen NMT program data read function, invoked during the
+ * 'download program' step of the 'boot slave' process to obtain the next part
+ * of the program data of a slave (see co_nmt_set_prog_src()). The same bytes
+ * may be requested more than once if SDO segments have to be resent.
+ *
+ * @param nmt    a pointer to an NMT master service.
+ * @param id     the node-ID of the slave (in the range [1..127]).
+ * @param offset the offset (in bytes) of the first byte to be read with respect
+ *               to the start of the program data.
+ * @param ptr    the address at which to store the bytes.
+ * @param n      the number of bytes to read.
+ * @param data   a pointer to user-specified data.
+ *
+ * @returns 0 on success, or an SDO abort code on error. In the latter case the
+ * download is aborted.
+ */
+typedef co_unsigned32_t co_nmt_prog_read_t(co_nmt_t *nmt, co_unsigned8_t id,
+		size_t offset, void *ptr, size_t n, void *data);
+
 /**
  * The type of a CANopen NMT 'update configuration' indication function, invoked
  * when a configuration request is received. This function MUST cause
@@ -806,6 +859,160 @@ int co_nmt_boot_req(co_nmt_t *nmt, co_unsigned8_t id, int timeout);
  */
 int co_nmt_is_booting(const co_nmt_t *nmt, co_unsigned8_t id);
 
+/**
+ * Returns the maximum number of concurrent NMT 'boot slave' processes, or 0 if
+ * there is no limit.
+ *
+ * @see co_nmt_set_boot_max()
+ */
+int co_nmt_get_boot_max(const co_nmt_t *nmt);
+
+/**
+ * Sets the maximum number of concurrent NMT 'boot slave' processes. If the
+ * maximum is reached, co_nmt_boot_req() queues the request. Queued requests are
+ * started as soon as a running process completes, mandatory slaves (bit 3 in
+ * object 1F81) first, then in order of priority (see co_nmt_set_boot_prio()),
+ * then in order of node-ID. A queued slave is reported as booting by
+ * co_nmt_is_booting().
+ *
+ * @param nmt a pointer to an NMT master service.
+ * @param max the maximum number of concurrent processes, or 0 if there is no
+ *            limit (the default).
+ *
+ * @see co_nmt_get_boot_max()
+ */
+void co_nmt_set_boot_max(co_nmt_t *nmt, int max);
+
+/**
+ * Returns the priority with which the NMT 'boot slave' process for the
+ * specified node is started if requests are queued (see co_nmt_set_boot_max()).
+ * A lower value means a higher priority. On error, 0 is returned.
+ *
+ * @see co_nmt_set_boot_prio()
+ */
+co_unsigned8_t co_nmt_get_boot_prio(const co_nmt_t *nmt, co_unsigned8_t id);
+
+/**
+ * Sets the priority with which the NMT 'boot slave' process for the specified
+ * node is started if requests are queued (see co_nmt_set_boot_max()).
+ *
+ * @param nmt  a pointer to an NMT master service.
+ * @param id   the node-ID (in the range [1..127]).
+ * @param prio the priority (0 is the highest and the default).
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ *
+ * @see co_nmt_get_boot_prio()
+ */
+int co_nmt_set_boot_prio(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t prio);
+
+/**
+ * Retrieves the statistics of the last completed NMT 'boot slave' process for
+ * the specified node. The durations are measured with the CAN network clock
+ * (see can_net_get_time()).
+ *
+ * @param nmt   a pointer to an NMT master service.
+ * @param id    the node-ID (in the range [1..127]).
+ * @param stats the address at which to store the statistics.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ */
+int co_nmt_get_boot_stats(const co_nmt_t *nmt, co_unsigned8_t id,
+		struct co_nmt_boot_stats *stats);
+
+/**
+ * Retrieves the sub-object on the slaves in which the hash of their concise DCF
+ * is stored. See co_nmt_set_cfg_hash().
+ *
+ * @param nmt     a pointer to an NMT master service.
+ * @param pidx    the address at which to store the object index (can be NULL).
+ * @param psubidx the address at which to store the object sub-index (can be
+ *                NULL).
+ */
+void co_nmt_get_cfg_hash(const co_nmt_t *nmt, co_unsigned16_t *pidx,
+		co_unsigned8_t *psubidx);
+
+/**
+ * Sets the sub-object on the slaves in which the hash of their concise DCF
+ * (sub-object 1F22:ID) is stored. If the expected configuration date and time
+ * (objects 1F26 and 1F27) are not set for a slave, the 'check configuration'
+ * step of the NMT 'boot slave' process reads this UNSIGNED32 sub-object and
+ * skips the 'update configuration' step if its value matches the hash of the
+ * concise DCF. Otherwise, the hash is written to the slave after the
+ * configuration has been updated. The slave SHOULD store the value
+ * persistently, together with the rest of its configuration.
+ *
+ * @param nmt    a pointer to an NMT master service.
+ * @param idx    the object index, or 0 to disable the hash check (the default).
+ * @param subidx the object sub-index.
+ *
+ * @see co_nmt_get_cfg_hash()
+ */
+void co_nmt_set_cfg_hash(
+		co_nmt_t *nmt, co_unsigned16_t idx, co_unsigned8_t subidx);
+
+/**
+ * Computes the hash of a concise DCF, as used by the 'check configuration'
+ * step of the NMT 'boot slave' process (see co_nmt_set_cfg_hash()). The hash
+ * is the 32-bit FNV-1a hash of the bytes.
+ */
+co_unsigned32_t co_nmt_cfg_hash(const void *ptr, size_t n);
+
+/**
+ * Retrieves the source of the program data downloaded to a slave during the
+ * 'boot slave' process. See co_nmt_set_prog_src().
+ *
+ * @param nmt   a pointer to an NMT master service.
+ * @param id    the node-ID (in the range [1..127]).
+ * @param psize the address at which to store the size (in bytes) of the
+ *              program data (can be NULL).
+ * @param pread the address at which to store a pointer to the program data
+ *              read function (can be NULL).
+ * @param pdata the address at which to store a pointer to user-specified data
+ *              (can be NULL).
+ */
+void co_nmt_get_prog_src(const co_nmt_t *nmt, co_unsigned8_t id,
+		size_t *psize, co_nmt_prog_read_t **pread, void **pdata);
+
+/**
+ * Sets the source of the program data downloaded to a slave during the 'boot
+ * slave' process. By default, the program data is taken from sub-object
+ * 1F58:ID, which requires the entire image to be resident in the object
+ * dictionary of the master. If a read function is specified, the program data
+ * is instead read incrementally, one SDO block at a time, while it is
+ * downloaded to the program data of the slave (sub-object 1F50:01). The amount
+ * of memory used per slave is bounded by LELY_CO_NMT_BOOT_PROG_BUFSIZE.
+ *
+ * @param nmt  a pointer to an NMT master service.
+ * @param id   the node-ID (in the range [1..127]).
+ * @param size the size (in bytes) of the program data.
+ * @param read a pointer to the function used to read the program data, or NULL
+ *             to use sub-object 1F58:ID.
+ * @param data a pointer to user-specified data (can be NULL). <b>data</b> is
+ *             passed as the last parameter to <b>read</b>.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ *
+ * @see co_nmt_get_prog_src()
+ */
+int co_nmt_set_prog_src(co_nmt_t *nmt, co_unsigned8_t id, size_t size,
+		co_nmt_prog_read_t *read, void *data);
+
+#if !LELY_NO_STDIO
+/**
+ * A program data read function reading from a file. <b>data</b> MUST be a
+ * pointer to a read file buffer (see frbuf_create()), which is accessed with
+ * frbuf_pread(), so the file is never loaded in its entirety.
+ *
+ * @see co_nmt_prog_read_t
+ */
+co_unsigned32_t co_nmt_prog_frbuf_read(co_nmt_t *nmt, co_unsigned8_t id,
+		size_t offset, void *ptr, size_t n, void *data);
+#endif
+
 /**
  * Checks if a boot-up message has been received from the specified node(s).
  *
@@ -183,6 +183,22 @@ co_obj_t *co_obj_create(co_unsigned16_t idx);
 /// Destroys a CANopen object, including its sub-objects. @see co_obj_create()
 void co_obj_destroy(co_obj_t *obj);
 
+/**
+ * Creates a CANopen object, using the arena of the specified device, if it has
+ * one (see co_dev_set_arena_size()). The object is not inserted into the object
+ * dictionary of the device. If the object is allocated from the arena, so is
+ * its first name. The object MUST NOT outlive the device.
+ *
+ * @param dev a pointer to a CANopen device (can be NULL).
+ * @param idx the object index.
+ *
+ * @returns a pointer to a new CANopen object, or NULL on error. In the latter
+ * case, the error number can be obtained with get_errc().
+ *
+ * @see co_obj_create(), co_obj_destroy()
+ */
+co_obj_t *co_obj_create_in(co_dev_t *dev, co_unsigned16_t idx);
+
 #endif // !LELY_NO_MALLOC
 
 /**
@@ -293,6 +309,21 @@ const char *co_obj_get_name(const co_obj_t *obj);
  */
 int co_obj_set_name(co_obj_t *obj, const char *name);
 
+/**
+ * Sets the name of a CANopen object without copying it. Unlike
+ * co_obj_set_name(), this does not allocate memory, which is useful when the
+ * names are already present in memory, such as in a memory-mapped binary
+ * device description (see co_dev_create_from_bin_ref()).
+ *
+ * @param obj  a pointer to a CANopen object.
+ * @param name a pointer to the null-terminated name (can be NULL). The string
+ *             MUST remain valid, and unmodified, for the lifetime of the
+ *             object, or until its name is changed.
+ *
+ * @see co_obj_get_name()
+ */
+void co_obj_set_name_ref(co_obj_t *obj, const char *name);
+
 /// Returns the object code of a CANopen object. @see co_obj_set_code()
 co_unsigned8_t co_obj_get_code(const co_obj_t *obj);
 
@@ -416,6 +447,18 @@ co_sub_t *co_sub_create(co_unsigned8_t subidx, co_unsigned16_t type);
 /// Destroys a CANopen sub-object. @see co_sub_create()
 void co_sub_destroy(co_sub_t *sub);
 
+/**
+ * Creates a CANopen sub-object, using the arena of the specified device, if it
+ * has one. See co_obj_create_in().
+ *
+ * @returns a pointer to a new CANopen sub-object, or NULL on error. In the
+ * latter case, the error number can be obtained with get_errc().
+ *
+ * @see co_sub_create(), co_sub_destroy()
+ */
+co_sub_t *co_sub_create_in(
+		co_dev_t *dev, co_unsigned8_t subidx, co_unsigned16_t type);
+
 #endif // !LELY_NO_MALLOC
 
 /**
@@ -460,6 +503,21 @@ const char *co_sub_get_name(const co_sub_t *sub);
  */
 int co_sub_set_name(co_sub_t *sub, const char *name);
 
+/**
+ * Sets the name of a CANopen sub-object without copying it. Unlike
+ * co_sub_set_name(), this does not allocate memory, which is useful when the
+ * names are already present in memory, such as in a memory-mapped binary
+ * device description (see co_dev_create_from_bin_ref()).
+ *
+ * @param sub  a pointer to a CANopen sub-object.
+ * @param name a pointer to the null-terminated name (can be NULL). The string
+ *             MUST remain valid, and unmodified, for the lifetime of the
+ *             sub-object, or until its name is changed.
+ *
+ * @see co_sub_get_name()
+ */
+void co_sub_set_name_ref(co_sub_t *sub, const char *name);
+
 /// Returns the data type of a CANopen sub-object.
 co_unsigned16_t co_sub_get_type(const co_sub_t *sub);
 
@@ -898,7 +956,7 @@ int co_sub_on_up(const co_sub_t *sub, struct co_sdo_req *req,
  * with co_sub_set_up_ind(). This is used for reading values from the object
  * dictionary.
  *
- * @param sub a pointer to a CANopen sub-object.
+ * @param sub  a pointer to a CANopen sub-object.
  * @param req a pointer to a CANopen SDO upload request. The <b>size</b> member
  *            of *<b>req</b> MUST be set to 0 on the first invocation. All
  *            members MUST be initialized by the indication function.
@@ -124,6 +124,11 @@ class COObj : public incomplete_c_type<__co_obj> {
     return co_obj_set_name(this, name);
   }
 
+  void
+  setNameRef(const char* name) noexcept {
+    co_obj_set_name_ref(this, name);
+  }
+
   co_unsigned8_t
   getCode() const noexcept {
     return co_obj_get_code(this);
@@ -254,6 +259,11 @@ class COSub : public incomplete_c_type<__co_sub> {
     return co_sub_set_name(this, name);
   }
 
+  void
+  setNameRef(const char* name) noexcept {
+    co_sub_set_name_ref(this, name);
+  }
+
   co_unsigned8_t
   getType() const noexcept {
     return co_sub_get_type(this);
@@ -119,6 +119,21 @@ struct __co_dev *__co_dev_init_from_sdev(
  */
 co_dev_t *co_dev_create_from_sdev(const struct co_sdev *sdev);
 
+/**
+ * Creates a CANopen device from a static device description and allocates its
+ * objects and sub-objects from an arena (see co_dev_set_arena_size()).
+ *
+ * @param sdev       a pointer to a static device description.
+ * @param arena_size the size (in bytes) of the blocks of the arena. If 0, the
+ *                   arena is disabled and this function is equivalent to
+ *                   co_dev_create_from_sdev().
+ *
+ * @returns a pointer to a new device, or NULL on error. In the latter case, the
+ * error number can be obtained with get_errc().
+ */
+co_dev_t *co_dev_create_from_sdev_arena(
+		const struct co_sdev *sdev, size_t arena_size);
+
 /**
  * Prints a C99 static initializer code fragment for a static device description
  * (struct #co_sdev) to a string buffer.
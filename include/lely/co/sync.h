@@ -117,6 +117,18 @@ can_net_t *co_sync_get_net(const co_sync_t *sync);
 /// Returns a pointer to the CANopen device of a SYNC producer/consumer service.
 co_dev_t *co_sync_get_dev(const co_sync_t *sync);
 
+/**
+ * Retrieves the time at which the last SYNC message was received or transmitted
+ * by a SYNC producer/consumer service. For received messages, this is the
+ * receive time reported by the CAN network interface (see
+ * can_net_get_recv_time()), which allows the SYNC jitter to be measured from
+ * the indication function independently of the processing latency.
+ *
+ * @param sync a pointer to a SYNC producer/consumer service.
+ * @param tp   the address at which to store the time (can be NULL).
+ */
+void co_sync_get_time(const co_sync_t *sync, struct timespec *tp);
+
 /**
  * Retrieves the indication function invoked after a CANopen SYNC message is
  * received or transmitted.
@@ -89,6 +89,11 @@ class COSync : public incomplete_c_type<__co_sync> {
     return co_sync_get_dev(this);
   }
 
+  void
+  getTime(timespec* tp) const noexcept {
+    co_sync_get_time(this, tp);
+  }
+
   void
   getInd(co_sync_ind_t** pind, void** pdata) const noexcept {
     co_sync_get_ind(this, pind, pdata);
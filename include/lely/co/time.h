@@ -25,6 +25,8 @@
 #include <lely/can/net.h>
 #include <lely/co/type.h>
 
+#include <stddef.h>
+
 /// The bit in the TIME COB-ID specifying whether the device is a consumer.
 #define CO_TIME_COBID_CONSUMER UINT32_C(0x80000000)
 
@@ -37,6 +39,48 @@
  */
 #define CO_TIME_COBID_FRAME UINT32_C(0x20000000)
 
+/// The statistics of a TIME producer. @see co_time_get_prod_stats()
+struct co_time_prod_stats {
+	/// The number of confirmed time stamps.
+	size_t n;
+	/**
+	 * The estimated delay (in nanoseconds) between the expiration of the
+	 * producer timer and the write confirmation of a time stamp. The
+	 * producer sends each time stamp this much ahead of its value.
+	 */
+	int_least64_t delay;
+	/**
+	 * The difference (in nanoseconds) between the write confirmation and
+	 * the value of the most recent time stamp.
+	 */
+	int_least64_t error;
+	/// The largest absolute value of #error (in nanoseconds).
+	int_least64_t error_max;
+};
+
+/// The statistics of a TIME consumer. @see co_time_get_cons_stats()
+struct co_time_cons_stats {
+	/// The number of time stamps received.
+	size_t n;
+	/**
+	 * The estimated offset (in nanoseconds) of the local clock with respect
+	 * to the producer at the reception of the most recent time stamp. This
+	 * is the offset before the correction, if any, is applied.
+	 */
+	int_least64_t offset;
+	/**
+	 * The estimated drift (in parts per billion) of the local clock with
+	 * respect to the producer. A positive value means the local clock runs
+	 * fast.
+	 */
+	int_least32_t drift;
+	/**
+	 * The mean absolute difference (in nanoseconds) between the measured
+	 * and the predicted offset.
+	 */
+	int_least64_t jitter;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +96,19 @@ extern "C" {
 typedef void co_time_ind_t(
 		co_time_t *time, const struct timespec *tp, void *data);
 
+/**
+ * The type of a CANopen TIME clock adjustment function, invoked by the servo of
+ * a TIME consumer after a time stamp is received. The function is expected to
+ * add <b>nsec</b> to the clock used for the CAN network interface, for example
+ * with io_clock_gettime() and io_clock_settime().
+ *
+ * @param time a pointer to a TIME consumer service.
+ * @param nsec the correction (in nanoseconds).
+ * @param data a pointer to user-specified data.
+ */
+typedef void co_time_adj_func_t(
+		co_time_t *time, int_least64_t nsec, void *data);
+
 /**
  * Loads the absolute time from a CANopen TIME_OF_DAY value.
  *
@@ -164,16 +221,65 @@ void co_time_get_ind(const co_time_t *time, co_time_ind_t **pind, void **pdata);
  */
 void co_time_set_ind(co_time_t *time, co_time_ind_t *ind, void *data);
 
+/**
+ * Retrieves the clock adjustment function invoked by the servo of a TIME
+ * consumer.
+ *
+ * @param time  a pointer to a TIME consumer service.
+ * @param pfunc the address at which to store a pointer to the adjustment
+ *              function (can be NULL).
+ * @param pdata the address at which to store a pointer to user-specified data
+ *              (can be NULL).
+ *
+ * @see co_time_set_adj_func()
+ */
+void co_time_get_adj_func(const co_time_t *time, co_time_adj_func_t **pfunc,
+		void **pdata);
+
+/**
+ * Sets the clock adjustment function invoked by the servo of a TIME consumer.
+ * The servo is a proportional-integral controller estimating the offset and
+ * drift of the local clock with respect to the producer from the reception
+ * time of each time stamp (see can_net_recv_at()). If an adjustment function is
+ * set, the servo disciplines the local clock by stepping it with the estimated
+ * offset on the first time stamp, and correcting it on each subsequent one.
+ *
+ * @param time a pointer to a TIME consumer service.
+ * @param func a pointer to the function to be invoked (can be NULL).
+ * @param data a pointer to user-specified data (can be NULL). <b>data</b> is
+ *             passed as the last parameter to <b>func</b>.
+ *
+ * @see co_time_get_adj_func()
+ */
+void co_time_set_adj_func(
+		co_time_t *time, co_time_adj_func_t *func, void *data);
+
+/**
+ * Retrieves the statistics of a TIME consumer, including the estimated offset
+ * and drift of the local clock.
+ *
+ * @see co_time_set_adj_func()
+ */
+void co_time_get_cons_stats(
+		const co_time_t *time, struct co_time_cons_stats *stats);
+
 /**
  * Starts a CANopen TIME producer. This function has no effect if the TIME
  * service is not a producer.
  *
+ * Time stamps are scheduled to be written at a whole millisecond, the
+ * resolution of a TIME_OF_DAY value. If write confirmations are reported with
+ * co_time_confirm(), each time stamp is sent ahead of its value by the
+ * estimated transmit delay, so the value matches the time at which it is
+ * written.
+ *
  * @param time     a pointer to a TIME producer service.
  * @param start    a pointer to the _absolute_ time when the next time stamp is
  *                 to be sent. If <b>start</b> is NULL, this time is given by
  *                 <b>interval</b> with respect to the current time as obtained
  *                 with can_net_get_time(). If <b>interval</b> is also NULL, the
- *                 producer is stopped.
+ *                 producer is stopped. The time is rounded up to the next
+ *                 millisecond.
  * @param interval a pointer to the interval between successive time stamps. If
  *                 <b>interval</b> is NULL, only a single time stamp is sent, at
  *                 the time given by <b>start</b>.
@@ -186,6 +292,27 @@ void co_time_start_prod(co_time_t *time, const struct timespec *start,
 /// Stops a CANopen TIME producer. @see co_time_start_prod()
 void co_time_stop_prod(co_time_t *time);
 
+/**
+ * Notifies a TIME producer that a CAN frame was written. If the frame is the
+ * most recent time stamp, its write confirmation time is used to update the
+ * estimated transmit delay. This function can be invoked from the function set
+ * with io_can_net_set_on_confirm_func(); frames other than time stamps are
+ * ignored.
+ *
+ * @param time a pointer to a TIME producer service.
+ * @param msg  a pointer to the CAN frame that was written.
+ * @param tp   a pointer to the time at which the write confirmation was
+ *             received, with respect to the clock used by can_net_get_time().
+ *
+ * @see co_time_get_prod_stats()
+ */
+void co_time_confirm(co_time_t *time, const struct can_msg *msg,
+		const struct timespec *tp);
+
+/// Retrieves the statistics of a TIME producer. @see co_time_confirm()
+void co_time_get_prod_stats(
+		const co_time_t *time, struct co_time_prod_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
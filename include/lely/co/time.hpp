@@ -122,6 +122,31 @@ class COTime : public incomplete_c_type<__co_time> {
     co_time_stop_prod(this);
   }
 
+  void
+  confirm(const can_msg& msg, const timespec& tp) noexcept {
+    co_time_confirm(this, &msg, &tp);
+  }
+
+  void
+  getProdStats(co_time_prod_stats* stats) const noexcept {
+    co_time_get_prod_stats(this, stats);
+  }
+
+  void
+  getAdjFunc(co_time_adj_func_t** pfunc, void** pdata) const noexcept {
+    co_time_get_adj_func(this, pfunc, pdata);
+  }
+
+  void
+  setAdjFunc(co_time_adj_func_t* func, void* data) noexcept {
+    co_time_set_adj_func(this, func, data);
+  }
+
+  void
+  getConsStats(co_time_cons_stats* stats) const noexcept {
+    co_time_get_cons_stats(this, stats);
+  }
+
  protected:
   ~COTime() = default;
 };
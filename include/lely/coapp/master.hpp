@@ -29,6 +29,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <cstddef>
 
@@ -38,6 +39,35 @@ namespace canopen {
 
 class DriverBase;
 
+/**
+ * An entry in a batch of SDO requests.
+ *
+ * @see BasicMaster::AsyncBatch()
+ */
+struct SdoBatchEntry {
+  /// The node-ID (in the range[1..127]).
+  uint8_t id{0};
+  /// The object index.
+  uint16_t idx{0};
+  /// The object sub-index.
+  uint8_t subidx{0};
+  /**
+   * The data type of the sub-object (in the range [1..27]). If the type is a
+   * basic data type, the size of the value is checked before it is written, or
+   * after it is read. If <b>type</b> is 0, the size is not checked.
+   */
+  uint16_t type{0};
+  /// `true` for a write (SDO download), `false` for a read (SDO upload).
+  bool write{false};
+  /**
+   * The value, in little-endian byte order. For a write, this is the value to
+   * be written. For a read, this contains the received value on success.
+   */
+  ::std::vector<uint8_t> value;
+  /// The result of the request (0 on success).
+  ::std::error_code ec;
+};
+
 /**
  * The CANopen master. The master implements a CANopen node. Handling events for
  * remote CANopen slaves is delegated to drivers (see #lely::canopen::DriverBase
@@ -1638,6 +1668,42 @@ class BasicMaster : public Node, protected ::std::map<uint8_t, DriverBase*> {
   SdoFuture<void> AsyncWriteDcf(ev_exec_t* exec, uint8_t id, const char* path,
                                 const ::std::chrono::milliseconds& timeout);
 
+  /**
+   * Equivalent to
+   * #AsyncBatch(ev_exec_t* exec, ::std::vector<SdoBatchEntry> batch, const ::std::chrono::milliseconds& timeout),
+   * except that it uses the SDO timeout given by #GetTimeout().
+   */
+  SdoFuture<::std::vector<SdoBatchEntry>>
+  AsyncBatch(ev_exec_t* exec, ::std::vector<SdoBatchEntry> batch) {
+    return AsyncBatch(exec, ::std::move(batch), GetTimeout());
+  }
+
+  /**
+   * Queues a batch of asynchronous read (SDO upload) and write (SDO download)
+   * operations and creates a future which becomes ready once all requests
+   * complete (or are canceled). All requests are submitted at once. Requests
+   * for different nodes are processed concurrently, each by the Client-SDO of
+   * that node, while requests for the same node are processed back-to-back in
+   * the order in which they appear in the batch. The batch therefore takes
+   * roughly as long as the longest sequence of requests for a single node,
+   * instead of the sum of all round trips.
+   *
+   * @param exec    the executor used to execute the completion task.
+   * @param batch   the requests.
+   * @param timeout the SDO timeout. If, after a single request is initiated,
+   *                the timeout expires before receiving a response from the
+   *                server, the client aborts the transfer with abort code
+   *                #SdoErrc::TIMEOUT.
+   *
+   * @returns a future which holds the batch, with the result of each request
+   * stored in its entry. The future itself never holds an error.
+   * `ec == SdoErrc::NO_SDO` for entries with an invalid node-ID or for which no
+   * Client-SDO is available.
+   */
+  SdoFuture<::std::vector<SdoBatchEntry>> AsyncBatch(
+      ev_exec_t* exec, ::std::vector<SdoBatchEntry> batch,
+      const ::std::chrono::milliseconds& timeout);
+
   /**
    * Registers a driver for a remote CANopen node. If an event occurs for that
    * node, or for the entire CANopen network, the corresponding method of the
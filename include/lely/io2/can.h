@@ -58,6 +58,8 @@ typedef const struct io_can_ctrl_vtbl *const io_can_ctrl_t;
 /// An abstract CAN channel.
 typedef const struct io_can_chan_vtbl *const io_can_chan_t;
 
+struct can_net_filter;
+
 /// The result of a CAN channel read operation.
 struct io_can_chan_read_result {
 	/**
@@ -132,6 +134,50 @@ struct io_can_chan_write {
 		(msg), EV_TASK_INIT(exec, func), 0 \
 	}
 
+/// A CAN channel vectored write operation.
+struct io_can_chan_write_vec {
+	/**
+	 * A pointer to the array of CAN frames to be written. It is the
+	 * responsibility of the user to ensure the buffer remains valid until
+	 * the write operation completes.
+	 */
+	const struct can_msg *msgs;
+	/// The number of CAN frames at #msgs.
+	size_t nmsgs;
+	/**
+	 * The task (to be) submitted upon completion (or cancellation) of the
+	 * write operation.
+	 */
+	struct ev_task task;
+	/**
+	 * The number of CAN frames successfully written when the operation
+	 * completes. If #errc is 0, this equals #nmsgs.
+	 */
+	size_t n;
+	/**
+	 * The error number, obtained as if by get_errc(), if an error occurred
+	 * or the operation was canceled.
+	 */
+	int errc;
+	// The index of the next CAN frame to be handed to the operating system,
+	// for CAN channels that support vectored write operations.
+	size_t _i;
+	// The single-frame write operation used to emulate a vectored write
+	// operation if the CAN channel does not support them.
+	struct io_can_chan_write _write;
+	// A pointer to the CAN channel used to emulate a vectored write
+	// operation.
+	io_can_chan_t *_chan;
+};
+
+/// The static initializer for #io_can_chan_write_vec.
+#define IO_CAN_CHAN_WRITE_VEC_INIT(msgs, nmsgs, exec, func) \
+	{ \
+		(msgs), (nmsgs), EV_TASK_INIT(exec, func), 0, 0, 0, \
+				IO_CAN_CHAN_WRITE_INIT(NULL, NULL, NULL), \
+				NULL \
+	}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -156,6 +202,10 @@ struct io_can_chan_vtbl {
 			int timeout);
 	void (*submit_write)(
 			io_can_chan_t *chan, struct io_can_chan_write *write);
+	void (*submit_write_vec)(io_can_chan_t *chan,
+			struct io_can_chan_write_vec *write);
+	int (*set_filter)(io_can_chan_t *chan,
+			const struct can_net_filter *filters, size_t n);
 };
 
 /**
@@ -374,6 +424,44 @@ static inline size_t io_can_chan_cancel_write(
 static inline size_t io_can_chan_abort_write(
 		io_can_chan_t *chan, struct io_can_chan_write *write);
 
+/**
+ * Submits a vectored write operation to a CAN channel. The CAN frames are
+ * written in order, and the completion task is submitted for execution once
+ * all frames are written or a write error occurs. On error, the number of
+ * frames written successfully is stored in the <b>n</b> member of
+ * *<b>write</b>.
+ *
+ * If the CAN channel supports it, the frames are handed to the operating
+ * system in batches (e.g., with `sendmmsg()` on Linux). Otherwise, the
+ * operation is emulated by submitting single-frame write operations one after
+ * the other.
+ */
+void io_can_chan_submit_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write);
+
+/**
+ * Cancels the specified CAN channel vectored write operation if it is pending.
+ * The completion task is submitted for execution with <b>errc</b> =
+ * #errnum2c(#ERRNUM_CANCELED).
+ *
+ * @returns 1 if the operation was canceled, and 0 if it was not pending.
+ *
+ * @see io_dev_cancel()
+ */
+static inline size_t io_can_chan_cancel_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write);
+
+/**
+ * Aborts the specified CAN channel vectored write operation if it is pending.
+ * If aborted, the completion task is _not_ submitted for execution.
+ *
+ * @returns 1 if the operation was aborted, and 0 if it was not pending.
+ *
+ * @see io_dev_abort()
+ */
+size_t io_can_chan_abort_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write);
+
 /**
  * Submits an asynchronous write operation to a CAN channel and creates a future
  * which becomes ready once the write operation completes (or is canceled). The
@@ -393,6 +481,27 @@ static inline size_t io_can_chan_abort_write(
 ev_future_t *io_can_chan_async_write(io_can_chan_t *chan, ev_exec_t *exec,
 		const struct can_msg *msg, struct io_can_chan_write **pwrite);
 
+/**
+ * Sets the CAN identifier filters of a CAN channel. If supported, the filters
+ * are applied by the operating system or hardware, so frames which do not match
+ * any of the filters are never delivered to user space. Error frames are not
+ * affected. The CAN channel ensures that write confirmations are still
+ * received for frames written to it, even if they do not match the filters.
+ * The filters are discarded when the CAN channel is closed.
+ *
+ * @param chan    a pointer to a CAN channel.
+ * @param filters a pointer to an array of filters. If <b>filters</b> is NULL,
+ *                all frames are accepted.
+ * @param n       the number of filters at <b>filters</b>. If <b>n</b> is 0
+ *                and <b>filters</b> is not NULL, no frames are accepted.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc(). If the CAN channel does not support
+ * filters, the error number is #ERRNUM_NOSYS.
+ */
+int io_can_chan_set_filter(io_can_chan_t *chan,
+		const struct can_net_filter *filters, size_t n);
+
 /**
  * Obtains a pointer to a CAN channel read operation from a pointer to its
  * completion task.
@@ -405,6 +514,13 @@ struct io_can_chan_read *io_can_chan_read_from_task(struct ev_task *task);
  */
 struct io_can_chan_write *io_can_chan_write_from_task(struct ev_task *task);
 
+/**
+ * Obtains a pointer to a CAN channel vectored write operation from a pointer to
+ * its completion task.
+ */
+struct io_can_chan_write_vec *io_can_chan_write_vec_from_task(
+		struct ev_task *task);
+
 inline int
 io_can_ctrl_stop(io_can_ctrl_t *ctrl)
 {
@@ -526,6 +642,15 @@ io_can_chan_abort_write(io_can_chan_t *chan, struct io_can_chan_write *write)
 	return io_can_chan_abort(chan, &write->task);
 }
 
+static inline size_t
+io_can_chan_cancel_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write)
+{
+	// Canceling the emulated operation completes the vectored operation.
+	return io_can_chan_cancel(chan, &write->task)
+			+ io_can_chan_cancel(chan, &write->_write.task);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -575,6 +575,24 @@ class CanChannelBase : public Device {
     return io_can_chan_abort_write(*this, &write) != 0;
   }
 
+  /// @see io_can_chan_submit_write_vec()
+  void
+  submit_write_vec(struct io_can_chan_write_vec& write) noexcept {
+    io_can_chan_submit_write_vec(*this, &write);
+  }
+
+  /// @see io_can_chan_cancel_write_vec()
+  bool
+  cancel_write_vec(struct io_can_chan_write_vec& write) noexcept {
+    return io_can_chan_cancel_write_vec(*this, &write) != 0;
+  }
+
+  /// @see io_can_chan_abort_write_vec()
+  bool
+  abort_write_vec(struct io_can_chan_write_vec& write) noexcept {
+    return io_can_chan_abort_write_vec(*this, &write) != 0;
+  }
+
   /// @see io_can_chan_async_write()
   ev::Future<void, int>
   async_write(ev_exec_t* exec, const can_msg& msg,
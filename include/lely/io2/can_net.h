@@ -34,6 +34,89 @@
 /// A CAN network interface.
 typedef struct io_can_net io_can_net_t;
 
+/**
+ * The number of priority classes of the transmit queue of a CAN network
+ * interface. Frames in a class with a lower number are always written before
+ * frames in a class with a higher number.
+ */
+#define IO_CAN_NET_NCLASS 3
+
+/// The priority class of NMT, SYNC, EMCY and TIME frames.
+#define IO_CAN_NET_CLASS_NMT 0
+
+/// The priority class of PDOs.
+#define IO_CAN_NET_CLASS_PDO 1
+
+/// The priority class of SDOs and all other frames.
+#define IO_CAN_NET_CLASS_SDO 2
+
+/**
+ * The number of buckets in each latency histogram of a CAN network interface.
+ * Bucket 0 counts latencies below 1 us, bucket <i>i</i> (0 < <i>i</i> <
+ * #IO_CAN_NET_NHIST - 1) latencies in the range [2^(<i>i</i> - 1), 2^<i>i</i>)
+ * us, and the last bucket all latencies of 2^(#IO_CAN_NET_NHIST - 2) us or
+ * more.
+ */
+#define IO_CAN_NET_NHIST 24
+
+/**
+ * The statistics of a CAN network interface. All counters are cumulative since
+ * the interface was created and wrap around on overflow. Rates, such as the
+ * number of frames per second or the bus load, can be obtained by taking the
+ * difference of two snapshots.
+ *
+ * @see io_can_net_get_stats(), io_can_net_stats_load()
+ */
+struct io_can_net_stats {
+	/// The time (with respect to the clock of the interface) of the snapshot.
+	struct timespec time;
+	/// The number of CAN frames received.
+	size_t rx_frames;
+	/**
+	 * The number of bits on the CAN bus (excluding bit stuffing) of the
+	 * received CAN format frames.
+	 */
+	size_t rx_bits;
+	/// The number of CAN frame read errors.
+	size_t rx_errors;
+	/**
+	 * The maximum number of frames in the receive queue (see
+	 * io_can_net_set_rxlen()).
+	 */
+	size_t rx_queue_max;
+	/// The number of CAN frames written.
+	size_t tx_frames;
+	/**
+	 * The number of bits on the CAN bus (excluding bit stuffing) of the
+	 * written CAN format frames.
+	 */
+	size_t tx_bits;
+	/// The number of CAN frames that could not be written.
+	size_t tx_errors;
+	/// The number of CAN frames dropped because the transmit queue was full.
+	size_t tx_dropped;
+	/// The maximum number of frames in the transmit queue.
+	size_t tx_queue_max;
+	/// The number of frames in the transmit queue of each priority class.
+	size_t tx_class_depth[IO_CAN_NET_NCLASS];
+	/**
+	 * The maximum number of frames in the transmit queue of each priority
+	 * class.
+	 */
+	size_t tx_class_max[IO_CAN_NET_NCLASS];
+	/**
+	 * The histogram of the time between the receipt of a CAN frame (if the
+	 * CAN channel provides a timestamp) and its dispatch to the receivers of
+	 * the internal CAN network interface.
+	 */
+	size_t rx_latency[IO_CAN_NET_NHIST];
+	/**
+	 * The histogram of the time between queueing a CAN frame with
+	 * can_net_send() and the completion of the write operation.
+	 */
+	size_t tx_latency[IO_CAN_NET_NHIST];
+};
+
 // Avoid including <lely/can/net.h>.
 struct __can_net;
 
@@ -86,6 +169,39 @@ typedef void io_can_net_on_can_state_func_t(
  */
 typedef void io_can_net_on_can_error_func_t(int error, void *arg);
 
+/**
+ * The type of function invoked by a CAN network interface to determine the
+ * priority class of a CAN frame before it is put into the transmit queue. The
+ * default implementation assigns NMT (0x000), SYNC and EMCY (0x080..0x0FF) and
+ * TIME (0x100) frames to #IO_CAN_NET_CLASS_NMT, PDOs (0x180..0x57F) to
+ * #IO_CAN_NET_CLASS_PDO, and all other frames, including those with an extended
+ * identifier, to #IO_CAN_NET_CLASS_SDO.
+ *
+ * The mutex protecting the CAN network interface will be locked when this
+ * function is called.
+ *
+ * @param msg a pointer to the CAN frame to be sent.
+ * @param arg the user-specifed argument.
+ *
+ * @returns the priority class, in the range [0, #IO_CAN_NET_NCLASS).
+ */
+typedef int io_can_net_tx_class_func_t(const struct can_msg *msg, void *arg);
+
+/**
+ * The type of function invoked when the write operation of a CAN frame sent by
+ * a CAN network interface completes successfully. The mutex protecting the CAN
+ * network interface will be locked when this function is called, so it is safe
+ * to invoke functions on the internal CAN network interface (see
+ * io_can_net_get_net()).
+ *
+ * @param msg a pointer to the CAN frame that was written.
+ * @param tp  a pointer to the time (with respect to the clock of the interface)
+ *            at which the write confirmation was received.
+ * @param arg the user-specifed argument.
+ */
+typedef void io_can_net_on_confirm_func_t(const struct can_msg *msg,
+		const struct timespec *tp, void *arg);
+
 void *io_can_net_alloc(void);
 void io_can_net_free(void *ptr);
 io_can_net_t *io_can_net_init(io_can_net_t *net, ev_exec_t *exec,
@@ -103,8 +219,10 @@ void io_can_net_fini(io_can_net_t *net);
  * @param chan    a pointer to a CAN channel. This channel MUST NOT be used for
  *                any other purpose.
  * @param txlen   the length (in number of frames) of the user-space transmit
- *                queue length. If <b>txlen</b> is 0, the default value
- *                #LELY_IO_CAN_NET_TXLEN is used.
+ *                queue of each priority class (see #IO_CAN_NET_NCLASS). If
+ *                <b>txlen</b> is 0, the default value #LELY_IO_CAN_NET_TXLEN
+ *                is used. Note that memory is reserved for
+ *                #IO_CAN_NET_NCLASS * <b>txlen</b> frames.
  * @param txtimeo the timeout (in milliseconds) when waiting for a CAN frame
  *                write confirmation. If <b>txtimeo</b> is 0, the default value
  *                #LELY_IO_CAN_CTX_TXTIMEO is used. If <b>txtimeo</b> is
@@ -126,6 +244,29 @@ void io_can_net_destroy(io_can_net_t *net);
  */
 void io_can_net_start(io_can_net_t *net);
 
+/**
+ * Enables or disables the receive queue of a CAN network interface. If enabled,
+ * frames are read from the CAN channel into a lock-free, single-producer,
+ * single-consumer ring buffer, without locking the mutex protecting the CAN
+ * network interface. The frames are then processed in batches by a task
+ * submitted to the executor of the CAN network interface, which updates the
+ * internal clock only once per batch. This prevents a slow timer or frame
+ * handler from blocking the reader. If the queue is full, no new frames are
+ * read until the handlers catch up.
+ *
+ * This function MUST be invoked before io_can_net_start(). It locks the mutex
+ * protecting the CAN network interface.
+ *
+ * @param net   a pointer to a CAN network interface.
+ * @param rxlen the length (in number of frames) of the receive queue, or 0 to
+ *              disable the queue and process frames directly after they are
+ *              read (the default).
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ */
+int io_can_net_set_rxlen(io_can_net_t *net, size_t rxlen);
+
 /**
  * Returns a pointer to the I/O context with which the CAN network interface is
  * registered.
@@ -206,6 +347,36 @@ void io_can_net_get_on_queue_error_func(const io_can_net_t *net,
 void io_can_net_set_on_queue_error_func(
 		io_can_net_t *net, io_can_net_on_error_func_t *func, void *arg);
 
+/**
+ * Retrieves the function used to determine the priority class of the frames
+ * sent by a CAN network interface.
+ *
+ * @param net   a pointer to a CAN network interface.
+ * @param pfunc the address at which to store a pointer to the function (can be
+ *              NULL).
+ * @param parg  the address at which to store the user-specified argument (can
+ *              be NULL).
+ *
+ * @see io_can_net_set_tx_class_func()
+ */
+void io_can_net_get_tx_class_func(const io_can_net_t *net,
+		io_can_net_tx_class_func_t **pfunc, void **parg);
+
+/**
+ * Sets the function used to determine the priority class of the frames sent by
+ * a CAN network interface. Frames that are already queued keep their class.
+ *
+ * @param net  a pointer to a CAN network interface.
+ * @param func a pointer to the function to be invoked. If <b>func</b> is NULL,
+ *             the default implementation will be used.
+ * @param arg  the user-specified argument (can be NULL). <b>arg</b> is passed
+ *             as the last argument to <b>func</b>.
+ *
+ * @see io_can_net_get_tx_class_func()
+ */
+void io_can_net_set_tx_class_func(
+		io_can_net_t *net, io_can_net_tx_class_func_t *func, void *arg);
+
 /**
  * Retrieves the function invoked when a new CAN frame write error occurs, or
  * when a write operation completes successfully after one or more errors.
@@ -236,6 +407,35 @@ void io_can_net_get_on_write_error_func(const io_can_net_t *net,
 void io_can_net_set_on_write_error_func(
 		io_can_net_t *net, io_can_net_on_error_func_t *func, void *arg);
 
+/**
+ * Retrieves the function invoked when a CAN frame is written successfully.
+ *
+ * @param net   a pointer to a CAN network interface.
+ * @param pfunc the address at which to store a pointer to the function (can be
+ *              NULL).
+ * @param parg  the address at which to store the user-specified argument (can
+ *              be NULL).
+ *
+ * @see io_can_net_set_on_confirm_func()
+ */
+void io_can_net_get_on_confirm_func(const io_can_net_t *net,
+		io_can_net_on_confirm_func_t **pfunc, void **parg);
+
+/**
+ * Sets the function invoked when a CAN frame is written successfully. This
+ * function can be used to obtain the time at which a frame left the transmit
+ * queue, for example to compensate a time stamp for the transmit delay.
+ *
+ * @param net  a pointer to a CAN network interface.
+ * @param func a pointer to the function to be invoked (can be NULL).
+ * @param arg  the user-specified argument (can be NULL). <b>arg</b> is passed
+ *             as the last argument to <b>func</b>.
+ *
+ * @see io_can_net_get_on_confirm_func()
+ */
+void io_can_net_set_on_confirm_func(io_can_net_t *net,
+		io_can_net_on_confirm_func_t *func, void *arg);
+
 /**
  * Retrieves the function invoked when a CAN bus state change is detected.
  *
@@ -335,6 +535,67 @@ struct __can_net *io_can_net_get_net(const io_can_net_t *net);
  */
 int io_can_net_set_time(io_can_net_t *net);
 
+/**
+ * Enables or disables CAN identifier filtering by the CAN channel of a CAN
+ * network interface. If enabled, the filters are computed from the CAN
+ * identifiers for which receivers are registered with the internal interface
+ * (see can_net_get_filter()) and merged until at most <b>nfilter</b> filters
+ * remain (see can_net_filter_merge()). The filters are installed immediately,
+ * and updated whenever receivers are started or stopped. An update that
+ * accepts CAN identifiers not accepted by the installed filters is applied
+ * immediately, so no frames for newly registered receivers are dropped. A
+ * receiver for CAN identifiers that are already accepted does not cause an
+ * update. Updates after a receiver is stopped, which only narrow the filters,
+ * are applied at most once per <b>interval</b> milliseconds.
+ *
+ * This function locks the mutex protecting the CAN network interface.
+ *
+ * @param net      a pointer to a CAN network interface.
+ * @param nfilter  the maximum number of filters. If <b>nfilter</b> is 0,
+ *                 filtering is disabled and all frames are accepted.
+ * @param interval the minimum interval (in milliseconds) between two filter
+ *                 updates. If <b>interval</b> is 0, the default value
+ *                 #LELY_IO_CAN_NET_FILTER_INTERVAL is used. If <b>interval</b>
+ *                 is negative, updates are only deferred until the next time
+ *                 the CAN network time is updated.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc(). If the CAN channel does not support filters,
+ * the error number is #ERRNUM_NOSYS.
+ *
+ * @see io_can_chan_set_filter()
+ */
+int io_can_net_set_filter(io_can_net_t *net, size_t nfilter, int interval);
+
+/**
+ * Obtains a snapshot of the statistics of a CAN network interface. The counters
+ * are maintained with relaxed atomic operations and can be read without locking
+ * the mutex protecting the CAN network interface. Individual counters are
+ * consistent, but the snapshot as a whole is not, since frames may be processed
+ * while it is being taken.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ */
+int io_can_net_get_stats(
+		const io_can_net_t *net, struct io_can_net_stats *stats);
+
+/**
+ * Computes the CAN bus load (as a percentage) in the interval between two
+ * snapshots of the statistics of a CAN network interface. Since only the frames
+ * sent and received by the interface are taken into account, and bit stuffing
+ * is ignored, this is a lower bound on the actual bus load.
+ *
+ * @param prev    a pointer to the first snapshot.
+ * @param next    a pointer to the second snapshot.
+ * @param bitrate the bitrate of the CAN bus (in bit/s).
+ *
+ * @returns the bus load, or 0 if the interval is empty or <b>bitrate</b> is not
+ * positive.
+ */
+double io_can_net_stats_load(const struct io_can_net_stats *prev,
+		const struct io_can_net_stats *next, int bitrate);
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,6 +81,13 @@ class CanNet : protected util::BasicLockable {
     io_can_net_start(*this);
   }
 
+  /// @see io_can_net_set_rxlen()
+  void
+  set_rxlen(::std::size_t rxlen) {
+    if (io_can_net_set_rxlen(*this, rxlen) == -1)
+      util::throw_errc("set_rxlen");
+  }
+
   /// @see io_can_net_get_ctx()
   ContextBase
   get_ctx() const noexcept {
@@ -99,6 +106,22 @@ class CanNet : protected util::BasicLockable {
     return Clock(io_can_net_get_clock(*this));
   }
 
+  /// @see io_can_net_set_filter()
+  void
+  set_filter(::std::size_t nfilter, int interval = 0) {
+    if (io_can_net_set_filter(*this, nfilter, interval) == -1)
+      util::throw_errc("set_filter");
+  }
+
+  /// @see io_can_net_get_stats()
+  io_can_net_stats
+  get_stats() const {
+    io_can_net_stats stats;
+    if (io_can_net_get_stats(*this, &stats) == -1)
+      util::throw_errc("get_stats");
+    return stats;
+  }
+
  protected:
   void
   lock() final {
@@ -158,7 +158,9 @@ int io_can_chan_open(io_can_chan_t *chan, const io_can_ctrl_t *ctrl, int flags);
  * Assigns an existing SocketCAN file descriptor to a CAN channel. Before being
  * assigned, the file descriptor will be modified in the following way:
  * - reception of CAN frames sent by the socket is enabled with the
- *   `CAN_RAW_LOOPBACK` and `CAN_RAW_RECV_OWN_MSGS` socket options, and
+ *   `CAN_RAW_LOOPBACK` and `CAN_RAW_RECV_OWN_MSGS` socket options,
+ * - reception timestamps are enabled with the `SO_TIMESTAMPNS` socket option,
+ *   and
  * - the size of the kernel send buffer is set to its minimum value.
  *
  * If the channel was already open, it is first closed as if by
@@ -201,6 +203,32 @@ int io_can_chan_is_open(const io_can_chan_t *chan);
  */
 int io_can_chan_close(io_can_chan_t *chan);
 
+/**
+ * Returns the maximum number of CAN frames read into the receive queue of a CAN
+ * channel with a single system call.
+ *
+ * @see io_can_chan_set_rxbatch()
+ */
+size_t io_can_chan_get_rxbatch(const io_can_chan_t *chan);
+
+/**
+ * Sets the maximum number of CAN frames read into the receive queue of a CAN
+ * channel with a single system call (with `recvmmsg()`). Larger batches reduce
+ * the number of system calls on a busy bus, at the cost of a larger stack
+ * footprint of the receive task.
+ *
+ * @param chan    a pointer to a CAN channel.
+ * @param rxbatch the maximum number of frames per system call. If
+ *                <b>rxbatch</b> is 0, the default value #LELY_IO_CAN_RXBATCH is
+ *                used. <b>rxbatch</b> MUST NOT exceed #LELY_IO_CAN_RXBATCH.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ *
+ * @see io_can_chan_get_rxbatch()
+ */
+int io_can_chan_set_rxbatch(io_can_chan_t *chan, size_t rxbatch);
+
 #ifdef __cplusplus
 }
 #endif
@@ -192,6 +192,32 @@ class CanChannel : public CanChannelBase {
     close(ec);
     if (ec) throw ::std::system_error(ec, "close");
   }
+
+  /// @see io_can_chan_get_rxbatch()
+  ::std::size_t
+  get_rxbatch() const noexcept {
+    return io_can_chan_get_rxbatch(*this);
+  }
+
+  /// @see io_can_chan_set_rxbatch()
+  void
+  set_rxbatch(::std::size_t rxbatch, ::std::error_code& ec) noexcept {
+    int errsv = get_errc();
+    set_errc(0);
+    if (!io_can_chan_set_rxbatch(*this, rxbatch))
+      ec.clear();
+    else
+      ec = util::make_error_code();
+    set_errc(errsv);
+  }
+
+  /// @see io_can_chan_set_rxbatch()
+  void
+  set_rxbatch(::std::size_t rxbatch) {
+    ::std::error_code ec;
+    set_rxbatch(rxbatch, ec);
+    if (ec) throw ::std::system_error(ec, "set_rxbatch");
+  }
 };
 
 }  // namespace io
@@ -184,6 +184,45 @@ size_t config_parse_ini_file(config_t *config, const char *filename);
 size_t config_parse_ini_text(config_t *config, const char *begin,
 		const char *end, struct floc *at);
 
+/**
+ * Parses an INI file and invokes a function for each key, without storing the
+ * keys in a configuration struct.
+ *
+ * @returns the number of characters read, or 0 on error. I/O and parsing errors
+ * are reported with diag_at().
+ *
+ * @see config_scan_ini_text()
+ */
+size_t config_scan_ini_file(const char *filename, config_foreach_func_t *func,
+		void *data);
+
+/**
+ * Parses a string in INI-format and invokes a function for each key, in the
+ * order in which they occur, without storing the keys in a configuration
+ * struct. This is useful when the keys are processed in a single pass, since it
+ * avoids duplicating each key and value. config_parse_ini_text() is equivalent
+ * to this function with a callback invoking config_set().
+ *
+ * @param begin a pointer to the first character in the string.
+ * @param end   a pointer to one past the last character in the string (can be
+ *              NULL if the string is null-terminated).
+ * @param at    an optional pointer to the file location of <b>begin</b> (used
+ *              for diagnostic purposes). On exit, if `at != NULL`, *<b>at</b>
+ *              points to one past the last character parsed.
+ * @param func  a pointer to the function to be invoked for each key. The
+ *              section, key and value strings are only valid for the duration
+ *              of the call. The section name of keys in the root section is "".
+ * @param data  a pointer to user-specified data (can be NULL). <b>data</b> is
+ *              passed as the last parameter to <b>func</b>.
+ *
+ * @returns the number of characters read. Parsing errors are reported with
+ * diag() and diag_at(), respectively.
+ *
+ * @see config_scan_ini_file()
+ */
+size_t config_scan_ini_text(const char *begin, const char *end,
+		struct floc *at, config_foreach_func_t *func, void *data);
+
 /**
  * Prints a configuration struct to an INI file.
  *
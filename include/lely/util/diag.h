@@ -171,6 +171,60 @@ void diag_at_get_handler(diag_at_handler_t **phandler, void **phandle);
  * @see diag_at_get_handler()
  */
 void diag_at_set_handler(diag_at_handler_t *handler, void *handle);
+
+/**
+ * Retrieves the handler function for diag() of the calling thread.
+ *
+ * @param phandler the address at which to store a pointer to the handler
+ *                 function (can be NULL). *<b>phandler</b> is NULL if the
+ *                 calling thread uses the global handler.
+ * @param phandle  the address at which to store the pointer to the extra
+ *                 argument for the handler function (can be NULL).
+ *
+ * @see diag_set_thrd_handler()
+ */
+void diag_get_thrd_handler(diag_handler_t **phandler, void **phandle);
+
+/**
+ * Sets the handler function for diag() of the calling thread. If set, this
+ * handler takes precedence over the global handler (see diag_set_handler()).
+ * This allows a thread to capture its own diagnostics without affecting other
+ * threads.
+ *
+ * @param handler a pointer to the new handler function, or NULL to revert to
+ *                the global handler.
+ * @param handle  an optional pointer to an extra argument for the handler
+ *                function (can be NULL).
+ *
+ * @see diag_get_thrd_handler()
+ */
+void diag_set_thrd_handler(diag_handler_t *handler, void *handle);
+
+/**
+ * Retrieves the handler function for diag_at() of the calling thread.
+ *
+ * @param phandler the address at which to store a pointer to the handler
+ *                 function (can be NULL). *<b>phandler</b> is NULL if the
+ *                 calling thread uses the global handler.
+ * @param phandle  the address at which to store the pointer to the extra
+ *                 argument for the handler function (can be NULL).
+ *
+ * @see diag_at_set_thrd_handler()
+ */
+void diag_at_get_thrd_handler(diag_at_handler_t **phandler, void **phandle);
+
+/**
+ * Sets the handler function for diag_at() of the calling thread. If set, this
+ * handler takes precedence over the global handler (see diag_at_set_handler()).
+ *
+ * @param handler a pointer to the new handler function, or NULL to revert to
+ *                the global handler.
+ * @param handle  an optional pointer to an extra argument for the handler
+ *                function (can be NULL).
+ *
+ * @see diag_at_get_thrd_handler()
+ */
+void diag_at_set_thrd_handler(diag_at_handler_t *handler, void *handle);
 #endif // !LELY_NO_DIAG
 
 /**
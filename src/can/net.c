@@ -4,7 +4,7 @@
  *
  * @see lely/can/net.h
  *
- * @copyright 2015-2020 Lely Industries N.V.
+ * @copyright 2015-2021 Lely Industries N.V.
  *
  * @author J. S. Seldenthuis <jseldenthuis@lely.com>
  *
@@ -23,6 +23,7 @@
 
 #include "can.h"
 #include <lely/can/net.h>
+#include <lely/util/bits.h>
 #include <lely/util/cmp.h>
 #include <lely/util/dllist.h>
 #include <lely/util/errnum.h>
@@ -33,26 +34,90 @@
 #include <assert.h>
 #include <stdlib.h>
 
+/// The binary logarithm of the number of slots in each level of a timer wheel.
+#define CAN_NET_WHEEL_BITS 6
+
+/// The number of slots in each level of a timer wheel.
+#define CAN_NET_WHEEL_SIZE (1u << CAN_NET_WHEEL_BITS)
+
+/// The number of levels of a timer wheel.
+#define CAN_NET_WHEEL_DEPTH 4
+
+/**
+ * The maximum number of ticks between the current tick of a timer wheel and the
+ * tick of a timer. Timers further in the future are stored in the top level and
+ * reinserted once that slot is reached.
+ */
+#define CAN_NET_WHEEL_SPAN \
+	((UINT64_C(1) << (CAN_NET_WHEEL_BITS * CAN_NET_WHEEL_DEPTH)) - 1)
+
+/**
+ * A hierarchical timer wheel with a resolution of 1 ms. Level <i>n</i> has
+ * #CAN_NET_WHEEL_SIZE slots, each covering 64^<i>n</i> ticks. A timer is stored
+ * in the lowest level that can hold it and is moved to a lower level ("cascaded")
+ * when the current tick reaches the start of its slot.
+ */
+struct can_net_wheel {
+	/// The current tick. All earlier slots have been processed.
+	uint_least64_t now;
+	/// The bitmasks of the non-empty slots in each level.
+	uint_least64_t mask[CAN_NET_WHEEL_DEPTH];
+	/// The lists of timers in each slot.
+	struct dllist slots[CAN_NET_WHEEL_DEPTH][CAN_NET_WHEEL_SIZE];
+};
+
 /// A CAN network interface.
 struct __can_net {
-	/// The heap containing all timers.
+	/// The heap containing all timers if #wheel is NULL.
 	struct pheap timer_heap;
+	/**
+	 * A pointer to the timer wheel containing all timers, or NULL if
+	 * #CAN_NET_TIMER_WHEEL was not specified.
+	 */
+	struct can_net_wheel *wheel;
 	/// The current time.
 	struct timespec time;
+	/**
+	 * A pointer to the time at which the CAN frame currently being
+	 * processed by can_net_recv_at() was received, or NULL if no frame is
+	 * being processed.
+	 */
+	const struct timespec *recv_time;
 	/// The time at which the next timer triggers.
 	struct timespec next;
 	/// A pointer to the callback function invoked by can_net_set_next().
 	can_timer_func_t *next_func;
 	/// A pointer to user-specified data for #next_func.
 	void *next_data;
-	/// The tree containing all receivers.
+	/// The flags specified when the network interface was created.
+	int flags;
+	/// The tree containing all receivers not stored in #recv_table.
 	struct rbtree recv_tree;
+	/// The list of receivers registered with can_recv_start_mask().
+	struct dllist recv_list;
+	/**
+	 * The table containing the receivers of CAN frames with an 11-bit
+	 * identifier and no flags, indexed by CAN identifier, or NULL if
+	 * #CAN_NET_RECV_TABLE was not specified.
+	 */
+	can_recv_t **recv_table;
 	/// A pointer to the callback function invoked by can_net_send().
 	can_send_func_t *send_func;
 	/// A pointer to the user-specified data for #send_func.
 	void *send_data;
+	/// A pointer to the callback function invoked by can_net_filter().
+	can_filter_func_t *filter_func;
+	/// A pointer to the user-specified data for #filter_func.
+	void *filter_data;
 };
 
+/**
+ * Invokes the callback function set with can_net_set_filter_func(), if any,
+ * with the filter of the specified receiver. This function is invoked when the
+ * set of CAN identifiers with registered receivers changes.
+ */
+static void can_net_filter(can_net_t *net, const can_recv_t *recv, int add);
+
 /**
  * Invokes the callback function if the time at which the next CAN timer
  * triggers has been updated.
@@ -63,6 +128,10 @@ static void can_net_set_next(can_net_t *net);
 struct __can_timer {
 	/// The node of this timer in the tree of timers.
 	struct pnode node;
+	/// The node of this timer in a slot of a timer wheel.
+	struct dlnode wnode;
+	/// A pointer to the slot of the timer wheel containing #wnode.
+	struct dllist *slot;
 	/**
 	 * A pointer to the network interface with which this timer is
 	 * registered.
@@ -78,6 +147,32 @@ struct __can_timer {
 	void *data;
 };
 
+/// Converts a time to a timer wheel tick.
+static inline uint_least64_t can_net_wheel_tick(const struct timespec *tp);
+
+/// Inserts a CAN timer into a timer wheel.
+static void can_net_wheel_insert(struct can_net_wheel *wheel, can_timer_t *timer);
+
+/// Removes a CAN timer from a timer wheel.
+static void can_net_wheel_remove(struct can_net_wheel *wheel, can_timer_t *timer);
+
+/// Returns 1 if a timer wheel contains no timers, and 0 if not.
+static int can_net_wheel_empty(const struct can_net_wheel *wheel);
+
+/**
+ * Returns a pointer to the CAN timer in a timer wheel that triggers first, or
+ * NULL if the wheel is empty.
+ */
+static can_timer_t *can_net_wheel_first(const struct can_net_wheel *wheel);
+
+/**
+ * Removes and returns a CAN timer that triggers at or before the specified
+ * time, advancing the current tick of a timer wheel as far as necessary.
+ * Returns NULL once no such timer remains.
+ */
+static can_timer_t *can_net_wheel_pop(
+		struct can_net_wheel *wheel, const struct timespec *tp);
+
 /**
  * The type of the key used to match CAN frame receivers to CAN frames. The key
  * is a combination of the CAN identifier and the flags.
@@ -95,9 +190,41 @@ static inline can_recv_key_t can_recv_key(
 /// The function used to compare to CAN receiver keys.
 static int can_recv_key_cmp(const void *p1, const void *p2);
 
+/**
+ * Returns a pointer to the first CAN frame receiver registered with the
+ * specified key, or NULL if no such receiver exists.
+ */
+static can_recv_t *can_net_find_recv(const can_net_t *net, can_recv_key_t key);
+
+/**
+ * Inserts the first CAN frame receiver for a key into the tree or table of
+ * receivers of a CAN network interface.
+ */
+static void can_net_insert_recv(can_net_t *net, can_recv_t *recv);
+
+/**
+ * Removes the first CAN frame receiver for a key from the tree or table of
+ * receivers of a CAN network interface.
+ */
+static void can_net_remove_recv(can_net_t *net, can_recv_t *recv);
+
+/// Converts a CAN receiver key to an exact-match CAN identifier filter.
+static struct can_net_filter can_recv_key_filter(can_recv_key_t key);
+
+/// The function used to sort CAN identifier filters.
+static int can_net_filter_cmp(const void *p1, const void *p2);
+
+/// Returns 1 if the filter at <b>f1</b> covers the one at <b>f2</b>, and 0 if not.
+static int can_net_filter_covers(
+		const struct can_net_filter *f1, const struct can_net_filter *f2);
+
 /// A CAN frame receiver.
 struct __can_recv {
-	/// The node of this receiver in the tree of receivers.
+	/**
+	 * The node of this receiver in the tree of receivers. This node is only
+	 * used if the receiver is the first in #list and is not stored in the
+	 * table of receivers.
+	 */
 	struct rbnode node;
 	/// The list of CAN frame receivers with the same key.
 	struct dlnode list;
@@ -108,6 +235,18 @@ struct __can_recv {
 	can_net_t *net;
 	/// The key used in #node.
 	can_recv_key_t key;
+	/**
+	 * The mask applied to the CAN identifier of a frame before it is
+	 * compared with #key, if #masked is 1.
+	 */
+	uint_least32_t mask;
+	/**
+	 * A flag indicating whether this receiver was registered with
+	 * can_recv_start_mask(). If so, #list is a node in the list of masked
+	 * receivers of the network interface instead of the list of receivers
+	 * with the same key.
+	 */
+	int masked;
 	/// A pointer to the callback function invoked by can_net_recv().
 	can_recv_func_t *func;
 	/// A pointer to the user-specified data for #func.
@@ -133,23 +272,80 @@ __can_net_free(void *ptr)
 
 struct __can_net *
 __can_net_init(struct __can_net *net)
+{
+	return __can_net_init_with_flags(net, 0);
+}
+
+struct __can_net *
+__can_net_init_with_flags(struct __can_net *net, int flags)
 {
 	assert(net);
 
+	int errc = 0;
+
+	if (flags & ~(CAN_NET_RECV_TABLE | CAN_NET_TIMER_WHEEL)) {
+		errc = errnum2c(ERRNUM_INVAL);
+		goto error_flags;
+	}
+
+	net->flags = flags;
+
+	net->recv_table = NULL;
+	if (flags & CAN_NET_RECV_TABLE) {
+		net->recv_table = calloc(
+				CAN_MASK_BID + 1, sizeof(*net->recv_table));
+		if (!net->recv_table) {
+#if !LELY_NO_ERRNO
+			errc = errno2c(errno);
+#endif
+			goto error_alloc_recv_table;
+		}
+	}
+
 	pheap_init(&net->timer_heap, &timespec_cmp);
 
+	net->wheel = NULL;
+	if (flags & CAN_NET_TIMER_WHEEL) {
+		net->wheel = malloc(sizeof(*net->wheel));
+		if (!net->wheel) {
+#if !LELY_NO_ERRNO
+			errc = errno2c(errno);
+#endif
+			goto error_alloc_wheel;
+		}
+		net->wheel->now = 0;
+		for (int i = 0; i < CAN_NET_WHEEL_DEPTH; i++) {
+			net->wheel->mask[i] = 0;
+			for (unsigned int j = 0; j < CAN_NET_WHEEL_SIZE; j++)
+				dllist_init(&net->wheel->slots[i][j]);
+		}
+	}
+
 	net->time = (struct timespec){ 0, 0 };
+	net->recv_time = NULL;
 	net->next = (struct timespec){ 0, 0 };
 
 	net->next_func = NULL;
 	net->next_data = NULL;
 
 	rbtree_init(&net->recv_tree, &can_recv_key_cmp);
+	dllist_init(&net->recv_list);
 
 	net->send_func = NULL;
 	net->send_data = NULL;
 
+	net->filter_func = NULL;
+	net->filter_data = NULL;
+
 	return net;
+
+	// free(net->wheel);
+error_alloc_wheel:
+	free(net->recv_table);
+error_alloc_recv_table:
+error_flags:
+	set_errc(errc);
+	return NULL;
 }
 
 void
@@ -157,12 +353,45 @@ __can_net_fini(struct __can_net *net)
 {
 	assert(net);
 
+	// Do not notify the user of the receivers being stopped.
+	net->filter_func = NULL;
+	net->filter_data = NULL;
+
 	rbtree_foreach (&net->recv_tree, node) {
 		can_recv_t *recv = structof(node, can_recv_t, node);
 		dlnode_foreach (&recv->list, node)
 			can_recv_stop(structof(node, can_recv_t, list));
 	}
 
+	if (net->recv_table) {
+		for (size_t i = 0; i <= CAN_MASK_BID; i++) {
+			can_recv_t *recv = net->recv_table[i];
+			if (!recv)
+				continue;
+			dlnode_foreach (&recv->list, node)
+				can_recv_stop(structof(node, can_recv_t, list));
+		}
+		free(net->recv_table);
+		net->recv_table = NULL;
+	}
+
+	dllist_foreach (&net->recv_list, node)
+		can_recv_stop(structof(node, can_recv_t, list));
+
+	if (net->wheel) {
+		for (int i = 0; i < CAN_NET_WHEEL_DEPTH; i++) {
+			for (unsigned int j = 0; j < CAN_NET_WHEEL_SIZE; j++) {
+				struct dllist *slot = &net->wheel->slots[i][j];
+				struct dlnode *node;
+				while ((node = dllist_first(slot)) != NULL)
+					can_timer_stop(structof(node,
+							can_timer_t, wnode));
+			}
+		}
+		free(net->wheel);
+		net->wheel = NULL;
+	}
+
 	struct pnode *node;
 	while ((node = pheap_first(&net->timer_heap)) != NULL)
 		can_timer_stop(structof(node, can_timer_t, node));
@@ -170,6 +399,12 @@ __can_net_fini(struct __can_net *net)
 
 can_net_t *
 can_net_create(void)
+{
+	return can_net_create_with_flags(0);
+}
+
+can_net_t *
+can_net_create_with_flags(int flags)
 {
 	int errc = 0;
 
@@ -179,7 +414,7 @@ can_net_create(void)
 		goto error_alloc_net;
 	}
 
-	if (!__can_net_init(net)) {
+	if (!__can_net_init_with_flags(net, flags)) {
 		errc = get_errc();
 		goto error_init_net;
 	}
@@ -202,6 +437,14 @@ can_net_destroy(can_net_t *net)
 	}
 }
 
+int
+can_net_get_flags(const can_net_t *net)
+{
+	assert(net);
+
+	return net->flags;
+}
+
 void
 can_net_get_time(const can_net_t *net, struct timespec *tp)
 {
@@ -223,21 +466,33 @@ can_net_set_time(can_net_t *net, const struct timespec *tp)
 	int result = 0;
 
 	// Keep processing the first timer until we're done.
-	struct pnode *node;
-	while ((node = pheap_first(&net->timer_heap)) != NULL) {
-		can_timer_t *timer = structof(node, can_timer_t, node);
-		// If the timeout of the first timer is after the current time,
-		// we're done.
-		if (timespec_cmp(&timer->start, &net->time) > 0)
-			break;
+	for (;;) {
+		can_timer_t *timer;
+		if (net->wheel) {
+			timer = can_net_wheel_pop(net->wheel, &net->time);
+			if (!timer)
+				break;
+		} else {
+			struct pnode *node = pheap_first(&net->timer_heap);
+			if (!node)
+				break;
+			timer = structof(node, can_timer_t, node);
+			// If the timeout of the first timer is after the
+			// current time, we're done.
+			if (timespec_cmp(&timer->start, &net->time) > 0)
+				break;
+			pheap_remove(&net->timer_heap, &timer->node);
+		}
 
 		// Requeue the timer before invoking the callback function.
-		pheap_remove(&net->timer_heap, &timer->node);
 		timer->net = NULL;
 		if (timer->interval.tv_sec || timer->interval.tv_nsec) {
 			timespec_add(&timer->start, &timer->interval);
 			timer->net = net;
-			pheap_insert(&net->timer_heap, &timer->node);
+			if (net->wheel)
+				can_net_wheel_insert(net->wheel, timer);
+			else
+				pheap_insert(&net->timer_heap, &timer->node);
 		}
 
 		// Invoke the callback function and check the result.
@@ -278,18 +533,30 @@ can_net_set_next_func(can_net_t *net, can_timer_func_t *func, void *data)
 
 int
 can_net_recv(can_net_t *net, const struct can_msg *msg)
+{
+	return can_net_recv_at(net, msg, NULL);
+}
+
+int
+can_net_recv_at(can_net_t *net, const struct can_msg *msg,
+		const struct timespec *tp)
 {
 	assert(net);
 	assert(msg);
 
+	// Save the receive time of the frame being processed, in case this
+	// function is invoked from a receiver callback function.
+	const struct timespec *recv_time = net->recv_time;
+	struct timespec now = net->time;
+	net->recv_time = tp ? tp : &now;
+
 	int errc = get_errc();
 	int result = 0;
 
-	can_recv_key_t key = can_recv_key(msg->id, msg->flags);
-	struct rbnode *node = rbtree_find(&net->recv_tree, &key);
-	if (node) {
+	can_recv_t *recv = can_net_find_recv(
+			net, can_recv_key(msg->id, msg->flags));
+	if (recv) {
 		// Loop over all matching receivers.
-		can_recv_t *recv = structof(node, can_recv_t, node);
 		dlnode_foreach (&recv->list, node) {
 			recv = structof(node, can_recv_t, list);
 			// Invoke the callback function and check the result.
@@ -302,10 +569,32 @@ can_net_recv(can_net_t *net, const struct can_msg *msg)
 		}
 	}
 
+	// Loop over all masked receivers.
+	dllist_foreach (&net->recv_list, node) {
+		recv = structof(node, can_recv_t, list);
+		if (can_recv_key(msg->id & recv->mask, msg->flags) != recv->key)
+			continue;
+		if (recv->func && recv->func(msg, recv->data) && !result) {
+			errc = get_errc();
+			result = -1;
+		}
+	}
+
+	net->recv_time = recv_time;
+
 	set_errc(errc);
 	return result;
 }
 
+void
+can_net_get_recv_time(const can_net_t *net, struct timespec *tp)
+{
+	assert(net);
+
+	if (tp)
+		*tp = net->recv_time ? *net->recv_time : net->time;
+}
+
 int
 can_net_send(can_net_t *net, const struct can_msg *msg)
 {
@@ -341,6 +630,151 @@ can_net_set_send_func(can_net_t *net, can_send_func_t *func, void *data)
 	net->send_data = data;
 }
 
+void
+can_net_get_filter_func(
+		const can_net_t *net, can_filter_func_t **pfunc, void **pdata)
+{
+	assert(net);
+
+	if (pfunc)
+		*pfunc = net->filter_func;
+	if (pdata)
+		*pdata = net->filter_data;
+}
+
+void
+can_net_set_filter_func(can_net_t *net, can_filter_func_t *func, void *data)
+{
+	assert(net);
+
+	net->filter_func = func;
+	net->filter_data = data;
+}
+
+size_t
+can_net_get_filter(const can_net_t *net, struct can_net_filter *filters,
+		size_t n)
+{
+	assert(net);
+	assert(filters || !n);
+
+	size_t i = 0;
+	// The keys in the table are smaller than those in the tree, so the
+	// filters are sorted by key.
+	if (net->recv_table) {
+		for (can_recv_key_t key = 0; key <= CAN_MASK_BID; key++) {
+			if (!net->recv_table[key])
+				continue;
+			if (i < n)
+				filters[i] = can_recv_key_filter(key);
+			i++;
+		}
+	}
+	rbtree_foreach (&net->recv_tree, node) {
+		if (i < n) {
+			can_recv_t *recv = structof(node, can_recv_t, node);
+			filters[i] = can_recv_key_filter(recv->key);
+		}
+		i++;
+	}
+	dllist_foreach (&net->recv_list, node) {
+		if (i < n) {
+			can_recv_t *recv = structof(node, can_recv_t, list);
+			filters[i] = can_recv_key_filter(recv->key);
+			filters[i].mask &= recv->mask;
+		}
+		i++;
+	}
+	return i;
+}
+
+size_t
+can_net_filter_merge(struct can_net_filter *filters, size_t n, size_t nmax)
+{
+	assert(filters || !n);
+
+	if (nmax < 2)
+		nmax = 2;
+
+	// Normalize and sort the filters.
+	for (size_t i = 0; i < n; i++) {
+		struct can_net_filter *f = &filters[i];
+		f->flags &= CAN_FLAG_IDE;
+		f->mask &= (f->flags & CAN_FLAG_IDE) ? CAN_MASK_EID
+						     : CAN_MASK_BID;
+		f->id &= f->mask;
+	}
+	if (n > 1)
+		qsort(filters, n, sizeof(*filters), &can_net_filter_cmp);
+
+	// Remove duplicates.
+	size_t k = n ? 1 : 0;
+	for (size_t i = 1; i < n; i++) {
+		if (!can_net_filter_covers(&filters[k - 1], &filters[i]))
+			filters[k++] = filters[i];
+	}
+	n = k;
+
+	while (n > nmax) {
+		// Find the pair of adjacent filters whose merged filter has the
+		// fewest "don't care" bits.
+		size_t best = n;
+		int best_cost = 0;
+		struct can_net_filter merged = { 0, 0, 0 };
+		for (size_t i = 0; i + 1 < n; i++) {
+			const struct can_net_filter *f1 = &filters[i];
+			const struct can_net_filter *f2 = &filters[i + 1];
+			if (f1->flags != f2->flags)
+				continue;
+			uint_least32_t mask = f1->mask & f2->mask
+					& ~(f1->id ^ f2->id);
+			uint_least32_t full = (f1->flags & CAN_FLAG_IDE)
+					? CAN_MASK_EID
+					: CAN_MASK_BID;
+			int cost = popcount32(full & ~mask);
+			if (best == n || cost < best_cost) {
+				best = i;
+				best_cost = cost;
+				merged = (struct can_net_filter){ f1->id & mask,
+					mask, f1->flags };
+			}
+		}
+		// Filters for 11-bit and 29-bit identifiers cannot be merged.
+		if (best == n)
+			break;
+
+		// Replace the pair by the merged filter and remove all filters
+		// covered by it.
+		filters[best] = merged;
+		k = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (i != best && can_net_filter_covers(&merged,
+							&filters[i]))
+				continue;
+			filters[k++] = filters[i];
+		}
+		n = k;
+	}
+
+	return n;
+}
+
+int
+can_net_filter_match(const struct can_net_filter *filters, size_t n,
+		uint_least32_t id, uint_least8_t flags)
+{
+	assert(filters || !n);
+
+	flags &= CAN_FLAG_IDE;
+	for (size_t i = 0; i < n; i++) {
+		const struct can_net_filter *f = &filters[i];
+		if ((f->flags & CAN_FLAG_IDE) == flags
+				&& !((f->id ^ id) & f->mask))
+			return 1;
+	}
+	return 0;
+}
+
 void *
 __can_timer_alloc(void)
 {
@@ -364,6 +798,8 @@ __can_timer_init(struct __can_timer *timer)
 	assert(timer);
 
 	timer->node.key = &timer->start;
+	dlnode_init(&timer->wnode);
+	timer->slot = NULL;
 
 	timer->net = NULL;
 
@@ -463,6 +899,19 @@ can_timer_start(can_timer_t *timer, can_net_t *net,
 
 	timer->net = net;
 
+	if (net->wheel) {
+		// Only notify the user if the timer triggers before the
+		// currently scheduled wakeup, or if no wakeup is scheduled.
+		int empty = can_net_wheel_empty(net->wheel);
+		can_net_wheel_insert(net->wheel, timer);
+		if (empty || timespec_cmp(&timer->start, &net->next) < 0) {
+			net->next = timer->start;
+			if (net->next_func)
+				net->next_func(&net->next, net->next_data);
+		}
+		return;
+	}
+
 	pheap_insert(&timer->net->timer_heap, &timer->node);
 
 	can_net_set_next(net);
@@ -477,10 +926,17 @@ can_timer_stop(can_timer_t *timer)
 	if (!net)
 		return;
 
-	pheap_remove(&timer->net->timer_heap, &timer->node);
-
 	timer->net = NULL;
 
+	if (net->wheel) {
+		// Do not reschedule the next wakeup. If it is caused by this
+		// timer, can_net_set_time() will simply find nothing to do.
+		can_net_wheel_remove(net->wheel, timer);
+		return;
+	}
+
+	pheap_remove(&net->timer_heap, &timer->node);
+
 	can_net_set_next(net);
 }
 
@@ -526,6 +982,8 @@ __can_recv_init(struct __can_recv *recv)
 	recv->net = NULL;
 
 	recv->key = 0;
+	recv->mask = 0;
+	recv->masked = 0;
 
 	recv->func = NULL;
 	recv->data = NULL;
@@ -605,16 +1063,43 @@ can_recv_start(can_recv_t *recv, can_net_t *net, uint_least32_t id,
 	recv->net = net;
 
 	recv->key = can_recv_key(id, flags);
-	struct rbnode *node = rbtree_find(&recv->net->recv_tree, &recv->key);
-	if (node) {
-		can_recv_t *prev = structof(node, can_recv_t, node);
+	recv->mask = (flags & CAN_FLAG_IDE) ? CAN_MASK_EID : CAN_MASK_BID;
+	recv->masked = 0;
+	can_recv_t *prev = can_net_find_recv(recv->net, recv->key);
+	if (prev) {
 		dlnode_insert_after(&prev->list, &recv->list);
 	} else {
-		rbtree_insert(&recv->net->recv_tree, &recv->node);
+		can_net_insert_recv(recv->net, recv);
 		dlnode_init(&recv->list);
+		can_net_filter(recv->net, recv, 1);
 	}
 }
 
+void
+can_recv_start_mask(can_recv_t *recv, can_net_t *net, uint_least32_t id,
+		uint_least32_t mask, uint_least8_t flags)
+{
+	assert(recv);
+	assert(net);
+
+	mask &= (flags & CAN_FLAG_IDE) ? CAN_MASK_EID : CAN_MASK_BID;
+	// Use the (faster) exact-match lookup if no bits are masked.
+	if (mask == ((flags & CAN_FLAG_IDE) ? CAN_MASK_EID : CAN_MASK_BID)) {
+		can_recv_start(recv, net, id, flags);
+		return;
+	}
+
+	can_recv_stop(recv);
+
+	recv->net = net;
+
+	recv->key = can_recv_key(id & mask, flags);
+	recv->mask = mask;
+	recv->masked = 1;
+	dllist_push_back(&recv->net->recv_list, &recv->list);
+	can_net_filter(recv->net, recv, 1);
+}
+
 void
 can_recv_stop(can_recv_t *recv)
 {
@@ -623,19 +1108,32 @@ can_recv_stop(can_recv_t *recv)
 	if (!recv->net)
 		return;
 
+	if (recv->masked) {
+		dllist_remove(&recv->net->recv_list, &recv->list);
+		dlnode_init(&recv->list);
+		can_net_t *net = recv->net;
+		recv->net = NULL;
+		recv->masked = 0;
+		can_net_filter(net, recv, 0);
+		return;
+	}
+
 	struct dlnode *prev = recv->list.prev;
 	struct dlnode *next = recv->list.next;
 
 	if (!prev)
-		rbtree_remove(&recv->net->recv_tree, &recv->node);
+		can_net_remove_recv(recv->net, recv);
 	dlnode_remove(&recv->list);
 	dlnode_init(&recv->list);
 
+	can_net_t *net = recv->net;
 	recv->net = NULL;
 
 	if (!prev && next) {
 		recv = structof(next, can_recv_t, list);
-		rbtree_insert(&recv->net->recv_tree, &recv->node);
+		can_net_insert_recv(recv->net, recv);
+	} else if (!prev) {
+		can_net_filter(net, recv, 0);
 	}
 }
 
@@ -644,16 +1142,34 @@ can_net_set_next(can_net_t *net)
 {
 	assert(net);
 
-	struct pnode *node = pheap_first(&net->timer_heap);
-	if (!node)
+	can_timer_t *timer;
+	if (net->wheel) {
+		timer = can_net_wheel_first(net->wheel);
+	} else {
+		struct pnode *node = pheap_first(&net->timer_heap);
+		timer = node ? structof(node, can_timer_t, node) : NULL;
+	}
+	if (!timer)
 		return;
-	can_timer_t *timer = structof(node, can_timer_t, node);
 
 	net->next = timer->start;
 	if (net->next_func)
 		net->next_func(&net->next, net->next_data);
 }
 
+static void
+can_net_filter(can_net_t *net, const can_recv_t *recv, int add)
+{
+	assert(net);
+	assert(recv);
+
+	if (net->filter_func) {
+		struct can_net_filter filter = can_recv_key_filter(recv->key);
+		filter.mask &= recv->mask;
+		net->filter_func(&filter, add, net->filter_data);
+	}
+}
+
 static inline can_recv_key_t
 can_recv_key(uint_least32_t id, uint_least8_t flags)
 {
@@ -670,3 +1186,243 @@ can_recv_key_cmp(const void *p1, const void *p2)
 	return uint64_cmp(p1, p2);
 #endif
 }
+
+static struct can_net_filter
+can_recv_key_filter(can_recv_key_t key)
+{
+	struct can_net_filter filter = { 0, 0, 0 };
+	filter.flags = (key >> 29) & CAN_FLAG_IDE;
+	filter.mask = (filter.flags & CAN_FLAG_IDE) ? CAN_MASK_EID
+						    : CAN_MASK_BID;
+	filter.id = key & filter.mask;
+	return filter;
+}
+
+static int
+can_net_filter_cmp(const void *p1, const void *p2)
+{
+	const struct can_net_filter *f1 = p1;
+	const struct can_net_filter *f2 = p2;
+
+	int cmp = (f1->flags > f2->flags) - (f1->flags < f2->flags);
+	if (!cmp)
+		cmp = (f1->id > f2->id) - (f1->id < f2->id);
+	// Sort filters with more "don't care" bits first, so they precede the
+	// filters they cover.
+	if (!cmp)
+		cmp = (f1->mask > f2->mask) - (f1->mask < f2->mask);
+	return cmp;
+}
+
+static int
+can_net_filter_covers(
+		const struct can_net_filter *f1, const struct can_net_filter *f2)
+{
+	assert(f1);
+	assert(f2);
+
+	return f1->flags == f2->flags && !(f1->mask & ~f2->mask)
+			&& !((f1->id ^ f2->id) & f1->mask);
+}
+
+static can_recv_t *
+can_net_find_recv(const can_net_t *net, can_recv_key_t key)
+{
+	assert(net);
+
+	if (net->recv_table && key <= CAN_MASK_BID)
+		return net->recv_table[key];
+
+	struct rbnode *node = rbtree_find(&net->recv_tree, &key);
+	return node ? structof(node, can_recv_t, node) : NULL;
+}
+
+static void
+can_net_insert_recv(can_net_t *net, can_recv_t *recv)
+{
+	assert(net);
+	assert(recv);
+
+	if (net->recv_table && recv->key <= CAN_MASK_BID) {
+		assert(!net->recv_table[recv->key]);
+		net->recv_table[recv->key] = recv;
+	} else {
+		rbtree_insert(&net->recv_tree, &recv->node);
+	}
+}
+
+static void
+can_net_remove_recv(can_net_t *net, can_recv_t *recv)
+{
+	assert(net);
+	assert(recv);
+
+	if (net->recv_table && recv->key <= CAN_MASK_BID) {
+		assert(net->recv_table[recv->key] == recv);
+		net->recv_table[recv->key] = NULL;
+	} else {
+		rbtree_remove(&net->recv_tree, &recv->node);
+	}
+}
+
+static inline uint_least64_t
+can_net_wheel_tick(const struct timespec *tp)
+{
+	assert(tp);
+
+	if (tp->tv_sec < 0)
+		return 0;
+	return (uint_least64_t)tp->tv_sec * 1000 + tp->tv_nsec / 1000000;
+}
+
+static void
+can_net_wheel_insert(struct can_net_wheel *wheel, can_timer_t *timer)
+{
+	assert(wheel);
+	assert(timer);
+	assert(!timer->slot);
+
+	uint_least64_t tick = can_net_wheel_tick(&timer->start);
+	// Timers that should already have triggered are stored in the current
+	// slot.
+	uint_least64_t delta = tick > wheel->now ? tick - wheel->now : 0;
+	if (delta > CAN_NET_WHEEL_SPAN)
+		delta = CAN_NET_WHEEL_SPAN;
+	tick = wheel->now + delta;
+
+	int level = 0;
+	while (level < CAN_NET_WHEEL_DEPTH - 1
+			&& delta >> (CAN_NET_WHEEL_BITS * (level + 1)))
+		level++;
+	unsigned int i = (tick >> (CAN_NET_WHEEL_BITS * level))
+			& (CAN_NET_WHEEL_SIZE - 1);
+
+	timer->slot = &wheel->slots[level][i];
+	dllist_push_back(timer->slot, &timer->wnode);
+	wheel->mask[level] |= UINT64_C(1) << i;
+}
+
+static void
+can_net_wheel_remove(struct can_net_wheel *wheel, can_timer_t *timer)
+{
+	assert(wheel);
+	assert(timer);
+	assert(timer->slot);
+
+	dllist_remove(timer->slot, &timer->wnode);
+	if (dllist_empty(timer->slot)) {
+		size_t n = timer->slot - &wheel->slots[0][0];
+		wheel->mask[n / CAN_NET_WHEEL_SIZE] &=
+				~(UINT64_C(1) << (n % CAN_NET_WHEEL_SIZE));
+	}
+	timer->slot = NULL;
+}
+
+static int
+can_net_wheel_empty(const struct can_net_wheel *wheel)
+{
+	assert(wheel);
+
+	for (int i = 0; i < CAN_NET_WHEEL_DEPTH; i++) {
+		if (wheel->mask[i])
+			return 0;
+	}
+	return 1;
+}
+
+static can_timer_t *
+can_net_wheel_first(const struct can_net_wheel *wheel)
+{
+	assert(wheel);
+
+	can_timer_t *first = NULL;
+	for (int level = 0; level < CAN_NET_WHEEL_DEPTH; level++) {
+		if (!wheel->mask[level])
+			continue;
+		// The slots in a level are ordered by time, starting with the
+		// current slot in level 0 and the one after the current slot
+		// in the higher levels. Only the first non-empty slot can
+		// contain the earliest timer of that level.
+		int shift = CAN_NET_WHEEL_BITS * level;
+		uint_least64_t now = wheel->now >> shift;
+		if (level)
+			now++;
+		unsigned int i = now & (CAN_NET_WHEEL_SIZE - 1);
+		now += ffs64(ror64(wheel->mask[level], i)) - 1;
+		// Skip the slot if it starts after the earliest timer found so
+		// far.
+		if (first && (now << shift) > can_net_wheel_tick(&first->start))
+			continue;
+		i = now & (CAN_NET_WHEEL_SIZE - 1);
+		dllist_foreach (&wheel->slots[level][i], node) {
+			can_timer_t *timer = structof(node, can_timer_t, wnode);
+			if (!first || timespec_cmp(&timer->start, &first->start)
+							< 0)
+				first = timer;
+		}
+	}
+	return first;
+}
+
+static can_timer_t *
+can_net_wheel_pop(struct can_net_wheel *wheel, const struct timespec *tp)
+{
+	assert(wheel);
+	assert(tp);
+
+	uint_least64_t tick = can_net_wheel_tick(tp);
+	for (;;) {
+		// Look for an expired timer in the current slot. Timers in this
+		// slot that trigger later in the current tick are skipped.
+		struct dllist *slot = &wheel->slots[0][wheel->now
+				& (CAN_NET_WHEEL_SIZE - 1)];
+		dllist_foreach (slot, node) {
+			can_timer_t *timer = structof(node, can_timer_t, wnode);
+			if (timespec_cmp(&timer->start, tp) <= 0) {
+				can_net_wheel_remove(wheel, timer);
+				return timer;
+			}
+		}
+
+		if (wheel->now >= tick)
+			return NULL;
+
+		// Find the next tick at which either a slot in level 0 becomes
+		// current, or a slot in a higher level needs to be cascaded.
+		// This allows us to skip large periods without timers.
+		uint_least64_t next = tick;
+		for (int level = 0; level < CAN_NET_WHEEL_DEPTH; level++) {
+			uint_least64_t mask = wheel->mask[level];
+			if (!mask)
+				continue;
+			int shift = CAN_NET_WHEEL_BITS * level;
+			uint_least64_t now = wheel->now >> shift;
+			unsigned int i = (now + 1) & (CAN_NET_WHEEL_SIZE - 1);
+			now += ffs64(ror64(mask, i));
+			if (now << shift < next)
+				next = now << shift;
+		}
+		wheel->now = next;
+
+		// Cascade the timers in the higher levels whose slot has become
+		// current, starting at the top.
+		for (int level = CAN_NET_WHEEL_DEPTH - 1; level > 0; level--) {
+			int shift = CAN_NET_WHEEL_BITS * level;
+			if (wheel->now & ((UINT64_C(1) << shift) - 1))
+				continue;
+			unsigned int i = (wheel->now >> shift)
+					& (CAN_NET_WHEEL_SIZE - 1);
+			struct dllist list;
+			dllist_init(&list);
+			dllist_append(&list, &wheel->slots[level][i]);
+			wheel->mask[level] &= ~(UINT64_C(1) << i);
+			struct dlnode *node;
+			while ((node = dllist_pop_front(&list)) != NULL) {
+				can_timer_t *timer = structof(
+						node, can_timer_t, wnode);
+				timer->slot = NULL;
+				can_net_wheel_insert(wheel, timer);
+			}
+		}
+	}
+}
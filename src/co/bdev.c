@@ -0,0 +1,881 @@
+/**@file
+ * This file is part of the CANopen library; it contains the implementation of
+ * the binary device description functions.
+ *
+ * @see lely/co/bdev.h
+ *
+ * @copyright 2021 Lely Industries N.V.
+ *
+ * @author J. S. Seldenthuis <jseldenthuis@lely.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "co.h"
+
+#if !LELY_NO_CO_BDEV
+
+#include "obj.h"
+#include <lely/co/bdev.h>
+#include <lely/co/crc.h>
+#include <lely/co/val.h>
+#include <lely/util/diag.h>
+#include <lely/util/endian.h>
+#include <lely/util/errnum.h>
+#if !LELY_NO_STDIO
+#include <lely/util/frbuf.h>
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+/// The optional features supported by this implementation.
+#if LELY_NO_CO_OBJ_NAME
+#define CO_BDEV_NAME_SUPPORTED 0
+#else
+#define CO_BDEV_NAME_SUPPORTED CO_BDEV_NAME
+#endif
+#if LELY_NO_CO_OBJ_LIMITS
+#define CO_BDEV_LIMITS_SUPPORTED 0
+#else
+#define CO_BDEV_LIMITS_SUPPORTED CO_BDEV_LIMITS
+#endif
+#if LELY_NO_CO_OBJ_DEFAULT
+#define CO_BDEV_DEFAULT_SUPPORTED 0
+#else
+#define CO_BDEV_DEFAULT_SUPPORTED CO_BDEV_DEFAULT
+#endif
+#define CO_BDEV_SUPPORTED \
+	(CO_BDEV_NAME_SUPPORTED | CO_BDEV_LIMITS_SUPPORTED \
+			| CO_BDEV_DEFAULT_SUPPORTED)
+
+/// An input buffer containing (part of) a binary device description.
+struct co_bdev_in {
+	/// A pointer to the next byte to be read.
+	const uint_least8_t *cp;
+	/// The number of bytes remaining at #cp.
+	size_t n;
+	/// The optional features present in the image.
+	co_unsigned16_t features;
+	/**
+	 * A flag indicating whether the names are referenced in place (see
+	 * co_dev_create_from_bin_ref()) instead of copied.
+	 */
+	int ref;
+};
+
+static struct __co_dev *co_bdev_init(struct __co_dev *dev, const void *ptr,
+		size_t n, int ref, size_t arena_size);
+
+static const uint_least8_t *co_bdev_get(struct co_bdev_in *in, size_t n);
+static int co_bdev_get_u8(struct co_bdev_in *in, co_unsigned8_t *pu8);
+static int co_bdev_get_u16(struct co_bdev_in *in, co_unsigned16_t *pu16);
+static int co_bdev_get_u32(struct co_bdev_in *in, co_unsigned32_t *pu32);
+static int co_bdev_get_str(struct co_bdev_in *in, const char **ps);
+
+static int co_bdev_load_dev(struct co_bdev_in *in, co_dev_t *dev);
+static int co_bdev_load_obj(struct co_bdev_in *in, co_obj_t *obj);
+static int co_bdev_load_sub(struct co_bdev_in *in, co_sub_t *sub);
+static int co_bdev_load_val(struct co_bdev_in *in, co_sub_t *sub,
+		size_t (*set)(co_sub_t *sub, const void *ptr, size_t n));
+
+/// An output buffer for a binary device description.
+struct co_bdev_out {
+	/**
+	 * A pointer to the start of the buffer, or NULL if only the size of the
+	 * image is computed.
+	 */
+	uint_least8_t *begin;
+	/// The number of bytes written (or that would have been written).
+	size_t n;
+};
+
+static void co_bdev_put(struct co_bdev_out *out, const void *ptr, size_t n);
+static void co_bdev_put_u8(struct co_bdev_out *out, co_unsigned8_t u8);
+static void co_bdev_put_u16(struct co_bdev_out *out, co_unsigned16_t u16);
+static void co_bdev_put_u32(struct co_bdev_out *out, co_unsigned32_t u32);
+static int co_bdev_put_str(struct co_bdev_out *out, const char *s);
+static int co_bdev_put_val(struct co_bdev_out *out, co_unsigned16_t type,
+		const void *val);
+
+static int co_bdev_save_dev(struct co_bdev_out *out, const co_dev_t *dev);
+static int co_bdev_save_obj(struct co_bdev_out *out, const co_obj_t *obj);
+static int co_bdev_save_sub(struct co_bdev_out *out, const co_sub_t *sub);
+
+struct __co_dev *
+__co_dev_init_from_bin(struct __co_dev *dev, const void *ptr, size_t n)
+{
+	return co_bdev_init(dev, ptr, n, 0, 0);
+}
+
+co_dev_t *
+co_dev_create_from_bin(const void *ptr, size_t n)
+{
+	return co_dev_create_from_bin_arena(ptr, n, 0);
+}
+
+co_dev_t *
+co_dev_create_from_bin_arena(const void *ptr, size_t n, size_t arena_size)
+{
+	int errc = 0;
+
+	co_dev_t *dev = __co_dev_alloc();
+	if (!dev) {
+		errc = get_errc();
+		goto error_alloc_dev;
+	}
+
+	if (!co_bdev_init(dev, ptr, n, 0, arena_size)) {
+		errc = get_errc();
+		goto error_init_dev;
+	}
+
+	return dev;
+
+error_init_dev:
+	__co_dev_free(dev);
+error_alloc_dev:
+	set_errc(errc);
+	return NULL;
+}
+
+struct __co_dev *
+__co_dev_init_from_bin_ref(struct __co_dev *dev, const void *ptr, size_t n)
+{
+	return co_bdev_init(dev, ptr, n, 1, 0);
+}
+
+co_dev_t *
+co_dev_create_from_bin_ref(const void *ptr, size_t n)
+{
+	int errc = 0;
+
+	co_dev_t *dev = __co_dev_alloc();
+	if (!dev) {
+		errc = get_errc();
+		goto error_alloc_dev;
+	}
+
+	if (!__co_dev_init_from_bin_ref(dev, ptr, n)) {
+		errc = get_errc();
+		goto error_init_dev;
+	}
+
+	return dev;
+
+error_init_dev:
+	__co_dev_free(dev);
+error_alloc_dev:
+	set_errc(errc);
+	return NULL;
+}
+
+#if !LELY_NO_STDIO
+
+co_dev_t *
+co_dev_create_from_bin_file(const char *filename)
+{
+	return co_dev_create_from_bin_file_arena(filename, 0);
+}
+
+co_dev_t *
+co_dev_create_from_bin_file_arena(const char *filename, size_t arena_size)
+{
+	int errc = 0;
+
+	frbuf_t *buf = frbuf_create(filename);
+	if (!buf) {
+		errc = get_errc();
+		goto error_create_buf;
+	}
+
+	size_t size = 0;
+	const void *ptr = frbuf_map(buf, 0, &size);
+	if (!ptr) {
+		errc = get_errc();
+		goto error_map;
+	}
+
+	co_dev_t *dev = co_dev_create_from_bin_arena(ptr, size, arena_size);
+	if (!dev) {
+		errc = get_errc();
+		goto error_create_dev;
+	}
+
+	frbuf_destroy(buf);
+
+	return dev;
+
+error_create_dev:
+error_map:
+	frbuf_destroy(buf);
+error_create_buf:
+	diag(DIAG_ERROR, errc, "%s", filename);
+	set_errc(errc);
+	return NULL;
+}
+
+co_dev_t *
+co_dev_create_from_bin_file_ref(const char *filename)
+{
+	int errc = 0;
+
+	frbuf_t *buf = frbuf_create(filename);
+	if (!buf) {
+		errc = get_errc();
+		goto error_create_buf;
+	}
+
+	size_t size = 0;
+	const void *ptr = frbuf_map(buf, 0, &size);
+	if (!ptr) {
+		errc = get_errc();
+		goto error_map;
+	}
+
+	co_dev_t *dev = co_dev_create_from_bin_ref(ptr, size);
+	if (!dev) {
+		errc = get_errc();
+		goto error_create_dev;
+	}
+
+	// The device keeps the file mapped until it is destroyed.
+	co_dev_set_image(dev, buf);
+
+	return dev;
+
+error_create_dev:
+error_map:
+	frbuf_destroy(buf);
+error_create_buf:
+	diag(DIAG_ERROR, errc, "%s", filename);
+	set_errc(errc);
+	return NULL;
+}
+
+#endif // !LELY_NO_STDIO
+
+size_t
+co_dev_write_bin(const co_dev_t *dev, uint_least8_t *begin, uint_least8_t *end)
+{
+	assert(dev);
+
+	// Compute the size of the image before writing anything, so the buffer
+	// is left untouched if it is too small.
+	struct co_bdev_out out = { .begin = NULL, .n = CO_BDEV_HDR_SIZE };
+	if (co_bdev_save_dev(&out, dev) == -1)
+		return 0;
+	size_t size = out.n;
+	if (size > UINT32_MAX) {
+		set_errnum(ERRNUM_OVERFLOW);
+		return 0;
+	}
+
+	if (!begin || (end && end - begin < (ptrdiff_t)size))
+		return size;
+
+	out = (struct co_bdev_out){ .begin = begin, .n = CO_BDEV_HDR_SIZE };
+	if (co_bdev_save_dev(&out, dev) == -1)
+		return 0;
+	assert(out.n == size);
+
+	stle_u32(begin, CO_BDEV_MAGIC);
+	stle_u16(begin + 4, CO_BDEV_VERSION);
+	stle_u16(begin + 6, CO_BDEV_SUPPORTED);
+	stle_u32(begin + 8, (uint_least32_t)size);
+	stle_u16(begin + 12,
+			co_crc(0, begin + CO_BDEV_HDR_SIZE,
+					size - CO_BDEV_HDR_SIZE));
+	stle_u16(begin + 14, 0);
+
+	return size;
+}
+
+#if !LELY_NO_STDIO
+
+int
+co_dev_write_bin_file(const co_dev_t *dev, const char *filename)
+{
+	size_t size = co_dev_write_bin(dev, NULL, NULL);
+	if (!size)
+		return -1;
+
+	void *dom = NULL;
+	if (co_val_init_dom(&dom, NULL, size) == -1)
+		return -1;
+	uint_least8_t *begin = dom;
+	co_dev_write_bin(dev, begin, begin + size);
+
+	if (co_val_write_file(CO_DEFTYPE_DOMAIN, &dom, filename) != size) {
+		co_val_fini(CO_DEFTYPE_DOMAIN, &dom);
+		return -1;
+	}
+
+	co_val_fini(CO_DEFTYPE_DOMAIN, &dom);
+	return 0;
+}
+
+#endif // !LELY_NO_STDIO
+
+static struct __co_dev *
+co_bdev_init(struct __co_dev *dev, const void *ptr, size_t n, int ref,
+		size_t arena_size)
+{
+	assert(dev);
+
+	int errc = 0;
+
+	if (!ptr && n) {
+		errc = errnum2c(ERRNUM_INVAL);
+		goto error_param;
+	}
+
+	// Check the header before touching the rest of the image.
+	const uint_least8_t *bp = ptr;
+	if (n < CO_BDEV_HDR_SIZE + 1 || ldle_u32(bp) != CO_BDEV_MAGIC
+			|| ldle_u16(bp + 4) != CO_BDEV_VERSION
+			|| (ldle_u16(bp + 6)
+					& ~(CO_BDEV_NAME | CO_BDEV_LIMITS
+							| CO_BDEV_DEFAULT))) {
+		errc = errnum2c(ERRNUM_BADMSG);
+		goto error_hdr;
+	}
+	size_t size = ldle_u32(bp + 8);
+	if (size <= CO_BDEV_HDR_SIZE || size > n
+			|| co_crc(0, bp + CO_BDEV_HDR_SIZE,
+					   size - CO_BDEV_HDR_SIZE)
+					!= ldle_u16(bp + 12)) {
+		errc = errnum2c(ERRNUM_BADMSG);
+		goto error_hdr;
+	}
+
+	struct co_bdev_in in = { .cp = bp + CO_BDEV_HDR_SIZE,
+		.n = size - CO_BDEV_HDR_SIZE,
+		.features = ldle_u16(bp + 6),
+		.ref = ref };
+
+	if (!__co_dev_init(dev, *in.cp)) {
+		errc = get_errc();
+		goto error_init_dev;
+	}
+	// The arena has to be enabled before the first object is created.
+	co_dev_set_arena_size(dev, arena_size);
+
+	if (co_bdev_load_dev(&in, dev) == -1) {
+		errc = get_errc();
+		goto error_load_dev;
+	}
+
+	return dev;
+
+error_load_dev:
+	__co_dev_fini(dev);
+error_init_dev:
+error_hdr:
+error_param:
+	set_errc(errc);
+	return NULL;
+}
+
+static const uint_least8_t *
+co_bdev_get(struct co_bdev_in *in, size_t n)
+{
+	assert(in);
+
+	if (n > in->n) {
+		set_errnum(ERRNUM_BADMSG);
+		return NULL;
+	}
+
+	const uint_least8_t *cp = in->cp;
+	in->cp += n;
+	in->n -= n;
+	return cp;
+}
+
+static int
+co_bdev_get_u8(struct co_bdev_in *in, co_unsigned8_t *pu8)
+{
+	assert(pu8);
+
+	const uint_least8_t *cp = co_bdev_get(in, 1);
+	if (!cp)
+		return -1;
+	*pu8 = *cp;
+	return 0;
+}
+
+static int
+co_bdev_get_u16(struct co_bdev_in *in, co_unsigned16_t *pu16)
+{
+	assert(pu16);
+
+	const uint_least8_t *cp = co_bdev_get(in, 2);
+	if (!cp)
+		return -1;
+	*pu16 = ldle_u16(cp);
+	return 0;
+}
+
+static int
+co_bdev_get_u32(struct co_bdev_in *in, co_unsigned32_t *pu32)
+{
+	assert(pu32);
+
+	const uint_least8_t *cp = co_bdev_get(in, 4);
+	if (!cp)
+		return -1;
+	*pu32 = ldle_u32(cp);
+	return 0;
+}
+
+static int
+co_bdev_get_str(struct co_bdev_in *in, const char **ps)
+{
+	assert(ps);
+
+	co_unsigned16_t n = 0;
+	if (co_bdev_get_u16(in, &n) == -1)
+		return -1;
+	if (!n) {
+		*ps = NULL;
+		return 0;
+	}
+
+	// Non-empty strings are stored with a terminating null byte, so they
+	// can be used in place.
+	const uint_least8_t *cp = co_bdev_get(in, n + 1);
+	if (!cp)
+		return -1;
+	if (cp[n] != '\0') {
+		set_errnum(ERRNUM_BADMSG);
+		return -1;
+	}
+	*ps = (const char *)cp;
+	return 0;
+}
+
+static int
+co_bdev_load_dev(struct co_bdev_in *in, co_dev_t *dev)
+{
+	assert(in);
+	assert(dev);
+
+	// The node-ID has already been used to initialize the device.
+	if (!co_bdev_get(in, 1))
+		return -1;
+
+	co_unsigned8_t lss = 0;
+	if (co_bdev_get_u8(in, &lss) == -1)
+		return -1;
+	co_dev_set_lss(dev, lss);
+
+	co_unsigned16_t baud = 0;
+	if (co_bdev_get_u16(in, &baud) == -1)
+		return -1;
+	co_dev_set_baud(dev, baud);
+
+	co_unsigned16_t rate = 0;
+	if (co_bdev_get_u16(in, &rate) == -1)
+		return -1;
+	co_dev_set_rate(dev, rate);
+
+	co_unsigned32_t u32 = 0;
+	if (co_bdev_get_u32(in, &u32) == -1)
+		return -1;
+	co_dev_set_vendor_id(dev, u32);
+	if (co_bdev_get_u32(in, &u32) == -1)
+		return -1;
+	co_dev_set_product_code(dev, u32);
+	if (co_bdev_get_u32(in, &u32) == -1)
+		return -1;
+	co_dev_set_revision(dev, u32);
+	if (co_bdev_get_u32(in, &u32) == -1)
+		return -1;
+	co_dev_set_dummy(dev, u32);
+
+	if (in->features & CO_BDEV_NAME) {
+		const char *name = NULL;
+		const char *vendor_name = NULL;
+		const char *product_name = NULL;
+		const char *order_code = NULL;
+		if (co_bdev_get_str(in, &name) == -1
+				|| co_bdev_get_str(in, &vendor_name) == -1
+				|| co_bdev_get_str(in, &product_name) == -1
+				|| co_bdev_get_str(in, &order_code) == -1)
+			return -1;
+#if !LELY_NO_CO_OBJ_NAME
+		if (co_dev_set_name(dev, name) == -1)
+			return -1;
+		if (co_dev_set_vendor_name(dev, vendor_name) == -1)
+			return -1;
+		if (co_dev_set_product_name(dev, product_name) == -1)
+			return -1;
+		if (co_dev_set_order_code(dev, order_code) == -1)
+			return -1;
+#endif
+	}
+
+	co_unsigned16_t nobj = 0;
+	if (co_bdev_get_u16(in, &nobj) == -1)
+		return -1;
+	for (size_t i = 0; i < nobj; i++) {
+		co_unsigned16_t idx = 0;
+		if (co_bdev_get_u16(in, &idx) == -1)
+			return -1;
+		co_obj_t *obj = co_obj_create_in(dev, idx);
+		if (!obj)
+			return -1;
+		if (co_dev_insert_obj(dev, obj) == -1) {
+			co_obj_destroy(obj);
+			// The only possible error is a duplicate index.
+			set_errnum(ERRNUM_BADMSG);
+			return -1;
+		}
+		if (co_bdev_load_obj(in, obj) == -1)
+			return -1;
+	}
+
+	if (in->n) {
+		set_errnum(ERRNUM_BADMSG);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+co_bdev_load_obj(struct co_bdev_in *in, co_obj_t *obj)
+{
+	assert(in);
+	assert(obj);
+
+	co_unsigned8_t code = 0;
+	if (co_bdev_get_u8(in, &code) == -1)
+		return -1;
+	if (co_obj_set_code(obj, code) == -1) {
+		set_errnum(ERRNUM_BADMSG);
+		return -1;
+	}
+
+	if (in->features & CO_BDEV_NAME) {
+		const char *name = NULL;
+		if (co_bdev_get_str(in, &name) == -1)
+			return -1;
+#if !LELY_NO_CO_OBJ_NAME
+		if (in->ref)
+			co_obj_set_name_ref(obj, name);
+		else if (co_obj_set_name(obj, name) == -1)
+			return -1;
+#endif
+	}
+
+	co_unsigned16_t nsub = 0;
+	if (co_bdev_get_u16(in, &nsub) == -1)
+		return -1;
+	for (size_t i = 0; i < nsub; i++) {
+		co_unsigned8_t subidx = 0;
+		if (co_bdev_get_u8(in, &subidx) == -1)
+			return -1;
+		co_unsigned16_t type = 0;
+		if (co_bdev_get_u16(in, &type) == -1)
+			return -1;
+		co_sub_t *sub = co_sub_create_in(
+				co_obj_get_dev(obj), subidx, type);
+		if (!sub)
+			return -1;
+		if (co_obj_insert_sub(obj, sub) == -1) {
+			co_sub_destroy(sub);
+			// The only possible error is a duplicate sub-index.
+			set_errnum(ERRNUM_BADMSG);
+			return -1;
+		}
+		if (co_bdev_load_sub(in, sub) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int
+co_bdev_load_sub(struct co_bdev_in *in, co_sub_t *sub)
+{
+	assert(in);
+	assert(sub);
+
+	co_unsigned8_t access = 0;
+	if (co_bdev_get_u8(in, &access) == -1)
+		return -1;
+	if (co_sub_set_access(sub, access) == -1) {
+		set_errnum(ERRNUM_BADMSG);
+		return -1;
+	}
+
+	co_unsigned8_t pdo_mapping = 0;
+	if (co_bdev_get_u8(in, &pdo_mapping) == -1)
+		return -1;
+	co_sub_set_pdo_mapping(sub, pdo_mapping);
+
+	co_unsigned32_t flags = 0;
+	if (co_bdev_get_u32(in, &flags) == -1)
+		return -1;
+	co_sub_set_flags(sub, flags);
+
+	if (in->features & CO_BDEV_NAME) {
+		const char *name = NULL;
+		if (co_bdev_get_str(in, &name) == -1)
+			return -1;
+#if !LELY_NO_CO_OBJ_NAME
+		if (in->ref)
+			co_sub_set_name_ref(sub, name);
+		else if (co_sub_set_name(sub, name) == -1)
+			return -1;
+#endif
+	}
+
+	if (in->features & CO_BDEV_LIMITS) {
+#if LELY_NO_CO_OBJ_LIMITS
+		if (co_bdev_load_val(in, sub, NULL) == -1)
+			return -1;
+		if (co_bdev_load_val(in, sub, NULL) == -1)
+			return -1;
+#else
+		if (co_bdev_load_val(in, sub, &co_sub_set_min) == -1)
+			return -1;
+		if (co_bdev_load_val(in, sub, &co_sub_set_max) == -1)
+			return -1;
+#endif
+	}
+
+	if (in->features & CO_BDEV_DEFAULT) {
+#if LELY_NO_CO_OBJ_DEFAULT
+		if (co_bdev_load_val(in, sub, NULL) == -1)
+			return -1;
+#else
+		if (co_bdev_load_val(in, sub, &co_sub_set_def) == -1)
+			return -1;
+#endif
+	}
+
+	return co_bdev_load_val(in, sub, &co_sub_set_val);
+}
+
+static int
+co_bdev_load_val(struct co_bdev_in *in, co_sub_t *sub,
+		size_t (*set)(co_sub_t *sub, const void *ptr, size_t n))
+{
+	assert(in);
+	assert(sub);
+
+	co_unsigned32_t n = 0;
+	if (co_bdev_get_u32(in, &n) == -1)
+		return -1;
+	const uint_least8_t *bp = co_bdev_get(in, n);
+	if (!bp)
+		return -1;
+	// Skip empty values and values of features that are not supported.
+	if (!n || !set)
+		return 0;
+
+	co_unsigned16_t type = co_sub_get_type(sub);
+	switch (type) {
+	case CO_DEFTYPE_OCTET_STRING:
+	case CO_DEFTYPE_DOMAIN:
+		// These arrays are stored as-is and can be copied directly. Strings
+		// are not, since they are not null-terminated in the image.
+		return set(sub, bp, n) ? 0 : -1;
+	default: break;
+	}
+
+	union co_val val;
+	size_t size = co_val_read(type, &val, bp, bp + n);
+	if (size != n) {
+		if (size)
+			co_val_fini(type, &val);
+		// co_val_read() only returns 0 for an array if the value cannot
+		// be allocated.
+		if (!size && co_type_is_array(type))
+			set_errnum(ERRNUM_NOMEM);
+		else
+			set_errnum(ERRNUM_BADMSG);
+		return -1;
+	}
+
+	const void *ptr = co_val_addressof(type, &val);
+	size = co_val_sizeof(type, &val);
+	int result = !size || set(sub, ptr, size) ? 0 : -1;
+	co_val_fini(type, &val);
+	return result;
+}
+
+static void
+co_bdev_put(struct co_bdev_out *out, const void *ptr, size_t n)
+{
+	assert(out);
+
+	if (out->begin)
+		memcpy(out->begin + out->n, ptr, n);
+	out->n += n;
+}
+
+static void
+co_bdev_put_u8(struct co_bdev_out *out, co_unsigned8_t u8)
+{
+	uint_least8_t b[1] = { u8 };
+	co_bdev_put(out, b, sizeof(b));
+}
+
+static void
+co_bdev_put_u16(struct co_bdev_out *out, co_unsigned16_t u16)
+{
+	uint_least8_t b[2];
+	stle_u16(b, u16);
+	co_bdev_put(out, b, sizeof(b));
+}
+
+static void
+co_bdev_put_u32(struct co_bdev_out *out, co_unsigned32_t u32)
+{
+	uint_least8_t b[4];
+	stle_u32(b, u32);
+	co_bdev_put(out, b, sizeof(b));
+}
+
+static int
+co_bdev_put_str(struct co_bdev_out *out, const char *s)
+{
+	size_t n = s ? strlen(s) : 0;
+	if (n > CO_UNSIGNED16_MAX) {
+		set_errnum(ERRNUM_NAMETOOLONG);
+		return -1;
+	}
+
+	co_bdev_put_u16(out, (co_unsigned16_t)n);
+	if (n)
+		co_bdev_put(out, s, n + 1);
+	return 0;
+}
+
+static int
+co_bdev_put_val(struct co_bdev_out *out, co_unsigned16_t type, const void *val)
+{
+	assert(out);
+
+	size_t n = val ? co_val_write(type, val, NULL, NULL) : 0;
+	if (n > CO_UNSIGNED32_MAX) {
+		set_errnum(ERRNUM_OVERFLOW);
+		return -1;
+	}
+
+	co_bdev_put_u32(out, (co_unsigned32_t)n);
+	if (out->begin && n)
+		co_val_write(type, val, out->begin + out->n, NULL);
+	out->n += n;
+	return 0;
+}
+
+static int
+co_bdev_save_dev(struct co_bdev_out *out, const co_dev_t *dev)
+{
+	assert(out);
+	assert(dev);
+
+	co_bdev_put_u8(out, co_dev_get_id(dev));
+	co_bdev_put_u8(out, co_dev_get_lss(dev));
+	co_bdev_put_u16(out, co_dev_get_baud(dev));
+	co_bdev_put_u16(out, co_dev_get_rate(dev));
+	co_bdev_put_u32(out, co_dev_get_vendor_id(dev));
+	co_bdev_put_u32(out, co_dev_get_product_code(dev));
+	co_bdev_put_u32(out, co_dev_get_revision(dev));
+	co_bdev_put_u32(out, co_dev_get_dummy(dev));
+
+#if !LELY_NO_CO_OBJ_NAME
+	if (co_bdev_put_str(out, co_dev_get_name(dev)) == -1)
+		return -1;
+	if (co_bdev_put_str(out, co_dev_get_vendor_name(dev)) == -1)
+		return -1;
+	if (co_bdev_put_str(out, co_dev_get_product_name(dev)) == -1)
+		return -1;
+	if (co_bdev_put_str(out, co_dev_get_order_code(dev)) == -1)
+		return -1;
+#endif
+
+	co_bdev_put_u16(out, co_dev_get_idx(dev, 0, NULL));
+	for (co_obj_t *obj = co_dev_first_obj(dev); obj;
+			obj = co_obj_next(obj)) {
+		if (co_bdev_save_obj(out, obj) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int
+co_bdev_save_obj(struct co_bdev_out *out, const co_obj_t *obj)
+{
+	assert(out);
+	assert(obj);
+
+	co_bdev_put_u16(out, co_obj_get_idx(obj));
+	co_bdev_put_u8(out, co_obj_get_code(obj));
+
+#if !LELY_NO_CO_OBJ_NAME
+	if (co_bdev_put_str(out, co_obj_get_name(obj)) == -1)
+		return -1;
+#endif
+
+	co_bdev_put_u16(out, co_obj_get_subidx(obj, 0, NULL));
+	for (co_sub_t *sub = co_obj_first_sub(obj); sub;
+			sub = co_sub_next(sub)) {
+		if (co_bdev_save_sub(out, sub) == -1)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int
+co_bdev_save_sub(struct co_bdev_out *out, const co_sub_t *sub)
+{
+	assert(out);
+	assert(sub);
+
+	co_unsigned16_t type = co_sub_get_type(sub);
+
+	co_bdev_put_u8(out, co_sub_get_subidx(sub));
+	co_bdev_put_u16(out, type);
+	co_bdev_put_u8(out, co_sub_get_access(sub));
+	co_bdev_put_u8(out, co_sub_get_pdo_mapping(sub));
+	co_bdev_put_u32(out, co_sub_get_flags(sub));
+
+#if !LELY_NO_CO_OBJ_NAME
+	if (co_bdev_put_str(out, co_sub_get_name(sub)) == -1)
+		return -1;
+#endif
+
+#if !LELY_NO_CO_OBJ_LIMITS
+	if (co_bdev_put_val(out, type, co_sub_get_min(sub)) == -1)
+		return -1;
+	if (co_bdev_put_val(out, type, co_sub_get_max(sub)) == -1)
+		return -1;
+#endif
+
+#if !LELY_NO_CO_OBJ_DEFAULT
+	if (co_bdev_put_val(out, type, co_sub_get_def(sub)) == -1)
+		return -1;
+#endif
+
+	return co_bdev_put_val(out, type, co_sub_get_val(sub));
+}
+
+#endif // !LELY_NO_CO_BDEV
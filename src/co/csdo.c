@@ -102,8 +102,40 @@ struct __co_csdo {
 	unsigned crc : 1;
 	/// The memory buffer used for download requests.
 	struct membuf dn_buf;
+	/**
+	 * The offset (in bytes) of the first byte in #dn_buf with respect to
+	 * the start of the value.
+	 */
+	size_t dn_off;
+	/// The CRC of the bytes sent during a block download.
+	co_unsigned16_t dn_crc;
+	/// The number of bytes included in #dn_crc.
+	size_t dn_crc_off;
+	/**
+	 * A pointer to the download read function, or NULL if the entire value
+	 * is in #dn_buf.
+	 */
+	co_csdo_dn_read_t *dn_read;
+	/// A pointer to the user-specified buffer used by #dn_read.
+	void *dn_ptr;
+	/// The size (in bytes) of the buffer at #dn_ptr.
+	size_t dn_cap;
 	/// A pointer to the memory buffer used for upload requests.
 	struct membuf *up_buf;
+	/**
+	 * The memory buffer wrapping a user-specified buffer for upload
+	 * requests. This buffer is never reallocated.
+	 */
+	struct membuf up_usr;
+	/**
+	 * The number of uploaded bytes already passed to #up_chunk and removed
+	 * from #up_buf.
+	 */
+	size_t up_off;
+	/// The CRC of the bytes already passed to #up_chunk.
+	co_unsigned16_t up_crc;
+	/// A pointer to the upload chunk function.
+	co_csdo_up_chunk_t *up_chunk;
 	/**
 	 * The memory buffer used for storing serialized values in the absence
 	 * of a user-specified buffer.
@@ -556,6 +588,39 @@ static int co_csdo_dn_ind(co_csdo_t *sdo, co_unsigned16_t idx,
 		co_unsigned8_t subidx, const void *ptr, size_t n,
 		co_csdo_dn_con_t *con, void *data);
 
+/**
+ * Processes a download request from a Client-SDO where the value is obtained
+ * from a download read function.
+ *
+ * @returns 0 on success, or -1 on error.
+ *
+ * @see co_csdo_dn_src_req(), co_csdo_blk_dn_src_req()
+ */
+static int co_csdo_dn_src_ind(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t size, void *ptr, size_t n,
+		co_csdo_dn_read_t *read, co_csdo_dn_con_t *con, void *data);
+
+/**
+ * Returns the number of bytes sent during the current download request. This
+ * number can decrease if segments have to be resent during a block download.
+ */
+static inline size_t co_csdo_dn_size(const co_csdo_t *sdo);
+
+/**
+ * Sets the position of the next byte to be sent during a download request. If
+ * the position lies outside the bytes currently in the download buffer, the
+ * buffer is refilled by the next call to co_csdo_dn_fill().
+ */
+static void co_csdo_dn_seek(co_csdo_t *sdo, size_t pos);
+
+/**
+ * Ensures the download buffer contains the bytes of the next segment, invoking
+ * the download read function if necessary.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+static co_unsigned32_t co_csdo_dn_fill(co_csdo_t *sdo);
+
 /**
  * Processes an upload request from a Client-SDO by checking and updating the
  * state.
@@ -565,8 +630,40 @@ static int co_csdo_dn_ind(co_csdo_t *sdo, co_unsigned16_t idx,
  * @see co_csdo_up_req(), co_csdo_blk_up_req()
  */
 static int co_csdo_up_ind(co_csdo_t *sdo, co_unsigned16_t idx,
-		co_unsigned8_t subidx, struct membuf *buf,
-		co_csdo_up_con_t *con, void *data);
+		co_unsigned8_t subidx, void *ptr, size_t n,
+		co_csdo_up_chunk_t *chunk, co_csdo_up_con_t *con, void *data);
+
+/**
+ * Returns the total number of bytes received during the current upload request,
+ * including the bytes already passed to the upload chunk function.
+ */
+static inline size_t co_csdo_up_size(const co_csdo_t *sdo);
+
+/**
+ * Reserves space for <b>size</b> bytes in the upload buffer. A user-specified
+ * buffer is never reallocated; in the absence of an upload chunk function, the
+ * entire value has to fit.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+static co_unsigned32_t co_csdo_up_reserve(co_csdo_t *sdo, size_t size);
+
+/**
+ * Appends <b>n</b> bytes to the upload buffer, flushing the buffer to the
+ * upload chunk function whenever it is full.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+static co_unsigned32_t co_csdo_up_write(
+		co_csdo_t *sdo, const void *ptr, size_t n);
+
+/**
+ * Passes the contents of the upload buffer to the upload chunk function, if
+ * any, and clears the buffer.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+static co_unsigned32_t co_csdo_up_flush(co_csdo_t *sdo);
 
 /**
  * Sends an abort transfer request.
@@ -938,7 +1035,17 @@ __co_csdo_init(struct __co_csdo *sdo, can_net_t *net, co_dev_t *dev,
 	sdo->crc = 0;
 
 	membuf_init(&sdo->dn_buf, NULL, 0);
+	sdo->dn_off = 0;
+	sdo->dn_crc = 0;
+	sdo->dn_crc_off = 0;
+	sdo->dn_read = NULL;
+	sdo->dn_ptr = NULL;
+	sdo->dn_cap = 0;
 	sdo->up_buf = NULL;
+	membuf_init(&sdo->up_usr, NULL, 0);
+	sdo->up_off = 0;
+	sdo->up_crc = 0;
+	sdo->up_chunk = NULL;
 #if LELY_NO_MALLOC
 	membuf_init(&sdo->buf, sdo->begin, CO_CSDO_MEMBUF_SIZE);
 	memset(sdo->begin, 0, CO_CSDO_MEMBUF_SIZE);
@@ -1233,6 +1340,39 @@ co_csdo_dn_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 	return 0;
 }
 
+int
+co_csdo_dn_src_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		size_t size, void *ptr, size_t n, co_csdo_dn_read_t *read,
+		co_csdo_dn_con_t *con, void *data)
+{
+	assert(sdo);
+
+	if (co_csdo_dn_src_ind(sdo, idx, subidx, size, ptr, n, read, con, data)
+			== -1)
+		return -1;
+
+	trace("CSDO: %04X:%02X: initiate download", idx, subidx);
+
+	if (sdo->size && sdo->size <= 4) {
+		// An expedited transfer requires the entire value up front.
+		co_unsigned32_t ac = co_csdo_dn_fill(sdo);
+		if (ac) {
+			set_errnum(ERRNUM_IO);
+			return -1;
+		}
+		if (sdo->timeout)
+			can_timer_timeout(sdo->timer, sdo->net, sdo->timeout);
+		co_csdo_send_dn_exp_req(sdo);
+	} else {
+		if (sdo->timeout)
+			can_timer_timeout(sdo->timer, sdo->net, sdo->timeout);
+		co_csdo_send_dn_ini_req(sdo);
+	}
+	co_csdo_enter(sdo, co_csdo_dn_ini_state);
+
+	return 0;
+}
+
 int
 co_csdo_dn_val_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		co_unsigned16_t type, const void *val, co_csdo_dn_con_t *con,
@@ -1289,10 +1429,18 @@ co_csdo_dn_dcf_req(co_csdo_t *sdo, const uint_least8_t *begin,
 int
 co_csdo_up_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		co_csdo_up_con_t *con, void *data)
+{
+	return co_csdo_up_buf_req(sdo, idx, subidx, NULL, 0, NULL, con, data);
+}
+
+int
+co_csdo_up_buf_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		void *ptr, size_t n, co_csdo_up_chunk_t *chunk,
+		co_csdo_up_con_t *con, void *data)
 {
 	assert(sdo);
 
-	if (co_csdo_up_ind(sdo, idx, subidx, NULL, con, data) == -1)
+	if (co_csdo_up_ind(sdo, idx, subidx, ptr, n, chunk, con, data) == -1)
 		return -1;
 
 	trace("CSDO: %04X:%02X: initiate upload", idx, subidx);
@@ -1324,6 +1472,27 @@ co_csdo_blk_dn_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 	return 0;
 }
 
+int
+co_csdo_blk_dn_src_req(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t size, void *ptr, size_t n,
+		co_csdo_dn_read_t *read, co_csdo_dn_con_t *con, void *data)
+{
+	assert(sdo);
+
+	if (co_csdo_dn_src_ind(sdo, idx, subidx, size, ptr, n, read, con, data)
+			== -1)
+		return -1;
+
+	trace("CSDO: %04X:%02X: initiate block download", idx, subidx);
+
+	if (sdo->timeout)
+		can_timer_timeout(sdo->timer, sdo->net, sdo->timeout);
+	co_csdo_send_blk_dn_ini_req(sdo);
+	co_csdo_enter(sdo, co_csdo_blk_dn_ini_state);
+
+	return 0;
+}
+
 int
 co_csdo_blk_dn_val_req(co_csdo_t *sdo, co_unsigned16_t idx,
 		co_unsigned8_t subidx, co_unsigned16_t type, const void *val,
@@ -1351,10 +1520,19 @@ co_csdo_blk_dn_val_req(co_csdo_t *sdo, co_unsigned16_t idx,
 int
 co_csdo_blk_up_req(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		co_unsigned8_t pst, co_csdo_up_con_t *con, void *data)
+{
+	return co_csdo_blk_up_buf_req(
+			sdo, idx, subidx, pst, NULL, 0, NULL, con, data);
+}
+
+int
+co_csdo_blk_up_buf_req(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, co_unsigned8_t pst, void *ptr, size_t n,
+		co_csdo_up_chunk_t *chunk, co_csdo_up_con_t *con, void *data)
 {
 	assert(sdo);
 
-	if (co_csdo_up_ind(sdo, idx, subidx, NULL, con, data) == -1)
+	if (co_csdo_up_ind(sdo, idx, subidx, ptr, n, chunk, con, data) == -1)
 		return -1;
 
 	trace("CSDO: %04X:%02X: initiate block upload", idx, subidx);
@@ -1630,9 +1808,12 @@ co_csdo_abort_on_leave(co_csdo_t *sdo)
 		struct membuf *buf = sdo->up_buf;
 		assert(buf);
 
+		// If the value was passed to the upload chunk function, only
+		// the total size is reported.
 		up_con(sdo, sdo->idx, sdo->subidx, sdo->ac,
-				sdo->ac ? NULL : buf->begin,
-				sdo->ac ? 0 : membuf_size(buf), up_con_data);
+				sdo->ac || sdo->up_chunk ? NULL : buf->begin,
+				sdo->ac ? 0 : co_csdo_up_size(sdo),
+				up_con_data);
 	}
 }
 
@@ -1685,13 +1866,15 @@ static co_csdo_state_t *
 co_csdo_dn_seg_on_enter(co_csdo_t *sdo)
 {
 	assert(sdo);
-	struct membuf *buf = &sdo->dn_buf;
 
-	size_t n = sdo->size - membuf_size(buf);
+	size_t n = sdo->size - co_csdo_dn_size(sdo);
 	// 0-byte values cannot be sent using expedited transfer, so we need to
 	// send one empty segment. We use the toggle bit to check if it was
 	// sent.
 	if (n || (!sdo->size && !sdo->toggle)) {
+		co_unsigned32_t ac = co_csdo_dn_fill(sdo);
+		if (ac)
+			return co_csdo_abort_res(sdo, ac);
 		if (sdo->timeout)
 			can_timer_timeout(sdo->timer, sdo->net, sdo->timeout);
 		co_csdo_send_dn_seg_req(sdo, MIN(n, 7), n <= 7);
@@ -1761,8 +1944,6 @@ co_csdo_up_ini_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 {
 	assert(sdo);
 	assert(msg);
-	struct membuf *buf = sdo->up_buf;
-	assert(buf);
 
 	if (msg->len < 1)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_CS);
@@ -1804,12 +1985,14 @@ co_csdo_up_ini_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 	}
 
 	// Allocate the buffer.
-	if (sdo->size && !membuf_reserve(buf, sdo->size))
-		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_MEM);
+	if (sdo->size && (ac = co_csdo_up_reserve(sdo, sdo->size)) != 0)
+		return co_csdo_abort_res(sdo, ac);
 
 	if (exp) {
 		// Perform an expedited transfer.
-		membuf_write(buf, data, sdo->size);
+		if ((ac = co_csdo_up_write(sdo, data, sdo->size)) != 0
+				|| (ac = co_csdo_up_flush(sdo)) != 0)
+			return co_csdo_abort_res(sdo, ac);
 
 		return co_csdo_abort_ind(sdo, 0);
 	} else {
@@ -1842,8 +2025,6 @@ co_csdo_up_seg_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 {
 	assert(sdo);
 	assert(msg);
-	struct membuf *buf = sdo->up_buf;
-	assert(buf);
 
 	if (msg->len < 1)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_CS);
@@ -1869,20 +2050,23 @@ co_csdo_up_seg_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_CS);
 	int last = !!(cs & CO_SDO_SEG_LAST);
 
-	if (membuf_size(buf) + n > sdo->size)
+	if (co_csdo_up_size(sdo) + n > sdo->size)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_TYPE_LEN_HI);
 
 	// Copy the data to the buffer.
-	assert(membuf_capacity(buf) >= n);
-	membuf_write(buf, msg->data + 1, n);
+	if ((ac = co_csdo_up_write(sdo, msg->data + 1, n)) != 0)
+		return co_csdo_abort_res(sdo, ac);
 
-	if ((last || !(membuf_size(buf) % (CO_SDO_MAX_SEQNO * 7))) && sdo->size
+	size_t nbyte = co_csdo_up_size(sdo);
+	if ((last || !(nbyte % (CO_SDO_MAX_SEQNO * 7))) && sdo->size
 			&& sdo->up_ind)
-		sdo->up_ind(sdo, sdo->idx, sdo->subidx, sdo->size,
-				membuf_size(buf), sdo->up_ind_data);
+		sdo->up_ind(sdo, sdo->idx, sdo->subidx, sdo->size, nbyte,
+				sdo->up_ind_data);
 	if (last) {
-		if (sdo->size && membuf_size(buf) != sdo->size)
+		if (sdo->size && nbyte != sdo->size)
 			return co_csdo_abort_res(sdo, CO_SDO_AC_TYPE_LEN_LO);
+		if ((ac = co_csdo_up_flush(sdo)) != 0)
+			return co_csdo_abort_res(sdo, ac);
 		return co_csdo_abort_ind(sdo, 0);
 	} else {
 		if (sdo->timeout)
@@ -1953,22 +2137,25 @@ static co_csdo_state_t *
 co_csdo_blk_dn_sub_on_enter(co_csdo_t *sdo)
 {
 	assert(sdo);
-	struct membuf *buf = &sdo->dn_buf;
 
-	size_t n = sdo->size - membuf_size(buf);
+	size_t n = sdo->size - co_csdo_dn_size(sdo);
 	if ((n > 0 && !sdo->blksize) || sdo->blksize > CO_SDO_MAX_SEQNO)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_BLK_SIZE);
 	sdo->blksize = (co_unsigned8_t)MIN((n + 6) / 7, sdo->blksize);
 
 	if (sdo->size && sdo->dn_ind)
 		sdo->dn_ind(sdo, sdo->idx, sdo->subidx, sdo->size,
-				membuf_size(buf), sdo->dn_ind_data);
+				co_csdo_dn_size(sdo), sdo->dn_ind_data);
 	if (sdo->timeout)
 		can_timer_timeout(sdo->timer, sdo->net, sdo->timeout);
 	if (n) {
 		// Send all segments in the current block.
-		for (co_unsigned8_t seqno = 1; seqno <= sdo->blksize; seqno++)
+		for (co_unsigned8_t seqno = 1; seqno <= sdo->blksize; seqno++) {
+			co_unsigned32_t ac = co_csdo_dn_fill(sdo);
+			if (ac)
+				return co_csdo_abort_res(sdo, ac);
 			co_csdo_send_blk_dn_sub_req(sdo, seqno);
+		}
 		return NULL;
 	} else {
 		co_csdo_send_blk_dn_end_req(sdo);
@@ -1995,7 +2182,6 @@ co_csdo_blk_dn_sub_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 {
 	assert(sdo);
 	assert(msg);
-	struct membuf *buf = &sdo->dn_buf;
 
 	if (msg->len < 1)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_CS);
@@ -2022,10 +2208,10 @@ co_csdo_blk_dn_sub_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 		// If the sequence number of the last segment that was
 		// successfully received is smaller than the number of segments
 		// in the block, resend the missing segments.
-		size_t n = (membuf_size(buf) + 6) / 7;
+		size_t n = (co_csdo_dn_size(sdo) + 6) / 7;
 		assert(n >= sdo->blksize);
 		n -= sdo->blksize - ackseq;
-		buf->cur = buf->begin + n * 7;
+		co_csdo_dn_seek(sdo, n * 7);
 	}
 
 	// Read the number of segments in the next block.
@@ -2096,8 +2282,6 @@ co_csdo_blk_up_ini_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 {
 	assert(sdo);
 	assert(msg);
-	struct membuf *buf = sdo->up_buf;
-	assert(buf);
 
 	if (msg->len < 1)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_CS);
@@ -2143,8 +2327,8 @@ co_csdo_blk_up_ini_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 	}
 
 	// Allocate the buffer.
-	if (sdo->size && !membuf_reserve(buf, sdo->size))
-		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_MEM);
+	if (sdo->size && (ac = co_csdo_up_reserve(sdo, sdo->size)) != 0)
+		return co_csdo_abort_res(sdo, ac);
 
 	sdo->ackseq = 0;
 
@@ -2173,8 +2357,6 @@ co_csdo_blk_up_sub_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 {
 	assert(sdo);
 	assert(msg);
-	struct membuf *buf = sdo->up_buf;
-	assert(buf);
 
 	if (msg->len < 1)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_CS);
@@ -2194,14 +2376,15 @@ co_csdo_blk_up_sub_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 		sdo->ackseq++;
 
 		// Determine the number of bytes to copy.
-		assert(sdo->size >= membuf_size(buf));
-		size_t n = MIN(sdo->size - membuf_size(buf), 7);
+		assert(sdo->size >= co_csdo_up_size(sdo));
+		size_t n = MIN(sdo->size - co_csdo_up_size(sdo), 7);
 		if (!last && n < 7)
 			return co_csdo_abort_res(sdo, CO_SDO_AC_TYPE_LEN_HI);
 
 		// Copy the data to the buffer.
-		assert(membuf_capacity(buf) >= n);
-		membuf_write(buf, msg->data + 1, n);
+		co_unsigned32_t ac = co_csdo_up_write(sdo, msg->data + 1, n);
+		if (ac)
+			return co_csdo_abort_res(sdo, ac);
 	}
 
 	// If this is the last segment in the block, send a confirmation.
@@ -2256,7 +2439,7 @@ co_csdo_blk_up_end_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_NO_CS);
 
 	// Check the total length.
-	if (sdo->size && membuf_size(buf) != sdo->size)
+	if (sdo->size && co_csdo_up_size(sdo) != sdo->size)
 		return co_csdo_abort_res(sdo, CO_SDO_AC_TYPE_LEN_LO);
 
 	// Check the number of bytes in the last segment.
@@ -2267,10 +2450,14 @@ co_csdo_blk_up_end_on_recv(co_csdo_t *sdo, const struct can_msg *msg)
 	// Check the CRC.
 	if (sdo->crc) {
 		co_unsigned16_t crc = ldle_u16(msg->data + 1);
-		if (crc != co_crc(0, (uint_least8_t *)buf->begin, sdo->size))
+		if (crc != co_crc(sdo->up_crc, (uint_least8_t *)buf->begin,
+					    membuf_size(buf)))
 			return co_csdo_abort_res(sdo, CO_SDO_AC_BLK_CRC);
 	}
 
+	if ((ac = co_csdo_up_flush(sdo)) != 0)
+		return co_csdo_abort_res(sdo, ac);
+
 	co_csdo_send_blk_up_end_res(sdo);
 	return co_csdo_abort_ind(sdo, 0);
 }
@@ -2316,6 +2503,12 @@ co_csdo_dn_ind(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 	// Casting away const is safe here since a download (write) request only
 	// reads from the provided buffer.
 	membuf_init(&sdo->dn_buf, (void *)ptr, n);
+	sdo->dn_off = 0;
+	sdo->dn_crc = 0;
+	sdo->dn_crc_off = 0;
+	sdo->dn_read = NULL;
+	sdo->dn_ptr = NULL;
+	sdo->dn_cap = 0;
 
 	sdo->dn_con = con;
 	sdo->dn_con_data = data;
@@ -2326,12 +2519,92 @@ co_csdo_dn_ind(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 	return 0;
 }
 
+static int
+co_csdo_dn_src_ind(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		size_t size, void *ptr, size_t n, co_csdo_dn_read_t *read,
+		co_csdo_dn_con_t *con, void *data)
+{
+	assert(sdo);
+
+	// The buffer has to be able to hold at least a single segment.
+	if (!ptr || n < 7 || !read || size > CO_UNSIGNED32_MAX) {
+		set_errnum(ERRNUM_INVAL);
+		return -1;
+	}
+
+	if (co_csdo_dn_ind(sdo, idx, subidx, NULL, 0, con, data) == -1)
+		return -1;
+
+	sdo->size = size;
+
+	sdo->dn_read = read;
+	sdo->dn_ptr = ptr;
+	sdo->dn_cap = n;
+
+	return 0;
+}
+
+static inline size_t
+co_csdo_dn_size(const co_csdo_t *sdo)
+{
+	assert(sdo);
+
+	return sdo->dn_off + membuf_size(&sdo->dn_buf);
+}
+
+static void
+co_csdo_dn_seek(co_csdo_t *sdo, size_t pos)
+{
+	assert(sdo);
+	struct membuf *buf = &sdo->dn_buf;
+
+	size_t n = buf->end - buf->begin;
+	if (pos >= sdo->dn_off && pos <= sdo->dn_off + n) {
+		buf->cur = buf->begin + (pos - sdo->dn_off);
+	} else {
+		// Invalidate the buffer.
+		membuf_init(buf, sdo->dn_ptr, 0);
+		sdo->dn_off = pos;
+	}
+}
+
+static co_unsigned32_t
+co_csdo_dn_fill(co_csdo_t *sdo)
+{
+	assert(sdo);
+	struct membuf *buf = &sdo->dn_buf;
+
+	size_t pos = co_csdo_dn_size(sdo);
+	assert(sdo->size >= pos);
+	size_t n = sdo->size - pos;
+	if (!sdo->dn_read || membuf_capacity(buf) >= MIN(n, 7))
+		return 0;
+
+	n = MIN(n, sdo->dn_cap);
+	co_unsigned32_t ac = sdo->dn_read(sdo, sdo->idx, sdo->subidx, pos,
+			sdo->dn_ptr, n, sdo->dn_con_data);
+	if (ac)
+		return ac;
+
+	membuf_init(buf, sdo->dn_ptr, n);
+	sdo->dn_off = pos;
+
+	return 0;
+}
+
 static int
 co_csdo_up_ind(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
-		struct membuf *buf, co_csdo_up_con_t *con, void *data)
+		void *ptr, size_t n, co_csdo_up_chunk_t *chunk,
+		co_csdo_up_con_t *con, void *data)
 {
 	assert(sdo);
 
+	// A chunk function requires a non-empty buffer to collect the chunks.
+	if (chunk && (!ptr || !n)) {
+		set_errnum(ERRNUM_INVAL);
+		return -1;
+	}
+
 	// Check whether the SDO exists, is valid and is in the waiting state.
 	if (!co_csdo_is_valid(sdo) || !co_csdo_is_idle(sdo)) {
 		set_errnum(ERRNUM_INVAL);
@@ -2348,8 +2621,16 @@ co_csdo_up_ind(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 	sdo->ackseq = 0;
 	sdo->crc = 0;
 
-	sdo->up_buf = buf ? buf : &sdo->buf;
+	if (ptr) {
+		membuf_init(&sdo->up_usr, ptr, n);
+		sdo->up_buf = &sdo->up_usr;
+	} else {
+		sdo->up_buf = &sdo->buf;
+	}
 	membuf_clear(sdo->up_buf);
+	sdo->up_off = 0;
+	sdo->up_crc = 0;
+	sdo->up_chunk = chunk;
 
 	sdo->dn_con = NULL;
 	sdo->dn_con_data = NULL;
@@ -2360,6 +2641,81 @@ co_csdo_up_ind(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 	return 0;
 }
 
+static inline size_t
+co_csdo_up_size(const co_csdo_t *sdo)
+{
+	assert(sdo);
+	assert(sdo->up_buf);
+
+	return sdo->up_off + membuf_size(sdo->up_buf);
+}
+
+static co_unsigned32_t
+co_csdo_up_reserve(co_csdo_t *sdo, size_t size)
+{
+	assert(sdo);
+	struct membuf *buf = sdo->up_buf;
+	assert(buf);
+
+	if (buf != &sdo->up_usr)
+		return membuf_reserve(buf, size) ? 0 : CO_SDO_AC_NO_MEM;
+
+	if (!sdo->up_chunk && membuf_capacity(buf) < size)
+		return CO_SDO_AC_NO_MEM;
+
+	return 0;
+}
+
+static co_unsigned32_t
+co_csdo_up_write(co_csdo_t *sdo, const void *ptr, size_t n)
+{
+	assert(sdo);
+	struct membuf *buf = sdo->up_buf;
+	assert(buf);
+	const char *cp = ptr;
+
+	while (n) {
+		if (!membuf_capacity(buf)) {
+			if (!sdo->up_chunk)
+				return CO_SDO_AC_NO_MEM;
+			co_unsigned32_t ac = co_csdo_up_flush(sdo);
+			if (ac)
+				return ac;
+		}
+		size_t nbyte = membuf_write(buf, cp, n);
+		cp += nbyte;
+		n -= nbyte;
+	}
+
+	return 0;
+}
+
+static co_unsigned32_t
+co_csdo_up_flush(co_csdo_t *sdo)
+{
+	assert(sdo);
+	struct membuf *buf = sdo->up_buf;
+	assert(buf);
+
+	size_t n = membuf_size(buf);
+	if (!sdo->up_chunk || !n)
+		return 0;
+
+	if (sdo->crc)
+		sdo->up_crc = co_crc(sdo->up_crc, (uint_least8_t *)buf->begin,
+				n);
+
+	co_unsigned32_t ac = sdo->up_chunk(sdo, sdo->idx, sdo->subidx,
+			sdo->up_off, buf->begin, n, sdo->up_con_data);
+	if (ac)
+		return ac;
+
+	sdo->up_off += n;
+	membuf_clear(buf);
+
+	return 0;
+}
+
 static void
 co_csdo_send_abort(co_csdo_t *sdo, co_unsigned32_t ac)
 {
@@ -2425,10 +2781,11 @@ co_csdo_send_dn_seg_req(co_csdo_t *sdo, co_unsigned32_t n, int last)
 	buf->cur += n;
 	can_net_send(sdo->net, &msg);
 
-	if ((last || !(membuf_size(buf) % (CO_SDO_MAX_SEQNO * 7))) && sdo->size
+	size_t nbyte = co_csdo_dn_size(sdo);
+	if ((last || !(nbyte % (CO_SDO_MAX_SEQNO * 7))) && sdo->size
 			&& sdo->dn_ind)
-		sdo->dn_ind(sdo, sdo->idx, sdo->subidx, sdo->size,
-				membuf_size(buf), sdo->dn_ind_data);
+		sdo->dn_ind(sdo, sdo->idx, sdo->subidx, sdo->size, nbyte,
+				sdo->dn_ind_data);
 }
 
 static void
@@ -2477,14 +2834,22 @@ co_csdo_send_blk_dn_sub_req(co_csdo_t *sdo, co_unsigned8_t seqno)
 	assert(seqno && seqno <= CO_SDO_MAX_SEQNO);
 	struct membuf *buf = &sdo->dn_buf;
 
-	size_t n = sdo->size - membuf_size(buf);
+	size_t pos = co_csdo_dn_size(sdo);
+	size_t n = sdo->size - pos;
 	int last = n <= 7;
 	n = MIN(n, 7);
+	assert(membuf_capacity(buf) >= n);
 
 	co_unsigned8_t cs = seqno;
 	if (last)
 		cs |= CO_SDO_SEQ_LAST;
 
+	// Update the CRC, unless the segment is being resent.
+	if (sdo->crc && pos == sdo->dn_crc_off) {
+		sdo->dn_crc = co_crc(sdo->dn_crc, (uint_least8_t *)buf->cur, n);
+		sdo->dn_crc_off += n;
+	}
+
 	struct can_msg msg;
 	co_csdo_init_seg_req(sdo, &msg, cs);
 	memcpy(msg.data + 1, buf->cur, n);
@@ -2496,7 +2861,7 @@ static void
 co_csdo_send_blk_dn_end_req(co_csdo_t *sdo)
 {
 	assert(sdo);
-	struct membuf *buf = &sdo->dn_buf;
+	assert(!sdo->crc || sdo->dn_crc_off == sdo->size);
 
 	// Compute the number of bytes in the last segment containing data.
 	co_unsigned8_t n = sdo->size ? (sdo->size - 1) % 7 + 1 : 0;
@@ -2504,9 +2869,8 @@ co_csdo_send_blk_dn_end_req(co_csdo_t *sdo)
 	co_unsigned8_t cs = CO_SDO_CCS_BLK_DN_REQ | CO_SDO_SC_END_BLK
 			| CO_SDO_BLK_SIZE_SET(n);
 
-	co_unsigned16_t crc = sdo->crc
-			? co_crc(0, (uint_least8_t *)buf->begin, sdo->size)
-			: 0;
+	// The CRC is computed incrementally as the segments are sent.
+	co_unsigned16_t crc = sdo->crc ? sdo->dn_crc : 0;
 
 	struct can_msg msg;
 	co_csdo_init_seg_req(sdo, &msg, cs);
@@ -2549,8 +2913,6 @@ static void
 co_csdo_send_blk_up_sub_res(co_csdo_t *sdo)
 {
 	assert(sdo);
-	struct membuf *buf = sdo->up_buf;
-	assert(buf);
 
 	co_unsigned8_t cs = CO_SDO_CCS_BLK_UP_REQ | CO_SDO_SC_BLK_RES;
 
@@ -2562,7 +2924,7 @@ co_csdo_send_blk_up_sub_res(co_csdo_t *sdo)
 
 	if (sdo->size && sdo->up_ind)
 		sdo->up_ind(sdo, sdo->idx, sdo->subidx, sdo->size,
-				membuf_size(buf), sdo->up_ind_data);
+				co_csdo_up_size(sdo), sdo->up_ind_data);
 }
 
 static void
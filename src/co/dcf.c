@@ -26,34 +26,252 @@
 
 #if !LELY_NO_CO_DCF
 
+#include "obj.h"
 #include <lely/co/dcf.h>
 #include <lely/co/detail/obj.h>
 #include <lely/co/pdo.h>
 #include <lely/libc/stdio.h>
+#if !LELY_NO_THREADS
+#include <lely/libc/threads.h>
+#endif
 #include <lely/libc/strings.h>
 #include <lely/util/config.h>
 #include <lely/util/diag.h>
 #include <lely/util/lex.h>
+#include <lely/util/membuf.h>
 
 #include <assert.h>
+#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 
-static struct __co_dev *__co_dev_init_from_dcf_cfg(
-		struct __co_dev *dev, const config_t *cfg);
+/// The kinds of sections in an EDS/DCF file recognized by the parser.
+enum co_dcf_sec_kind {
+	/// An unknown section. The entries in this section are ignored.
+	CO_DCF_SEC_NONE,
+	/// The [DeviceInfo] section.
+	CO_DCF_SEC_DEVICE_INFO,
+	/// The [DummyUsage] section.
+	CO_DCF_SEC_DUMMY_USAGE,
+	/// The [MandatoryObjects] section.
+	CO_DCF_SEC_MANDATORY_OBJECTS,
+	/// The [OptionalObjects] section.
+	CO_DCF_SEC_OPTIONAL_OBJECTS,
+	/// The [ManufacturerObjects] section.
+	CO_DCF_SEC_MANUFACTURER_OBJECTS,
+	/// The [DeviceComissioning] section.
+	CO_DCF_SEC_DEVICE_COMISSIONING,
+	/// An object section ([<idx>]).
+	CO_DCF_SEC_OBJ,
+	/// A sub-object section ([<idx>sub<subidx>]).
+	CO_DCF_SEC_SUB,
+	/// The names of the sub-objects of a compact array ([<idx>Name]).
+	CO_DCF_SEC_NAME,
+	/// The values of the sub-objects of a compact array ([<idx>Value]).
+	CO_DCF_SEC_VALUE
+};
+
+/**
+ * Returns the numeric key of a section. The sections of the same kind are
+ * ordered by object index and sub-index.
+ */
+#define CO_DCF_SEC(kind, idx, subidx) \
+	(((uint_least32_t)(kind) << 24) | ((uint_least32_t)(idx) << 8) \
+			| (uint_least32_t)(subidx))
+
+/// The keys recognized by the parser, in the same order as #co_dcf_keys.
+enum co_dcf_key {
+	/// An unknown key. The entry is ignored.
+	CO_DCF_KEY_NONE,
+	CO_DCF_KEY_ACCESS_TYPE,
+	CO_DCF_KEY_BAUDRATE,
+	CO_DCF_KEY_BAUD_RATE_10,
+	CO_DCF_KEY_BAUD_RATE_1000,
+	CO_DCF_KEY_BAUD_RATE_125,
+	CO_DCF_KEY_BAUD_RATE_20,
+	CO_DCF_KEY_BAUD_RATE_250,
+	CO_DCF_KEY_BAUD_RATE_50,
+	CO_DCF_KEY_BAUD_RATE_500,
+	CO_DCF_KEY_BAUD_RATE_800,
+	CO_DCF_KEY_COMPACT_PDO,
+	CO_DCF_KEY_COMPACT_SUB_OBJ,
+	CO_DCF_KEY_DATA_TYPE,
+	CO_DCF_KEY_DEFAULT_VALUE,
+	CO_DCF_KEY_DENOTATION,
+	CO_DCF_KEY_DOWNLOAD_FILE,
+	CO_DCF_KEY_HIGH_LIMIT,
+	CO_DCF_KEY_LOW_LIMIT,
+	CO_DCF_KEY_LSS_SERIAL_NUMBER,
+	CO_DCF_KEY_LSS_SUPPORTED,
+	CO_DCF_KEY_NET_NUMBER,
+	CO_DCF_KEY_NODE_ID,
+	CO_DCF_KEY_NODE_NAME,
+	CO_DCF_KEY_NR_OF_ENTRIES,
+	CO_DCF_KEY_NR_OF_RX_PDO,
+	CO_DCF_KEY_NR_OF_TX_PDO,
+	CO_DCF_KEY_OBJECT_TYPE,
+	CO_DCF_KEY_OBJ_FLAGS,
+	CO_DCF_KEY_ORDER_CODE,
+	CO_DCF_KEY_PARAMETER_NAME,
+	CO_DCF_KEY_PARAMETER_VALUE,
+	CO_DCF_KEY_PDO_MAPPING,
+	CO_DCF_KEY_PRODUCT_NAME,
+	CO_DCF_KEY_PRODUCT_NUMBER,
+	CO_DCF_KEY_REVISION_NUMBER,
+	CO_DCF_KEY_SUB_NUMBER,
+	CO_DCF_KEY_SUPPORTED_OBJECTS,
+	CO_DCF_KEY_UPLOAD_FILE,
+	CO_DCF_KEY_VENDOR_NAME,
+	CO_DCF_KEY_VENDOR_NUMBER
+};
+
+/// The names of the keys recognized by the parser, in case-insensitive order.
+static const char *const co_dcf_keys[] = {
+	"AccessType",
+	"Baudrate",
+	"BaudRate_10",
+	"BaudRate_1000",
+	"BaudRate_125",
+	"BaudRate_20",
+	"BaudRate_250",
+	"BaudRate_50",
+	"BaudRate_500",
+	"BaudRate_800",
+	"CompactPDO",
+	"CompactSubObj",
+	"DataType",
+	"DefaultValue",
+	"Denotation",
+	"DownloadFile",
+	"HighLimit",
+	"LowLimit",
+	"LSS_SerialNumber",
+	"LSS_Supported",
+	"NetNumber",
+	"NodeID",
+	"NodeName",
+	"NrOfEntries",
+	"NrOfRxPDO",
+	"NrOfTxPDO",
+	"ObjectType",
+	"ObjFlags",
+	"OrderCode",
+	"ParameterName",
+	"ParameterValue",
+	"PDOMapping",
+	"ProductName",
+	"ProductNumber",
+	"RevisionNumber",
+	"SubNumber",
+	"SupportedObjects",
+	"UploadFile",
+	"VendorName",
+	"VendorNumber"
+};
+
+/// Returns the numeric key of an entry with a decimal name ("1", "2", ...).
+#define CO_DCF_KEY_NUM(n) (UINT32_C(0x10000) | (uint_least32_t)(n))
+
+/// Returns the numeric key of a "DummyXXXX" entry in the [DummyUsage] section.
+#define CO_DCF_KEY_DUMMY(n) (UINT32_C(0x20000) | (uint_least32_t)(n))
+
+/// An entry in an indexed EDS/DCF file.
+struct co_dcf_ent {
+	/// The numeric key of the section (see #CO_DCF_SEC()).
+	uint_least32_t sec;
+	/// The numeric key of the entry.
+	uint_least32_t key;
+	/// The offset of the null-terminated value in co_dcf::vals.
+	size_t val;
+};
+
+/**
+ * An EDS/DCF file indexed in a single pass. Instead of building a configuration
+ * struct with string-keyed trees of sections and keys, the recognized entries
+ * are stored in a flat array with numeric section and key names, which is
+ * sorted once the file has been scanned. Entries in unknown sections, and
+ * entries with unknown keys, are discarded during the scan.
+ */
+struct co_dcf {
+	/// The array of entries (struct #co_dcf_ent).
+	struct membuf ents;
+	/// The null-terminated values of the entries.
+	struct membuf vals;
+	/// The error number of the first error that occurred during the scan.
+	int errc;
+};
+
+/// A section in an indexed EDS/DCF file.
+struct co_dcf_sec {
+	/// A pointer to the first entry in the section.
+	const struct co_dcf_ent *begin;
+	/// A pointer to one past the last entry in the section.
+	const struct co_dcf_ent *end;
+	/// A pointer to the values of the entries.
+	const char *vals;
+};
+
+static void co_dcf_init(struct co_dcf *dcf);
+static void co_dcf_fini(struct co_dcf *dcf);
+static int co_dcf_sort(struct co_dcf *dcf);
+static void co_dcf_scan_func(const char *section, const char *key,
+		const char *value, void *data);
+static int co_dcf_ent_cmp(const void *p1, const void *p2);
+static uint_least32_t co_dcf_parse_sec(const char *section);
+static uint_least32_t co_dcf_parse_key(const char *key);
+static size_t co_dcf_lex_hex(const char *s, size_t n, uint_least32_t *pval);
+static const struct co_dcf_ent *co_dcf_lower_bound(
+		const struct co_dcf *dcf, uint_least32_t sec);
+static void co_dcf_get_sec(const struct co_dcf *dcf, uint_least32_t sec,
+		struct co_dcf_sec *psec);
+static const struct co_dcf_ent *co_dcf_next_sec(const struct co_dcf *dcf,
+		const struct co_dcf_ent *ent, const struct co_dcf_ent *end,
+		struct co_dcf_sec *psec);
+static const char *co_dcf_sec_get(
+		const struct co_dcf_sec *sec, uint_least32_t key);
+
+static struct __co_dev *co_dev_init_from_dcf_file(
+		struct __co_dev *dev, const char *filename, size_t arena_size);
+static struct __co_dev *__co_dev_init_from_dcf_cfg(struct __co_dev *dev,
+		const struct co_dcf *dcf, size_t arena_size);
+
+/// A set of EDS/DCF files loaded concurrently by co_dev_create_from_dcf_files().
+struct co_dcf_files {
+	/// A pointer to the array of files.
+	struct co_dcf_file *files;
+	/// The number of files at #files.
+	size_t n;
+	/// The index of the next file to be loaded.
+	size_t next;
+#if !LELY_NO_THREADS
+	/// A flag indicating whether #mtx is initialized.
+	int locked;
+	/// The mutex protecting #next.
+	mtx_t mtx;
+#endif
+};
+
+static int co_dcf_files_thrd_start(void *arg);
+#if !LELY_NO_DIAG && !LELY_NO_STDIO
+static void co_dcf_file_diag_handler(void *handle, enum diag_severity severity,
+		int errc, const char *format, va_list ap);
+static void co_dcf_file_diag_at_handler(void *handle,
+		enum diag_severity severity, int errc, const struct floc *at,
+		const char *format, va_list ap);
+#endif
 
-static int co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg);
+static int co_dev_parse_cfg(co_dev_t *dev, const struct co_dcf *dcf);
 
-static int co_obj_parse_cfg(
-		co_obj_t *obj, const config_t *cfg, const char *section);
+static int co_obj_parse_cfg(co_obj_t *obj, const struct co_dcf *dcf,
+		const struct co_dcf_sec *sec, const char *section);
 #if !LELY_NO_CO_OBJ_NAME
-static int co_obj_parse_names(co_obj_t *obj, const config_t *cfg);
+static int co_obj_parse_names(co_obj_t *obj, const struct co_dcf *dcf);
 #endif
-static int co_obj_parse_values(co_obj_t *obj, const config_t *cfg);
+static int co_obj_parse_values(co_obj_t *obj, const struct co_dcf *dcf);
 static co_obj_t *co_obj_build(co_dev_t *dev, co_unsigned16_t idx);
 
-static int co_sub_parse_cfg(
-		co_sub_t *sub, const config_t *cfg, const char *section);
+static int co_sub_parse_cfg(co_sub_t *sub, const struct co_dcf_sec *sec,
+		const char *section);
 static co_sub_t *co_sub_build(co_obj_t *obj, co_unsigned8_t subidx,
 		co_unsigned16_t type, const char *name);
 
@@ -66,38 +284,23 @@ static size_t co_val_lex_id(
 		const char *begin, const char *end, struct floc *at);
 static void co_val_set_id(co_unsigned16_t type, void *val, co_unsigned8_t id);
 
-static co_unsigned16_t config_get_idx(const config_t *cfg, const char *section,
-		co_unsigned16_t maxidx, co_unsigned16_t *idx);
+static co_unsigned16_t co_dcf_get_idx(const struct co_dcf *dcf,
+		uint_least32_t sec, co_unsigned16_t maxidx, co_unsigned16_t *idx);
 
 struct __co_dev *
 __co_dev_init_from_dcf_file(struct __co_dev *dev, const char *filename)
 {
-	config_t *cfg = config_create(CONFIG_CASE);
-	if (!cfg) {
-		diag(DIAG_ERROR, get_errc(),
-				"unable to create configuration struct");
-		goto error_create_cfg;
-	}
-
-	if (!config_parse_ini_file(cfg, filename))
-		goto error_parse_ini_file;
-
-	if (!__co_dev_init_from_dcf_cfg(dev, cfg))
-		goto error_init_dev;
-
-	config_destroy(cfg);
-
-	return dev;
-
-error_init_dev:
-error_parse_ini_file:
-	config_destroy(cfg);
-error_create_cfg:
-	return NULL;
+	return co_dev_init_from_dcf_file(dev, filename, 0);
 }
 
 co_dev_t *
 co_dev_create_from_dcf_file(const char *filename)
+{
+	return co_dev_create_from_dcf_file_arena(filename, 0);
+}
+
+co_dev_t *
+co_dev_create_from_dcf_file_arena(const char *filename, size_t arena_size)
 {
 	int errc = 0;
 
@@ -107,7 +310,7 @@ co_dev_create_from_dcf_file(const char *filename)
 		goto error_alloc_dev;
 	}
 
-	if (!__co_dev_init_from_dcf_file(dev, filename)) {
+	if (!co_dev_init_from_dcf_file(dev, filename, arena_size)) {
 		errc = get_errc();
 		goto error_init_dev;
 	}
@@ -121,31 +324,83 @@ error_alloc_dev:
 	return NULL;
 }
 
+int
+co_dev_create_from_dcf_files(struct co_dcf_file *files, size_t n, size_t nthrd)
+{
+	assert(files || !n);
+
+	for (size_t i = 0; i < n; i++) {
+		files[i].dev = NULL;
+		files[i].errc = 0;
+		files[i].diag = NULL;
+	}
+
+	struct co_dcf_files ctx = { .files = files, .n = n, .next = 0 };
+
+#if LELY_NO_THREADS
+	(void)nthrd;
+
+	co_dcf_files_thrd_start(&ctx);
+#else
+	// If the mutex cannot be created, the files are loaded sequentially.
+	ctx.locked = mtx_init(&ctx.mtx, mtx_plain) == thrd_success;
+
+	// The calling thread loads files as well, so at most nthrd - 1
+	// additional threads are needed. If a thread cannot be created, the
+	// remaining files are loaded by the threads that do exist.
+	nthrd = ctx.locked ? MIN(nthrd, n) : 0;
+	thrd_t *thr = nthrd > 1 ? calloc(nthrd - 1, sizeof(*thr)) : NULL;
+	size_t nthr = 0;
+	while (thr && nthr < nthrd - 1
+			&& thrd_create(thr + nthr, &co_dcf_files_thrd_start,
+					   &ctx) == thrd_success)
+		nthr++;
+
+	co_dcf_files_thrd_start(&ctx);
+
+	while (nthr--)
+		thrd_join(thr[nthr], NULL);
+	free(thr);
+
+	if (ctx.locked)
+		mtx_destroy(&ctx.mtx);
+#endif
+
+	for (size_t i = 0; i < n; i++) {
+		if (!files[i].dev) {
+			set_errc(files[i].errc);
+			return -1;
+		}
+	}
+	return 0;
+}
+
 struct __co_dev *
 __co_dev_init_from_dcf_text(struct __co_dev *dev, const char *begin,
 		const char *end, struct floc *at)
 {
-	config_t *cfg = config_create(CONFIG_CASE);
-	if (!cfg) {
-		diag(DIAG_ERROR, get_errc(),
-				"unable to create configuration struct");
-		goto error_create_cfg;
-	}
+	struct co_dcf dcf;
+	co_dcf_init(&dcf);
+
+	if (!config_scan_ini_text(begin, end, at, &co_dcf_scan_func, &dcf))
+		goto error_scan_ini_text;
 
-	if (!config_parse_ini_text(cfg, begin, end, at))
-		goto error_parse_ini_text;
+	if (co_dcf_sort(&dcf) == -1) {
+		diag(DIAG_ERROR, dcf.errc, "unable to index EDS/DCF text");
+		goto error_sort;
+	}
 
-	if (!__co_dev_init_from_dcf_cfg(dev, cfg))
+	if (!__co_dev_init_from_dcf_cfg(dev, &dcf, 0))
 		goto error_init_dev;
 
-	config_destroy(cfg);
+	co_dcf_fini(&dcf);
 
 	return dev;
 
 error_init_dev:
-error_parse_ini_text:
-	config_destroy(cfg);
-error_create_cfg:
+error_sort:
+error_scan_ini_text:
+	co_dcf_fini(&dcf);
 	return NULL;
 }
 
@@ -174,19 +429,404 @@ error_alloc_dev:
 	return NULL;
 }
 
+static int
+co_dcf_files_thrd_start(void *arg)
+{
+	struct co_dcf_files *ctx = arg;
+	assert(ctx);
+
+#if !LELY_NO_DIAG && !LELY_NO_STDIO
+	// Collect the diagnostic messages of this thread in the file being
+	// loaded, instead of passing them to the global handler.
+	diag_handler_t *handler = NULL;
+	void *handle = NULL;
+	diag_get_thrd_handler(&handler, &handle);
+	diag_at_handler_t *at_handler = NULL;
+	void *at_handle = NULL;
+	diag_at_get_thrd_handler(&at_handler, &at_handle);
+#endif
+
+	for (;;) {
+#if !LELY_NO_THREADS
+		if (ctx->locked)
+			mtx_lock(&ctx->mtx);
+#endif
+		size_t i = ctx->next < ctx->n ? ctx->next++ : ctx->n;
+#if !LELY_NO_THREADS
+		if (ctx->locked)
+			mtx_unlock(&ctx->mtx);
+#endif
+		if (i >= ctx->n)
+			break;
+		struct co_dcf_file *file = &ctx->files[i];
+
+#if !LELY_NO_DIAG && !LELY_NO_STDIO
+		diag_set_thrd_handler(&co_dcf_file_diag_handler, file);
+		diag_at_set_thrd_handler(&co_dcf_file_diag_at_handler, file);
+#endif
+		file->dev = co_dev_create_from_dcf_file(file->filename);
+		if (!file->dev)
+			file->errc = get_errc();
+	}
+
+#if !LELY_NO_DIAG && !LELY_NO_STDIO
+	diag_at_set_thrd_handler(at_handler, at_handle);
+	diag_set_thrd_handler(handler, handle);
+#endif
+
+	return 0;
+}
+
+#if !LELY_NO_DIAG && !LELY_NO_STDIO
+
+static void
+co_dcf_file_diag_handler(void *handle, enum diag_severity severity, int errc,
+		const char *format, va_list ap)
+{
+	co_dcf_file_diag_at_handler(handle, severity, errc, NULL, format, ap);
+}
+
+static void
+co_dcf_file_diag_at_handler(void *handle, enum diag_severity severity,
+		int errc, const struct floc *at, const char *format, va_list ap)
+{
+	struct co_dcf_file *file = handle;
+	assert(file);
+
+	int errsv = get_errc();
+	char *s = NULL;
+	int n = vasprintf_diag_at(&s, severity, errc, at, format, ap);
+	if (n >= 0) {
+		size_t len = file->diag ? strlen(file->diag) : 0;
+		char *diag = realloc(file->diag, len + n + 2);
+		if (diag) {
+			memcpy(diag + len, s, n);
+			diag[len + n] = '\n';
+			diag[len + n + 1] = '\0';
+			file->diag = diag;
+		}
+	}
+	free(s);
+	set_errc(errsv);
+}
+
+#endif // !LELY_NO_DIAG && !LELY_NO_STDIO
+
+static void
+co_dcf_init(struct co_dcf *dcf)
+{
+	assert(dcf);
+
+	membuf_init(&dcf->ents, NULL, 0);
+	membuf_init(&dcf->vals, NULL, 0);
+	dcf->errc = 0;
+}
+
+static void
+co_dcf_fini(struct co_dcf *dcf)
+{
+	assert(dcf);
+
+	membuf_fini(&dcf->vals);
+	membuf_fini(&dcf->ents);
+}
+
+static int
+co_dcf_sort(struct co_dcf *dcf)
+{
+	assert(dcf);
+
+	if (dcf->errc) {
+		set_errc(dcf->errc);
+		return -1;
+	}
+
+	size_t n = membuf_size(&dcf->ents) / sizeof(struct co_dcf_ent);
+	if (n > 1)
+		qsort(membuf_begin(&dcf->ents), n, sizeof(struct co_dcf_ent),
+				&co_dcf_ent_cmp);
+
+	return 0;
+}
+
+static void
+co_dcf_scan_func(const char *section, const char *key, const char *value,
+		void *data)
+{
+	assert(section);
+	struct co_dcf *dcf = data;
+	assert(dcf);
+
+	if (dcf->errc || !key || !value)
+		return;
+
+	uint_least32_t sec = co_dcf_parse_sec(section);
+	if (!sec)
+		return;
+	uint_least32_t k = co_dcf_parse_key(key);
+	if (!k)
+		return;
+
+	size_t n = strlen(value) + 1;
+	if (!membuf_reserve(&dcf->vals, n)
+			|| !membuf_reserve(&dcf->ents,
+					sizeof(struct co_dcf_ent))) {
+		dcf->errc = get_errc();
+		return;
+	}
+
+	struct co_dcf_ent ent = {
+		.sec = sec, .key = k, .val = membuf_size(&dcf->vals)
+	};
+	membuf_write(&dcf->vals, value, n);
+	membuf_write(&dcf->ents, &ent, sizeof(ent));
+}
+
+static int
+co_dcf_ent_cmp(const void *p1, const void *p2)
+{
+	const struct co_dcf_ent *e1 = p1;
+	const struct co_dcf_ent *e2 = p2;
+
+	if (e1->sec != e2->sec)
+		return e1->sec < e2->sec ? -1 : 1;
+	if (e1->key != e2->key)
+		return e1->key < e2->key ? -1 : 1;
+	// Preserve the order of duplicate keys, so the last one can be found.
+	return (e2->val < e1->val) - (e1->val < e2->val);
+}
+
+static uint_least32_t
+co_dcf_parse_sec(const char *section)
+{
+	assert(section);
+
+	static const struct {
+		const char *name;
+		enum co_dcf_sec_kind kind;
+	} tbl[] = { { "DeviceInfo", CO_DCF_SEC_DEVICE_INFO },
+		{ "DummyUsage", CO_DCF_SEC_DUMMY_USAGE },
+		{ "MandatoryObjects", CO_DCF_SEC_MANDATORY_OBJECTS },
+		{ "OptionalObjects", CO_DCF_SEC_OPTIONAL_OBJECTS },
+		{ "ManufacturerObjects", CO_DCF_SEC_MANUFACTURER_OBJECTS },
+		{ "DeviceComissioning", CO_DCF_SEC_DEVICE_COMISSIONING } };
+	for (size_t i = 0; i < sizeof(tbl) / sizeof(*tbl); i++) {
+		if (!strcasecmp(section, tbl[i].name))
+			return CO_DCF_SEC(tbl[i].kind, 0, 0);
+	}
+
+	const char *cp = section;
+
+	uint_least32_t idx = 0;
+	size_t chars = co_dcf_lex_hex(cp, 4, &idx);
+	if (!chars)
+		return CO_DCF_SEC_NONE;
+	cp += chars;
+
+	if (!*cp)
+		return CO_DCF_SEC(CO_DCF_SEC_OBJ, idx, 0);
+
+	if (!strncasecmp(cp, "sub", 3)) {
+		cp += 3;
+		uint_least32_t subidx = 0;
+		chars = co_dcf_lex_hex(cp, 2, &subidx);
+		if (!chars || cp[chars])
+			return CO_DCF_SEC_NONE;
+		return CO_DCF_SEC(CO_DCF_SEC_SUB, idx, subidx);
+	}
+
+	if (!strcasecmp(cp, "Name"))
+		return CO_DCF_SEC(CO_DCF_SEC_NAME, idx, 0);
+
+	if (!strcasecmp(cp, "Value"))
+		return CO_DCF_SEC(CO_DCF_SEC_VALUE, idx, 0);
+
+	return CO_DCF_SEC_NONE;
+}
+
+static uint_least32_t
+co_dcf_parse_key(const char *key)
+{
+	assert(key);
+
+	if (isdigit((unsigned char)*key)) {
+		// Only accept decimal numbers without leading zeros, since those
+		// are the keys looked up by the parser.
+		if (*key == '0' && key[1])
+			return CO_DCF_KEY_NONE;
+		uint_least32_t n = 0;
+		for (; isdigit((unsigned char)*key); key++) {
+			n = n * 10 + (*key - '0');
+			if (n > 0xffff)
+				return CO_DCF_KEY_NONE;
+		}
+		return *key ? CO_DCF_KEY_NONE : CO_DCF_KEY_NUM(n);
+	}
+
+	if (!strncasecmp(key, "Dummy", 5)) {
+		uint_least32_t n = 0;
+		for (int i = 5; i < 9; i++) {
+			if (!isxdigit((unsigned char)key[i]))
+				return CO_DCF_KEY_NONE;
+			n = (n << 4) | ctox(key[i]);
+		}
+		return key[9] ? CO_DCF_KEY_NONE : CO_DCF_KEY_DUMMY(n);
+	}
+
+	size_t lo = 0;
+	size_t hi = sizeof(co_dcf_keys) / sizeof(*co_dcf_keys);
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = strcasecmp(key, co_dcf_keys[mid]);
+		if (!cmp)
+			return (uint_least32_t)(mid + 1);
+		if (cmp < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return CO_DCF_KEY_NONE;
+}
+
+static size_t
+co_dcf_lex_hex(const char *s, size_t n, uint_least32_t *pval)
+{
+	assert(s);
+	assert(pval);
+
+	size_t chars = 0;
+	while (isxdigit((unsigned char)s[chars]))
+		chars++;
+	// Only accept hexadecimal numbers without leading zeros, since those
+	// are the section names looked up by the parser.
+	if (!chars || chars > n || (*s == '0' && chars > 1))
+		return 0;
+
+	uint_least32_t val = 0;
+	for (size_t i = 0; i < chars; i++)
+		val = (val << 4) | ctox(s[i]);
+	*pval = val;
+
+	return chars;
+}
+
+static const struct co_dcf_ent *
+co_dcf_lower_bound(const struct co_dcf *dcf, uint_least32_t sec)
+{
+	assert(dcf);
+
+	const struct co_dcf_ent *begin = membuf_begin(&dcf->ents);
+	size_t n = membuf_size(&dcf->ents) / sizeof(struct co_dcf_ent);
+	while (n) {
+		size_t half = n / 2;
+		if (begin[half].sec < sec) {
+			begin += half + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	return begin;
+}
+
+static void
+co_dcf_get_sec(const struct co_dcf *dcf, uint_least32_t sec,
+		struct co_dcf_sec *psec)
+{
+	assert(dcf);
+	assert(psec);
+
+	psec->begin = co_dcf_lower_bound(dcf, sec);
+	psec->end = co_dcf_lower_bound(dcf, sec + 1);
+	psec->vals = membuf_begin(&dcf->vals);
+}
+
+static const struct co_dcf_ent *
+co_dcf_next_sec(const struct co_dcf *dcf, const struct co_dcf_ent *ent,
+		const struct co_dcf_ent *end, struct co_dcf_sec *psec)
+{
+	assert(dcf);
+	assert(ent);
+	assert(end);
+	assert(psec);
+
+	psec->begin = ent;
+	while (ent < end && ent->sec == psec->begin->sec)
+		ent++;
+	psec->end = ent;
+	psec->vals = membuf_begin(&dcf->vals);
+
+	return ent;
+}
+
+static const char *
+co_dcf_sec_get(const struct co_dcf_sec *sec, uint_least32_t key)
+{
+	assert(sec);
+
+	// Find the last entry with the specified key.
+	const struct co_dcf_ent *begin = sec->begin;
+	size_t n = sec->end - sec->begin;
+	while (n) {
+		size_t half = n / 2;
+		if (begin[half].key <= key) {
+			begin += half + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	if (begin == sec->begin || begin[-1].key != key)
+		return NULL;
+	return sec->vals + begin[-1].val;
+}
+
+static struct __co_dev *
+co_dev_init_from_dcf_file(
+		struct __co_dev *dev, const char *filename, size_t arena_size)
+{
+	struct co_dcf dcf;
+	co_dcf_init(&dcf);
+
+	if (!config_scan_ini_file(filename, &co_dcf_scan_func, &dcf))
+		goto error_scan_ini_file;
+
+	if (co_dcf_sort(&dcf) == -1) {
+		diag(DIAG_ERROR, dcf.errc, "%s: unable to index file",
+				filename);
+		goto error_sort;
+	}
+
+	if (!__co_dev_init_from_dcf_cfg(dev, &dcf, arena_size))
+		goto error_init_dev;
+
+	co_dcf_fini(&dcf);
+
+	return dev;
+
+error_init_dev:
+error_sort:
+error_scan_ini_file:
+	co_dcf_fini(&dcf);
+	return NULL;
+}
+
 static struct __co_dev *
-__co_dev_init_from_dcf_cfg(struct __co_dev *dev, const config_t *cfg)
+__co_dev_init_from_dcf_cfg(struct __co_dev *dev, const struct co_dcf *dcf,
+		size_t arena_size)
 {
 	assert(dev);
-	assert(cfg);
+	assert(dcf);
 
 	if (!__co_dev_init(dev, 0xff)) {
 		diag(DIAG_ERROR, get_errc(),
 				"unable to initialize device description");
 		goto error_init_dev;
 	}
+	// The arena has to be enabled before the first object is created.
+	co_dev_set_arena_size(dev, arena_size);
 
-	if (co_dev_parse_cfg(dev, cfg) == -1)
+	if (co_dev_parse_cfg(dev, dcf) == -1)
 		goto error_parse_cfg;
 
 	return dev;
@@ -198,89 +838,91 @@ error_init_dev:
 }
 
 static int
-co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
+co_dev_parse_cfg(co_dev_t *dev, const struct co_dcf *dcf)
 {
 	assert(dev);
-	assert(cfg);
+	assert(dcf);
 
 	const char *val;
 
+	struct co_dcf_sec info;
+	co_dcf_get_sec(dcf, CO_DCF_SEC(CO_DCF_SEC_DEVICE_INFO, 0, 0), &info);
+
 	// clang-format off
 	if (co_dev_set_vendor_name(dev,
-			config_get(cfg, "DeviceInfo", "VendorName")) == -1) {
+			co_dcf_sec_get(&info, CO_DCF_KEY_VENDOR_NAME)) == -1) {
 		// clang-format on
 		diag(DIAG_ERROR, get_errc(), "unable to set vendor name");
 		goto error_parse_dev;
 	}
 
-	val = config_get(cfg, "DeviceInfo", "VendorNumber");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_VENDOR_NUMBER);
 	if (val && *val)
 		co_dev_set_vendor_id(dev, strtoul(val, NULL, 0));
 
 	// clang-format off
 	if (co_dev_set_product_name(dev,
-			config_get(cfg, "DeviceInfo", "ProductName")) == -1) {
+			co_dcf_sec_get(&info, CO_DCF_KEY_PRODUCT_NAME)) == -1) {
 		// clang-format on
 		diag(DIAG_ERROR, get_errc(), "unable to set product name");
 		goto error_parse_dev;
 	}
 
-	val = config_get(cfg, "DeviceInfo", "ProductNumber");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_PRODUCT_NUMBER);
 	if (val && *val)
 		co_dev_set_product_code(dev, strtoul(val, NULL, 0));
 
-	val = config_get(cfg, "DeviceInfo", "RevisionNumber");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_REVISION_NUMBER);
 	if (val && *val)
 		co_dev_set_revision(dev, strtoul(val, NULL, 0));
 
 	// clang-format off
 	if (co_dev_set_order_code(dev,
-			config_get(cfg, "DeviceInfo", "OrderCode")) == -1) {
+			co_dcf_sec_get(&info, CO_DCF_KEY_ORDER_CODE)) == -1) {
 		diag(DIAG_ERROR, get_errc(), "unable to set order code");
 		goto error_parse_dev;
 		// clang-format on
 	}
 
 	unsigned int baud = 0;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_10");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_10);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_10;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_20");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_20);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_20;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_50");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_50);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_50;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_125");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_125);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_125;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_250");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_250);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_250;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_500");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_500);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_500;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_800");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_800);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_800;
-	val = config_get(cfg, "DeviceInfo", "BaudRate_1000");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_BAUD_RATE_1000);
 	if (val && *val && strtoul(val, NULL, 0))
 		baud |= CO_BAUD_1000;
 	co_dev_set_baud(dev, baud);
 
-	val = config_get(cfg, "DeviceInfo", "LSS_Supported");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_LSS_SUPPORTED);
 	if (val && *val)
 		co_dev_set_lss(dev, strtoul(val, NULL, 0));
 
 	// For each of the basic data types, check whether it is supported for
 	// mapping dummy entries in PDOs.
+	struct co_dcf_sec dummy_sec;
+	co_dcf_get_sec(dcf, CO_DCF_SEC(CO_DCF_SEC_DUMMY_USAGE, 0, 0),
+			&dummy_sec);
 	co_unsigned32_t dummy = 0;
 	for (int i = 0; i < 0x20; i++) {
-		// Create the key name.
-		char key[10];
-		snprintf(key, sizeof(key), "Dummy%04X", (co_unsigned16_t)i);
-
-		val = config_get(cfg, "DummyUsage", key);
+		val = co_dcf_sec_get(&dummy_sec, CO_DCF_KEY_DUMMY(i));
 		if (val && *val && strtoul(val, NULL, 0))
 			dummy |= 1u << i;
 	}
@@ -288,9 +930,12 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 
 	// Count the total number of objects.
 	co_unsigned16_t n = 0;
-	n += config_get_idx(cfg, "MandatoryObjects", 0, NULL);
-	n += config_get_idx(cfg, "OptionalObjects", 0, NULL);
-	n += config_get_idx(cfg, "ManufacturerObjects", 0, NULL);
+	n += co_dcf_get_idx(dcf,
+			CO_DCF_SEC(CO_DCF_SEC_MANDATORY_OBJECTS, 0, 0), 0, NULL);
+	n += co_dcf_get_idx(dcf,
+			CO_DCF_SEC(CO_DCF_SEC_OPTIONAL_OBJECTS, 0, 0), 0, NULL);
+	n += co_dcf_get_idx(dcf,
+			CO_DCF_SEC(CO_DCF_SEC_MANUFACTURER_OBJECTS, 0, 0), 0, NULL);
 
 	// Parse the object indices.
 	co_unsigned16_t *idx = malloc(n * sizeof(co_unsigned16_t));
@@ -304,9 +949,13 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 		goto error_parse_idx;
 	}
 	co_unsigned16_t i = 0;
-	i += config_get_idx(cfg, "MandatoryObjects", n - i, idx + i);
-	i += config_get_idx(cfg, "OptionalObjects", n - i, idx + i);
-	config_get_idx(cfg, "ManufacturerObjects", n - i, idx + i);
+	i += co_dcf_get_idx(dcf,
+			CO_DCF_SEC(CO_DCF_SEC_MANDATORY_OBJECTS, 0, 0), n - i,
+			idx + i);
+	i += co_dcf_get_idx(dcf, CO_DCF_SEC(CO_DCF_SEC_OPTIONAL_OBJECTS, 0, 0),
+			n - i, idx + i);
+	co_dcf_get_idx(dcf, CO_DCF_SEC(CO_DCF_SEC_MANUFACTURER_OBJECTS, 0, 0),
+			n - i, idx + i);
 
 	for (i = 0; i < n; i++) {
 		if (!idx[i]) {
@@ -325,7 +974,9 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 			goto error_parse_obj;
 
 		// Parse the configuration section for the object.
-		if (co_obj_parse_cfg(obj, cfg, section) == -1)
+		struct co_dcf_sec sec;
+		co_dcf_get_sec(dcf, CO_DCF_SEC(CO_DCF_SEC_OBJ, idx[i], 0), &sec);
+		if (co_obj_parse_cfg(obj, dcf, &sec, section) == -1)
 			goto error_parse_obj;
 	}
 
@@ -338,11 +989,11 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 
 	// Parse compact PDO definitions after the explicit object definitions
 	// to prevent overwriting PDOs.
-	val = config_get(cfg, "DeviceInfo", "CompactPDO");
+	val = co_dcf_sec_get(&info, CO_DCF_KEY_COMPACT_PDO);
 	unsigned int mask = val && *val ? strtoul(val, NULL, 0) : 0;
 	if (mask) {
 		co_unsigned16_t nrpdo = 0;
-		val = config_get(cfg, "DeviceInfo", "NrOfRxPDO");
+		val = co_dcf_sec_get(&info, CO_DCF_KEY_NR_OF_RX_PDO);
 		if (val && *val)
 			nrpdo = (co_unsigned16_t)strtoul(val, NULL, 0);
 		// Count the number of implicit RPDOs.
@@ -364,7 +1015,7 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 		}
 
 		co_unsigned16_t ntpdo = 0;
-		val = config_get(cfg, "DeviceInfo", "NrOfTxPDO");
+		val = co_dcf_sec_get(&info, CO_DCF_KEY_NR_OF_TX_PDO);
 		if (val && *val)
 			ntpdo = (co_unsigned16_t)strtoul(val, NULL, 0);
 		// Count the number of implicit TPDOs.
@@ -386,7 +1037,11 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 		}
 	}
 
-	val = config_get(cfg, "DeviceComissioning", "NodeID");
+	struct co_dcf_sec dcf_sec;
+	co_dcf_get_sec(dcf, CO_DCF_SEC(CO_DCF_SEC_DEVICE_COMISSIONING, 0, 0),
+			&dcf_sec);
+
+	val = co_dcf_sec_get(&dcf_sec, CO_DCF_KEY_NODE_ID);
 	// clang-format off
 	if (val && *val && co_dev_set_id(dev,
 			(co_unsigned8_t)strtoul(val, NULL, 0)) == -1) {
@@ -396,7 +1051,7 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 		goto error_parse_dcf;
 	}
 
-	val = config_get(cfg, "DeviceComissioning", "NetNumber");
+	val = co_dcf_sec_get(&dcf_sec, CO_DCF_KEY_NET_NUMBER);
 	// clang-format off
 	if (val && *val && co_dev_set_netid(dev,
 			(co_unsigned32_t)strtoul(val, NULL, 0)) == -1) {
@@ -408,18 +1063,18 @@ co_dev_parse_cfg(co_dev_t *dev, const config_t *cfg)
 
 	// clang-format off
 	if (co_dev_set_name(dev,
-			config_get(cfg, "DeviceComissioning", "NodeName"))
+			co_dcf_sec_get(&dcf_sec, CO_DCF_KEY_NODE_NAME))
 			== -1) {
 		// clang-format on
 		diag(DIAG_ERROR, get_errc(), "unable to set node name");
 		goto error_parse_dcf;
 	}
 
-	val = config_get(cfg, "DeviceComissioning", "Baudrate");
+	val = co_dcf_sec_get(&dcf_sec, CO_DCF_KEY_BAUDRATE);
 	if (val && *val)
 		co_dev_set_rate(dev, (co_unsigned16_t)strtoul(val, NULL, 0));
 
-	val = config_get(cfg, "DeviceComissioning", "LSS_SerialNumber");
+	val = co_dcf_sec_get(&dcf_sec, CO_DCF_KEY_LSS_SERIAL_NUMBER);
 	// clang-format off
 	if (val && *val && !co_dev_set_val_u32(dev, 0x1018, 0x04,
 			strtoul(val, NULL, 0))) {
@@ -442,17 +1097,19 @@ error_parse_dev:
 }
 
 static int
-co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
+co_obj_parse_cfg(co_obj_t *obj, const struct co_dcf *dcf,
+		const struct co_dcf_sec *sec, const char *section)
 {
 	assert(obj);
-	assert(cfg);
+	assert(dcf);
+	assert(sec);
 
 	const char *val;
 	struct floc at = { section, 0, 0 };
 
 	co_unsigned16_t idx = co_obj_get_idx(obj);
 
-	const char *name = config_get(cfg, section, "ParameterName");
+	const char *name = co_dcf_sec_get(sec, CO_DCF_KEY_PARAMETER_NAME);
 	if (!name) {
 		diag(DIAG_ERROR, 0,
 				"ParameterName not specified for object 0x%04X",
@@ -460,7 +1117,7 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 		return -1;
 	}
 #if !LELY_NO_CO_OBJ_NAME
-	val = config_get(cfg, section, "Denotation");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_DENOTATION);
 	if (val && *val)
 		name = val;
 	if (co_obj_set_name(obj, name) == -1) {
@@ -471,7 +1128,7 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 #endif
 
 	co_unsigned8_t code = co_obj_get_code(obj);
-	val = config_get(cfg, section, "ObjectType");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_OBJECT_TYPE);
 	if (val && *val) {
 		code = (co_unsigned8_t)strtoul(val, NULL, 0);
 		if (co_obj_set_code(obj, code) == -1) {
@@ -485,11 +1142,11 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 	if (code == CO_OBJECT_DEFSTRUCT || code == CO_OBJECT_ARRAY
 			|| code == CO_OBJECT_RECORD) {
 		co_unsigned8_t subnum = 0;
-		val = config_get(cfg, section, "SubNumber");
+		val = co_dcf_sec_get(sec, CO_DCF_KEY_SUB_NUMBER);
 		if (val && *val)
 			subnum = (co_unsigned8_t)strtoul(val, NULL, 0);
 		co_unsigned8_t subobj = 0;
-		val = config_get(cfg, section, "CompactSubObj");
+		val = co_dcf_sec_get(sec, CO_DCF_KEY_COMPACT_SUB_OBJ);
 		if (val && *val)
 			subobj = (co_unsigned8_t)strtoul(val, NULL, 0);
 		if (!subnum && !subobj) {
@@ -505,30 +1162,39 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 			return -1;
 		}
 
-		// Parse the sub-objects specified by SubNumber.
-		for (size_t subidx = 0; subnum && subidx < 0xff; subidx++) {
-			// Create section name for the sub-object.
-			char section[10];
-			snprintf(section, sizeof(section), "%Xsub%X",
-					(co_unsigned16_t)idx,
-					(co_unsigned8_t)subidx);
+		// Parse the sub-objects specified by SubNumber. Since the
+		// sections are sorted, the sub-object sections of this object
+		// are adjacent and can be visited in order of their sub-index.
+		const struct co_dcf_ent *ent = co_dcf_lower_bound(
+				dcf, CO_DCF_SEC(CO_DCF_SEC_SUB, idx, 0));
+		const struct co_dcf_ent *end = co_dcf_lower_bound(
+				dcf, CO_DCF_SEC(CO_DCF_SEC_SUB, idx, 0xff));
+		while (subnum && ent < end) {
+			struct co_dcf_sec subsec;
+			ent = co_dcf_next_sec(dcf, ent, end, &subsec);
+			co_unsigned8_t subidx = subsec.begin->sec & 0xff;
 
 			// Check whether the sub-index exists by checking the
 			// presence of the mandatory ParameterName keyword.
-			const char *name = config_get(
-					cfg, section, "ParameterName");
+			const char *name = co_dcf_sec_get(
+					&subsec, CO_DCF_KEY_PARAMETER_NAME);
 			if (!name)
 				continue;
 			subnum--;
 
+			// Create section name for the sub-object.
+			char section[10];
+			snprintf(section, sizeof(section), "%Xsub%X",
+					(co_unsigned16_t)idx, subidx);
+
 			// The Denonation entry, if it exists, overrides
 			// ParameterName.
-			val = config_get(cfg, section, "Denotation");
+			val = co_dcf_sec_get(&subsec, CO_DCF_KEY_DENOTATION);
 			if (val && *val)
 				name = val;
 
 			// Obtain the data type of the sub-object.
-			val = config_get(cfg, section, "DataType");
+			val = co_dcf_sec_get(&subsec, CO_DCF_KEY_DATA_TYPE);
 			if (!val || !*val) {
 				diag_at(DIAG_ERROR, 0, &at,
 						"DataType not specified");
@@ -538,13 +1204,12 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 					(co_unsigned16_t)strtoul(val, NULL, 0);
 
 			// Create and insert the sub-object.
-			co_sub_t *sub = co_sub_build(obj,
-					(co_unsigned8_t)subidx, type, name);
+			co_sub_t *sub = co_sub_build(obj, subidx, type, name);
 			if (!sub)
 				return -1;
 
 			// Parse the configuration section for the sub-object.
-			if (co_sub_parse_cfg(sub, cfg, section) == -1)
+			if (co_sub_parse_cfg(sub, &subsec, section) == -1)
 				return -1;
 		}
 
@@ -561,10 +1226,10 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 #endif
 			co_sub_set_access(sub, CO_ACCESS_RO);
 
-			name = config_get(cfg, section, "ParameterName");
+			name = co_dcf_sec_get(sec, CO_DCF_KEY_PARAMETER_NAME);
 
 			// Obtain the data type of the sub-object.
-			val = config_get(cfg, section, "DataType");
+			val = co_dcf_sec_get(sec, CO_DCF_KEY_DATA_TYPE);
 			if (!val || !*val) {
 				diag_at(DIAG_ERROR, 0, &at,
 						"DataType not specified");
@@ -592,18 +1257,18 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 
 				// Parse the configuration section for the
 				// sub-object.
-				if (co_sub_parse_cfg(sub, cfg, section) == -1)
+				if (co_sub_parse_cfg(sub, sec, section) == -1)
 					return -1;
 			}
 
 #if !LELY_NO_CO_OBJ_NAME
 			// Parse the names of the sub-objects.
-			if (co_obj_parse_names(obj, cfg) == -1)
+			if (co_obj_parse_names(obj, dcf) == -1)
 				return -1;
 #endif
 
 			// Parse the values of the sub-objects.
-			if (co_obj_parse_values(obj, cfg) == -1)
+			if (co_obj_parse_values(obj, dcf) == -1)
 				return -1;
 		}
 
@@ -618,7 +1283,7 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 		co_unsigned16_t type = code == CO_OBJECT_DOMAIN
 				? CO_DEFTYPE_DOMAIN
 				: 0;
-		val = config_get(cfg, section, "DataType");
+		val = co_dcf_sec_get(sec, CO_DCF_KEY_DATA_TYPE);
 		if (val && *val)
 			type = (co_unsigned16_t)strtoul(val, NULL, 0);
 		if (!type) {
@@ -632,7 +1297,7 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 			return -1;
 
 		// Parse the configuration section for the sub-object.
-		if (co_sub_parse_cfg(sub, cfg, section) == -1)
+		if (co_sub_parse_cfg(sub, sec, section) == -1)
 			return -1;
 	}
 
@@ -641,27 +1306,24 @@ co_obj_parse_cfg(co_obj_t *obj, const config_t *cfg, const char *section)
 
 #if !LELY_NO_CO_OBJ_NAME
 static int
-co_obj_parse_names(co_obj_t *obj, const config_t *cfg)
+co_obj_parse_names(co_obj_t *obj, const struct co_dcf *dcf)
 {
 	assert(obj);
-	assert(cfg);
+	assert(dcf);
 
 	co_unsigned16_t idx = co_obj_get_idx(obj);
 
-	// Create the section name for the explicit names of the sub-objects.
-	char section[9];
-	snprintf(section, sizeof(section), "%XName", idx);
+	// Obtain the section with the explicit names of the sub-objects.
+	struct co_dcf_sec sec;
+	co_dcf_get_sec(dcf, CO_DCF_SEC(CO_DCF_SEC_NAME, idx, 0), &sec);
 
-	const char *val = config_get(cfg, section, "NrOfEntries");
+	const char *val = co_dcf_sec_get(&sec, CO_DCF_KEY_NR_OF_ENTRIES);
 	if (!val || !*val)
 		return 0;
 
 	co_unsigned8_t n = (co_unsigned8_t)strtoul(val, NULL, 0);
 	for (size_t subidx = 1; n && subidx < 0xff; subidx++) {
-		char key[4];
-		snprintf(key, sizeof(key), "%u", (co_unsigned8_t)subidx);
-
-		val = config_get(cfg, section, key);
+		val = co_dcf_sec_get(&sec, CO_DCF_KEY_NUM(subidx));
 		if (val && *val) {
 			n--;
 			co_sub_t *sub = co_obj_find_sub(
@@ -681,10 +1343,10 @@ co_obj_parse_names(co_obj_t *obj, const config_t *cfg)
 #endif // LELY_NO_CO_OBJ_NAME
 
 static int
-co_obj_parse_values(co_obj_t *obj, const config_t *cfg)
+co_obj_parse_values(co_obj_t *obj, const struct co_dcf *dcf)
 {
 	assert(obj);
-	assert(cfg);
+	assert(dcf);
 
 	co_unsigned8_t id = co_dev_get_id(co_obj_get_dev(obj));
 	co_unsigned16_t idx = co_obj_get_idx(obj);
@@ -694,16 +1356,16 @@ co_obj_parse_values(co_obj_t *obj, const config_t *cfg)
 	snprintf(section, sizeof(section), "%XValue", (co_unsigned16_t)idx);
 	struct floc at = { section, 0, 0 };
 
-	const char *val = config_get(cfg, section, "NrOfEntries");
+	struct co_dcf_sec sec;
+	co_dcf_get_sec(dcf, CO_DCF_SEC(CO_DCF_SEC_VALUE, idx, 0), &sec);
+
+	const char *val = co_dcf_sec_get(&sec, CO_DCF_KEY_NR_OF_ENTRIES);
 	if (!val || !*val)
 		return 0;
 
 	co_unsigned8_t n = (co_unsigned8_t)strtoul(val, NULL, 0);
 	for (size_t subidx = 1; n && subidx < 0xff; subidx++) {
-		char key[4];
-		snprintf(key, sizeof(key), "%u", (co_unsigned8_t)subidx);
-
-		val = config_get(cfg, section, key);
+		val = co_dcf_sec_get(&sec, CO_DCF_KEY_NUM(subidx));
 		if (val && *val) {
 			n--;
 			co_sub_t *sub = co_obj_find_sub(
@@ -735,7 +1397,7 @@ co_obj_build(co_dev_t *dev, co_unsigned16_t idx)
 {
 	assert(dev);
 
-	co_obj_t *obj = co_obj_create(idx);
+	co_obj_t *obj = co_obj_create_in(dev, idx);
 	if (!obj) {
 		diag(DIAG_ERROR, get_errc(), "unable to create object 0x%04X",
 				idx);
@@ -754,10 +1416,11 @@ co_obj_build(co_dev_t *dev, co_unsigned16_t idx)
 }
 
 static int
-co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
+co_sub_parse_cfg(co_sub_t *sub, const struct co_dcf_sec *sec,
+		const char *section)
 {
 	assert(sub);
-	assert(cfg);
+	assert(sec);
 
 	int result = -1;
 
@@ -773,7 +1436,7 @@ co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
 #endif
 
 #if !LELY_NO_CO_OBJ_LIMITS
-	val = config_get(cfg, section, "LowLimit");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_LOW_LIMIT);
 	if (val && *val) {
 		size_t chars = co_val_lex_id(val, NULL, &at);
 		if (chars) {
@@ -789,7 +1452,7 @@ co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
 			co_val_set_id(type, &sub->min, id);
 	}
 
-	val = config_get(cfg, section, "HighLimit");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_HIGH_LIMIT);
 	if (val && *val) {
 		size_t chars = co_val_lex_id(val, NULL, &at);
 		if (chars) {
@@ -807,7 +1470,7 @@ co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
 #endif // LELY_NO_CO_OBJ_LIMITS
 
 	unsigned int access = co_sub_get_access(sub);
-	val = config_get(cfg, section, "AccessType");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_ACCESS_TYPE);
 	if (val && *val) {
 		if (!strcasecmp(val, "ro")) {
 			access = CO_ACCESS_RO;
@@ -831,7 +1494,7 @@ co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
 		goto error;
 	}
 
-	val = config_get(cfg, section, "DefaultValue");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_DEFAULT_VALUE);
 	if (val && *val) {
 		size_t chars = co_val_lex_id(val, NULL, &at);
 		if (chars) {
@@ -855,15 +1518,15 @@ co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
 #endif
 	}
 
-	val = config_get(cfg, section, "PDOMapping");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_PDO_MAPPING);
 	if (val && *val)
 		co_sub_set_pdo_mapping(sub, strtoul(val, NULL, 0));
 
-	val = config_get(cfg, section, "ObjFlags");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_OBJ_FLAGS);
 	if (val && *val)
 		sub->flags |= strtoul(val, NULL, 0);
 
-	val = config_get(cfg, section, "ParameterValue");
+	val = co_dcf_sec_get(sec, CO_DCF_KEY_PARAMETER_VALUE);
 	if (val && *val) {
 		sub->flags |= CO_OBJ_FLAGS_PARAMETER_VALUE;
 		size_t chars = co_val_lex_id(val, NULL, &at);
@@ -880,7 +1543,7 @@ co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
 			co_val_set_id(type, sub->val, id);
 #if !LELY_NO_CO_OBJ_FILE
 	} else if (type == CO_DEFTYPE_DOMAIN
-			&& (val = config_get(cfg, section, "UploadFile"))
+			&& (val = co_dcf_sec_get(sec, CO_DCF_KEY_UPLOAD_FILE))
 					!= NULL) {
 		if (!(access & CO_ACCESS_READ) || (access & CO_ACCESS_WRITE)) {
 			diag_at(DIAG_WARNING, 0, &at,
@@ -899,7 +1562,7 @@ co_sub_parse_cfg(co_sub_t *sub, const config_t *cfg, const char *section)
 			goto error;
 		}
 	} else if (type == CO_DEFTYPE_DOMAIN
-			&& (val = config_get(cfg, section, "DownloadFile"))
+			&& (val = co_dcf_sec_get(sec, CO_DCF_KEY_DOWNLOAD_FILE))
 					!= NULL) {
 		if ((access & CO_ACCESS_READ) || !(access & CO_ACCESS_WRITE)) {
 			diag_at(DIAG_WARNING, 0, &at,
@@ -970,7 +1633,7 @@ co_sub_build(co_obj_t *obj, co_unsigned8_t subidx, co_unsigned16_t type,
 
 	co_unsigned16_t idx = co_obj_get_idx(obj);
 
-	co_sub_t *sub = co_sub_create(subidx, type);
+	co_sub_t *sub = co_sub_create_in(co_obj_get_dev(obj), subidx, type);
 	if (!sub) {
 		diag(DIAG_ERROR, get_errc(),
 				"unable to create sub-object %Xsub%X", idx,
@@ -1385,24 +2048,24 @@ co_val_set_id(co_unsigned16_t type, void *val, co_unsigned8_t id)
 }
 
 static co_unsigned16_t
-config_get_idx(const config_t *cfg, const char *section, co_unsigned16_t maxidx,
-		co_unsigned16_t *idx)
+co_dcf_get_idx(const struct co_dcf *dcf, uint_least32_t sec,
+		co_unsigned16_t maxidx, co_unsigned16_t *idx)
 {
-	assert(cfg);
+	assert(dcf);
 
 	if (!idx)
 		maxidx = 0;
 
-	const char *val = config_get(cfg, section, "SupportedObjects");
+	struct co_dcf_sec s;
+	co_dcf_get_sec(dcf, sec, &s);
+
+	const char *val = co_dcf_sec_get(&s, CO_DCF_KEY_SUPPORTED_OBJECTS);
 	if (!val || !*val)
 		return 0;
 
 	co_unsigned16_t n = (co_unsigned16_t)strtoul(val, NULL, 0);
 	for (size_t i = 0; i < (size_t)MIN(n, maxidx); i++) {
-		char key[6];
-		snprintf(key, sizeof(key), "%u", (co_unsigned16_t)(i + 1));
-
-		val = config_get(cfg, section, key);
+		val = co_dcf_sec_get(&s, CO_DCF_KEY_NUM(i + 1));
 		// clang-format off
 		idx[i] = val && *val
 				? (co_unsigned16_t)strtoul(val, NULL, 0) : 0;
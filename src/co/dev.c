@@ -22,19 +22,52 @@
  */
 
 #include "co.h"
+#include "obj.h"
 #include <lely/co/detail/dev.h>
 #include <lely/co/detail/obj.h>
 #include <lely/util/cmp.h>
 #include <lely/util/diag.h>
+#if !LELY_NO_MALLOC && !LELY_NO_STDIO
+#include <lely/util/frbuf.h>
+#endif
+#if !LELY_NO_MALLOC
+#include <lely/util/membuf.h>
+#endif
 #if !LELY_NO_CO_TPDO
 #include <lely/co/pdo.h>
 #endif
 
 #include <assert.h>
 #if !LELY_NO_MALLOC
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #endif
 
+#if !LELY_NO_MALLOC
+
+/// A block of memory in the arena of a CANopen device.
+struct co_dev_arena {
+	/// A pointer to the previously allocated block.
+	struct co_dev_arena *next;
+	/// The size (in bytes) of the memory region at #data.
+	size_t size;
+	/// The number of bytes allocated from the memory region at #data.
+	size_t used;
+	/// The memory region, aligned for any type.
+	union {
+		long double ld;
+		long long ll;
+		void *ptr;
+		void (*fn)(void);
+	} data[];
+};
+
+/// Releases all memory blocks of the arena of a CANopen device.
+static void co_dev_arena_fini(co_dev_t *dev);
+
+#endif // !LELY_NO_MALLOC
+
 static void co_obj_set_id(
 		co_obj_t *obj, co_unsigned8_t new_id, co_unsigned8_t old_id);
 static void co_sub_set_id(
@@ -42,6 +75,60 @@ static void co_sub_set_id(
 static void co_val_set_id(co_unsigned16_t type, void *val,
 		co_unsigned8_t new_id, co_unsigned8_t old_id);
 
+/**
+ * Writes the value of a sub-object to a memory buffer, in the concise DCF
+ * format. This is equivalent to co_dev_write_sub(), but does not require a
+ * lookup.
+ */
+static size_t co_sub_write_dcf(
+		const co_sub_t *sub, uint_least8_t *begin, uint_least8_t *end);
+
+#if !LELY_NO_MALLOC
+
+/// An entry in a concise DCF cache, describing the location of a sub-object.
+struct co_dcf_cache_ent {
+	/// A pointer to the sub-object.
+	const co_sub_t *sub;
+	/// The offset (in bytes) of the sub-object in the concise DCF.
+	size_t offset;
+	/// The size (in bytes) of the sub-object in the concise DCF.
+	size_t size;
+};
+
+/// A concise DCF cache.
+struct co_dcf_cache {
+	/// A pointer to the CANopen device.
+	const co_dev_t *dev;
+	/// The minimum object index.
+	co_unsigned16_t min;
+	/// The maximum object index.
+	co_unsigned16_t max;
+	/// A pointer to the array of sub-object entries.
+	struct co_dcf_cache_ent *ents;
+	/// The number of entries at #ents.
+	size_t nents;
+	/// The memory buffer containing the concise DCF.
+	struct membuf buf;
+	/// A flag indicating whether #buf contains a valid concise DCF.
+	int built;
+	/// The modification counter of the device at the last update.
+	co_unsigned32_t gen;
+	/// The layout counter of the device at the last update.
+	co_unsigned32_t layout;
+};
+
+/// Rebuilds a concise DCF cache from scratch.
+static int co_dcf_cache_build(co_dcf_cache_t *cache);
+
+/**
+ * Updates a concise DCF cache by re-serializing only the sub-objects that
+ * changed since the last update. The layout of the object dictionary MUST NOT
+ * have changed.
+ */
+static int co_dcf_cache_update(co_dcf_cache_t *cache);
+
+#endif // !LELY_NO_MALLOC
+
 #if !LELY_NO_MALLOC
 
 void *
@@ -77,6 +164,20 @@ __co_dev_init(struct __co_dev *dev, co_unsigned8_t id)
 	dev->id = id;
 
 	rbtree_init(&dev->tree, &uint16_cmp);
+#if !LELY_NO_MALLOC
+	dev->objs = NULL;
+	dev->keys = NULL;
+	dev->nobjs = 0;
+	dev->subs = NULL;
+	dev->nsubs = 0;
+	dev->arena = NULL;
+	dev->arena_size = 0;
+	dev->gen = 0;
+	dev->layout = 0;
+#if !LELY_NO_STDIO
+	dev->image = NULL;
+#endif
+#endif
 
 #if !LELY_NO_CO_OBJ_NAME
 	dev->name = NULL;
@@ -119,9 +220,20 @@ __co_dev_fini(struct __co_dev *dev)
 #if LELY_NO_MALLOC
 	(void)dev;
 #else
+	co_dev_thaw(dev);
+
 	rbtree_foreach (&dev->tree, node)
 		co_obj_destroy(structof(node, co_obj_t, node));
 
+	// Release the objects allocated from the arena in one go, after they
+	// have all been finalized.
+	co_dev_arena_fini(dev);
+
+#if !LELY_NO_STDIO
+	// The names of the objects may reference the image.
+	frbuf_destroy(dev->image);
+#endif
+
 #if !LELY_NO_CO_OBJ_NAME
 	free(dev->vendor_name);
 	free(dev->product_name);
@@ -215,6 +327,9 @@ co_dev_set_id(co_dev_t *dev, co_unsigned8_t id)
 		co_obj_set_id(structof(node, co_obj_t, node), id, dev->id);
 
 	dev->id = id;
+#if !LELY_NO_MALLOC
+	co_dev_touch(dev, NULL);
+#endif
 
 	return 0;
 }
@@ -253,6 +368,11 @@ co_dev_insert_obj(co_dev_t *dev, co_obj_t *obj)
 	if (rbtree_find(&dev->tree, obj->node.key))
 		return -1;
 
+#if !LELY_NO_MALLOC
+	co_dev_thaw(dev);
+	co_dev_touch(dev, NULL);
+#endif
+
 	obj->dev = dev;
 	rbtree_insert(&obj->dev->tree, &obj->node);
 
@@ -268,6 +388,11 @@ co_dev_remove_obj(co_dev_t *dev, co_obj_t *obj)
 	if (obj->dev != dev)
 		return -1;
 
+#if !LELY_NO_MALLOC
+	co_dev_thaw(dev);
+	co_dev_touch(dev, NULL);
+#endif
+
 	rbtree_remove(&obj->dev->tree, &obj->node);
 	rbnode_init(&obj->node, &obj->idx);
 	obj->dev = NULL;
@@ -280,6 +405,23 @@ co_dev_find_obj(const co_dev_t *dev, co_unsigned16_t idx)
 {
 	assert(dev);
 
+#if !LELY_NO_MALLOC
+	if (dev->objs) {
+		size_t lo = 0;
+		size_t hi = dev->nobjs;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (dev->keys[mid] == idx)
+				return dev->objs[mid];
+			else if (dev->keys[mid] < idx)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return NULL;
+	}
+#endif
+
 	struct rbnode *node = rbtree_find(&dev->tree, &idx);
 	if (!node)
 		return NULL;
@@ -311,6 +453,232 @@ co_dev_last_obj(const co_dev_t *dev)
 	return node ? structof(node, co_obj_t, node) : NULL;
 }
 
+#if !LELY_NO_MALLOC
+
+int
+co_dev_freeze(co_dev_t *dev)
+{
+	assert(dev);
+
+	int errc = 0;
+
+	co_dev_thaw(dev);
+
+	size_t nobjs = rbtree_size(&dev->tree);
+	size_t nsubs = 0;
+	rbtree_foreach (&dev->tree, node)
+		nsubs += rbtree_size(&structof(node, co_obj_t, node)->tree);
+
+	// Allocate at least one element, so a frozen object dictionary can be
+	// recognized by a non-NULL pointer.
+	co_obj_t **objs = malloc(MAX(nobjs, 1) * sizeof(*objs));
+	if (!objs) {
+#if !LELY_NO_ERRNO
+		errc = errno2c(errno);
+#endif
+		goto error_alloc_objs;
+	}
+
+	co_unsigned16_t *keys = malloc(MAX(nobjs, 1) * sizeof(*keys));
+	if (!keys) {
+#if !LELY_NO_ERRNO
+		errc = errno2c(errno);
+#endif
+		goto error_alloc_keys;
+	}
+
+	co_sub_t **subs = malloc(MAX(nsubs, 1) * sizeof(*subs));
+	if (!subs) {
+#if !LELY_NO_ERRNO
+		errc = errno2c(errno);
+#endif
+		goto error_alloc_subs;
+	}
+
+	// The trees are traversed in order, so the arrays are sorted by
+	// (sub-)index. The sub-objects of each object form a contiguous slice
+	// of the device array.
+	size_t i = 0;
+	size_t j = 0;
+	rbtree_foreach (&dev->tree, node) {
+		co_obj_t *obj = structof(node, co_obj_t, node);
+		keys[i] = obj->idx;
+		objs[i++] = obj;
+		obj->subs = subs + j;
+		obj->nsubs = 0;
+		rbtree_foreach (&obj->tree, subnode) {
+			subs[j++] = structof(subnode, co_sub_t, node);
+			obj->nsubs++;
+		}
+	}
+	assert(i == nobjs);
+	assert(j == nsubs);
+
+	dev->objs = objs;
+	dev->keys = keys;
+	dev->nobjs = nobjs;
+	dev->subs = subs;
+	dev->nsubs = nsubs;
+
+	return 0;
+
+	// free(subs);
+error_alloc_subs:
+	free(keys);
+error_alloc_keys:
+	free(objs);
+error_alloc_objs:
+	set_errc(errc);
+	return -1;
+}
+
+void
+co_dev_thaw(co_dev_t *dev)
+{
+	assert(dev);
+
+	if (!dev->objs)
+		return;
+
+	for (size_t i = 0; i < dev->nobjs; i++) {
+		dev->objs[i]->subs = NULL;
+		dev->objs[i]->nsubs = 0;
+	}
+
+	free(dev->subs);
+	dev->subs = NULL;
+	dev->nsubs = 0;
+
+	free(dev->keys);
+	dev->keys = NULL;
+
+	free(dev->objs);
+	dev->objs = NULL;
+	dev->nobjs = 0;
+}
+
+int
+co_dev_is_frozen(const co_dev_t *dev)
+{
+	assert(dev);
+
+	return dev->objs != NULL;
+}
+
+size_t
+co_dev_get_arena_size(const co_dev_t *dev)
+{
+	assert(dev);
+
+	return dev->arena_size;
+}
+
+void
+co_dev_set_arena_size(co_dev_t *dev, size_t size)
+{
+	assert(dev);
+
+	dev->arena_size = size;
+}
+
+#if !LELY_NO_STDIO
+void
+co_dev_set_image(co_dev_t *dev, struct __frbuf *image)
+{
+	assert(dev);
+
+	frbuf_destroy(dev->image);
+	dev->image = image;
+}
+#endif
+
+int
+co_dev_in_arena(const co_dev_t *dev, const void *ptr)
+{
+	assert(dev);
+
+	// Compare addresses as integers, since the blocks are separate objects.
+	uintptr_t addr = (uintptr_t)ptr;
+	for (const struct co_dev_arena *block = dev->arena; block;
+			block = block->next) {
+		uintptr_t begin = (uintptr_t)block->data;
+		if (addr >= begin && addr < begin + block->used)
+			return 1;
+	}
+	return 0;
+}
+
+void *
+co_dev_arena_alloc(co_dev_t *dev, size_t size)
+{
+	if (!dev || !dev->arena_size)
+		return NULL;
+
+	// Round up the size to preserve the alignment of the next allocation.
+	const size_t align = sizeof(dev->arena->data[0]);
+	size = (size + align - 1) / align * align;
+
+	struct co_dev_arena *arena = dev->arena;
+	if (!arena || arena->size - arena->used < size) {
+		// Allocations larger than the block size get a block of their
+		// own, which is inserted behind the current one, so the free
+		// space in that block is not lost.
+		size_t n = MAX(size, dev->arena_size);
+		struct co_dev_arena *block = malloc(sizeof(*block) + n);
+		if (!block)
+			return NULL;
+		block->size = n;
+		block->used = 0;
+		if (arena && size > dev->arena_size) {
+			block->next = arena->next;
+			arena->next = block;
+		} else {
+			block->next = arena;
+			dev->arena = block;
+		}
+		arena = block;
+	}
+
+	void *ptr = (char *)arena->data + arena->used;
+	arena->used += size;
+	return ptr;
+}
+
+void
+co_dev_touch(co_dev_t *dev, co_sub_t *sub)
+{
+	assert(dev);
+
+	if (!++dev->gen) {
+		// On wrap-around, reset the modification counters of all
+		// sub-objects and treat it as a change in the structure, so
+		// the caches are rebuilt.
+		rbtree_foreach (&dev->tree, node) {
+			co_obj_t *obj = structof(node, co_obj_t, node);
+			for (sub = co_obj_first_sub(obj); sub;
+					sub = co_sub_next(sub))
+				sub->gen = 0;
+		}
+		dev->gen = 1;
+		sub = NULL;
+	}
+
+	if (sub)
+		sub->gen = dev->gen;
+	else
+		dev->layout++;
+}
+
+co_unsigned32_t
+co_dev_get_layout(const co_dev_t *dev)
+{
+	assert(dev);
+
+	return dev->layout;
+}
+
+#endif // !LELY_NO_MALLOC
+
 #if !LELY_NO_CO_OBJ_NAME
 
 const char *
@@ -674,6 +1042,16 @@ co_dev_write_sub(const co_dev_t *dev, co_unsigned16_t idx,
 	co_sub_t *sub = co_dev_find_sub(dev, idx, subidx);
 	if (!sub)
 		return 0;
+	return co_sub_write_dcf(sub, begin, end);
+}
+
+static size_t
+co_sub_write_dcf(const co_sub_t *sub, uint_least8_t *begin, uint_least8_t *end)
+{
+	assert(sub);
+
+	co_unsigned16_t idx = co_obj_get_idx(co_sub_get_obj(sub));
+	co_unsigned8_t subidx = co_sub_get_subidx(sub);
 	co_unsigned16_t type = co_sub_get_type(sub);
 	const void *val = co_sub_get_val(sub);
 
@@ -785,8 +1163,7 @@ co_dev_write_dcf(const co_dev_t *dev, co_unsigned16_t min, co_unsigned16_t max,
 			break;
 		for (co_sub_t *sub = co_obj_first_sub(obj); sub;
 				sub = co_sub_next(sub)) {
-			co_unsigned8_t subidx = co_sub_get_subidx(sub);
-			size += co_dev_write_sub(dev, idx, subidx, NULL, NULL);
+			size += co_sub_write_dcf(sub, NULL, NULL);
 			n++;
 		}
 	}
@@ -811,8 +1188,7 @@ co_dev_write_dcf(const co_dev_t *dev, co_unsigned16_t min, co_unsigned16_t max,
 			break;
 		for (co_sub_t *sub = co_obj_first_sub(obj); sub;
 				sub = co_sub_next(sub)) {
-			co_unsigned8_t subidx = co_sub_get_subidx(sub);
-			begin += co_dev_write_sub(dev, idx, subidx, begin, end);
+			begin += co_sub_write_dcf(sub, begin, end);
 		}
 	}
 
@@ -839,6 +1215,69 @@ co_dev_write_dcf_file(const co_dev_t *dev, co_unsigned16_t min,
 }
 #endif
 
+#if !LELY_NO_MALLOC
+
+co_dcf_cache_t *
+co_dcf_cache_create(
+		const co_dev_t *dev, co_unsigned16_t min, co_unsigned16_t max)
+{
+	assert(dev);
+
+	co_dcf_cache_t *cache = malloc(sizeof(*cache));
+	if (!cache) {
+#if !LELY_NO_ERRNO
+		set_errc(errno2c(errno));
+#endif
+		return NULL;
+	}
+
+	cache->dev = dev;
+	cache->min = min;
+	cache->max = max;
+
+	cache->ents = NULL;
+	cache->nents = 0;
+	membuf_init(&cache->buf, NULL, 0);
+
+	cache->built = 0;
+	cache->gen = 0;
+	cache->layout = 0;
+
+	return cache;
+}
+
+void
+co_dcf_cache_destroy(co_dcf_cache_t *cache)
+{
+	if (cache) {
+		membuf_fini(&cache->buf);
+		free(cache->ents);
+		free(cache);
+	}
+}
+
+const void *
+co_dcf_cache_get(co_dcf_cache_t *cache, size_t *psize)
+{
+	assert(cache);
+	const co_dev_t *dev = cache->dev;
+	assert(dev);
+
+	if (!cache->built || cache->layout != dev->layout) {
+		if (co_dcf_cache_build(cache) == -1)
+			return NULL;
+	} else if (cache->gen != dev->gen) {
+		if (co_dcf_cache_update(cache) == -1)
+			return NULL;
+	}
+
+	if (psize)
+		*psize = membuf_size(&cache->buf);
+	return membuf_begin(&cache->buf);
+}
+
+#endif // !LELY_NO_MALLOC
+
 #if !LELY_NO_CO_TPDO
 
 void
@@ -1032,3 +1471,149 @@ co_val_set_id(co_unsigned16_t type, void *val, co_unsigned8_t new_id,
 #undef LELY_CO_DEFINE_TYPE
 	}
 }
+
+#if !LELY_NO_MALLOC
+static void
+co_dev_arena_fini(co_dev_t *dev)
+{
+	assert(dev);
+
+	while (dev->arena) {
+		struct co_dev_arena *block = dev->arena;
+		dev->arena = block->next;
+		free(block);
+	}
+}
+#endif
+
+#if !LELY_NO_MALLOC
+
+static int
+co_dcf_cache_build(co_dcf_cache_t *cache)
+{
+	assert(cache);
+	const co_dev_t *dev = cache->dev;
+	assert(dev);
+
+	cache->built = 0;
+
+	size_t size = 4;
+	co_unsigned32_t n = 0;
+
+	// Count the number of matching sub-objects and compute the total size
+	// (in bytes).
+	for (co_obj_t *obj = co_dev_first_obj(dev); obj;
+			obj = co_obj_next(obj)) {
+		co_unsigned16_t idx = co_obj_get_idx(obj);
+		if (idx < cache->min)
+			continue;
+		if (idx > cache->max)
+			break;
+		for (co_sub_t *sub = co_obj_first_sub(obj); sub;
+				sub = co_sub_next(sub)) {
+			size += co_sub_write_dcf(sub, NULL, NULL);
+			n++;
+		}
+	}
+
+	if (n > cache->nents) {
+		struct co_dcf_cache_ent *ents =
+				realloc(cache->ents, n * sizeof(*ents));
+		if (!ents) {
+#if !LELY_NO_ERRNO
+			set_errc(errno2c(errno));
+#endif
+			return -1;
+		}
+		cache->ents = ents;
+	}
+	cache->nents = n;
+
+	membuf_clear(&cache->buf);
+	if (membuf_reserve(&cache->buf, size) < size)
+		return -1;
+
+	uint_least8_t *begin = membuf_begin(&cache->buf);
+	uint_least8_t *end = begin + size;
+	uint_least8_t *cp = begin;
+
+	// Write the total number of sub-indices.
+	cp += co_val_write(CO_DEFTYPE_UNSIGNED32, &n, cp, end);
+
+	// Write the sub-objects and record their location.
+	struct co_dcf_cache_ent *ent = cache->ents;
+	for (co_obj_t *obj = co_dev_first_obj(dev); obj;
+			obj = co_obj_next(obj)) {
+		co_unsigned16_t idx = co_obj_get_idx(obj);
+		if (idx < cache->min)
+			continue;
+		if (idx > cache->max)
+			break;
+		for (co_sub_t *sub = co_obj_first_sub(obj); sub;
+				sub = co_sub_next(sub), ent++) {
+			ent->sub = sub;
+			ent->offset = cp - begin;
+			ent->size = co_sub_write_dcf(sub, cp, end);
+			cp += ent->size;
+		}
+	}
+	assert((size_t)(cp - begin) == size);
+	membuf_seek(&cache->buf, size);
+
+	cache->built = 1;
+	cache->gen = dev->gen;
+	cache->layout = dev->layout;
+
+	return 0;
+}
+
+static int
+co_dcf_cache_update(co_dcf_cache_t *cache)
+{
+	assert(cache);
+	const co_dev_t *dev = cache->dev;
+	assert(dev);
+	assert(cache->built);
+	assert(cache->layout == dev->layout);
+
+	// The number of bytes by which the current entry has moved because of
+	// changes in the size of the preceding entries.
+	ptrdiff_t shift = 0;
+	for (size_t i = 0; i < cache->nents; i++) {
+		struct co_dcf_cache_ent *ent = &cache->ents[i];
+		ent->offset += shift;
+		if (ent->sub->gen <= cache->gen)
+			continue;
+
+		size_t size = co_sub_write_dcf(ent->sub, NULL, NULL);
+		if (size != ent->size) {
+			// Move the remainder of the concise DCF to make room
+			// for the new value.
+			if (size > ent->size
+					&& membuf_reserve(&cache->buf,
+							   size - ent->size)
+							< size - ent->size) {
+				cache->built = 0;
+				return -1;
+			}
+			uint_least8_t *begin = membuf_begin(&cache->buf);
+			size_t end = ent->offset + ent->size;
+			memmove(begin + ent->offset + size, begin + end,
+					membuf_size(&cache->buf) - end);
+			ptrdiff_t diff = (ptrdiff_t)size - (ptrdiff_t)ent->size;
+			membuf_seek(&cache->buf, diff);
+			shift += diff;
+			ent->size = size;
+		}
+
+		uint_least8_t *begin = membuf_begin(&cache->buf);
+		co_sub_write_dcf(ent->sub, begin + ent->offset,
+				begin + ent->offset + ent->size);
+	}
+
+	cache->gen = dev->gen;
+
+	return 0;
+}
+
+#endif // !LELY_NO_MALLOC
@@ -33,13 +33,12 @@
 #include <lely/co/val.h>
 #include <lely/util/diag.h>
 #include <lely/util/endian.h>
+#include <lely/util/spscring.h>
 #include <lely/util/time.h>
 
 #include <assert.h>
 #include <stdlib.h>
-#if LELY_NO_MALLOC
 #include <string.h>
-#endif
 
 #if LELY_NO_MALLOC
 #ifndef CO_EMCY_CAN_BUF_SIZE
@@ -56,8 +55,18 @@
  */
 #define CO_EMCY_MAX_NMSG 8
 #endif
+#ifndef CO_EMCY_MAX_NEVENT
+/**
+ * The default maximum capacity of the EMCY event ring in the absence of dynamic
+ * memory allocation.
+ */
+#define CO_EMCY_MAX_NEVENT 64
+#endif
 #endif // LELY_NO_MALLOC
 
+/// The mask used to receive all pre-defined EMCY COB-IDs with one receiver.
+#define CO_EMCY_CANID_MASK (CAN_MASK_BID & ~CO_NUM_NODES)
+
 /// An EMCY message.
 struct co_emcy_msg {
 	/// The emergency error code.
@@ -70,17 +79,49 @@ struct co_emcy_msg {
 struct co_emcy_node {
 	/// The node-ID.
 	co_unsigned8_t id;
-	/// A pointer to the CAN frame receiver.
+	/**
+	 * A flag specifying whether the node uses the pre-defined EMCY COB-ID
+	 * and is received by the shared CAN frame receiver.
+	 */
+	int shared;
+	/**
+	 * A pointer to the CAN frame receiver for a node with a non-default
+	 * EMCY COB-ID. The receiver is created on first use.
+	 */
 	can_recv_t *recv;
 };
 
 /**
- * The CAN receive callback function for a remote CANopen EMCY producer node.
+ * The CAN receive callback function for all remote CANopen EMCY producer nodes
+ * using the pre-defined EMCY COB-ID.
+ *
+ * @see can_recv_func_t
+ */
+static int co_emcy_recv(const struct can_msg *msg, void *data);
+
+/**
+ * The CAN receive callback function for a remote CANopen EMCY producer node
+ * with a non-default EMCY COB-ID.
  *
  * @see can_recv_func_t
  */
 static int co_emcy_node_recv(const struct can_msg *msg, void *data);
 
+/**
+ * Processes an EMCY message received from a remote node. This function adds
+ * the message to the EMCY event ring, if enabled, and invokes the user-defined
+ * indication function.
+ */
+static void co_emcy_node_on_recv(
+		co_emcy_t *emcy, co_unsigned8_t id, const struct can_msg *msg);
+
+/**
+ * Stops receiving EMCY messages from a remote node.
+ *
+ * @see co_emcy_set_1028()
+ */
+static void co_emcy_node_stop(co_emcy_t *emcy, struct co_emcy_node *node);
+
 /// A CANopen EMCY producer/consumer service.
 struct __co_emcy {
 	/// A pointer to a CAN network interface.
@@ -116,6 +157,25 @@ struct __co_emcy {
 	struct timespec inhibit;
 	/// An array of pointers to remote nodes.
 	struct co_emcy_node nodes[CO_NUM_NODES];
+	/**
+	 * A pointer to the CAN frame receiver for all nodes using the
+	 * pre-defined EMCY COB-ID.
+	 */
+	can_recv_t *recv;
+	/// The number of nodes received by #recv.
+	co_unsigned8_t nshared;
+	/// The ring buffer indices of #events.
+	struct spscring ring;
+	/// The capacity of the EMCY event ring (0 if the ring is disabled).
+	size_t nevent;
+	/// An array of received EMCY events.
+#if LELY_NO_MALLOC
+	struct co_emcy_event events[CO_EMCY_MAX_NEVENT];
+#else
+	struct co_emcy_event *events;
+#endif
+	/// The number of EMCY events dropped because the ring was full.
+	spscring_atomic_t ndropped;
 	/// A pointer to the indication function.
 	co_emcy_ind_t *ind;
 	/// A pointer to user-specified data for #ind.
@@ -157,13 +217,17 @@ static co_unsigned32_t co_1014_dn_ind(
 		co_sub_t *sub, struct co_sdo_req *req, void *data);
 
 /**
- * Sets the value of CANopen object 1028 (Emergency consumer object).
+ * Sets the value of CANopen object 1028 (Emergency consumer object). Nodes
+ * using the pre-defined EMCY COB-ID (0x80 + node-ID) share a single CAN frame
+ * receiver; all other nodes get a receiver of their own.
  *
  * @param emcy  a pointer to an EMCY service.
  * @param id    the node-ID.
  * @param cobid the COB-ID of the EMCY object.
+ *
+ * @returns 0 on success, or -1 on error.
  */
-static void co_emcy_set_1028(
+static int co_emcy_set_1028(
 		co_emcy_t *emcy, co_unsigned8_t id, co_unsigned32_t cobid);
 
 /**
@@ -270,25 +334,26 @@ __co_emcy_init(struct __co_emcy *emcy, can_net_t *net, co_dev_t *dev)
 	for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++) {
 		struct co_emcy_node *node = &emcy->nodes[id - 1];
 		node->id = id;
+		node->shared = 0;
 		node->recv = NULL;
 	}
 
-	co_obj_t *obj_1028 = co_dev_find_obj(emcy->dev, 0x1028);
-	if (obj_1028) {
-		// Initialize the nodes.
-		for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++) {
-			co_sub_t *sub = co_obj_find_sub(obj_1028, id);
-			if (!sub)
-				continue;
-			struct co_emcy_node *node = &emcy->nodes[id - 1];
-			node->recv = can_recv_create();
-			if (!node->recv) {
-				errc = get_errc();
-				goto error_create_recv;
-			}
-			can_recv_set_func(node->recv, &co_emcy_node_recv, node);
-		}
+	emcy->recv = can_recv_create();
+	if (!emcy->recv) {
+		errc = get_errc();
+		goto error_create_recv;
 	}
+	can_recv_set_func(emcy->recv, &co_emcy_recv, emcy);
+	emcy->nshared = 0;
+
+	// The EMCY event ring is disabled until co_emcy_set_ring_size() is
+	// invoked.
+	spscring_init(&emcy->ring, 1);
+	emcy->nevent = 0;
+#if !LELY_NO_MALLOC
+	emcy->events = NULL;
+#endif
+	emcy->ndropped = 0;
 
 	if (co_emcy_start(emcy) == -1) {
 		errc = get_errc();
@@ -299,9 +364,10 @@ __co_emcy_init(struct __co_emcy *emcy, can_net_t *net, co_dev_t *dev)
 
 	// co_emcy_stop(emcy);
 error_start:
-error_create_recv:
 	for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++)
 		can_recv_destroy(emcy->nodes[id - 1].recv);
+	can_recv_destroy(emcy->recv);
+error_create_recv:
 	can_timer_destroy(emcy->timer);
 error_create_timer:
 	can_buf_fini(&emcy->buf);
@@ -317,8 +383,13 @@ __co_emcy_fini(struct __co_emcy *emcy)
 
 	co_emcy_stop(emcy);
 
+#if !LELY_NO_MALLOC
+	free(emcy->events);
+#endif
+
 	for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++)
 		can_recv_destroy(emcy->nodes[id - 1].recv);
+	can_recv_destroy(emcy->recv);
 
 	can_timer_destroy(emcy->timer);
 
@@ -395,9 +466,13 @@ co_emcy_start(co_emcy_t *emcy)
 				CO_NUM_NODES);
 		for (co_unsigned8_t id = 1; id <= maxid; id++) {
 			co_sub_t *sub = co_obj_find_sub(obj_1028, id);
-			if (sub)
-				co_emcy_set_1028(emcy, id,
-						co_sub_get_val_u32(sub));
+			if (!sub)
+				continue;
+			co_unsigned32_t cobid = co_sub_get_val_u32(sub);
+			if (co_emcy_set_1028(emcy, id, cobid) == -1)
+				diag(DIAG_ERROR, get_errc(),
+						"unable to start EMCY consumer for node %d",
+						id);
 		}
 	}
 
@@ -419,11 +494,9 @@ co_emcy_stop(co_emcy_t *emcy)
 	co_obj_t *obj_1028 = co_dev_find_obj(emcy->dev, 0x1028);
 	if (obj_1028) {
 		// Stop all CAN frame receivers.
-		for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++) {
-			co_sub_t *sub = co_obj_find_sub(obj_1028, id);
-			if (sub)
-				can_recv_stop(emcy->nodes[id - 1].recv);
-		}
+		for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++)
+			co_emcy_node_stop(emcy, &emcy->nodes[id - 1]);
+		assert(!emcy->nshared);
 		// Remove the download indication function for the emergency
 		// consumer object.
 		co_obj_set_dn_ind(obj_1028, NULL, NULL);
@@ -602,6 +675,102 @@ co_emcy_set_ind(co_emcy_t *emcy, co_emcy_ind_t *ind, void *data)
 	emcy->data = data;
 }
 
+size_t
+co_emcy_get_ring_size(const co_emcy_t *emcy)
+{
+	assert(emcy);
+
+	return emcy->nevent;
+}
+
+int
+co_emcy_set_ring_size(co_emcy_t *emcy, size_t n)
+{
+	assert(emcy);
+
+	if (n == emcy->nevent)
+		return 0;
+
+#if LELY_NO_MALLOC
+	if (n > CO_EMCY_MAX_NEVENT) {
+		set_errnum(ERRNUM_NOMEM);
+		return -1;
+	}
+#else
+	struct co_emcy_event *events = NULL;
+	if (n) {
+		events = malloc(n * sizeof(*events));
+		if (!events) {
+#if !LELY_NO_ERRNO
+			set_errc(errno2c(errno));
+#endif
+			return -1;
+		}
+	}
+	free(emcy->events);
+	emcy->events = events;
+#endif
+	emcy->nevent = n;
+	spscring_init(&emcy->ring, n ? n : 1);
+
+	return 0;
+}
+
+size_t
+co_emcy_read_ring(co_emcy_t *emcy, struct co_emcy_event *events, size_t n)
+{
+	assert(emcy);
+	assert(events || !n);
+
+	if (!emcy->nevent)
+		return 0;
+
+	size_t nread = 0;
+	while (nread < n) {
+		// Copy the events in at most two contiguous blocks.
+		size_t size = n - nread;
+		size_t i = spscring_c_alloc_no_wrap(&emcy->ring, &size);
+		if (!size)
+			break;
+		memcpy(events + nread, emcy->events + i,
+				size * sizeof(*events));
+		spscring_c_commit(&emcy->ring, size);
+		nread += size;
+	}
+	return nread;
+}
+
+size_t
+co_emcy_get_ring_dropped(const co_emcy_t *emcy)
+{
+	assert(emcy);
+
+#if LELY_NO_ATOMICS
+	return emcy->ndropped;
+#else
+	return atomic_load_explicit((spscring_atomic_t *)&emcy->ndropped,
+			memory_order_relaxed);
+#endif
+}
+
+static int
+co_emcy_recv(const struct can_msg *msg, void *data)
+{
+	assert(msg);
+	co_emcy_t *emcy = data;
+	assert(emcy);
+
+	// Ignore the SYNC message (CAN-ID 0x80) and messages from nodes that
+	// do not use the pre-defined EMCY COB-ID.
+	co_unsigned8_t id = msg->id & CO_NUM_NODES;
+	if (!id || !emcy->nodes[id - 1].shared)
+		return 0;
+
+	co_emcy_node_on_recv(emcy, id, msg);
+
+	return 0;
+}
+
 static int
 co_emcy_node_recv(const struct can_msg *msg, void *data)
 {
@@ -612,14 +781,27 @@ co_emcy_node_recv(const struct can_msg *msg, void *data)
 	co_emcy_t *emcy = structof(node, co_emcy_t, nodes[node->id - 1]);
 	assert(emcy);
 
+	co_emcy_node_on_recv(emcy, node->id, msg);
+
+	return 0;
+}
+
+static void
+co_emcy_node_on_recv(
+		co_emcy_t *emcy, co_unsigned8_t id, const struct can_msg *msg)
+{
+	assert(emcy);
+	assert(id > 0 && id <= CO_NUM_NODES);
+	assert(msg);
+
 	// Ignore remote frames.
 	if (msg->flags & CAN_FLAG_RTR)
-		return 0;
+		return;
 
 #if !LELY_NO_CANFD
 	// Ignore CAN FD format frames.
 	if (msg->flags & CAN_FLAG_EDL)
-		return 0;
+		return;
 #endif
 
 	// Extract the parameters from the frame.
@@ -630,14 +812,34 @@ co_emcy_node_recv(const struct can_msg *msg, void *data)
 	co_unsigned8_t msef[5] = { 0 };
 	if (msg->len >= 4)
 		memcpy(msef, msg->data + 3,
-				MAX((uint_least8_t)(msg->len - 3), 5));
+				MIN((uint_least8_t)(msg->len - 3), 5));
+
+	if (emcy->nevent) {
+		// Add the event to the ring, unless it is full.
+		size_t n = 1;
+		size_t i = spscring_p_alloc(&emcy->ring, &n);
+		if (n) {
+			struct co_emcy_event *event = &emcy->events[i];
+			can_net_get_recv_time(emcy->net, &event->time);
+			event->id = id;
+			event->er = er;
+			event->eec = eec;
+			memcpy(event->msef, msef, 5);
+			spscring_p_commit(&emcy->ring, 1);
+		} else {
+#if LELY_NO_ATOMICS
+			emcy->ndropped++;
+#else
+			atomic_fetch_add_explicit(&emcy->ndropped, 1,
+					memory_order_relaxed);
+#endif
+		}
+	}
 
 	// Notify the user.
 	trace("EMCY: received %04X %02X", eec, er);
 	if (emcy->ind)
-		emcy->ind(emcy, node->id, eec, er, msef, emcy->data);
-
-	return 0;
+		emcy->ind(emcy, id, eec, er, msef, emcy->data);
 }
 
 static int
@@ -737,28 +939,71 @@ co_1014_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
 	return 0;
 }
 
-static void
+static int
 co_emcy_set_1028(co_emcy_t *emcy, co_unsigned8_t id, co_unsigned32_t cobid)
 {
 	assert(emcy);
 	assert(id && id <= CO_NUM_NODES);
 	struct co_emcy_node *node = &emcy->nodes[id - 1];
 
-	if (!(cobid & CO_EMCY_COBID_VALID)) {
-		// Register the receiver under the specified CAN-ID.
-		uint_least32_t id = cobid;
-		uint_least8_t flags = 0;
-		if (id & CO_EMCY_COBID_FRAME) {
-			id &= CAN_MASK_EID;
-			flags |= CAN_FLAG_IDE;
-		} else {
-			id &= CAN_MASK_BID;
-		}
-		can_recv_start(node->recv, emcy->net, id, flags);
+	// Stop the receiver unless the EMCY COB-ID is valid.
+	if (cobid & CO_EMCY_COBID_VALID) {
+		co_emcy_node_stop(emcy, node);
+		return 0;
+	}
+
+	uint_least32_t canid = cobid;
+	uint_least8_t flags = 0;
+	if (canid & CO_EMCY_COBID_FRAME) {
+		canid &= CAN_MASK_EID;
+		flags |= CAN_FLAG_IDE;
 	} else {
-		// Stop the receiver unless the EMCY COB-ID is valid.
-		can_recv_stop(node->recv);
+		canid &= CAN_MASK_BID;
 	}
+
+	if (!flags && canid == (uint_least32_t)CO_EMCY_CANID(id)) {
+		// Nodes using the pre-defined EMCY COB-ID are received by the
+		// shared receiver.
+		if (node->recv)
+			can_recv_stop(node->recv);
+		if (!node->shared) {
+			node->shared = 1;
+			if (!emcy->nshared++)
+				can_recv_start_mask(emcy->recv, emcy->net,
+						CO_EMCY_CANID(0),
+						CO_EMCY_CANID_MASK, 0);
+		}
+		return 0;
+	}
+
+	// Register a dedicated receiver under the specified CAN-ID.
+	if (!node->recv) {
+		node->recv = can_recv_create();
+		if (!node->recv)
+			return -1;
+		can_recv_set_func(node->recv, &co_emcy_node_recv, node);
+	}
+	co_emcy_node_stop(emcy, node);
+	can_recv_start(node->recv, emcy->net, canid, flags);
+
+	return 0;
+}
+
+static void
+co_emcy_node_stop(co_emcy_t *emcy, struct co_emcy_node *node)
+{
+	assert(emcy);
+	assert(node);
+
+	if (node->shared) {
+		node->shared = 0;
+		assert(emcy->nshared);
+		if (!--emcy->nshared)
+			can_recv_stop(emcy->recv);
+	}
+
+	if (node->recv)
+		can_recv_stop(node->recv);
 }
 
 static co_unsigned32_t
@@ -805,7 +1050,8 @@ co_1028_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
 			&& (cobid & (CAN_MASK_EID ^ CAN_MASK_BID)))
 		return CO_SDO_AC_PARAM_VAL;
 
-	co_emcy_set_1028(emcy, id, cobid);
+	if (co_emcy_set_1028(emcy, id, cobid) == -1)
+		return CO_SDO_AC_NO_MEM;
 
 	co_sub_dn(sub, &val);
 
@@ -44,6 +44,9 @@
 #include <lely/co/val.h>
 #if !LELY_NO_CO_NMT_BOOT
 #include "nmt_boot.h"
+#if !LELY_NO_STDIO
+#include <lely/util/frbuf.h>
+#endif
 #endif
 #if !LELY_NO_CO_NMT_CFG
 #include "nmt_cfg.h"
@@ -65,14 +68,6 @@
  */
 #define CO_NMT_CAN_BUF_SIZE 16
 #endif
-#ifndef CO_NMT_MAX_NHB
-/**
- * The default maximum number of heartbeat consumers in the absence of dynamic
- * memory allocation. The default value equals the maximum number of CANopen
- * nodes.
- */
-#define CO_NMT_MAX_NHB CO_NUM_NODES
-#endif
 #endif // LELY_NO_MALLOC
 
 struct __co_nmt_state;
@@ -104,6 +99,11 @@ struct co_nmt_slave {
 	char es;
 	/// A flag specifying whether the 'boot slave' process is in progress.
 	unsigned booting : 1;
+	/**
+	 * A flag specifying whether the 'boot slave' process is waiting for
+	 * other processes to complete (see co_nmt_set_boot_max()).
+	 */
+	unsigned boot_queued : 1;
 #endif
 #if !LELY_NO_CO_NMT_CFG
 	/**
@@ -119,6 +119,23 @@ struct co_nmt_slave {
 	unsigned booted : 1;
 	/// A pointer to the NMT 'boot slave' service.
 	co_nmt_boot_t *boot;
+	/// The size (in bytes) of the program data read by #prog_read.
+	size_t prog_size;
+	/**
+	 * A pointer to the program data read function, or NULL if the program
+	 * data is taken from sub-object 1F58:ID.
+	 */
+	co_nmt_prog_read_t *prog_read;
+	/// A pointer to user-specified data for #prog_read.
+	void *prog_data;
+	/// The priority of a queued 'boot slave' process.
+	co_unsigned8_t boot_prio;
+	/// The SDO timeout (in milliseconds) of a queued 'boot slave' process.
+	int boot_timeout;
+	/// The time at which the 'boot slave' process was requested.
+	struct timespec boot_time;
+	/// The statistics of the last 'boot slave' process.
+	struct co_nmt_boot_stats boot_stats;
 #endif
 #if !LELY_NO_CO_NMT_CFG
 	/// A pointer to the NMT 'update configuration' service.
@@ -205,12 +222,8 @@ struct __co_nmt {
 #endif
 	/// The producer heartbeat time (in milliseconds).
 	co_unsigned16_t ms;
-	/// An array of pointers to the heartbeat consumers.
-#if LELY_NO_MALLOC
-	co_nmt_hb_t *hbs[CO_NMT_MAX_NHB];
-#else
-	co_nmt_hb_t **hbs;
-#endif
+	/// A pointer to the heartbeat consumer table.
+	co_nmt_hb_t *hb;
 	/// The number of heartbeat consumers.
 	co_unsigned8_t nhb;
 	/// A pointer to the heartbeat event indication function.
@@ -258,6 +271,25 @@ struct __co_nmt {
 	co_nmt_boot_ind_t *boot_ind;
 	/// A pointer to user-specified data for #boot_ind.
 	void *boot_data;
+	/**
+	 * The maximum number of concurrent 'boot slave' processes, or 0 if
+	 * there is no limit.
+	 */
+	int boot_max;
+	/// The number of running (not queued) 'boot slave' processes.
+	int boot_num;
+	/**
+	 * A flag specifying whether all 'boot slave' requests are queued, so
+	 * they can be started in order of priority.
+	 */
+	unsigned boot_defer : 1;
+	/**
+	 * The object index of the sub-object on the slaves holding the hash of
+	 * the concise DCF, or 0 if the hash check is disabled.
+	 */
+	co_unsigned16_t cfg_hash_idx;
+	/// The object sub-index corresponding to #cfg_hash_idx.
+	co_unsigned8_t cfg_hash_subidx;
 #endif
 #if !LELY_NO_CO_NMT_CFG
 	/// A pointer to the NMT 'configuration request' indication function.
@@ -699,8 +731,11 @@ static void co_nmt_hb_fini(co_nmt_t *nmt);
 #if !LELY_NO_CO_MASTER
 
 #if !LELY_NO_CO_NMT_BOOT || !LELY_NO_CO_NMT_CFG
-/// Find the heartbeat consumer for the specified node.
-static co_nmt_hb_t *co_nmt_hb_find(
+/**
+ * Finds the heartbeat consumer for the specified node and returns its sub-index
+ * in object 1016, or 0 if the node is not monitored.
+ */
+static co_unsigned8_t co_nmt_hb_find(
 		co_nmt_t *nmt, co_unsigned8_t id, co_unsigned16_t *pms);
 #endif
 
@@ -718,6 +753,19 @@ static void co_nmt_slaves_fini(co_nmt_t *nmt);
  * mandatory slaves, or -1 if an error occurred for a mandatory slave.
  */
 static int co_nmt_slaves_boot(co_nmt_t *nmt);
+
+/**
+ * Creates and starts the NMT 'boot slave' service for the specified node.
+ *
+ * @returns 0 on success, or -1 on error.
+ */
+static int co_nmt_boot_start(co_nmt_t *nmt, co_unsigned8_t id, int timeout);
+
+/**
+ * Starts queued NMT 'boot slave' processes, in order of priority, until the
+ * maximum number of concurrent processes is reached.
+ */
+static void co_nmt_boot_next(co_nmt_t *nmt);
 #endif
 
 /**
@@ -915,11 +963,7 @@ __co_nmt_init(struct __co_nmt *nmt, can_net_t *net, co_dev_t *dev)
 
 	nmt->ms = 0;
 
-#if LELY_NO_MALLOC
-	memset(nmt->hbs, 0, CO_NMT_MAX_NHB * sizeof(*nmt->hbs));
-#else
-	nmt->hbs = NULL;
-#endif
+	nmt->hb = NULL;
 	nmt->nhb = 0;
 	nmt->hb_ind = &default_hb_ind;
 	nmt->hb_data = NULL;
@@ -969,9 +1013,19 @@ __co_nmt_init(struct __co_nmt *nmt, can_net_t *net, co_dev_t *dev)
 		slave->es = 0;
 
 		slave->booting = 0;
+		slave->boot_queued = 0;
 		slave->booted = 0;
 
 		slave->boot = NULL;
+
+		slave->prog_size = 0;
+		slave->prog_read = NULL;
+		slave->prog_data = NULL;
+
+		slave->boot_prio = 0;
+		slave->boot_timeout = 0;
+		slave->boot_time = (struct timespec){ 0, 0 };
+		slave->boot_stats = (struct co_nmt_boot_stats){ .wait = 0 };
 #endif
 
 #if !LELY_NO_CO_NMT_CFG
@@ -1015,6 +1069,11 @@ __co_nmt_init(struct __co_nmt *nmt, can_net_t *net, co_dev_t *dev)
 #if !LELY_NO_CO_NMT_BOOT
 	nmt->boot_ind = NULL;
 	nmt->boot_data = NULL;
+	nmt->boot_max = 0;
+	nmt->boot_num = 0;
+	nmt->boot_defer = 0;
+	nmt->cfg_hash_idx = 0;
+	nmt->cfg_hash_subidx = 0;
 #endif
 #if !LELY_NO_CO_NMT_CFG
 	nmt->cfg_ind = NULL;
@@ -1871,32 +1930,31 @@ co_nmt_boot_req(co_nmt_t *nmt, co_unsigned8_t id, int timeout)
 	trace("NMT: booting slave %d", id);
 
 	// Disable the heartbeat consumer during the 'boot slave' process.
-	co_nmt_hb_t *hb = co_nmt_hb_find(nmt, id, NULL);
-	if (hb)
-		co_nmt_hb_set_1016(hb, id, 0);
+	co_unsigned8_t subidx = co_nmt_hb_find(nmt, id, NULL);
+	if (subidx)
+		co_nmt_hb_set_1016(nmt->hb, subidx, id, 0);
 
 	slave->booting = 1;
-
-	slave->boot = co_nmt_boot_create(nmt->net, nmt->dev, nmt);
-	if (!slave->boot) {
-		errc = get_errc();
-		goto error_create_boot;
+	can_net_get_time(nmt->net, &slave->boot_time);
+
+	// Queue the request if the maximum number of concurrent 'boot slave'
+	// processes has been reached.
+	if (nmt->boot_defer
+			|| (nmt->boot_max && nmt->boot_num >= nmt->boot_max)) {
+		trace("NMT: queued 'boot slave' process for slave %d", id);
+		slave->boot_queued = 1;
+		slave->boot_timeout = timeout;
+		return 0;
 	}
 
-	// clang-format off
-	if (co_nmt_boot_boot_req(slave->boot, id, timeout, &co_nmt_dn_ind,
-			&co_nmt_up_ind, nmt) == -1) {
-		// clang-format on
+	if (co_nmt_boot_start(nmt, id, timeout) == -1) {
 		errc = get_errc();
-		goto error_boot_req;
+		goto error_boot_start;
 	}
 
 	return 0;
 
-error_boot_req:
-	co_nmt_boot_destroy(slave->boot);
-	slave->boot = NULL;
-error_create_boot:
+error_boot_start:
 	slave->booting = 0;
 error_param:
 	set_errc(errc);
@@ -1914,9 +1972,165 @@ co_nmt_is_booting(const co_nmt_t *nmt, co_unsigned8_t id)
 	if (!id || id > CO_NUM_NODES || id == co_dev_get_id(nmt->dev))
 		return 0;
 
-	return !!nmt->slaves[id - 1].boot;
+	return nmt->slaves[id - 1].booting;
+}
+
+int
+co_nmt_get_boot_max(const co_nmt_t *nmt)
+{
+	assert(nmt);
+
+	return nmt->boot_max;
+}
+
+void
+co_nmt_set_boot_max(co_nmt_t *nmt, int max)
+{
+	assert(nmt);
+
+	nmt->boot_max = MAX(max, 0);
+
+	// Start queued processes if the maximum was increased.
+	co_nmt_boot_next(nmt);
+}
+
+co_unsigned8_t
+co_nmt_get_boot_prio(const co_nmt_t *nmt, co_unsigned8_t id)
+{
+	assert(nmt);
+
+	if (!id || id > CO_NUM_NODES)
+		return 0;
+
+	return nmt->slaves[id - 1].boot_prio;
+}
+
+int
+co_nmt_set_boot_prio(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t prio)
+{
+	assert(nmt);
+
+	if (!id || id > CO_NUM_NODES) {
+		set_errnum(ERRNUM_INVAL);
+		return -1;
+	}
+
+	nmt->slaves[id - 1].boot_prio = prio;
+
+	return 0;
+}
+
+int
+co_nmt_get_boot_stats(const co_nmt_t *nmt, co_unsigned8_t id,
+		struct co_nmt_boot_stats *stats)
+{
+	assert(nmt);
+	assert(stats);
+
+	if (!id || id > CO_NUM_NODES) {
+		set_errnum(ERRNUM_INVAL);
+		return -1;
+	}
+
+	*stats = nmt->slaves[id - 1].boot_stats;
+
+	return 0;
+}
+
+void
+co_nmt_get_cfg_hash(const co_nmt_t *nmt, co_unsigned16_t *pidx,
+		co_unsigned8_t *psubidx)
+{
+	assert(nmt);
+
+	if (pidx)
+		*pidx = nmt->cfg_hash_idx;
+	if (psubidx)
+		*psubidx = nmt->cfg_hash_subidx;
+}
+
+void
+co_nmt_set_cfg_hash(co_nmt_t *nmt, co_unsigned16_t idx, co_unsigned8_t subidx)
+{
+	assert(nmt);
+
+	nmt->cfg_hash_idx = idx;
+	nmt->cfg_hash_subidx = idx ? subidx : 0;
+}
+
+co_unsigned32_t
+co_nmt_cfg_hash(const void *ptr, size_t n)
+{
+	assert(ptr || !n);
+
+	// The 32-bit FNV-1a hash.
+	co_unsigned32_t hash = UINT32_C(2166136261);
+	for (const uint_least8_t *bp = ptr; n; n--, bp++) {
+		hash ^= *bp;
+		hash *= UINT32_C(16777619);
+	}
+
+	return hash;
 }
 
+void
+co_nmt_get_prog_src(const co_nmt_t *nmt, co_unsigned8_t id, size_t *psize,
+		co_nmt_prog_read_t **pread, void **pdata)
+{
+	assert(nmt);
+
+	const struct co_nmt_slave *slave = id && id <= CO_NUM_NODES
+			? &nmt->slaves[id - 1]
+			: NULL;
+
+	if (psize)
+		*psize = slave ? slave->prog_size : 0;
+	if (pread)
+		*pread = slave ? slave->prog_read : NULL;
+	if (pdata)
+		*pdata = slave ? slave->prog_data : NULL;
+}
+
+int
+co_nmt_set_prog_src(co_nmt_t *nmt, co_unsigned8_t id, size_t size,
+		co_nmt_prog_read_t *read, void *data)
+{
+	assert(nmt);
+
+	if (!id || id > CO_NUM_NODES || size > CO_UNSIGNED32_MAX) {
+		set_errnum(ERRNUM_INVAL);
+		return -1;
+	}
+	struct co_nmt_slave *slave = &nmt->slaves[id - 1];
+
+	slave->prog_size = read ? size : 0;
+	slave->prog_read = read;
+	slave->prog_data = read ? data : NULL;
+
+	return 0;
+}
+
+#if !LELY_NO_STDIO
+co_unsigned32_t
+co_nmt_prog_frbuf_read(co_nmt_t *nmt, co_unsigned8_t id, size_t offset,
+		void *ptr, size_t n, void *data)
+{
+	(void)nmt;
+	(void)id;
+	frbuf_t *buf = data;
+	assert(buf);
+
+	ssize_t result = frbuf_pread(buf, ptr, n, offset);
+	if (result < 0)
+		return CO_SDO_AC_NO_READ;
+	// The file is shorter than the program data size.
+	if ((size_t)result != n)
+		return CO_SDO_AC_TYPE_LEN_LO;
+
+	return 0;
+}
+#endif
+
 #endif // !LELY_NO_CO_NMT_BOOT
 
 #if !LELY_NO_CO_MASTER
@@ -1980,9 +2194,9 @@ co_nmt_cfg_req(co_nmt_t *nmt, co_unsigned8_t id, int timeout,
 	trace("NMT: starting update configuration process for node %d", id);
 
 	// Disable the heartbeat consumer during a configuration request.
-	co_nmt_hb_t *hb = co_nmt_hb_find(nmt, id, NULL);
-	if (hb)
-		co_nmt_hb_set_1016(hb, id, 0);
+	co_unsigned8_t subidx = co_nmt_hb_find(nmt, id, NULL);
+	if (subidx)
+		co_nmt_hb_set_1016(nmt->hb, subidx, id, 0);
 
 	slave->configuring = 1;
 
@@ -2291,14 +2505,19 @@ co_nmt_boot_con(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t st, char es)
 	slave->es = es;
 	slave->booting = 0;
 	slave->booted = 1;
+	if (slave->boot) {
+		co_nmt_boot_get_stats(slave->boot, &slave->boot_stats);
+		assert(nmt->boot_num > 0);
+		nmt->boot_num--;
+	}
 	co_nmt_boot_destroy(slave->boot);
 	slave->boot = NULL;
 
 	// Re-enable the heartbeat consumer for the node, if necessary.
 	co_unsigned16_t ms = 0;
-	co_nmt_hb_t *hb = co_nmt_hb_find(nmt, id, &ms);
-	if (hb)
-		co_nmt_hb_set_1016(hb, id, ms);
+	co_unsigned8_t subidx = co_nmt_hb_find(nmt, id, &ms);
+	if (subidx)
+		co_nmt_hb_set_1016(nmt->hb, subidx, id, ms);
 
 	// Update object 1F82 (Request NMT) with the NMT state.
 	co_sub_t *sub = co_dev_find_sub(nmt->dev, 0x1f82, id);
@@ -2320,8 +2539,8 @@ co_nmt_boot_con(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t st, char es)
 	// If the error control service was successfully started, resume
 	// heartbeat consumption or node guarding.
 	if (!es || es == 'L') {
-		if (hb) {
-			co_nmt_hb_set_st(hb, st);
+		if (subidx) {
+			co_nmt_hb_set_st(nmt->hb, subidx, st);
 #if !LELY_NO_CO_NG
 			// Disable node guarding.
 			slave->assignment &= 0xff;
@@ -2344,6 +2563,9 @@ co_nmt_boot_con(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t st, char es)
 		nmt->boot_ind(nmt, id, st, es, nmt->boot_data);
 
 	co_nmt_emit_boot(nmt, id, st, es);
+
+	// Start the next queued 'boot slave' process, if any.
+	co_nmt_boot_next(nmt);
 }
 #endif // !LELY_NO_CO_NMT_BOOT
 
@@ -2380,9 +2602,9 @@ co_nmt_cfg_con(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned32_t ac)
 	if (!slave->booting) {
 #endif
 		co_unsigned16_t ms = 0;
-		co_nmt_hb_t *hb = co_nmt_hb_find(nmt, id, &ms);
-		if (hb)
-			co_nmt_hb_set_1016(hb, id, ms);
+		co_unsigned8_t subidx = co_nmt_hb_find(nmt, id, &ms);
+		if (subidx)
+			co_nmt_hb_set_1016(nmt->hb, subidx, id, ms);
 #if !LELY_NO_CO_NMT_BOOT
 	}
 #endif
@@ -2542,7 +2764,7 @@ co_1016_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
 
 	co_sub_dn(sub, &val);
 
-	co_nmt_hb_set_1016(nmt->hbs[subidx - 1], id, ms);
+	co_nmt_hb_set_1016(nmt->hb, subidx, id, ms);
 	return 0;
 }
 
@@ -3704,44 +3926,26 @@ co_nmt_hb_init(co_nmt_t *nmt)
 	assert(nmt);
 
 	// Create and initialize the heartbeat consumers.
-#if LELY_NO_MALLOC
-	memset(nmt->hbs, 0, CO_NMT_MAX_NHB * sizeof(*nmt->hbs));
-#else
-	assert(!nmt->hbs);
-#endif
+	assert(!nmt->hb);
 	assert(!nmt->nhb);
 	co_obj_t *obj_1016 = co_dev_find_obj(nmt->dev, 0x1016);
 	if (obj_1016) {
 		nmt->nhb = co_obj_get_val_u8(obj_1016, 0x00);
-#if LELY_NO_MALLOC
-		if (nmt->nhb > CO_NMT_MAX_NHB) {
-			set_errnum(ERRNUM_NOMEM);
-#else // !LELY_NO_MALLOC
-		nmt->hbs = calloc(nmt->nhb, sizeof(*nmt->hbs));
-		if (!nmt->hbs && nmt->nhb) {
-#if !LELY_NO_ERRNO
-			set_errc(errno2c(errno));
-#endif
-#endif // !LELY_NO_MALLOC
-			diag(DIAG_ERROR, get_errc(),
-					"unable to create heartbeat consumers");
-			nmt->nhb = 0;
+		if (nmt->nhb) {
+			nmt->hb = co_nmt_hb_create(nmt->net, nmt, nmt->nhb);
+			if (!nmt->hb) {
+				diag(DIAG_ERROR, get_errc(),
+						"unable to create heartbeat consumers");
+				nmt->nhb = 0;
+			}
 		}
 	}
 
-	for (co_unsigned8_t i = 0; i < nmt->nhb; i++) {
-		nmt->hbs[i] = co_nmt_hb_create(nmt->net, nmt);
-		if (!nmt->hbs[i]) {
-			diag(DIAG_ERROR, get_errc(),
-					"unable to create heartbeat consumer 0x%02X",
-					(co_unsigned8_t)(i + 1));
-			continue;
-		}
-
-		co_unsigned32_t val = co_obj_get_val_u32(obj_1016, i + 1);
+	for (co_unsigned8_t i = 1; i <= nmt->nhb; i++) {
+		co_unsigned32_t val = co_obj_get_val_u32(obj_1016, i);
 		co_unsigned8_t id = (val >> 16) & 0xff;
 		co_unsigned16_t ms = val & 0xffff;
-		co_nmt_hb_set_1016(nmt->hbs[i], id, ms);
+		co_nmt_hb_set_1016(nmt->hb, i, id, ms);
 	}
 }
 
@@ -3751,19 +3955,15 @@ co_nmt_hb_fini(co_nmt_t *nmt)
 	assert(nmt);
 
 	// Destroy all heartbeat consumers.
-	for (size_t i = 0; i < nmt->nhb; i++)
-		co_nmt_hb_destroy(nmt->hbs[i]);
-#if !LELY_NO_MALLOC
-	free(nmt->hbs);
-	nmt->hbs = NULL;
-#endif
+	co_nmt_hb_destroy(nmt->hb);
+	nmt->hb = NULL;
 	nmt->nhb = 0;
 }
 
 #if !LELY_NO_CO_MASTER
 
 #if !LELY_NO_CO_NMT_BOOT || !LELY_NO_CO_NMT_CFG
-static co_nmt_hb_t *
+static co_unsigned8_t
 co_nmt_hb_find(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned16_t *pms)
 {
 	assert(nmt);
@@ -3771,17 +3971,17 @@ co_nmt_hb_find(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned16_t *pms)
 
 	const co_obj_t *obj_1016 = co_dev_find_obj(nmt->dev, 0x1016);
 	if (!obj_1016)
-		return NULL;
+		return 0;
 
-	for (co_unsigned8_t i = 0; i < nmt->nhb; i++) {
-		co_unsigned32_t val = co_obj_get_val_u32(obj_1016, i + 1);
+	for (co_unsigned8_t i = 1; i <= nmt->nhb; i++) {
+		co_unsigned32_t val = co_obj_get_val_u32(obj_1016, i);
 		if (id == ((val >> 16) & 0xff)) {
 			if (pms)
 				*pms = val & 0xffff;
-			return nmt->hbs[i];
+			return i;
 		}
 	}
-	return NULL;
+	return 0;
 }
 #endif
 
@@ -3828,6 +4028,7 @@ co_nmt_slaves_fini(co_nmt_t *nmt)
 		slave->es = 0;
 
 		slave->booting = 0;
+		slave->boot_queued = 0;
 		slave->booted = 0;
 
 		co_nmt_boot_destroy(slave->boot);
@@ -3851,6 +4052,10 @@ co_nmt_slaves_fini(co_nmt_t *nmt)
 		slave->ng_state = CO_NMT_EC_RESOLVED;
 #endif
 	}
+#if !LELY_NO_CO_NMT_BOOT
+	nmt->boot_num = 0;
+	nmt->boot_defer = 0;
+#endif
 }
 
 #if !LELY_NO_CO_NMT_BOOT
@@ -3860,6 +4065,11 @@ co_nmt_slaves_boot(co_nmt_t *nmt)
 	assert(nmt);
 	assert(nmt->master);
 
+	// Queue all requests, so the processes are started in order of
+	// priority instead of node-ID if the number of concurrent processes is
+	// limited.
+	nmt->boot_defer = !!nmt->boot_max;
+
 	int res = 0;
 	for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++) {
 		struct co_nmt_slave *slave = &nmt->slaves[id - 1];
@@ -3880,8 +4090,113 @@ co_nmt_slaves_boot(co_nmt_t *nmt)
 		if (co_nmt_boot_req(nmt, id, nmt->timeout) == -1 && mandatory)
 			res = -1;
 	}
+
+	nmt->boot_defer = 0;
+	co_nmt_boot_next(nmt);
+
 	return res;
 }
+
+static int
+co_nmt_boot_start(co_nmt_t *nmt, co_unsigned8_t id, int timeout)
+{
+	assert(nmt);
+	assert(nmt->master);
+	assert(id && id <= CO_NUM_NODES);
+	struct co_nmt_slave *slave = &nmt->slaves[id - 1];
+	assert(slave->booting);
+	assert(!slave->boot);
+
+	int errc = 0;
+
+	slave->boot_queued = 0;
+
+	struct timespec now = { 0, 0 };
+	can_net_get_time(nmt->net, &now);
+	slave->boot_stats = (struct co_nmt_boot_stats){
+		.wait = (co_unsigned32_t)MAX(
+				timespec_diff_msec(&now, &slave->boot_time), 0)
+	};
+
+	slave->boot = co_nmt_boot_create(nmt->net, nmt->dev, nmt);
+	if (!slave->boot) {
+		errc = get_errc();
+		goto error_create_boot;
+	}
+
+	// Count the process before starting it, since it may complete (and
+	// invoke co_nmt_boot_con()) before co_nmt_boot_boot_req() returns.
+	nmt->boot_num++;
+	// clang-format off
+	if (co_nmt_boot_boot_req(slave->boot, id, timeout, &co_nmt_dn_ind,
+			&co_nmt_up_ind, nmt) == -1) {
+		// clang-format on
+		errc = get_errc();
+		goto error_boot_req;
+	}
+
+	return 0;
+
+error_boot_req:
+	nmt->boot_num--;
+	co_nmt_boot_destroy(slave->boot);
+	slave->boot = NULL;
+error_create_boot:
+	set_errc(errc);
+	return -1;
+}
+
+static void
+co_nmt_boot_next(co_nmt_t *nmt)
+{
+	assert(nmt);
+
+	if (!nmt->master || nmt->boot_defer)
+		return;
+
+	while (!nmt->boot_max || nmt->boot_num < nmt->boot_max) {
+		// Find the queued slave with the highest priority. Mandatory
+		// slaves (bit 3) go first, then the slaves with the lowest
+		// priority value, then the slaves with the lowest node-ID.
+		struct co_nmt_slave *next = NULL;
+		co_unsigned8_t next_id = 0;
+		for (co_unsigned8_t id = 1; id <= CO_NUM_NODES; id++) {
+			struct co_nmt_slave *slave = &nmt->slaves[id - 1];
+			if (!slave->boot_queued)
+				continue;
+			if (next) {
+				int mandatory = !!(slave->assignment & 0x08);
+				int next_mandatory = !!(next->assignment & 0x08);
+				if (mandatory < next_mandatory)
+					continue;
+				// clang-format off
+				if (mandatory == next_mandatory
+						&& slave->boot_prio
+						>= next->boot_prio)
+					// clang-format on
+					continue;
+			}
+			next = slave;
+			next_id = id;
+		}
+		if (!next)
+			break;
+
+		int errc = get_errc();
+		if (co_nmt_boot_start(nmt, next_id, next->boot_timeout) == -1) {
+			diag(DIAG_ERROR, get_errc(),
+					"unable to start 'boot slave' process for node %02X",
+					next_id);
+			next->boot_queued = 0;
+			// Report the failure as if the slave did not respond,
+			// since the request that queued the process has
+			// already returned. This invokes co_nmt_boot_next()
+			// for the remaining queued slaves.
+			co_nmt_boot_con(nmt, next_id, 0, 'B');
+		}
+		set_errc(errc);
+	}
+}
 #endif
 
 static int
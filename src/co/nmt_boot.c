@@ -30,6 +30,7 @@
 #include <lely/co/obj.h>
 #include <lely/co/val.h>
 #include <lely/util/diag.h>
+#include <lely/util/endian.h>
 #include <lely/util/time.h>
 
 #include <assert.h>
@@ -43,6 +44,15 @@
 #define LELY_CO_NMT_BOOT_WAIT_TIMEOUT 1000
 #endif
 
+#ifndef LELY_CO_NMT_BOOT_PROG_BUFSIZE
+/**
+ * The size (in bytes) of the buffer used to read the program data of a slave
+ * if a program data source is specified with co_nmt_set_prog_src(). The default
+ * allows an entire SDO block (127 segments) to be read at once.
+ */
+#define LELY_CO_NMT_BOOT_PROG_BUFSIZE (127 * 7)
+#endif
+
 #ifndef LELY_CO_NMT_BOOT_SDO_RETRY
 /// The number of times an SDO request is retried after a timeout.
 #define LELY_CO_NMT_BOOT_SDO_RETRY 10 //originally 3
@@ -103,12 +113,40 @@ struct __co_nmt_boot {
 	co_unsigned16_t ms;
 	/// The CANopen SDO upload request used for reading sub-objects.
 	struct co_sdo_req req;
+	/// The size (in bytes) of the program data read by #prog_read.
+	size_t prog_size;
+	/**
+	 * A pointer to the program data read function, or NULL if the program
+	 * data is taken from sub-object 1F58:ID.
+	 */
+	co_nmt_prog_read_t *prog_read;
+	/// A pointer to user-specified data for #prog_read.
+	void *prog_data;
+	/**
+	 * A pointer to the buffer of #LELY_CO_NMT_BOOT_PROG_BUFSIZE bytes used
+	 * to hold the program data read by #prog_read, or NULL if no program
+	 * data is being downloaded from a source.
+	 */
+	char *prog_buf;
 	/// The number of SDO retries remaining.
 	int retry;
 	/// The state of the node (including the toggle bit).
 	co_unsigned8_t st;
 	/// The error status.
 	char es;
+	/// The current phase (one of #CO_NMT_BOOT_PHASE_ID, ...), or -1.
+	int phase;
+	/// The time at which the current phase started.
+	struct timespec phase_start;
+	/// The duration of the phases of the 'boot slave' process.
+	struct co_nmt_boot_stats stats;
+	/**
+	 * The hash of the concise DCF to be stored on the slave after a
+	 * successful configuration update.
+	 */
+	co_unsigned32_t cfg_hash;
+	/// A flag indicating whether #cfg_hash is valid.
+	unsigned cfg_hash_valid : 1;
 };
 
 /**
@@ -144,6 +182,17 @@ static void co_nmt_boot_up_con(co_csdo_t *sdo, co_unsigned16_t idx,
 		co_unsigned8_t subidx, co_unsigned32_t ac, const void *ptr,
 		size_t n, void *data);
 
+/**
+ * The CANopen SDO download read callback function for a 'boot slave' service.
+ * This function reads the program data from the source specified with
+ * co_nmt_set_prog_src().
+ *
+ * @see co_csdo_dn_read_t
+ */
+static co_unsigned32_t co_nmt_boot_prog_read(co_csdo_t *sdo,
+		co_unsigned16_t idx, co_unsigned8_t subidx, size_t offset,
+		void *ptr, size_t n, void *data);
+
 /**
  * The CANopen NMT 'configuration request' confirmation callback function for a
  * 'boot slave' service.
@@ -694,6 +743,31 @@ LELY_CO_DEFINE_STATE(co_nmt_boot_chk_cfg_time_state,
 )
 // clang-format on
 
+/// The entry function of the 'check configuration hash' state.
+static co_nmt_boot_state_t *co_nmt_boot_chk_cfg_hash_on_enter(
+		co_nmt_boot_t *boot);
+
+/**
+ * The 'SDO upload confirmation' transition function of the 'check configuration
+ * hash' state.
+ */
+static co_nmt_boot_state_t *co_nmt_boot_chk_cfg_hash_on_up_con(
+		co_nmt_boot_t *boot, co_unsigned32_t ac, const void *ptr,
+		size_t n);
+
+/**
+ * The 'check configuration hash' state. This state replaces the configuration
+ * date and time check if the expected values are not configured, but the
+ * slave stores the hash of the last concise DCF it received (see
+ * co_nmt_set_cfg_hash()).
+ */
+// clang-format off
+LELY_CO_DEFINE_STATE(co_nmt_boot_chk_cfg_hash_state,
+	.on_enter = &co_nmt_boot_chk_cfg_hash_on_enter,
+	.on_up_con = &co_nmt_boot_chk_cfg_hash_on_up_con
+)
+// clang-format on
+
 /// The entry function of the 'update configuration' state.
 static co_nmt_boot_state_t *co_nmt_boot_up_cfg_on_enter(co_nmt_boot_t *boot);
 
@@ -714,6 +788,28 @@ LELY_CO_DEFINE_STATE(co_nmt_boot_up_cfg_state,
 )
 // clang-format on
 
+/// The entry function of the 'store configuration hash' state.
+static co_nmt_boot_state_t *co_nmt_boot_store_cfg_hash_on_enter(
+		co_nmt_boot_t *boot);
+
+/**
+ * The 'SDO download confirmation' transition function of the 'store
+ * configuration hash' state.
+ */
+static co_nmt_boot_state_t *co_nmt_boot_store_cfg_hash_on_dn_con(
+		co_nmt_boot_t *boot, co_unsigned32_t ac);
+
+/**
+ * The 'store configuration hash' state. In this state the hash of the concise
+ * DCF is written to the slave after a successful configuration update.
+ */
+// clang-format off
+LELY_CO_DEFINE_STATE(co_nmt_boot_store_cfg_hash_state,
+	.on_enter = &co_nmt_boot_store_cfg_hash_on_enter,
+	.on_dn_con = &co_nmt_boot_store_cfg_hash_on_dn_con
+)
+// clang-format on
+
 /// The entry function of the 'start error control' state.
 static co_nmt_boot_state_t *co_nmt_boot_ec_on_enter(co_nmt_boot_t *boot);
 
@@ -792,6 +888,16 @@ static int co_nmt_boot_chk(co_nmt_boot_t *boot, co_unsigned16_t idx,
 static int co_nmt_boot_send_rtr(co_nmt_boot_t *boot);
 #endif
 
+/**
+ * Ends the current phase of the 'boot slave' process, if any, and starts the
+ * next one.
+ *
+ * @param boot  a pointer to a 'boot slave' service.
+ * @param phase the next phase (one of #CO_NMT_BOOT_PHASE_ID, ...), or -1 if
+ *              no new phase is started.
+ */
+static void co_nmt_boot_set_phase(co_nmt_boot_t *boot, int phase);
+
 void *
 __co_nmt_boot_alloc(void)
 {
@@ -854,7 +960,17 @@ __co_nmt_boot_init(struct __co_nmt_boot *boot, can_net_t *net, co_dev_t *dev,
 	boot->st = 0;
 	boot->es = 0;
 
+	boot->phase = -1;
+	boot->phase_start = boot->start;
+	boot->stats = (struct co_nmt_boot_stats){ .wait = 0 };
+	boot->cfg_hash = 0;
+	boot->cfg_hash_valid = 0;
+
 	co_sdo_req_init(&boot->req);
+	boot->prog_size = 0;
+	boot->prog_read = NULL;
+	boot->prog_data = NULL;
+	boot->prog_buf = NULL;
 	boot->retry = 0;
 
 	co_nmt_boot_enter(boot, co_nmt_boot_wait_state);
@@ -876,6 +992,8 @@ __co_nmt_boot_fini(struct __co_nmt_boot *boot)
 	co_sdo_req_fini(&boot->req);
 
 	co_csdo_destroy(boot->sdo);
+	// The buffer may be in use by the Client-SDO until it is destroyed.
+	free(boot->prog_buf);
 
 	can_timer_destroy(boot->timer);
 	can_recv_destroy(boot->recv);
@@ -947,6 +1065,19 @@ co_nmt_boot_boot_req(co_nmt_boot_t *boot, co_unsigned8_t id, int timeout,
 	return 0;
 }
 
+void
+co_nmt_boot_get_stats(
+		const co_nmt_boot_t *boot, struct co_nmt_boot_stats *stats)
+{
+	assert(boot);
+	assert(stats);
+
+	stats->total = boot->stats.total;
+	for (int i = 0; i < CO_NMT_BOOT_NUM_PHASES; i++)
+		stats->phase[i] = boot->stats.phase[i];
+	stats->cfg_skipped = boot->stats.cfg_skipped;
+}
+
 static int
 co_nmt_boot_recv(const struct can_msg *msg, void *data)
 {
@@ -984,6 +1115,22 @@ co_nmt_boot_dn_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 	co_nmt_boot_emit_dn_con(boot, ac);
 }
 
+static co_unsigned32_t
+co_nmt_boot_prog_read(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t offset, void *ptr, size_t n,
+		void *data)
+{
+	(void)sdo;
+	(void)idx;
+	(void)subidx;
+	co_nmt_boot_t *boot = data;
+	assert(boot);
+	assert(boot->prog_read);
+
+	return boot->prog_read(boot->nmt, boot->id, offset, ptr, n,
+			boot->prog_data);
+}
+
 static void
 co_nmt_boot_up_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		co_unsigned32_t ac, const void *ptr, size_t n, void *data)
@@ -1123,6 +1270,9 @@ co_nmt_boot_abort_on_enter(co_nmt_boot_t *boot)
 	can_recv_stop(boot->recv);
 	can_timer_stop(boot->timer);
 
+	free(boot->prog_buf);
+	boot->prog_buf = NULL;
+
 	// If the node is already operational, end the 'boot slave' process with
 	// error status L.
 	if (!boot->es && (boot->st & ~CO_NMT_ST_TOGGLE) == CO_NMT_ST_START)
@@ -1170,6 +1320,12 @@ co_nmt_boot_error_on_leave(co_nmt_boot_t *boot)
 {
 	assert(boot);
 
+	co_nmt_boot_set_phase(boot, -1);
+	struct timespec now = { 0, 0 };
+	can_net_get_time(boot->net, &now);
+	boot->stats.total = (co_unsigned32_t)MAX(
+			timespec_diff_msec(&now, &boot->start), 0);
+
 	co_nmt_boot_con(boot->nmt, boot->id, boot->st, boot->es);
 }
 
@@ -1178,6 +1334,8 @@ co_nmt_boot_chk_device_type_on_enter(co_nmt_boot_t *boot)
 {
 	assert(boot);
 
+	co_nmt_boot_set_phase(boot, CO_NMT_BOOT_PHASE_ID);
+
 	boot->es = 'B';
 
 	// The device type check may follow an NMT 'reset communication'
@@ -1506,6 +1664,8 @@ co_nmt_boot_chk_sw_on_enter(co_nmt_boot_t *boot)
 {
 	assert(boot);
 
+	co_nmt_boot_set_phase(boot, CO_NMT_BOOT_PHASE_SW);
+
 	if (boot->assignment & 0x20) {
 		boot->es = 'G';
 
@@ -1679,6 +1839,29 @@ co_nmt_boot_blk_dn_prog_on_enter(co_nmt_boot_t *boot)
 {
 	assert(boot);
 
+	// If a program data source is specified, the program data is read
+	// incrementally during the download.
+	co_nmt_get_prog_src(boot->nmt, boot->id, &boot->prog_size,
+			&boot->prog_read, &boot->prog_data);
+	if (boot->prog_read) {
+		// Only allocate the program data buffer once a download from a
+		// source actually starts.
+		if (!boot->prog_buf) {
+			boot->prog_buf = malloc(LELY_CO_NMT_BOOT_PROG_BUFSIZE);
+			if (!boot->prog_buf) {
+#if !LELY_NO_STDIO
+				diag(DIAG_ERROR, 0,
+						"unable to allocate program data buffer for node %02X",
+						boot->id);
+#endif
+				return co_nmt_boot_abort_state;
+			}
+		}
+		boot->retry = LELY_CO_NMT_BOOT_SDO_RETRY + 1;
+		return co_nmt_boot_blk_dn_prog_on_dn_con(
+				boot, CO_SDO_AC_TIMEOUT);
+	}
+
 	co_sub_t *sub = co_dev_find_sub(boot->dev, 0x1f58, boot->id);
 	if (!sub)
 		return co_nmt_boot_abort_state;
@@ -1713,13 +1896,20 @@ co_nmt_boot_blk_dn_prog_on_dn_con(co_nmt_boot_t *boot, co_unsigned32_t ac)
 	// Retry the SDO request on timeout (this includes the first attempt).
 	if (ac == CO_SDO_AC_TIMEOUT && boot->retry--) {
 		struct co_sdo_req *req = &boot->req;
-		// Write the program data (sub-object 1F58:ID) to the program
-		// data of the slave (sub-object 1F50:01) using SDO block
-		// transfer.
-		// clang-format off
-		if (co_csdo_blk_dn_req(boot->sdo, 0x1f50, 0x01, req->buf,
-				req->size, &co_nmt_boot_dn_con, boot) == -1)
-			// clang-format on
+		// Write the program data (sub-object 1F58:ID or the program
+		// data source) to the program data of the slave (sub-object
+		// 1F50:01) using SDO block transfer.
+		int result = boot->prog_read
+				? co_csdo_blk_dn_src_req(boot->sdo, 0x1f50,
+						0x01, boot->prog_size,
+						boot->prog_buf,
+						LELY_CO_NMT_BOOT_PROG_BUFSIZE,
+						&co_nmt_boot_prog_read,
+						&co_nmt_boot_dn_con, boot)
+				: co_csdo_blk_dn_req(boot->sdo, 0x1f50, 0x01,
+						req->buf, req->size,
+						&co_nmt_boot_dn_con, boot);
+		if (result == -1)
 			return co_nmt_boot_abort_state;
 		return NULL;
 	} else if (ac) {
@@ -1752,13 +1942,19 @@ co_nmt_boot_dn_prog_on_dn_con(co_nmt_boot_t *boot, co_unsigned32_t ac)
 	// Retry the SDO request on timeout (this includes the first attempt).
 	if (ac == CO_SDO_AC_TIMEOUT && boot->retry--) {
 		struct co_sdo_req *req = &boot->req;
-		// Write the program data (sub-object 1F58:ID) to the program
-		// data of the slave (sub-object 1F50:01) using SDO segmented
-		// transfer.
-		// clang-format off
-		if (co_csdo_dn_req(boot->sdo, 0x1f50, 0x01, req->buf, req->size,
-				&co_nmt_boot_dn_con, boot) == -1)
-			// clang-format on
+		// Write the program data (sub-object 1F58:ID or the program
+		// data source) to the program data of the slave (sub-object
+		// 1F50:01) using SDO segmented transfer.
+		int result = boot->prog_read
+				? co_csdo_dn_src_req(boot->sdo, 0x1f50, 0x01,
+						boot->prog_size, boot->prog_buf,
+						LELY_CO_NMT_BOOT_PROG_BUFSIZE,
+						&co_nmt_boot_prog_read,
+						&co_nmt_boot_dn_con, boot)
+				: co_csdo_dn_req(boot->sdo, 0x1f50, 0x01,
+						req->buf, req->size,
+						&co_nmt_boot_dn_con, boot);
+		if (result == -1)
 			return co_nmt_boot_abort_state;
 		return NULL;
 	} else if (ac) {
@@ -1779,6 +1975,10 @@ co_nmt_boot_wait_flash_on_enter(co_nmt_boot_t *boot)
 {
 	assert(boot);
 
+	// The program data has been downloaded.
+	free(boot->prog_buf);
+	boot->prog_buf = NULL;
+
 	// Wait for a while before checking the flash status indication.
 	can_timer_timeout(
 			boot->timer, boot->net, LELY_CO_NMT_BOOT_CHECK_TIMEOUT);
@@ -2019,17 +2219,19 @@ co_nmt_boot_chk_cfg_date_on_enter(co_nmt_boot_t *boot)
 {
 	assert(boot);
 
+	co_nmt_boot_set_phase(boot, CO_NMT_BOOT_PHASE_CFG);
+
 	boot->es = 'J';
 
 	// If the expected configuration date (sub-object 1F26:ID) or time
-	// (sub-object 1F27:ID) are not configured, proceed to 'update
-	// configuration'.
+	// (sub-object 1F27:ID) are not configured, check the hash of the
+	// concise DCF, if available, or proceed to 'update configuration'.
 	co_unsigned32_t cfg_date =
 			co_dev_get_val_u32(boot->dev, 0x1f26, boot->id);
 	co_unsigned32_t cfg_time =
 			co_dev_get_val_u32(boot->dev, 0x1f27, boot->id);
 	if (!cfg_date || !cfg_time)
-		return co_nmt_boot_up_cfg_state;
+		return co_nmt_boot_chk_cfg_hash_state;
 
 	// The configuration check may follow an NMT 'reset communication'
 	// command (if the 'check software version' step was skipped), in which
@@ -2096,6 +2298,68 @@ co_nmt_boot_chk_cfg_time_on_up_con(co_nmt_boot_t *boot, co_unsigned32_t ac,
 	return co_nmt_boot_ec_state;
 }
 
+static co_nmt_boot_state_t *
+co_nmt_boot_chk_cfg_hash_on_enter(co_nmt_boot_t *boot)
+{
+	assert(boot);
+
+	boot->cfg_hash_valid = 0;
+
+	co_unsigned16_t idx = 0;
+	co_nmt_get_cfg_hash(boot->nmt, &idx, NULL);
+	if (!idx)
+		return co_nmt_boot_up_cfg_state;
+
+	// Compute the hash of the concise DCF of the slave (sub-object 1F22:ID).
+	// If there is no concise DCF, there is nothing to skip.
+	co_sub_t *sub = co_dev_find_sub(boot->dev, 0x1f22, boot->id);
+	if (!sub || co_sub_get_type(sub) != CO_DEFTYPE_DOMAIN)
+		return co_nmt_boot_up_cfg_state;
+	size_t n = co_sub_sizeof_val(sub);
+	if (!n)
+		return co_nmt_boot_up_cfg_state;
+	boot->cfg_hash = co_nmt_cfg_hash(co_sub_addressof_val(sub), n);
+	boot->cfg_hash_valid = 1;
+
+	// The configuration check may follow an NMT 'reset communication'
+	// command, in which case we may have to give the slave some time to
+	// complete the state change. Start the first SDO request by simulating
+	// a timeout.
+	boot->retry = LELY_CO_NMT_BOOT_SDO_RETRY + 1;
+	return co_nmt_boot_chk_cfg_hash_on_up_con(
+			boot, CO_SDO_AC_TIMEOUT, NULL, 0);
+}
+
+static co_nmt_boot_state_t *
+co_nmt_boot_chk_cfg_hash_on_up_con(co_nmt_boot_t *boot, co_unsigned32_t ac,
+		const void *ptr, size_t n)
+{
+	assert(boot);
+
+	co_unsigned16_t idx = 0;
+	co_unsigned8_t subidx = 0;
+	co_nmt_get_cfg_hash(boot->nmt, &idx, &subidx);
+
+	// Retry the SDO request on timeout (this includes the first attempt).
+	if (ac == CO_SDO_AC_TIMEOUT && boot->retry--) {
+		// Read the hash of the last concise DCF stored on the slave.
+		if (co_nmt_boot_up(boot, idx, subidx) == -1)
+			return co_nmt_boot_abort_state;
+		return NULL;
+	}
+
+	// If the hash matches, the slave is already configured and the
+	// configuration update can be skipped. A missing or mismatching hash is
+	// not an error.
+	if (!ac && n == 4 && ldle_u32(ptr) == boot->cfg_hash) {
+		boot->stats.cfg_skipped = 1;
+		boot->cfg_hash_valid = 0;
+		return co_nmt_boot_ec_state;
+	}
+
+	return co_nmt_boot_up_cfg_state;
+}
+
 static co_nmt_boot_state_t *
 co_nmt_boot_up_cfg_on_enter(co_nmt_boot_t *boot)
 {
@@ -2131,6 +2395,56 @@ co_nmt_boot_up_cfg_on_cfg_con(co_nmt_boot_t *boot, co_unsigned32_t ac)
 		return co_nmt_boot_abort_state;
 	}
 
+	// Store the hash of the concise DCF on the slave, so the next
+	// configuration update can be skipped.
+	if (boot->cfg_hash_valid)
+		return co_nmt_boot_store_cfg_hash_state;
+
+	return co_nmt_boot_ec_state;
+}
+
+static co_nmt_boot_state_t *
+co_nmt_boot_store_cfg_hash_on_enter(co_nmt_boot_t *boot)
+{
+	assert(boot);
+	assert(boot->cfg_hash_valid);
+
+	boot->cfg_hash_valid = 0;
+
+	co_unsigned16_t idx = 0;
+	co_unsigned8_t subidx = 0;
+	co_nmt_get_cfg_hash(boot->nmt, &idx, &subidx);
+
+	// clang-format off
+	if (co_nmt_boot_dn(boot, idx, subidx, CO_DEFTYPE_UNSIGNED32,
+			&boot->cfg_hash) == -1)
+		// clang-format on
+		return co_nmt_boot_ec_state;
+
+	return NULL;
+}
+
+static co_nmt_boot_state_t *
+co_nmt_boot_store_cfg_hash_on_dn_con(co_nmt_boot_t *boot, co_unsigned32_t ac)
+{
+#if LELY_NO_STDIO
+	(void)boot;
+#else
+	assert(boot);
+#endif
+
+	// Failing to store the hash only means the next configuration update
+	// cannot be skipped.
+#if !LELY_NO_STDIO
+	if (ac)
+		diag(DIAG_WARNING, 0,
+				"SDO abort code %08" PRIX32
+				" received while storing the configuration hash of node %02X: %s",
+				ac, boot->id, co_sdo_ac2str(ac));
+#else
+	(void)ac;
+#endif
+
 	return co_nmt_boot_ec_state;
 }
 
@@ -2139,6 +2453,8 @@ co_nmt_boot_ec_on_enter(co_nmt_boot_t *boot)
 {
 	assert(boot);
 
+	co_nmt_boot_set_phase(boot, CO_NMT_BOOT_PHASE_EC);
+
 	if (boot->ms) {
 		boot->es = 'K';
 		// Start the CAN frame receiver for heartbeat messages.
@@ -2241,4 +2557,24 @@ co_nmt_boot_send_rtr(co_nmt_boot_t *boot)
 }
 #endif
 
+static void
+co_nmt_boot_set_phase(co_nmt_boot_t *boot, int phase)
+{
+	assert(boot);
+	assert(phase < CO_NMT_BOOT_NUM_PHASES);
+
+	struct timespec now = { 0, 0 };
+	can_net_get_time(boot->net, &now);
+
+	if (boot->phase >= 0) {
+		int_least64_t msec =
+				timespec_diff_msec(&now, &boot->phase_start);
+		if (msec > 0)
+			boot->stats.phase[boot->phase] += (co_unsigned32_t)msec;
+	}
+
+	boot->phase = phase;
+	boot->phase_start = now;
+}
+
 #endif // !LELY_NO_CO_MASTER && !LELY_NO_CO_NMT_BOOT
@@ -91,6 +91,17 @@ void co_nmt_boot_destroy(co_nmt_boot_t *boot);
 int co_nmt_boot_boot_req(co_nmt_boot_t *boot, co_unsigned8_t id, int timeout,
 		co_csdo_ind_t *dn_ind, co_csdo_ind_t *up_ind, void *data);
 
+/**
+ * Retrieves the duration of the phases of a CANopen NMT 'boot slave' process.
+ * The waiting time (#co_nmt_boot_stats::wait) is not modified, since it is
+ * maintained by the NMT master service.
+ *
+ * @param boot  a pointer to an NMT 'boot slave' service.
+ * @param stats the address at which to store the statistics.
+ */
+void co_nmt_boot_get_stats(
+		const co_nmt_boot_t *boot, struct co_nmt_boot_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
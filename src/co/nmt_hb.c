@@ -25,42 +25,82 @@
 #include "co.h"
 #include <lely/co/dev.h>
 #include <lely/util/diag.h>
+#include <lely/util/time.h>
 
 #include <assert.h>
 #include <stdlib.h>
 
-/// A CANopen NMT heartbeat consumer.
+/// An entry in the CANopen NMT heartbeat consumer table.
+struct co_nmt_hb_ent {
+	/**
+	 * The time at which a heartbeat timeout occurs for the node, if
+	 * #armed is 1.
+	 */
+	struct timespec deadline;
+	/// The consumer heartbeat time (in milliseconds).
+	co_unsigned16_t ms;
+	/// The node-ID.
+	co_unsigned8_t id;
+	/// The state of the node (excluding the toggle bit).
+	co_unsigned8_t st;
+	/// A flag indicating whether #deadline is valid.
+	co_unsigned8_t armed;
+	/**
+	 * Indicates whether a heartbeat error occurred (#CO_NMT_EC_OCCURRED or
+	 * #CO_NMT_EC_RESOLVED).
+	 */
+	co_unsigned8_t state;
+};
+
+/// A CANopen NMT heartbeat consumer table.
 struct __co_nmt_hb {
 	/// A pointer to a CAN network interface.
 	can_net_t *net;
 	/// A pointer to an NMT master/slave service.
 	co_nmt_t *nmt;
-	/// A pointer to the CAN frame receiver.
+	/// A pointer to the CAN frame receiver for all heartbeat messages.
 	can_recv_t *recv;
-	/// A pointer to the CAN timer.
+	/// A pointer to the CAN timer for the earliest deadline.
 	can_timer_t *timer;
-	/// The node-ID.
-	co_unsigned8_t id;
-	/// The state of the node (excluding the toggle bit).
-	co_unsigned8_t st;
-	/// The consumer heartbeat time (in milliseconds).
-	co_unsigned16_t ms;
+	/// The time at which #timer triggers, if #armed is 1.
+	struct timespec next;
+	/// A flag indicating whether #timer is running.
+	int armed;
+	/// The number of entries in #ents.
+	co_unsigned8_t n;
+	/// The number of active entries (valid node-ID and non-zero time).
+	co_unsigned8_t nactive;
 	/**
-	 * Indicates whether a heartbeat error occurred (#CO_NMT_EC_OCCURRED or
-	 * #CO_NMT_EC_RESOLVED).
+	 * The (1-based) index in #ents of the active entry for each node-ID, or
+	 * 0 if the node is not monitored.
 	 */
-	int state;
+	co_unsigned8_t map[CO_NUM_NODES + 1];
+	/// An array of consumer entries.
+#if LELY_NO_MALLOC
+	struct co_nmt_hb_ent ents[CO_NMT_MAX_NHB];
+#else
+	struct co_nmt_hb_ent *ents;
+#endif
 };
 
+/// Returns 1 if a heartbeat consumer entry is active, and 0 if not.
+static inline int co_nmt_hb_ent_active(const struct co_nmt_hb_ent *ent);
+
+/**
+ * Starts the CAN timer of a heartbeat consumer table, if it is not running or
+ * scheduled to trigger after <b>tp</b>.
+ */
+static void co_nmt_hb_arm(co_nmt_hb_t *hb, const struct timespec *tp);
+
 /**
- * The CAN receive callback function for a heartbeat consumer.
+ * The CAN receive callback function for a heartbeat consumer table.
  *
  * @see can_recv_func_t
  */
 static int co_nmt_hb_recv(const struct can_msg *msg, void *data);
 
 /**
- * The CAN timer callback function for a heartbeat consumer.
+ * The CAN timer callback function for a heartbeat consumer table.
  *
  * @see can_timer_func_t
  */
@@ -84,7 +124,8 @@ __co_nmt_hb_free(void *ptr)
 }
 
 struct __co_nmt_hb *
-__co_nmt_hb_init(struct __co_nmt_hb *hb, can_net_t *net, co_nmt_t *nmt)
+__co_nmt_hb_init(struct __co_nmt_hb *hb, can_net_t *net, co_nmt_t *nmt,
+		co_unsigned8_t n)
 {
 	assert(hb);
 	assert(net);
@@ -109,14 +150,42 @@ __co_nmt_hb_init(struct __co_nmt_hb *hb, can_net_t *net, co_nmt_t *nmt)
 	}
 	can_timer_set_func(hb->timer, &co_nmt_hb_timer, hb);
 
-	hb->id = 0;
-	hb->st = 0;
-	hb->ms = 0;
-	hb->state = CO_NMT_EC_RESOLVED;
+	hb->next = (struct timespec){ 0, 0 };
+	hb->armed = 0;
+
+#if LELY_NO_MALLOC
+	if (n > CO_NMT_MAX_NHB) {
+		errc = errnum2c(ERRNUM_NOMEM);
+		goto error_alloc_ents;
+	}
+#else
+	hb->ents = n ? calloc(n, sizeof(*hb->ents)) : NULL;
+	if (!hb->ents && n) {
+#if !LELY_NO_ERRNO
+		errc = errno2c(errno);
+#endif
+		goto error_alloc_ents;
+	}
+#endif
+	hb->n = n;
+	hb->nactive = 0;
+
+	for (co_unsigned8_t i = 0; i < hb->n; i++) {
+		struct co_nmt_hb_ent *ent = &hb->ents[i];
+		ent->deadline = (struct timespec){ 0, 0 };
+		ent->ms = 0;
+		ent->id = 0;
+		ent->st = 0;
+		ent->armed = 0;
+		ent->state = CO_NMT_EC_RESOLVED;
+	}
+	for (co_unsigned8_t id = 0; id <= CO_NUM_NODES; id++)
+		hb->map[id] = 0;
 
 	return hb;
 
-	// can_timer_destroy(hb->timer);
+error_alloc_ents:
+	can_timer_destroy(hb->timer);
 error_create_timer:
 	can_recv_destroy(hb->recv);
 error_create_recv:
@@ -129,12 +198,16 @@ __co_nmt_hb_fini(struct __co_nmt_hb *hb)
 {
 	assert(hb);
 
+#if !LELY_NO_MALLOC
+	free(hb->ents);
+#endif
+
 	can_timer_destroy(hb->timer);
 	can_recv_destroy(hb->recv);
 }
 
 co_nmt_hb_t *
-co_nmt_hb_create(can_net_t *net, co_nmt_t *nmt)
+co_nmt_hb_create(can_net_t *net, co_nmt_t *nmt, co_unsigned8_t n)
 {
 	int errc = 0;
 
@@ -144,7 +217,7 @@ co_nmt_hb_create(can_net_t *net, co_nmt_t *nmt)
 		goto error_alloc_hb;
 	}
 
-	if (!__co_nmt_hb_init(hb, net, nmt)) {
+	if (!__co_nmt_hb_init(hb, net, nmt, n)) {
 		errc = get_errc();
 		goto error_init_hb;
 	}
@@ -168,47 +241,111 @@ co_nmt_hb_destroy(co_nmt_hb_t *hb)
 }
 
 void
-co_nmt_hb_set_1016(co_nmt_hb_t *hb, co_unsigned8_t id, co_unsigned16_t ms)
+co_nmt_hb_set_1016(co_nmt_hb_t *hb, co_unsigned8_t i, co_unsigned8_t id,
+		co_unsigned16_t ms)
 {
 	assert(hb);
+	assert(i && i <= hb->n);
+	struct co_nmt_hb_ent *ent = &hb->ents[i - 1];
+
+	if (co_nmt_hb_ent_active(ent)) {
+		assert(hb->nactive);
+		hb->nactive--;
+		if (hb->map[ent->id] == i) {
+			// Hand the node over to another active entry with the
+			// same node-ID, if any.
+			hb->map[ent->id] = 0;
+			for (co_unsigned8_t j = 1; j <= hb->n; j++) {
+				const struct co_nmt_hb_ent *ent_j =
+						&hb->ents[j - 1];
+				if (j != i && ent_j->id == ent->id
+						&& co_nmt_hb_ent_active(ent_j)) {
+					hb->map[ent->id] = j;
+					break;
+				}
+			}
+		}
+	}
 
-	can_recv_stop(hb->recv);
-	can_timer_stop(hb->timer);
-
-	hb->id = id;
-	hb->st = 0;
-	hb->ms = ms;
-	hb->state = CO_NMT_EC_RESOLVED;
-
-	if (hb->id && hb->id <= CO_NUM_NODES && hb->ms) {
-		can_recv_start(hb->recv, hb->net, CO_NMT_EC_CANID(hb->id), 0);
-	} else {
+	ent->id = id;
+	ent->st = 0;
+	ent->ms = ms;
+	ent->state = CO_NMT_EC_RESOLVED;
+	// The timer of the table is not stopped. If it triggers for this
+	// entry, it is simply rescheduled for the next deadline.
+	ent->armed = 0;
+
+	if (co_nmt_hb_ent_active(ent)) {
+		if (!hb->map[ent->id])
+			hb->map[ent->id] = i;
+		if (!hb->nactive++)
+			can_recv_start_mask(hb->recv, hb->net,
+					CO_NMT_EC_CANID(0), ~CO_NUM_NODES, 0);
+	} else if (!hb->nactive) {
 		can_recv_stop(hb->recv);
 		can_timer_stop(hb->timer);
+		hb->armed = 0;
 	}
 }
 
 void
-co_nmt_hb_set_st(co_nmt_hb_t *hb, co_unsigned8_t st)
+co_nmt_hb_set_st(co_nmt_hb_t *hb, co_unsigned8_t i, co_unsigned8_t st)
 {
 	assert(hb);
-
-	if (hb->id && hb->id <= CO_NUM_NODES && hb->ms) {
-		hb->st = st;
-		hb->state = CO_NMT_EC_RESOLVED;
-		// Reset the CAN timer for the heartbeat consumer.
-		can_timer_timeout(hb->timer, hb->net, hb->ms);
+	assert(i && i <= hb->n);
+	struct co_nmt_hb_ent *ent = &hb->ents[i - 1];
+
+	if (co_nmt_hb_ent_active(ent)) {
+		ent->st = st;
+		ent->state = CO_NMT_EC_RESOLVED;
+		// Reset the deadline for the heartbeat consumer. The timeout is
+		// measured from the time at which the heartbeat message was
+		// received, not from the time at which it is processed.
+		can_net_get_recv_time(hb->net, &ent->deadline);
+		timespec_add_msec(&ent->deadline, ent->ms);
+		ent->armed = 1;
+		co_nmt_hb_arm(hb, &ent->deadline);
 	}
 }
 
+static inline int
+co_nmt_hb_ent_active(const struct co_nmt_hb_ent *ent)
+{
+	assert(ent);
+
+	return ent->id && ent->id <= CO_NUM_NODES && ent->ms;
+}
+
+static void
+co_nmt_hb_arm(co_nmt_hb_t *hb, const struct timespec *tp)
+{
+	assert(hb);
+	assert(tp);
+
+	// Since deadlines are almost always extended, the timer only needs to
+	// be restarted if the new deadline is earlier than the current one.
+	if (hb->armed && timespec_cmp(tp, &hb->next) >= 0)
+		return;
+
+	hb->next = *tp;
+	hb->armed = 1;
+	can_timer_start(hb->timer, hb->net, &hb->next, NULL);
+}
+
 static int
 co_nmt_hb_recv(const struct can_msg *msg, void *data)
 {
 	assert(msg);
 	co_nmt_hb_t *hb = data;
 	assert(hb);
-	assert(hb->id && hb->id <= CO_NUM_NODES);
-	assert(msg->id == (uint_least32_t)CO_NMT_EC_CANID(hb->id));
+
+	co_unsigned8_t id = msg->id & CO_NUM_NODES;
+	assert(msg->id == (uint_least32_t)CO_NMT_EC_CANID(id));
+	co_unsigned8_t i = hb->map[id];
+	if (!i)
+		return 0;
+	struct co_nmt_hb_ent *ent = &hb->ents[i - 1];
+	assert(co_nmt_hb_ent_active(ent));
 
 	// Obtain the node status from the CAN frame. Ignore if the toggle bit
 	// is set, since then it is not a heartbeat message.
@@ -218,33 +355,28 @@ co_nmt_hb_recv(const struct can_msg *msg, void *data)
 	if (st & CO_NMT_ST_TOGGLE)
 		return 0;
 
-	// This might happen upon receipt of a boot-up message. The 'boot slave'
-	// process has disabled the heartbeat consumer, but the event has
-	// already been scheduled.
-	if (!hb->ms)
-		return 0;
-
 	// Update the state.
-	co_unsigned8_t old_st = hb->st;
-	int old_state = hb->state;
-	co_nmt_hb_set_st(hb, st);
+	co_unsigned8_t old_st = ent->st;
+	int old_state = ent->state;
+	co_nmt_hb_set_st(hb, i, st);
 
 	if (old_state == CO_NMT_EC_OCCURRED) {
 		diag(DIAG_INFO, 0,
 				"NMT: heartbeat time out resolved for node %d",
-				hb->id);
+				id);
 		// If a heartbeat timeout event occurred, notify the user that
 		// it has been resolved.
-		co_nmt_hb_ind(hb->nmt, hb->id, hb->state, CO_NMT_EC_TIMEOUT, 0);
+		co_nmt_hb_ind(hb->nmt, id, CO_NMT_EC_RESOLVED, CO_NMT_EC_TIMEOUT,
+				0);
 	}
 
 	// Notify the application of the occurrence of a state change.
 	if (st != old_st) {
 		diag(DIAG_INFO, 0,
 				"NMT: heartbeat state change occurred for node %d",
-				hb->id);
-		co_nmt_hb_ind(hb->nmt, hb->id, CO_NMT_EC_OCCURRED,
-				CO_NMT_EC_STATE, st);
+				id);
+		co_nmt_hb_ind(hb->nmt, id, CO_NMT_EC_OCCURRED, CO_NMT_EC_STATE,
+				st);
 	}
 
 	return 0;
@@ -253,16 +385,39 @@ co_nmt_hb_recv(const struct can_msg *msg, void *data)
 static int
 co_nmt_hb_timer(const struct timespec *tp, void *data)
 {
-	(void)tp;
+	assert(tp);
 	co_nmt_hb_t *hb = data;
 	assert(hb);
 
-	// Notify the application of the occurrence of a heartbeat timeout
-	// event.
-	diag(DIAG_INFO, 0, "NMT: heartbeat time out occurred for node %d",
-			hb->id);
-	hb->state = CO_NMT_EC_OCCURRED;
-	co_nmt_hb_ind(hb->nmt, hb->id, hb->state, CO_NMT_EC_TIMEOUT, 0);
+	hb->armed = 0;
+
+	for (co_unsigned8_t i = 1; i <= hb->n; i++) {
+		struct co_nmt_hb_ent *ent = &hb->ents[i - 1];
+		if (!ent->armed || timespec_cmp(&ent->deadline, tp) > 0)
+			continue;
+		ent->armed = 0;
+		// Notify the application of the occurrence of a heartbeat
+		// timeout event.
+		diag(DIAG_INFO, 0,
+				"NMT: heartbeat time out occurred for node %d",
+				ent->id);
+		ent->state = CO_NMT_EC_OCCURRED;
+		co_nmt_hb_ind(hb->nmt, ent->id, ent->state, CO_NMT_EC_TIMEOUT,
+				0);
+	}
+
+	// Reschedule the timer for the earliest remaining deadline. Note that
+	// the indication function may already have done so.
+	const struct timespec *next = NULL;
+	for (co_unsigned8_t i = 1; i <= hb->n; i++) {
+		const struct co_nmt_hb_ent *ent = &hb->ents[i - 1];
+		if (ent->armed
+				&& (!next || timespec_cmp(&ent->deadline, next)
+								< 0))
+			next = &ent->deadline;
+	}
+	if (next)
+		co_nmt_hb_arm(hb, next);
 
 	return 0;
 }
@@ -26,9 +26,20 @@
 #include "co.h"
 #include <lely/co/nmt.h>
 
+#if LELY_NO_MALLOC
+#ifndef CO_NMT_MAX_NHB
+/**
+ * The default maximum number of heartbeat consumers in the absence of dynamic
+ * memory allocation. The default value equals the maximum number of CANopen
+ * nodes.
+ */
+#define CO_NMT_MAX_NHB CO_NUM_NODES
+#endif
+#endif
+
 struct __co_nmt_hb;
 #ifndef __cplusplus
-/// An opaque CANopen NMT heartbeat consumer type.
+/// An opaque CANopen NMT heartbeat consumer table type.
 typedef struct __co_nmt_hb co_nmt_hb_t;
 #endif
 
@@ -54,50 +65,58 @@ void co_nmt_hb_ind(co_nmt_t *nmt, co_unsigned8_t id, int state, int reason,
 
 void *__co_nmt_hb_alloc(void);
 void __co_nmt_hb_free(void *ptr);
-struct __co_nmt_hb *__co_nmt_hb_init(
-		struct __co_nmt_hb *hb, can_net_t *net, co_nmt_t *nmt);
+struct __co_nmt_hb *__co_nmt_hb_init(struct __co_nmt_hb *hb, can_net_t *net,
+		co_nmt_t *nmt, co_unsigned8_t n);
 void __co_nmt_hb_fini(struct __co_nmt_hb *hb);
 
 /**
- * Creates a new CANopen NMT heartbeat consumer service.
+ * Creates a new CANopen NMT heartbeat consumer table. The table monitors all
+ * nodes with a single CAN frame receiver for the heartbeat messages
+ * (0x700 + node-ID) and a single CAN timer for the earliest deadline.
  *
  * @param net a pointer to a CAN network.
  * @param nmt a pointer to an NMT master/slave service.
+ * @param n   the number of heartbeat consumers (i.e., the highest sub-index of
+ *            object 1016).
  *
- * @returns a pointer to a new heartbeat consumer service, or NULL on error. In
+ * @returns a pointer to a new heartbeat consumer table, or NULL on error. In
  * the latter case, the error number can be obtained with get_errc().
  *
  * @see co_nmt_hb_destroy()
  */
-co_nmt_hb_t *co_nmt_hb_create(can_net_t *net, co_nmt_t *nmt);
+co_nmt_hb_t *co_nmt_hb_create(can_net_t *net, co_nmt_t *nmt, co_unsigned8_t n);
 
-/// Destroys a CANopen NMT heartbeat consumer service. @see co_nmt_hb_create()
+/// Destroys a CANopen NMT heartbeat consumer table. @see co_nmt_hb_create()
 void co_nmt_hb_destroy(co_nmt_hb_t *hb);
 
 /**
  * Processes the value of CANopen object 1016 (Consumer heartbeat time) for the
  * specified heartbeat consumer. If the node-ID is valid and the heartbeat time
  * is non-zero, the heartbeat consumer is activated. Note that this only
- * activates the CAN frame receiver for heartbeat messages. The CAN timer for
- * heartbeat events is not activated until the first heartbeat message is
- * received or co_nmt_hb_set_st() is invoked.
+ * activates the reception of heartbeat messages. The deadline for heartbeat
+ * events is not set until the first heartbeat message is received or
+ * co_nmt_hb_set_st() is invoked.
  *
- * @param hb a pointer to a heartbeat consumer service.
+ * @param hb a pointer to a heartbeat consumer table.
+ * @param i  the sub-index of the consumer in object 1016 (in the range
+ *           [1..<b>n</b>]).
  * @param id the node-ID.
  * @param ms the heartbeat time (in milliseconds).
  */
-void co_nmt_hb_set_1016(co_nmt_hb_t *hb, co_unsigned8_t id, co_unsigned16_t ms);
+void co_nmt_hb_set_1016(co_nmt_hb_t *hb, co_unsigned8_t i, co_unsigned8_t id,
+		co_unsigned16_t ms);
 
 /**
  * Sets the expected state of a remote NMT node. If the heartbeat consumer is
  * active, invocation of this function is equivalent to reception of a heartbeat
- * message with the specified state and will (re)activate the CAN timer for
- * heartbeat events.
+ * message with the specified state and will reset the deadline for heartbeat
+ * events.
  *
- * @param hb a pointer to a heartbeat consumer service.
+ * @param hb a pointer to a heartbeat consumer table.
+ * @param i  the sub-index of the consumer in object 1016.
  * @param st the state of the node (excluding the toggle bit).
  */
-void co_nmt_hb_set_st(co_nmt_hb_t *hb, co_unsigned8_t st);
+void co_nmt_hb_set_st(co_nmt_hb_t *hb, co_unsigned8_t i, co_unsigned8_t st);
 
 #ifdef __cplusplus
 }
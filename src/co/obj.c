@@ -22,6 +22,7 @@
  */
 
 #include "co.h"
+#include "obj.h"
 #include <lely/co/detail/obj.h>
 #include <lely/co/dev.h>
 #include <lely/co/sdo.h>
@@ -45,6 +46,12 @@ static void co_obj_update(co_obj_t *obj);
 /// Destroys all sub-objects.
 static void co_obj_clear(co_obj_t *obj);
 
+/**
+ * Records a change in the value of a sub-object, if it is part of the object
+ * dictionary of a device (see co_dev_touch()).
+ */
+static inline void co_sub_touch(co_sub_t *sub);
+
 void *
 __co_obj_alloc(void)
 {
@@ -78,6 +85,13 @@ __co_obj_init(struct __co_obj *obj, co_unsigned16_t idx, void *val, size_t size)
 	obj->idx = idx;
 
 	rbtree_init(&obj->tree, &uint8_cmp);
+#if !LELY_NO_MALLOC
+	obj->subs = NULL;
+	obj->nsubs = 0;
+	obj->arena = 0;
+	obj->arena_name = 0;
+	obj->ref_name = 0;
+#endif
 
 #if !LELY_NO_CO_OBJ_NAME
 	obj->name = NULL;
@@ -104,7 +118,8 @@ __co_obj_fini(struct __co_obj *obj)
 #endif
 
 #if !LELY_NO_MALLOC && !LELY_NO_CO_OBJ_NAME
-	free(obj->name);
+	if (!obj->arena_name && !obj->ref_name)
+		free(obj->name);
 #endif
 }
 
@@ -112,14 +127,28 @@ __co_obj_fini(struct __co_obj *obj)
 
 co_obj_t *
 co_obj_create(co_unsigned16_t idx)
+{
+	return co_obj_create_in(NULL, idx);
+}
+
+co_obj_t *
+co_obj_create_in(co_dev_t *dev, co_unsigned16_t idx)
 {
 	trace("creating object %04X", idx);
 
-	co_obj_t *obj = __co_obj_alloc();
-	if (!obj)
-		return NULL;
+	int arena = 1;
+	co_obj_t *obj = co_dev_arena_alloc(dev, sizeof(*obj));
+	if (!obj) {
+		arena = 0;
+		obj = __co_obj_alloc();
+		if (!obj)
+			return NULL;
+	}
+
+	__co_obj_init(obj, idx, NULL, 0);
+	obj->arena = arena;
 
-	return __co_obj_init(obj, idx, NULL, 0);
+	return obj;
 }
 
 void
@@ -127,8 +156,12 @@ co_obj_destroy(co_obj_t *obj)
 {
 	if (obj) {
 		trace("destroying object %04X", obj->idx);
+		int arena = obj->arena;
 		__co_obj_fini(obj);
-		__co_obj_free(obj);
+		// The memory of an object allocated from an arena is released
+		// when the device is destroyed.
+		if (!arena)
+			__co_obj_free(obj);
 	}
 }
 
@@ -203,6 +236,13 @@ co_obj_insert_sub(co_obj_t *obj, co_sub_t *sub)
 	if (rbtree_find(&obj->tree, sub->node.key))
 		return -1;
 
+#if !LELY_NO_MALLOC
+	if (obj->dev) {
+		co_dev_thaw(obj->dev);
+		co_dev_touch(obj->dev, NULL);
+	}
+#endif
+
 	sub->obj = obj;
 	rbtree_insert(&sub->obj->tree, &sub->node);
 
@@ -222,6 +262,13 @@ co_obj_remove_sub(co_obj_t *obj, co_sub_t *sub)
 	if (sub->obj != obj)
 		return -1;
 
+#if !LELY_NO_MALLOC
+	if (obj->dev) {
+		co_dev_thaw(obj->dev);
+		co_dev_touch(obj->dev, NULL);
+	}
+#endif
+
 	rbtree_remove(&sub->obj->tree, &sub->node);
 	rbnode_init(&sub->node, &sub->subidx);
 	sub->obj = NULL;
@@ -241,6 +288,28 @@ co_obj_find_sub(const co_obj_t *obj, co_unsigned8_t subidx)
 {
 	assert(obj);
 
+#if !LELY_NO_MALLOC
+	if (obj->subs) {
+		// Most objects have contiguous sub-indices starting at 0, in
+		// which case the sub-index is the position in the array.
+		if (subidx < obj->nsubs && obj->subs[subidx]->subidx == subidx)
+			return obj->subs[subidx];
+		size_t lo = 0;
+		size_t hi = obj->nsubs;
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			co_sub_t *sub = obj->subs[mid];
+			if (sub->subidx == subidx)
+				return sub;
+			else if (sub->subidx < subidx)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return NULL;
+	}
+#endif
+
 	struct rbnode *node = rbtree_find(&obj->tree, &subidx);
 	return node ? structof(node, co_sub_t, node) : NULL;
 }
@@ -280,23 +349,56 @@ co_obj_set_name(co_obj_t *obj, const char *name)
 	assert(obj);
 
 	if (!name || !*name) {
-		free(obj->name);
+		if (!obj->arena_name && !obj->ref_name)
+			free(obj->name);
 		obj->name = NULL;
+		obj->arena_name = 0;
+		obj->ref_name = 0;
 		return 0;
 	}
 
-	void *ptr = realloc(obj->name, strlen(name) + 1);
+	size_t n = strlen(name) + 1;
+	void *ptr = NULL;
+	if (obj->arena_name && n <= strlen(obj->name) + 1) {
+		// Reuse the arena memory of the old name if the new one fits.
+		ptr = obj->name;
+	} else if (!obj->name && obj->arena) {
+		// Allocate the first name from the same arena as the object, if
+		// possible. Renames that do not fit use malloc(), so the arena
+		// does not grow with every rename.
+		ptr = co_dev_arena_alloc(obj->dev, n);
+		if (ptr)
+			obj->arena_name = 1;
+	}
 	if (!ptr) {
+		ptr = realloc(obj->arena_name || obj->ref_name ? NULL : obj->name,
+				n);
+		if (!ptr) {
 #if !LELY_NO_ERRNO
-		set_errc(errno2c(errno));
+			set_errc(errno2c(errno));
 #endif
-		return -1;
+			return -1;
+		}
+		obj->arena_name = 0;
 	}
+	obj->ref_name = 0;
 	obj->name = ptr;
 	strcpy(obj->name, name);
 
 	return 0;
 }
+
+void
+co_obj_set_name_ref(co_obj_t *obj, const char *name)
+{
+	assert(obj);
+
+	if (!obj->arena_name && !obj->ref_name)
+		free(obj->name);
+	obj->name = name && *name ? (char *)name : NULL;
+	obj->arena_name = 0;
+	obj->ref_name = obj->name != NULL;
+}
 #endif // !LELY_NO_MALLOC && !LELY_NO_CO_OBJ_NAME
 
 co_unsigned8_t
@@ -442,6 +544,12 @@ __co_sub_init(struct __co_sub *sub, co_unsigned8_t subidx, co_unsigned16_t type,
 #if !LELY_NO_CO_OBJ_NAME
 	sub->name = NULL;
 #endif
+#if !LELY_NO_MALLOC
+	sub->arena = 0;
+	sub->arena_name = 0;
+	sub->ref_name = 0;
+	sub->gen = 0;
+#endif
 
 	sub->type = type;
 #if !LELY_NO_CO_OBJ_LIMITS
@@ -487,7 +595,8 @@ __co_sub_fini(struct __co_sub *sub)
 #endif
 
 #if !LELY_NO_MALLOC && !LELY_NO_CO_OBJ_NAME
-	free(sub->name);
+	if (!sub->arena_name && !sub->ref_name)
+		free(sub->name);
 #endif
 }
 
@@ -495,24 +604,37 @@ __co_sub_fini(struct __co_sub *sub)
 
 co_sub_t *
 co_sub_create(co_unsigned8_t subidx, co_unsigned16_t type)
+{
+	return co_sub_create_in(NULL, subidx, type);
+}
+
+co_sub_t *
+co_sub_create_in(co_dev_t *dev, co_unsigned8_t subidx, co_unsigned16_t type)
 {
 	int errc = 0;
 
-	co_sub_t *sub = __co_sub_alloc();
+	int arena = 1;
+	co_sub_t *sub = co_dev_arena_alloc(dev, sizeof(*sub));
 	if (!sub) {
-		errc = get_errc();
-		goto error_alloc_sub;
+		arena = 0;
+		sub = __co_sub_alloc();
+		if (!sub) {
+			errc = get_errc();
+			goto error_alloc_sub;
+		}
 	}
 
 	if (!__co_sub_init(sub, subidx, type, NULL)) {
 		errc = get_errc();
 		goto error_init_sub;
 	}
+	sub->arena = arena;
 
 	return sub;
 
 error_init_sub:
-	__co_sub_free(sub);
+	if (!arena)
+		__co_sub_free(sub);
 error_alloc_sub:
 	set_errc(errc);
 	return NULL;
@@ -522,8 +644,10 @@ void
 co_sub_destroy(co_sub_t *sub)
 {
 	if (sub) {
+		int arena = sub->arena;
 		__co_sub_fini(sub);
-		__co_sub_free(sub);
+		if (!arena)
+			__co_sub_free(sub);
 	}
 }
 
@@ -580,23 +704,55 @@ co_sub_set_name(co_sub_t *sub, const char *name)
 	assert(sub);
 
 	if (!name || !*name) {
-		free(sub->name);
+		if (!sub->arena_name && !sub->ref_name)
+			free(sub->name);
 		sub->name = NULL;
+		sub->arena_name = 0;
+		sub->ref_name = 0;
 		return 0;
 	}
 
-	void *ptr = realloc(sub->name, strlen(name) + 1);
+	size_t n = strlen(name) + 1;
+	void *ptr = NULL;
+	if (sub->arena_name && n <= strlen(sub->name) + 1) {
+		// Reuse the arena memory of the old name if the new one fits.
+		ptr = sub->name;
+	} else if (!sub->name && sub->arena && sub->obj) {
+		// Allocate the first name from the same arena as the sub-object,
+		// if possible (see co_obj_set_name()).
+		ptr = co_dev_arena_alloc(sub->obj->dev, n);
+		if (ptr)
+			sub->arena_name = 1;
+	}
 	if (!ptr) {
+		ptr = realloc(sub->arena_name || sub->ref_name ? NULL : sub->name,
+				n);
+		if (!ptr) {
 #if !LELY_NO_ERRNO
-		set_errc(errno2c(errno));
+			set_errc(errno2c(errno));
 #endif
-		return -1;
+			return -1;
+		}
+		sub->arena_name = 0;
 	}
+	sub->ref_name = 0;
 	sub->name = ptr;
 	strcpy(sub->name, name);
 
 	return 0;
 }
+
+void
+co_sub_set_name_ref(co_sub_t *sub, const char *name)
+{
+	assert(sub);
+
+	if (!sub->arena_name && !sub->ref_name)
+		free(sub->name);
+	sub->name = name && *name ? (char *)name : NULL;
+	sub->arena_name = 0;
+	sub->ref_name = sub->name != NULL;
+}
 #endif // !LELY_NO_MALLOC && !LELY_NO_CO_OBJ_NAME
 
 co_unsigned16_t
@@ -720,7 +876,11 @@ co_sub_set_val(co_sub_t *sub, const void *ptr, size_t n)
 	assert(sub);
 
 	co_val_fini(sub->type, sub->val);
-	return co_val_make(sub->type, sub->val, ptr, n);
+	size_t size = co_val_make(sub->type, sub->val, ptr, n);
+#if !LELY_NO_MALLOC
+	co_sub_touch(sub);
+#endif
+	return size;
 }
 
 #define LELY_CO_DEFINE_TYPE(a, b, c, d) \
@@ -1003,7 +1163,9 @@ co_sub_dn(co_sub_t *sub, void *val)
 			return -1;
 #else
 		co_val_fini(sub->type, sub->val);
-		if (!co_val_move(sub->type, sub->val, val))
+		size_t n = co_val_move(sub->type, sub->val, val);
+		co_sub_touch(sub);
+		if (!n)
 			return -1;
 #endif
 	}
@@ -1164,4 +1326,13 @@ co_obj_clear(co_obj_t *obj)
 	obj->val = NULL;
 }
 
+static inline void
+co_sub_touch(co_sub_t *sub)
+{
+	assert(sub);
+
+	if (sub->obj && sub->obj->dev)
+		co_dev_touch(sub->obj->dev, sub);
+}
+
 #endif // !LELY_NO_MALLOC
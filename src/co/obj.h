@@ -0,0 +1,86 @@
+/**@file
+ * This is the internal header file of the object dictionary declarations.
+ *
+ * @see lely/co/dev.h, lely/co/obj.h
+ *
+ * @copyright 2021 Lely Industries N.V.
+ *
+ * @author J. S. Seldenthuis <jseldenthuis@lely.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LELY_CO_INTERN_OBJ_H_
+#define LELY_CO_INTERN_OBJ_H_
+
+#include "co.h"
+#include <lely/co/dev.h>
+#include <lely/co/obj.h>
+
+#if !LELY_NO_MALLOC
+
+struct __frbuf;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Allocates memory from the arena of a CANopen device. The memory is suitably
+ * aligned for any type and is released when the device is destroyed.
+ *
+ * @param dev  a pointer to a CANopen device (can be NULL).
+ * @param size the number of bytes to allocate.
+ *
+ * @returns a pointer to the allocated memory, or NULL if <b>dev</b> is NULL,
+ * the device does not use an arena, or an error occurred. Since the caller is
+ * expected to fall back to malloc(), no error number is set.
+ */
+void *co_dev_arena_alloc(co_dev_t *dev, size_t size);
+
+/**
+ * Records a change in the object dictionary of a CANopen device by
+ * incrementing its modification counter. This allows concise DCF caches to
+ * re-serialize only the sub-objects that changed (see co_dcf_cache_get()).
+ *
+ * @param dev a pointer to a CANopen device.
+ * @param sub a pointer to the sub-object whose value changed, or NULL if the
+ *            structure of the object dictionary (or the node-ID) changed.
+ */
+void co_dev_touch(co_dev_t *dev, co_sub_t *sub);
+
+/**
+ * Returns the layout counter of a CANopen device. The counter is incremented
+ * whenever objects or sub-objects are inserted into or removed from the object
+ * dictionary, or the node-ID changes (see co_dev_touch()).
+ */
+co_unsigned32_t co_dev_get_layout(const co_dev_t *dev);
+
+#if !LELY_NO_STDIO
+/**
+ * Transfers ownership of a read file buffer to a CANopen device. The buffer is
+ * destroyed when the device is destroyed, after all objects have been
+ * destroyed. This is used to keep a memory-mapped binary device description
+ * alive as long as the device references the names in it (see
+ * co_dev_create_from_bin_file_ref()).
+ */
+void co_dev_set_image(co_dev_t *dev, struct __frbuf *image);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !LELY_NO_MALLOC
+
+#endif // !LELY_CO_INTERN_OBJ_H_
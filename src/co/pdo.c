@@ -21,15 +21,17 @@
  * limitations under the License.
  */
 
-#include "co.h"
+#include "pdo.h"
 
 #if !LELY_NO_CO_RPDO || !LELY_NO_CO_TPDO
 
+#include "obj.h"
 #include <lely/can/msg.h>
+#include <lely/co/detail/obj.h>
 #include <lely/co/dev.h>
 #include <lely/co/obj.h>
-#include <lely/co/pdo.h>
 #include <lely/co/sdo.h>
+#include <lely/co/val.h>
 #include <lely/util/endian.h>
 
 #include <assert.h>
@@ -40,11 +42,65 @@ static co_unsigned32_t co_dev_cfg_pdo_comm(const co_dev_t *dev,
 static co_unsigned32_t co_dev_cfg_pdo_map(const co_dev_t *dev,
 		co_unsigned16_t num, const struct co_pdo_map_par *par);
 
+#if !LELY_NO_CO_RPDO
+/**
+ * Checks if the access type and PDO mapping flag of an existing sub-object
+ * allow it to be mapped into an RPDO.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+static co_unsigned32_t co_sub_chk_rpdo(const co_sub_t *sub);
+#endif
+
+#if !LELY_NO_CO_TPDO
+/**
+ * Checks if the access type and PDO mapping flag of an existing sub-object
+ * allow it to be mapped into a TPDO.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+static co_unsigned32_t co_sub_chk_tpdo(const co_sub_t *sub);
+#endif
+
 #if !LELY_NO_CO_RPDO && !LELY_NO_CO_MPDO
 co_unsigned32_t co_mpdo_dn(const struct co_pdo_map_par *par, co_dev_t *dev,
 		struct co_sdo_req *req, const uint_least8_t *buf, size_t n);
 #endif
 
+/**
+ * Compiles the PDO mapping parameters into a plan by looking up and checking
+ * each of the mapped sub-objects.
+ *
+ * @param plan a pointer to the plan to be (re)compiled.
+ * @param par  a pointer to the PDO mapping parameters.
+ * @param dev  a pointer to a CANopen device.
+ * @param chk  a pointer to the function used to check whether a sub-object can
+ *             be mapped (co_dev_chk_rpdo() or co_dev_chk_tpdo()).
+ */
+static void co_pdo_plan_compile(struct co_pdo_plan *plan,
+		const struct co_pdo_map_par *par, const co_dev_t *dev,
+		co_unsigned32_t (*chk)(const co_dev_t *dev, co_unsigned16_t idx,
+				co_unsigned8_t subidx));
+
+/**
+ * Returns 1 if a precompiled PDO mapping is valid and the layout of the object
+ * dictionary has not changed since it was compiled, and 0 if not.
+ */
+static int co_pdo_plan_is_valid(
+		const struct co_pdo_plan *plan, const co_dev_t *dev);
+
+#if !LELY_NO_CO_RPDO
+/**
+ * Downloads a value of a basic data type directly into a sub-object, bypassing
+ * the SDO download request. This is equivalent to invoking the default download
+ * indication function.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+static co_unsigned32_t co_pdo_plan_dn_val(
+		co_sub_t *sub, const uint_least8_t *buf, size_t nbyte);
+#endif
+
 #if !LELY_NO_CO_RPDO
 
 co_unsigned32_t
@@ -65,12 +121,7 @@ co_dev_chk_rpdo(const co_dev_t *dev, co_unsigned16_t idx, co_unsigned8_t subidx)
 		if (!sub)
 			return CO_SDO_AC_NO_SUB;
 
-		unsigned int access = co_sub_get_access(sub);
-		if (!(access & CO_ACCESS_WRITE))
-			return CO_SDO_AC_NO_WRITE;
-
-		if (!co_sub_get_pdo_mapping(sub) || !(access & CO_ACCESS_RPDO))
-			return CO_SDO_AC_NO_PDO;
+		return co_sub_chk_rpdo(sub);
 	}
 
 	return 0;
@@ -139,14 +190,7 @@ co_dev_chk_tpdo(const co_dev_t *dev, co_unsigned16_t idx, co_unsigned8_t subidx)
 	if (!sub)
 		return CO_SDO_AC_NO_SUB;
 
-	unsigned int access = co_sub_get_access(sub);
-	if (!(access & CO_ACCESS_READ))
-		return CO_SDO_AC_NO_READ;
-
-	if (!co_sub_get_pdo_mapping(sub) || !(access & CO_ACCESS_TPDO))
-		return CO_SDO_AC_NO_PDO;
-
-	return 0;
+	return co_sub_chk_tpdo(sub);
 }
 
 co_unsigned32_t
@@ -425,6 +469,82 @@ co_pdo_dn(const struct co_pdo_map_par *par, co_dev_t *dev,
 }
 #endif // !LELY_NO_CO_RPDO
 
+void
+co_pdo_plan_clear(struct co_pdo_plan *plan)
+{
+	assert(plan);
+
+	plan->valid = 0;
+	plan->n = 0;
+}
+
+#if !LELY_NO_CO_RPDO
+co_unsigned32_t
+co_pdo_plan_dn(struct co_pdo_plan *plan, const struct co_pdo_map_par *par,
+		co_dev_t *dev, struct co_sdo_req *req, const uint_least8_t *buf,
+		size_t n)
+{
+	assert(plan);
+	assert(par);
+	assert(dev);
+	assert(req);
+	assert(buf);
+
+	// Multiplex PDOs do not have a static mapping.
+	if (par->n > CO_PDO_NUM_MAPS)
+		return co_pdo_dn(par, dev, req, buf, n);
+
+	if (n > CAN_MAX_LEN)
+		return CO_SDO_AC_PDO_LEN;
+
+	if (!co_pdo_plan_is_valid(plan, dev))
+		co_pdo_plan_compile(plan, par, dev, &co_dev_chk_rpdo);
+
+	size_t offset = 0;
+	for (size_t i = 0; i < plan->n; i++) {
+		const struct co_pdo_plan_ent *ent = &plan->ent[i];
+
+		// Check the PDO length.
+		if (offset + ent->len > n * 8)
+			return CO_SDO_AC_PDO_LEN;
+
+		// Check whether the sub-object exists and can be mapped into an
+		// RPDO (or is a valid dummy entry).
+		co_sub_t *sub = ent->sub;
+		co_unsigned32_t ac = sub ? co_sub_chk_rpdo(sub) : ent->ac;
+		if (ac)
+			return ac;
+
+		if (sub) {
+			uint_least8_t tmp[CAN_MAX_LEN] = { 0 };
+			bcpyle(tmp, 0, buf, offset, ent->len);
+			size_t nbyte = (ent->len + 7) / 8;
+
+			// The download indication function can be changed at
+			// any time, so it cannot be part of the plan.
+			co_sub_dn_ind_t *ind = NULL;
+			co_sub_get_dn_ind(sub, &ind, NULL);
+
+			if (ent->basic && ind == &co_sub_default_dn_ind) {
+				ac = co_pdo_plan_dn_val(sub, tmp, nbyte);
+			} else {
+				co_sdo_req_clear(req);
+				req->size = nbyte;
+				req->buf = tmp;
+				req->nbyte = req->size;
+				ac = co_sub_dn_ind(sub, req);
+			}
+			if (ac)
+				return ac;
+		}
+
+		offset += ent->len;
+	}
+
+	return 0;
+}
+#endif // !LELY_NO_CO_RPDO
+
 #if !LELY_NO_CO_TPDO
 
 co_unsigned32_t
@@ -477,6 +597,83 @@ co_pdo_up(const struct co_pdo_map_par *par, const co_dev_t *dev,
 	return 0;
 }
 
+co_unsigned32_t
+co_pdo_plan_up(struct co_pdo_plan *plan, const struct co_pdo_map_par *par,
+		const co_dev_t *dev, struct co_sdo_req *req, uint_least8_t *buf,
+		size_t *pn)
+{
+	assert(plan);
+	assert(par);
+	assert(dev);
+	assert(req);
+
+	if (par->n > CO_PDO_NUM_MAPS)
+		return CO_SDO_AC_PDO_LEN;
+
+	if (!co_pdo_plan_is_valid(plan, dev))
+		co_pdo_plan_compile(plan, par, dev, &co_dev_chk_tpdo);
+
+	size_t offset = 0;
+	for (size_t i = 0; i < plan->n; i++) {
+		const struct co_pdo_plan_ent *ent = &plan->ent[i];
+
+		// Check the PDO length.
+		if (offset + ent->len > CAN_MAX_LEN * 8)
+			return CO_SDO_AC_PDO_LEN;
+
+		// Check whether the sub-object exists and can be mapped into a
+		// TPDO.
+		const co_sub_t *sub = ent->sub;
+		co_unsigned32_t ac = sub ? co_sub_chk_tpdo(sub) : ent->ac;
+		if (ac)
+			return ac;
+
+		// The upload indication function can be changed at any time,
+		// so it cannot be part of the plan.
+		const void *val = NULL;
+		if (ent->basic) {
+#if LELY_NO_CO_OBJ_UPLOAD
+			val = co_sub_get_val(sub);
+#else
+			co_sub_up_ind_t *ind = NULL;
+			co_sub_get_up_ind(sub, &ind, NULL);
+			if (ind == &co_sub_default_up_ind)
+				val = co_sub_get_val(sub);
+#endif
+		}
+
+		if (val) {
+			// Copy the value directly from the sub-object.
+			if (buf && pn && offset + ent->len <= *pn * 8) {
+				uint_least8_t tmp[sizeof(co_unsigned64_t)] = {
+					0
+				};
+				co_val_write(co_sub_get_type(sub), val, tmp,
+						tmp + sizeof(tmp));
+				bcpyle(buf, offset, tmp, 0, ent->len);
+			}
+		} else {
+			// Upload the value of the sub-object and copy the
+			// value.
+			co_sdo_req_clear(req);
+			ac = co_sub_up_ind(sub, req);
+			if (ac)
+				return ac;
+			if (!co_sdo_req_first(req) || !co_sdo_req_last(req))
+				return CO_SDO_AC_PDO_LEN;
+			if (buf && pn && offset + ent->len <= *pn * 8)
+				bcpyle(buf, offset, req->buf, 0, ent->len);
+		}
+
+		offset += ent->len;
+	}
+
+	if (pn)
+		*pn = (offset + 7) / 8;
+
+	return 0;
+}
+
 #if !LELY_NO_CO_MPDO
 co_unsigned32_t
 co_sam_mpdo_up(const co_dev_t *dev, co_unsigned16_t idx, co_unsigned8_t subidx,
@@ -617,6 +814,122 @@ co_dev_cfg_pdo_map(const co_dev_t *dev, co_unsigned16_t idx,
 	return co_sub_dn_ind_val(sub_00, CO_DEFTYPE_UNSIGNED8, &par->n);
 }
 
+#if !LELY_NO_CO_RPDO
+static co_unsigned32_t
+co_sub_chk_rpdo(const co_sub_t *sub)
+{
+	assert(sub);
+
+	unsigned int access = co_sub_get_access(sub);
+	if (!(access & CO_ACCESS_WRITE))
+		return CO_SDO_AC_NO_WRITE;
+
+	if (!co_sub_get_pdo_mapping(sub) || !(access & CO_ACCESS_RPDO))
+		return CO_SDO_AC_NO_PDO;
+
+	return 0;
+}
+#endif
+
+#if !LELY_NO_CO_TPDO
+static co_unsigned32_t
+co_sub_chk_tpdo(const co_sub_t *sub)
+{
+	assert(sub);
+
+	unsigned int access = co_sub_get_access(sub);
+	if (!(access & CO_ACCESS_READ))
+		return CO_SDO_AC_NO_READ;
+
+	if (!co_sub_get_pdo_mapping(sub) || !(access & CO_ACCESS_TPDO))
+		return CO_SDO_AC_NO_PDO;
+
+	return 0;
+}
+#endif
+
+static void
+co_pdo_plan_compile(struct co_pdo_plan *plan, const struct co_pdo_map_par *par,
+		const co_dev_t *dev,
+		co_unsigned32_t (*chk)(const co_dev_t *dev, co_unsigned16_t idx,
+				co_unsigned8_t subidx))
+{
+	assert(plan);
+	assert(par);
+	assert(par->n <= CO_PDO_NUM_MAPS);
+	assert(dev);
+	assert(chk);
+
+	plan->n = 0;
+	for (size_t i = 0; i < par->n; i++) {
+		co_unsigned32_t map = par->map[i];
+		if (!map)
+			continue;
+
+		co_unsigned16_t idx = (map >> 16) & 0xffff;
+		co_unsigned8_t subidx = (map >> 8) & 0xff;
+
+		struct co_pdo_plan_ent *ent = &plan->ent[plan->n++];
+		ent->sub = co_dev_find_sub(dev, idx, subidx);
+		// The access type and PDO mapping flag of existing sub-objects
+		// are checked for every PDO.
+		ent->ac = ent->sub ? 0 : chk(dev, idx, subidx);
+		ent->len = map & 0xff;
+		ent->basic = ent->sub
+				&& co_type_is_basic(co_sub_get_type(ent->sub));
+	}
+
+	plan->valid = 1;
+#if !LELY_NO_MALLOC
+	plan->layout = co_dev_get_layout(dev);
+#endif
+}
+
+static int
+co_pdo_plan_is_valid(const struct co_pdo_plan *plan, const co_dev_t *dev)
+{
+	assert(plan);
+	assert(dev);
+
+#if LELY_NO_MALLOC
+	(void)dev;
+
+	return plan->valid;
+#else
+	return plan->valid && plan->layout == co_dev_get_layout(dev);
+#endif
+}
+
+#if !LELY_NO_CO_RPDO
+static co_unsigned32_t
+co_pdo_plan_dn_val(co_sub_t *sub, const uint_least8_t *buf, size_t nbyte)
+{
+	assert(sub);
+
+	co_unsigned16_t type = co_sub_get_type(sub);
+	assert(co_type_is_basic(type));
+
+	// Read the value and check its size.
+	union co_val val;
+	size_t size = co_val_read(type, &val, buf, buf + nbyte);
+	if (!size)
+		return CO_SDO_AC_TYPE_LEN_LO;
+	else if (size < nbyte)
+		return CO_SDO_AC_TYPE_LEN_HI;
+
+#if !LELY_NO_CO_OBJ_LIMITS
+	// Accept the value if it is within bounds.
+	co_unsigned32_t ac = co_sub_chk_val(sub, type, &val);
+	if (ac)
+		return ac;
+#endif
+
+	co_sub_dn(sub, &val);
+
+	return 0;
+}
+#endif // !LELY_NO_CO_RPDO
+
 #if !LELY_NO_CO_RPDO && !LELY_NO_CO_MPDO
 co_unsigned32_t
 co_mpdo_dn(const struct co_pdo_map_par *par, co_dev_t *dev,
@@ -0,0 +1,143 @@
+/**@file
+ * This is the internal header file of the Process Data Object (PDO)
+ * declarations.
+ *
+ * @see lely/co/pdo.h
+ *
+ * @copyright 2021 Lely Industries N.V.
+ *
+ * @author J. S. Seldenthuis <jseldenthuis@lely.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LELY_CO_INTERN_PDO_H_
+#define LELY_CO_INTERN_PDO_H_
+
+#include "co.h"
+#include <lely/co/pdo.h>
+
+/// An entry in a precompiled PDO mapping.
+struct co_pdo_plan_ent {
+	/**
+	 * A pointer to the mapped sub-object, or NULL if the entry is a dummy
+	 * entry that does not exist in the object dictionary.
+	 */
+	co_sub_t *sub;
+	/**
+	 * If #sub is NULL, the SDO abort code resulting from checking whether
+	 * the entry is a valid dummy entry, or 0 if the check succeeded. The
+	 * access type and PDO mapping flag of an existing sub-object can change
+	 * at any time, so they are checked for every PDO.
+	 */
+	co_unsigned32_t ac;
+	/// The length (in bits) of the mapped value.
+	co_unsigned8_t len;
+	/**
+	 * A flag indicating whether the value of the sub-object is of a basic
+	 * data type and can be copied directly to or from the PDO, provided no
+	 * custom indication function is installed.
+	 */
+	unsigned int basic : 1;
+};
+
+/**
+ * A precompiled PDO mapping. The plan caches the result of decoding the PDO
+ * mapping parameters and of looking up the mapped sub-objects in the object
+ * dictionary, so that these steps do not have to be repeated for every PDO. It
+ * MUST be invalidated with co_pdo_plan_clear() whenever the mapping parameters
+ * change. The plan is recompiled automatically when objects are inserted into
+ * or removed from the object dictionary. If #LELY_NO_MALLOC is defined, the
+ * object dictionary does not track such changes and the plan MUST be
+ * invalidated explicitly.
+ */
+struct co_pdo_plan {
+	/// A flag indicating whether the plan is up to date.
+	unsigned int valid : 1;
+#if !LELY_NO_MALLOC
+	/**
+	 * The layout counter of the object dictionary when the plan was
+	 * compiled (see co_dev_get_layout()).
+	 */
+	co_unsigned32_t layout;
+#endif
+	/// The number of entries in #ent.
+	co_unsigned8_t n;
+	/// An array of non-empty entries, in the order in which they are mapped.
+	struct co_pdo_plan_ent ent[CO_PDO_NUM_MAPS];
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Invalidates a precompiled PDO mapping. The plan will be recompiled the next
+ * time it is used.
+ */
+void co_pdo_plan_clear(struct co_pdo_plan *plan);
+
+#if !LELY_NO_CO_RPDO
+/**
+ * Writes mapped PDO values to the object dictionary using a precompiled PDO
+ * mapping. This function is equivalent to co_pdo_dn(), except that the mapping
+ * is (re)compiled only if <b>plan</b> is invalid and that values of basic data
+ * types are copied directly to sub-objects without a custom download
+ * indication function.
+ *
+ * @param plan a pointer to a precompiled PDO mapping.
+ * @param par  a pointer to the PDO mapping parameters.
+ * @param dev  a pointer to a CANopen device.
+ * @param req  a pointer to the CANopen SDO download request used for writing
+ *             to the object dictionary.
+ * @param buf  a pointer to the mapped values.
+ * @param n    the number of bytes at <b>buf</b>.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+co_unsigned32_t co_pdo_plan_dn(struct co_pdo_plan *plan,
+		const struct co_pdo_map_par *par, co_dev_t *dev,
+		struct co_sdo_req *req, const uint_least8_t *buf, size_t n);
+#endif
+
+#if !LELY_NO_CO_TPDO
+/**
+ * Reads mapped PDO values from the object dictionary using a precompiled PDO
+ * mapping. This function is equivalent to co_pdo_up(), except that the mapping
+ * is (re)compiled only if <b>plan</b> is invalid and that values of basic data
+ * types are copied directly from sub-objects without a custom upload
+ * indication function.
+ *
+ * @param plan a pointer to a precompiled PDO mapping.
+ * @param par  a pointer to the PDO mapping parameters.
+ * @param dev  a pointer to a CANopen device.
+ * @param req  a pointer to the CANopen SDO upload request used for reading
+ *             from the object dictionary.
+ * @param buf  the address at which to store the mapped values (can be NULL).
+ * @param pn   the address of a value containing the size (in bytes) of the
+ *             buffer at <b>buf</b>. On exit, if <b>pn</b> is not NULL,
+ *             *<b>pn</b> contains the number of bytes that would have been
+ *             written had the buffer at <b>buf</b> been sufficiently large.
+ *
+ * @returns 0 on success, or an SDO abort code on error.
+ */
+co_unsigned32_t co_pdo_plan_up(struct co_pdo_plan *plan,
+		const struct co_pdo_map_par *par, const co_dev_t *dev,
+		struct co_sdo_req *req, uint_least8_t *buf, size_t *pn);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // !LELY_CO_INTERN_PDO_H_
@@ -21,7 +21,7 @@
  * limitations under the License.
  */
 
-#include "co.h"
+#include "pdo.h"
 
 #if !LELY_NO_CO_RPDO
 
@@ -53,6 +53,8 @@ struct __co_rpdo {
 	struct co_pdo_comm_par comm;
 	/// The PDO mapping parameter.
 	struct co_pdo_map_par map;
+	/// The precompiled PDO mapping.
+	struct co_pdo_plan plan;
 	/// A pointer to the CAN frame receiver.
 	can_recv_t *recv;
 	/// A pointer to the CAN timer for deadline monitoring.
@@ -198,6 +200,7 @@ __co_rpdo_init(struct __co_rpdo *pdo, can_net_t *net, co_dev_t *dev,
 
 	memset(&pdo->comm, 0, sizeof(pdo->comm));
 	memset(&pdo->map, 0, sizeof(pdo->map));
+	co_pdo_plan_clear(&pdo->plan);
 
 	pdo->recv = can_recv_create();
 	if (!pdo->recv) {
@@ -325,6 +328,7 @@ co_rpdo_start(co_rpdo_t *pdo)
 	// Copy the PDO mapping parameter record.
 	memcpy(&pdo->map, co_obj_addressof_val(obj_1600),
 			MIN(co_obj_sizeof_val(obj_1600), sizeof(pdo->map)));
+	co_pdo_plan_clear(&pdo->plan);
 	// Set the download indication functions PDO mapping parameter record.
 	co_obj_set_dn_ind(obj_1600, &co_1600_dn_ind, pdo);
 
@@ -713,6 +717,7 @@ co_1600_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
 		}
 
 		pdo->map.n = n;
+		co_pdo_plan_clear(&pdo->plan);
 	} else {
 		assert(type == CO_DEFTYPE_UNSIGNED32);
 		co_unsigned32_t map = val.u32;
@@ -735,6 +740,7 @@ co_1600_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
 		}
 
 		pdo->map.map[co_sub_get_subidx(sub) - 1] = map;
+		co_pdo_plan_clear(&pdo->plan);
 	}
 
 	co_sub_dn(sub, &val);
@@ -808,8 +814,8 @@ co_rpdo_read_frame(co_rpdo_t *pdo, const struct can_msg *msg)
 	assert(msg);
 
 	size_t n = MIN(msg->len, CAN_MAX_LEN);
-	co_unsigned32_t ac =
-			co_pdo_dn(&pdo->map, pdo->dev, &pdo->req, msg->data, n);
+	co_unsigned32_t ac = co_pdo_plan_dn(&pdo->plan, &pdo->map, pdo->dev,
+			&pdo->req, msg->data, n);
 
 #if !defined(NDEBUG) && !LELY_NO_STDIO && !LELY_NO_DIAG
 	if (ac)
@@ -25,6 +25,7 @@
 
 #if !LELY_NO_CO_SDEV
 
+#include "obj.h"
 #include <lely/co/sdev.h>
 #include <lely/libc/stdio.h>
 #include <lely/util/errnum.h>
@@ -41,6 +42,8 @@
 #include <stdlib.h>
 #endif
 
+static struct __co_dev *co_dev_init_from_sdev(struct __co_dev *dev,
+		const struct co_sdev *sdev, size_t arena_size);
 static int co_sdev_load(const struct co_sdev *sdev, co_dev_t *dev);
 static int co_sobj_load(const struct co_sobj *sobj, co_obj_t *obj);
 static int co_ssub_load(const struct co_ssub *ssub, co_sub_t *sub);
@@ -56,56 +59,71 @@ static int snprintf_c99_esc(char *s, size_t n, const char *esc);
 struct __co_dev *
 __co_dev_init_from_sdev(struct __co_dev *dev, const struct co_sdev *sdev)
 {
-	assert(dev);
+	return co_dev_init_from_sdev(dev, sdev, 0);
+}
 
-	int errc = 0;
+co_dev_t *
+co_dev_create_from_sdev(const struct co_sdev *sdev)
+{
+	return co_dev_create_from_sdev_arena(sdev, 0);
+}
 
-	if (!sdev) {
-		errc = errnum2c(ERRNUM_INVAL);
-		goto error_param;
-	}
+co_dev_t *
+co_dev_create_from_sdev_arena(const struct co_sdev *sdev, size_t arena_size)
+{
+	int errc = 0;
 
-	if (!__co_dev_init(dev, sdev->id)) {
+	co_dev_t *dev = __co_dev_alloc();
+	if (!dev) {
 		errc = get_errc();
-		goto error_init_dev;
+		goto error_alloc_dev;
 	}
 
-	if (co_sdev_load(sdev, dev) == -1) {
+	if (!co_dev_init_from_sdev(dev, sdev, arena_size)) {
 		errc = get_errc();
-		goto error_load_sdev;
+		goto error_init_dev;
 	}
 
 	return dev;
 
-error_load_sdev:
-	__co_dev_fini(dev);
 error_init_dev:
-error_param:
+	__co_dev_free(dev);
+error_alloc_dev:
 	set_errc(errc);
 	return NULL;
 }
 
-co_dev_t *
-co_dev_create_from_sdev(const struct co_sdev *sdev)
+static struct __co_dev *
+co_dev_init_from_sdev(struct __co_dev *dev, const struct co_sdev *sdev,
+		size_t arena_size)
 {
+	assert(dev);
+
 	int errc = 0;
 
-	co_dev_t *dev = __co_dev_alloc();
-	if (!dev) {
-		errc = get_errc();
-		goto error_alloc_dev;
+	if (!sdev) {
+		errc = errnum2c(ERRNUM_INVAL);
+		goto error_param;
 	}
 
-	if (!__co_dev_init_from_sdev(dev, sdev)) {
+	if (!__co_dev_init(dev, sdev->id)) {
 		errc = get_errc();
 		goto error_init_dev;
 	}
+	// The arena has to be enabled before the first object is created.
+	co_dev_set_arena_size(dev, arena_size);
+
+	if (co_sdev_load(sdev, dev) == -1) {
+		errc = get_errc();
+		goto error_load_sdev;
+	}
 
 	return dev;
 
+error_load_sdev:
+	__co_dev_fini(dev);
 error_init_dev:
-	__co_dev_free(dev);
-error_alloc_dev:
+error_param:
 	set_errc(errc);
 	return NULL;
 }
@@ -473,7 +491,7 @@ co_sdev_load(const struct co_sdev *sdev, co_dev_t *dev)
 
 	for (size_t i = 0; i < sdev->nobj; i++) {
 		const struct co_sobj *sobj = &sdev->objs[i];
-		co_obj_t *obj = co_obj_create(sobj->idx);
+		co_obj_t *obj = co_obj_create_in(dev, sobj->idx);
 		if (!obj)
 			return -1;
 		if (co_dev_insert_obj(dev, obj) == -1) {
@@ -505,7 +523,8 @@ co_sobj_load(const struct co_sobj *sobj, co_obj_t *obj)
 
 	for (size_t i = 0; i < sobj->nsub; i++) {
 		const struct co_ssub *ssub = &sobj->subs[i];
-		co_sub_t *sub = co_sub_create(ssub->subidx, ssub->type);
+		co_sub_t *sub = co_sub_create_in(
+				co_obj_get_dev(obj), ssub->subidx, ssub->type);
 		if (!sub)
 			return -1;
 		if (co_obj_insert_sub(obj, sub) == -1) {
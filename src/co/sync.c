@@ -56,6 +56,8 @@ struct __co_sync {
 	can_timer_t *timer;
 	/// The counter value.
 	co_unsigned8_t cnt;
+	/// The time at which the last SYNC message was received or transmitted.
+	struct timespec time;
 	/// A pointer to the indication function.
 	co_sync_ind_t *ind;
 	/// A pointer to user-specified data for #ind.
@@ -171,6 +173,7 @@ __co_sync_init(struct __co_sync *sync, can_net_t *net, co_dev_t *dev)
 	can_timer_set_func(sync->timer, &co_sync_timer, sync);
 
 	sync->cnt = 1;
+	sync->time = (struct timespec){ 0, 0 };
 
 	sync->ind = NULL;
 	sync->ind_data = NULL;
@@ -333,6 +336,15 @@ co_sync_get_dev(const co_sync_t *sync)
 	return sync->dev;
 }
 
+void
+co_sync_get_time(const co_sync_t *sync, struct timespec *tp)
+{
+	assert(sync);
+
+	if (tp)
+		*tp = sync->time;
+}
+
 void
 co_sync_get_ind(const co_sync_t *sync, co_sync_ind_t **pind, void **pdata)
 {
@@ -556,6 +568,8 @@ co_sync_recv(const struct can_msg *msg, void *data)
 	if (msg->len != len && sync->err)
 		sync->err(sync, 0x8240, 0x10, sync->err_data);
 
+	can_net_get_recv_time(sync->net, &sync->time);
+
 	co_unsigned8_t cnt = len && msg->len == len ? msg->data[0] : 0;
 	if (sync->ind)
 		sync->ind(sync, cnt, sync->ind_data);
@@ -566,7 +580,7 @@ co_sync_recv(const struct can_msg *msg, void *data)
 static int
 co_sync_timer(const struct timespec *tp, void *data)
 {
-	(void)tp;
+	assert(tp);
 	co_sync_t *sync = data;
 	assert(sync);
 
@@ -584,6 +598,7 @@ co_sync_timer(const struct timespec *tp, void *data)
 		sync->cnt = sync->cnt < sync->max_cnt ? sync->cnt + 1 : 1;
 	}
 	can_net_send(sync->net, &msg);
+	sync->time = *tp;
 
 	co_unsigned8_t cnt = msg.len ? msg.data[0] : 0;
 	if (sync->ind)
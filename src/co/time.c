@@ -37,6 +37,15 @@
 #include <assert.h>
 #include <stdlib.h>
 
+/// The proportional gain of the TIME consumer servo.
+#define CO_TIME_SERVO_KP 0.7
+
+/// The integral gain of the TIME consumer servo.
+#define CO_TIME_SERVO_KI 0.3
+
+/// The maximum drift (in s/s) estimated by the TIME consumer servo.
+#define CO_TIME_SERVO_MAX_DRIFT 500e-6
+
 /// A CANopen TIME producer/consumer service.
 struct __co_time {
 	/// A pointer to a CAN network interface.
@@ -55,10 +64,41 @@ struct __co_time {
 	can_timer_t *timer;
 	/// The creation time of the service.
 	struct timespec start;
+	/// The value of the next time stamp to be sent by the producer.
+	struct timespec next;
+	/// The interval between successive time stamps.
+	struct timespec interval;
+	/// The time at which the CAN timer was set to expire for #next.
+	struct timespec sched;
+	/// The value of the most recently sent time stamp.
+	struct timespec stamp;
+	/// The time at which the CAN timer was set to expire for #stamp.
+	struct timespec expire;
+	/**
+	 * A flag indicating whether a write confirmation is pending for
+	 * #stamp.
+	 */
+	int pending;
+	/// The producer statistics.
+	struct co_time_prod_stats prod;
+	/// The value of the most recently received time stamp.
+	struct timespec last;
+	/// The offset (in nanoseconds) estimated by the servo.
+	int_least64_t offset;
+	/// The drift (in s/s) of the local clock estimated by the servo.
+	double drift;
+	/// The mean absolute prediction error (in nanoseconds) of the servo.
+	double jitter;
+	/// The consumer statistics.
+	struct co_time_cons_stats cons;
 	/// A pointer to the indication function.
 	co_time_ind_t *ind;
 	/// A pointer to user-specified data for #ind.
 	void *data;
+	/// A pointer to the clock adjustment function.
+	co_time_adj_func_t *adj_func;
+	/// A pointer to user-specified data for #adj_func.
+	void *adj_data;
 };
 
 /**
@@ -91,6 +131,30 @@ static int co_time_recv(const struct can_msg *msg, void *data);
  */
 static int co_time_timer(const struct timespec *tp, void *data);
 
+/**
+ * Starts the CAN timer of a TIME producer such that the next time stamp is
+ * written at its value, given the estimated transmit delay.
+ */
+static void co_time_sched(co_time_t *time);
+
+/**
+ * Updates the TIME consumer servo with a received time stamp and, if a clock
+ * adjustment function is set, disciplines the local clock.
+ *
+ * @param time a pointer to a TIME consumer service.
+ * @param tp   a pointer to the value of the received time stamp.
+ */
+static void co_time_servo(co_time_t *time, const struct timespec *tp);
+
+/**
+ * Returns 1 if the specified CAN frame has the CAN-ID of the TIME COB-ID, and 0
+ * if not.
+ */
+static int co_time_is_cobid(const co_time_t *time, const struct can_msg *msg);
+
+/// Rounds a time up to the next whole millisecond.
+static void co_time_ceil_msec(struct timespec *tp);
+
 void
 co_time_of_day_get(const co_time_of_day_t *tod, struct timespec *tp)
 {
@@ -198,9 +262,24 @@ __co_time_init(struct __co_time *time, can_net_t *net, co_dev_t *dev)
 	can_timer_set_func(time->timer, &co_time_timer, time);
 
 	time->start = (struct timespec){ 0, 0 };
+	time->next = (struct timespec){ 0, 0 };
+	time->interval = (struct timespec){ 0, 0 };
+	time->sched = (struct timespec){ 0, 0 };
+	time->stamp = (struct timespec){ 0, 0 };
+	time->expire = (struct timespec){ 0, 0 };
+	time->pending = 0;
+	time->prod = (struct co_time_prod_stats){ 0, 0, 0, 0 };
+
+	time->last = (struct timespec){ 0, 0 };
+	time->offset = 0;
+	time->drift = 0;
+	time->jitter = 0;
+	time->cons = (struct co_time_cons_stats){ 0, 0, 0, 0 };
 
 	time->ind = NULL;
 	time->data = NULL;
+	time->adj_func = NULL;
+	time->adj_data = NULL;
 
 	if (co_time_start(time) == -1) {
 		errc = get_errc();
@@ -356,14 +435,60 @@ co_time_set_ind(co_time_t *time, co_time_ind_t *ind, void *data)
 	time->data = data;
 }
 
+void
+co_time_get_adj_func(const co_time_t *time, co_time_adj_func_t **pfunc,
+		void **pdata)
+{
+	assert(time);
+
+	if (pfunc)
+		*pfunc = time->adj_func;
+	if (pdata)
+		*pdata = time->adj_data;
+}
+
+void
+co_time_set_adj_func(co_time_t *time, co_time_adj_func_t *func, void *data)
+{
+	assert(time);
+
+	time->adj_func = func;
+	time->adj_data = data;
+}
+
+void
+co_time_get_cons_stats(const co_time_t *time, struct co_time_cons_stats *stats)
+{
+	assert(time);
+	assert(stats);
+
+	*stats = time->cons;
+}
+
 void
 co_time_start_prod(co_time_t *time, const struct timespec *start,
 		const struct timespec *interval)
 {
 	assert(time);
 
-	if (time->cobid & CO_TIME_COBID_PRODUCER)
-		can_timer_start(time->timer, time->net, start, interval);
+	if (!(time->cobid & CO_TIME_COBID_PRODUCER))
+		return;
+
+	if (!start && !interval) {
+		co_time_stop_prod(time);
+		return;
+	}
+
+	if (start) {
+		time->next = *start;
+	} else {
+		can_net_get_time(time->net, &time->next);
+		timespec_add(&time->next, interval);
+	}
+	co_time_ceil_msec(&time->next);
+	time->interval = interval ? *interval : (struct timespec){ 0, 0 };
+
+	co_time_sched(time);
 }
 
 void
@@ -371,8 +496,50 @@ co_time_stop_prod(co_time_t *time)
 {
 	assert(time);
 
-	if (time->cobid & CO_TIME_COBID_PRODUCER)
+	if (time->cobid & CO_TIME_COBID_PRODUCER) {
 		can_timer_stop(time->timer);
+		time->interval = (struct timespec){ 0, 0 };
+		time->pending = 0;
+	}
+}
+
+void
+co_time_confirm(co_time_t *time, const struct can_msg *msg,
+		const struct timespec *tp)
+{
+	assert(time);
+	assert(msg);
+	assert(tp);
+
+	if (!time->pending || !co_time_is_cobid(time, msg))
+		return;
+	time->pending = 0;
+
+	// Update the estimated delay between the expiration of the timer and
+	// the write confirmation with an exponential moving average.
+	int_least64_t delay = MAX(timespec_diff_nsec(tp, &time->expire), 0);
+	if (time->prod.n)
+		time->prod.delay += (delay - time->prod.delay) / 4;
+	else
+		time->prod.delay = delay;
+
+	int_least64_t error = timespec_diff_nsec(tp, &time->stamp);
+	time->prod.n++;
+	time->prod.error = error;
+	time->prod.error_max = MAX(time->prod.error_max, MAX(error, -error));
+
+	// Reschedule the next time stamp with the updated delay.
+	if (time->interval.tv_sec || time->interval.tv_nsec)
+		co_time_sched(time);
+}
+
+void
+co_time_get_prod_stats(const co_time_t *time, struct co_time_prod_stats *stats)
+{
+	assert(time);
+	assert(stats);
+
+	*stats = time->prod;
 }
 
 static void
@@ -478,6 +645,8 @@ co_time_recv(const struct can_msg *msg, void *data)
 	struct timespec tv;
 	co_time_of_day_get(&tod, &tv);
 
+	co_time_servo(time, &tv);
+
 	if (time->ind)
 		time->ind(time, &tv, time->data);
 
@@ -487,19 +656,25 @@ co_time_recv(const struct can_msg *msg, void *data)
 static int
 co_time_timer(const struct timespec *tp, void *data)
 {
-	assert(tp);
+	(void)tp;
 	co_time_t *time = data;
 	assert(time);
 
+	// The time stamp contains the time at which it is expected to be
+	// written, not the time at which the timer expired.
+	time->stamp = time->next;
+	time->expire = time->sched;
+	time->pending = 1;
+
 	// Update the high-resolution time stamp, if it exists.
 	if (time->sub_1013_00)
 		co_sub_set_val_u32(time->sub_1013_00,
 				(co_unsigned32_t)timespec_diff_usec(
-						tp, &time->start));
+						&time->stamp, &time->start));
 
 	// Convert the time to a TIME_OF_DAY value.
 	co_time_of_day_t tod = { 0, 0 };
-	co_time_of_day_set(&tod, tp);
+	co_time_of_day_set(&tod, &time->stamp);
 
 	struct can_msg msg = CAN_MSG_INIT;
 	msg.id = time->cobid;
@@ -514,7 +689,94 @@ co_time_timer(const struct timespec *tp, void *data)
 	stle_u16(msg.data + 4, tod.days);
 	can_net_send(time->net, &msg);
 
+	// Schedule the next time stamp, if any.
+	if (time->interval.tv_sec || time->interval.tv_nsec) {
+		timespec_add(&time->next, &time->interval);
+		co_time_ceil_msec(&time->next);
+		co_time_sched(time);
+	}
+
 	return 0;
 }
 
+static void
+co_time_sched(co_time_t *time)
+{
+	assert(time);
+
+	time->sched = time->next;
+	timespec_sub_nsec(&time->sched, time->prod.delay);
+	can_timer_start(time->timer, time->net, &time->sched, NULL);
+}
+
+static void
+co_time_servo(co_time_t *time, const struct timespec *tp)
+{
+	assert(time);
+	assert(tp);
+
+	// The measured offset of the local clock at the reception of the time
+	// stamp.
+	struct timespec now = { 0, 0 };
+	can_net_get_recv_time(time->net, &now);
+	int_least64_t offset = timespec_diff_nsec(&now, tp);
+
+	int_least64_t dt = timespec_diff_nsec(tp, &time->last);
+	time->last = *tp;
+	if (!time->cons.n || dt <= 0) {
+		// (Re)initialize the servo with the measured offset.
+		time->offset = offset;
+		time->drift = 0;
+		time->jitter = 0;
+	} else {
+		// Predict the offset from the estimated drift and update both
+		// with the prediction error.
+		int_least64_t pred = time->offset
+				+ (int_least64_t)(time->drift * dt);
+		int_least64_t error = offset - pred;
+		time->offset = pred + (int_least64_t)(CO_TIME_SERVO_KP * error);
+		time->drift += CO_TIME_SERVO_KI * error / dt;
+		time->drift = MAX(-CO_TIME_SERVO_MAX_DRIFT,
+				MIN(time->drift, CO_TIME_SERVO_MAX_DRIFT));
+		time->jitter += ((error < 0 ? -error : error) - time->jitter)
+				/ 16;
+	}
+
+	time->cons.n++;
+	time->cons.offset = time->offset;
+	time->cons.drift = (int_least32_t)(time->drift * 1e9);
+	time->cons.jitter = (int_least64_t)time->jitter;
+
+	// Discipline the local clock, if possible. Once the clock is corrected,
+	// the servo predicts the remaining offset from the drift only.
+	if (time->adj_func) {
+		time->adj_func(time, -time->offset, time->adj_data);
+		time->offset = 0;
+	}
+}
+
+static int
+co_time_is_cobid(const co_time_t *time, const struct can_msg *msg)
+{
+	assert(time);
+	assert(msg);
+
+	if (time->cobid & CO_TIME_COBID_FRAME)
+		return (msg->flags & CAN_FLAG_IDE)
+				&& msg->id == (time->cobid & CAN_MASK_EID);
+	else
+		return !(msg->flags & CAN_FLAG_IDE)
+				&& msg->id == (time->cobid & CAN_MASK_BID);
+}
+
+static void
+co_time_ceil_msec(struct timespec *tp)
+{
+	assert(tp);
+
+	long rem = tp->tv_nsec % 1000000;
+	if (rem)
+		timespec_add_nsec(tp, 1000000 - rem);
+}
+
 #endif // !LELY_NO_CO_TIME
@@ -30,7 +30,7 @@
  * limitations under the License.
  */
 
-#include "co.h"
+#include "pdo.h"
 
 #if !LELY_NO_CO_TPDO
 
@@ -65,6 +65,8 @@ struct __co_tpdo {
 	struct co_pdo_comm_par comm;
 	/// The PDO mapping parameter.
 	struct co_pdo_map_par map;
+	/// The precompiled PDO mapping.
+	struct co_pdo_plan plan;
 	/// A pointer to the CAN frame receiver.
 	can_recv_t *recv;
 	/// A pointer to the CAN timer for events.
@@ -228,6 +230,7 @@ __co_tpdo_init(struct __co_tpdo *pdo, can_net_t *net, co_dev_t *dev,
 
 	memset(&pdo->comm, 0, sizeof(pdo->comm));
 	memset(&pdo->map, 0, sizeof(pdo->map));
+	co_pdo_plan_clear(&pdo->plan);
 
 	pdo->recv = can_recv_create();
 	if (!pdo->recv) {
@@ -360,6 +363,7 @@ co_tpdo_start(co_tpdo_t *pdo)
 	// Copy the PDO mapping parameter record.
 	memcpy(&pdo->map, co_obj_addressof_val(obj_1a00),
 			MIN(co_obj_sizeof_val(obj_1a00), sizeof(pdo->map)));
+	co_pdo_plan_clear(&pdo->plan);
 	// Set the download indication functions PDO mapping parameter record.
 	co_obj_set_dn_ind(obj_1a00, &co_1a00_dn_ind, pdo);
 
@@ -1038,6 +1042,7 @@ co_1a00_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
 		}
 
 		pdo->map.n = n;
+		co_pdo_plan_clear(&pdo->plan);
 	} else {
 		assert(type == CO_DEFTYPE_UNSIGNED32);
 		co_unsigned32_t map = val.u32;
@@ -1061,6 +1066,7 @@ co_1a00_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
 		}
 
 		pdo->map.map[co_sub_get_subidx(sub) - 1] = map;
+		co_pdo_plan_clear(&pdo->plan);
 	}
 
 	co_sub_dn(sub, &val);
@@ -1155,8 +1161,8 @@ co_tpdo_init_frame(co_tpdo_t *pdo, struct can_msg *msg)
 	}
 
 	size_t n = CAN_MAX_LEN;
-	co_unsigned32_t ac = co_pdo_up(
-			&pdo->map, pdo->dev, &pdo->req, msg->data, &n);
+	co_unsigned32_t ac = co_pdo_plan_up(&pdo->plan, &pdo->map, pdo->dev,
+			&pdo->req, msg->data, &n);
 	if (ac) {
 		if (pdo->ind)
 			pdo->ind(pdo, ac, NULL, 0, pdo->data);
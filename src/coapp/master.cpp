@@ -27,10 +27,12 @@
 
 #include <lely/co/dev.h>
 #include <lely/co/nmt.h>
+#include <lely/co/val.h>
 #include <lely/coapp/driver.hpp>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -253,6 +255,91 @@ BasicMaster::AsyncWriteDcf(ev_exec_t* exec, uint8_t id, const char* path,
   }
 }
 
+namespace {
+
+/// Checks the size of the value of an SDO batch entry against its data type.
+::std::error_code
+SdoBatchCheck(const SdoBatchEntry& entry) {
+  if (!entry.type || !co_type_is_basic(entry.type)) return {};
+
+  co_val val;
+  co_val_init(entry.type, &val);
+  auto n = co_val_write(entry.type, &val, nullptr, nullptr);
+  if (entry.value.size() > n) return SdoErrc::TYPE_LEN_HI;
+  if (entry.value.size() < n) return SdoErrc::TYPE_LEN_LO;
+  return {};
+}
+
+}  // namespace
+
+SdoFuture<::std::vector<SdoBatchEntry>>
+BasicMaster::AsyncBatch(ev_exec_t* exec, ::std::vector<SdoBatchEntry> batch,
+                        const ::std::chrono::milliseconds& timeout) {
+  if (!exec) exec = GetExecutor();
+
+  // The state shared by the confirmation functions of the requests. The
+  // completion counter includes one extra reference, which is released once
+  // all requests have been submitted.
+  struct State {
+    ::std::vector<SdoBatchEntry> batch;
+    ::std::atomic<::std::size_t> n{0};
+    SdoPromise<::std::vector<SdoBatchEntry>> p;
+
+    void
+    Done() {
+      if (n.fetch_sub(1, ::std::memory_order_acq_rel) == 1)
+        p.set(util::success(::std::move(batch)));
+    }
+  };
+  auto state = ::std::make_shared<State>();
+  state->batch = ::std::move(batch);
+  state->n.store(state->batch.size() + 1, ::std::memory_order_relaxed);
+  auto f = state->p.get_future();
+
+  {
+    ::std::lock_guard<BasicLockable> lock(*this);
+
+    SetTime();
+    for (::std::size_t i = 0; i < state->batch.size(); i++) {
+      auto& entry = state->batch[i];
+      entry.ec.clear();
+
+      auto sdo = entry.id && entry.id <= 0x7f ? GetSdo(entry.id) : nullptr;
+      if (!sdo) {
+        entry.ec = SdoErrc::NO_SDO;
+        state->Done();
+      } else if (entry.write) {
+        if ((entry.ec = SdoBatchCheck(entry))) {
+          state->Done();
+          continue;
+        }
+        sdo->SubmitDownload(
+            exec, entry.idx, entry.subidx, entry.value,
+            [state, i](uint8_t, uint16_t, uint8_t, ::std::error_code ec) {
+              state->batch[i].ec = ec;
+              state->Done();
+            },
+            false, timeout);
+      } else {
+        sdo->SubmitUpload<::std::vector<uint8_t>>(
+            exec, entry.idx, entry.subidx,
+            [state, i](uint8_t, uint16_t, uint8_t, ::std::error_code ec,
+                       ::std::vector<uint8_t> value) {
+              auto& entry = state->batch[i];
+              entry.value = ::std::move(value);
+              if (!ec) ec = SdoBatchCheck(entry);
+              entry.ec = ec;
+              state->Done();
+            },
+            false, timeout);
+      }
+    }
+  }
+
+  state->Done();
+  return f;
+}
+
 void
 BasicMaster::Insert(DriverBase& driver) {
   ::std::lock_guard<util::BasicLockable> lock(*this);
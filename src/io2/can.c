@@ -23,7 +23,9 @@
 
 #include "io2.h"
 #define LELY_IO_CAN_INLINE extern inline
+#include <lely/ev/exec.h>
 #include <lely/io2/can.h>
+#include <lely/util/errnum.h>
 #include <lely/util/util.h>
 
 #include <assert.h>
@@ -42,6 +44,54 @@ struct io_can_chan_async_write {
 
 static void io_can_chan_async_write_func(struct ev_task *task);
 
+static void io_can_chan_write_vec_func(struct ev_task *task);
+
+void
+io_can_chan_submit_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write)
+{
+	assert(chan);
+	assert(write);
+	assert(write->msgs || !write->nmsgs);
+
+	if ((*chan)->submit_write_vec) {
+		(*chan)->submit_write_vec(chan, write);
+		return;
+	}
+
+	// Emulate the vectored write operation with single-frame write
+	// operations. The completion task of each write operation submits the
+	// next one.
+	struct ev_task *task = &write->task;
+	if (!task->exec)
+		task->exec = io_dev_get_exec(io_can_chan_get_dev(chan));
+	assert(task->exec);
+
+	write->n = 0;
+	write->errc = 0;
+	write->_chan = chan;
+	write->_write = (struct io_can_chan_write)IO_CAN_CHAN_WRITE_INIT(
+			write->msgs, task->exec, &io_can_chan_write_vec_func);
+
+	if (write->nmsgs) {
+		io_can_chan_submit_write(chan, &write->_write);
+	} else {
+		ev_exec_on_task_init(task->exec);
+		ev_exec_post(task->exec, task);
+		ev_exec_on_task_fini(task->exec);
+	}
+}
+
+size_t
+io_can_chan_abort_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write)
+{
+	assert(write);
+
+	return io_can_chan_abort(chan, &write->task)
+			+ io_can_chan_abort(chan, &write->_write.task);
+}
+
 ev_future_t *
 io_can_chan_async_read(io_can_chan_t *chan, ev_exec_t *exec,
 		struct can_msg *msg, struct can_err *err, struct timespec *tp,
@@ -89,6 +139,20 @@ io_can_chan_async_write(io_can_chan_t *chan, ev_exec_t *exec,
 	return future;
 }
 
+int
+io_can_chan_set_filter(io_can_chan_t *chan,
+		const struct can_net_filter *filters, size_t n)
+{
+	assert(chan);
+
+	if (!(*chan)->set_filter) {
+		set_errnum(ERRNUM_NOSYS);
+		return -1;
+	}
+
+	return (*chan)->set_filter(chan, filters, n);
+}
+
 struct io_can_chan_read *
 io_can_chan_read_from_task(struct ev_task *task)
 {
@@ -101,6 +165,12 @@ io_can_chan_write_from_task(struct ev_task *task)
 	return task ? structof(task, struct io_can_chan_write, task) : NULL;
 }
 
+struct io_can_chan_write_vec *
+io_can_chan_write_vec_from_task(struct ev_task *task)
+{
+	return task ? structof(task, struct io_can_chan_write_vec, task) : NULL;
+}
+
 static void
 io_can_chan_async_read_func(struct ev_task *task)
 {
@@ -124,3 +194,24 @@ io_can_chan_async_write_func(struct ev_task *task)
 	ev_promise_set(async_write->promise, &write->errc);
 	ev_promise_release(async_write->promise);
 }
+
+static void
+io_can_chan_write_vec_func(struct ev_task *task)
+{
+	assert(task);
+	struct io_can_chan_write *write_ = io_can_chan_write_from_task(task);
+	struct io_can_chan_write_vec *write =
+			structof(write_, struct io_can_chan_write_vec, _write);
+
+	// Submit the next frame, if any, unless an error occurred.
+	if (!write_->errc && ++write->n < write->nmsgs) {
+		write_->msg = &write->msgs[write->n];
+		io_can_chan_submit_write(write->_chan, write_);
+		return;
+	}
+
+	write->errc = write_->errc;
+	// The completion task is invoked from the same executor, so we do not
+	// have to keep the executor alive with ev_exec_on_task_init().
+	ev_exec_post(write->task.exec, &write->task);
+}
@@ -26,8 +26,13 @@
 #if !LELY_NO_MALLOC
 
 #include <lely/can/net.h>
+#include <lely/ev/exec.h>
+#include <lely/ev/task.h>
 #include <lely/io2/can_net.h>
 #include <lely/io2/ctx.h>
+#if !LELY_NO_THREADS
+#include <lely/libc/stdatomic.h>
+#endif
 #include <lely/libc/stdlib.h>
 #if !LELY_NO_THREADS
 #include <lely/libc/threads.h>
@@ -42,11 +47,21 @@
 #ifndef LELY_IO_CAN_NET_TXLEN
 /**
  * The default length (in number of CAN frames) of the user-space transmit queue
- * of a CAN network interface.
+ * of each priority class of a CAN network interface.
  */
 #define LELY_IO_CAN_NET_TXLEN 1000
 #endif
 
+#ifndef LELY_IO_CAN_NET_TXBURST
+/**
+ * The maximum number of CAN frames of a priority class other than
+ * #IO_CAN_NET_CLASS_NMT written by a CAN network interface in a single write
+ * operation. This bounds the time a high-priority frame has to wait for a burst
+ * of low-priority frames.
+ */
+#define LELY_IO_CAN_NET_TXBURST 8
+#endif
+
 #ifndef LELY_IO_CAN_NET_TXTIMEO
 /**
  * The default timeout (in milliseconds) of a CAN network interface when waiting
@@ -55,6 +70,23 @@
 #define LELY_IO_CAN_NET_TXTIMEO 100
 #endif
 
+#ifndef LELY_IO_CAN_NET_RXAGE
+/**
+ * The maximum age (in milliseconds) of a received CAN frame, according to its
+ * receive timestamp, before the timestamp is considered invalid and replaced by
+ * the current time.
+ */
+#define LELY_IO_CAN_NET_RXAGE 1000
+#endif
+
+#ifndef LELY_IO_CAN_NET_FILTER_INTERVAL
+/**
+ * The default minimum interval (in milliseconds) between two updates of the CAN
+ * identifier filters of a CAN network interface.
+ */
+#define LELY_IO_CAN_NET_FILTER_INTERVAL 100
+#endif
+
 static void io_can_net_svc_shutdown(struct io_svc *svc);
 
 // clang-format off
@@ -64,6 +96,73 @@ static const struct io_svc_vtbl io_can_net_svc_vtbl = {
 };
 // clang-format on
 
+#if LELY_NO_THREADS
+/// The type of the statistics counters of a CAN network interface.
+typedef size_t io_can_net_cnt_t;
+#else
+/**
+ * The type of the statistics counters of a CAN network interface. Each counter
+ * has a single writer (protected by a mutex) and can be read concurrently
+ * without locking.
+ */
+typedef atomic_size_t io_can_net_cnt_t;
+#endif
+
+/// The statistics counters of a CAN network interface.
+struct io_can_net_cnt {
+	io_can_net_cnt_t rx_frames;
+	io_can_net_cnt_t rx_bits;
+	io_can_net_cnt_t rx_errors;
+	/// This counter is protected by #io_can_net::rx_mtx.
+	io_can_net_cnt_t rx_queue_max;
+	io_can_net_cnt_t tx_frames;
+	io_can_net_cnt_t tx_bits;
+	io_can_net_cnt_t tx_errors;
+	io_can_net_cnt_t tx_dropped;
+	io_can_net_cnt_t tx_queue_max;
+	io_can_net_cnt_t tx_class_depth[IO_CAN_NET_NCLASS];
+	io_can_net_cnt_t tx_class_max[IO_CAN_NET_NCLASS];
+	io_can_net_cnt_t rx_latency[IO_CAN_NET_NHIST];
+	io_can_net_cnt_t tx_latency[IO_CAN_NET_NHIST];
+};
+
+static void io_can_net_cnt_init(io_can_net_cnt_t *cnt);
+static inline size_t io_can_net_cnt_get(const io_can_net_cnt_t *cnt);
+static inline void io_can_net_cnt_set(io_can_net_cnt_t *cnt, size_t n);
+static inline void io_can_net_cnt_add(io_can_net_cnt_t *cnt, size_t n);
+static inline void io_can_net_cnt_max(io_can_net_cnt_t *cnt, size_t n);
+
+/**
+ * Adds the time between <b>t0</b> and <b>t1</b> to the specified latency
+ * histogram.
+ */
+static void io_can_net_hist_add(io_can_net_cnt_t *hist,
+		const struct timespec *t0, const struct timespec *t1);
+
+/// The transmit queue of a single priority class of a CAN network interface.
+struct io_can_net_txq {
+	/// The ring buffer used to control the queue.
+	struct spscring ring;
+	/// The queued frames.
+	struct can_msg *buf;
+	/// The times at which the frames in #buf were queued.
+	struct timespec *time;
+};
+
+/// An entry in the receive queue of a CAN network interface.
+struct io_can_net_rx {
+	/// The CAN frame.
+	struct can_msg msg;
+	/// The CAN error frame.
+	struct can_err err;
+	/// The system time at which the CAN frame was received.
+	struct timespec tp;
+	/// The result of the read operation.
+	int result;
+	/// The error code of the read operation.
+	int errc;
+};
+
 /// The implementation of a CAN network interface.
 struct io_can_net {
 	/// The I/O service representing the channel.
@@ -91,6 +190,8 @@ struct io_can_net {
 	struct can_msg read_msg;
 	/// The CAN error frame being read.
 	struct can_err read_err;
+	/// The system time at which the CAN frame being read was received.
+	struct timespec read_tp;
 	/// The operation used to read CAN frames.
 	struct io_can_chan_read read;
 	/// The error code of the last read operation.
@@ -99,20 +200,54 @@ struct io_can_net {
 	size_t read_errcnt;
 	/// The current state of the CAN bus.
 	int state;
-	/// The CAN frame being written.
-	struct can_msg write_msg;
-	/// The operation used to write CAN frames.
-	struct io_can_chan_write write;
+	/**
+	 * The operation used to write CAN frames. The frames are written
+	 * directly from the transmit queue, as many at a time as are stored
+	 * consecutively.
+	 */
+	struct io_can_chan_write_vec write;
 	/// The error code of the last write operation.
 	int write_errc;
 	/// The number of errors since the last successful write operation.
 	size_t write_errcnt;
-	/// The ring buffer used to control the transmit queue.
-	struct spscring tx_ring;
-	/// The transmit queue.
+	/**
+	 * The receive queue, or NULL if received CAN frames are processed
+	 * directly by the read operation.
+	 */
+	struct io_can_net_rx *rx_buf;
+	/// The ring buffer used to control the receive queue.
+	struct spscring rx_ring;
+	/// The index in #rx_buf of the entry being read.
+	size_t rx_i;
+	/// The task used to process the frames in the receive queue.
+	struct ev_task rx_task;
+#if !LELY_NO_THREADS
+	/**
+	 * The mutex protecting the producer side of the receive queue and the
+	 * flags below. It is never held while processing frames, so the reader
+	 * does not have to wait for the CAN network interface.
+	 */
+	mtx_t rx_mtx;
+#endif
+	/**
+	 * A flag indicating whether #read has been submitted to #chan, or is
+	 * waiting for room in the receive queue.
+	 */
+	unsigned rx_submitted : 1;
+	/// A copy of #shutdown for the producer side of the receive queue.
+	unsigned rx_shutdown : 1;
+	/// The transmit queues, one for each priority class.
+	struct io_can_net_txq txq[IO_CAN_NET_NCLASS];
+	/// The storage for the frames in #txq.
 	struct can_msg *tx_buf;
+	/// The storage for the times at which the frames in #txq were queued.
+	struct timespec *tx_time;
+	/// The priority class of the frames being written by #write.
+	int tx_class;
 	/// The number of frames dropped due to the transmit queue being full.
 	size_t tx_errcnt;
+	/// The statistics counters.
+	struct io_can_net_cnt cnt;
 #if !LELY_NO_THREADS
 	/**
 	 * The mutex protecting the callbacks, flags and internal CAN network
@@ -136,6 +271,13 @@ struct io_can_net {
 	io_can_net_on_error_func_t *on_queue_error_func;
 	/// The user-specified argument for #on_queue_error_func.
 	void *on_queue_error_arg;
+	/**
+	 * A pointer to the function used to determine the priority class of a
+	 * CAN frame.
+	 */
+	io_can_net_tx_class_func_t *tx_class_func;
+	/// The user-specified argument for #tx_class_func.
+	void *tx_class_arg;
 	/**
 	 * A pointer to the function invoked when a new CAN frame write error
 	 * occurs, or when a write operation completes successfully after one or
@@ -144,6 +286,13 @@ struct io_can_net {
 	io_can_net_on_error_func_t *on_write_error_func;
 	/// The user-specified argument for #on_write_error_func.
 	void *on_write_error_arg;
+	/**
+	 * A pointer to the function invoked when a CAN frame is written
+	 * successfully.
+	 */
+	io_can_net_on_confirm_func_t *on_confirm_func;
+	/// The user-specified argument for #on_confirm_func.
+	void *on_confirm_arg;
 	/**
 	 * A pointer to the function to be invoked when a CAN bus state change
 	 * is detected.
@@ -170,21 +319,119 @@ struct io_can_net {
 	unsigned read_submitted : 1;
 	/// A flag indicating whether #write has been submitted to #chan.
 	unsigned write_submitted : 1;
+	/**
+	 * A flag indicating whether the CAN network interface is waiting for
+	 * frames to be put into the transmit queue.
+	 */
+	unsigned tx_wait : 1;
+	/**
+	 * A flag indicating whether #rx_task has been submitted to #exec or is
+	 * waiting for frames to be put into the receive queue.
+	 */
+	unsigned rx_wait_submitted : 1;
 	/// A pointer to the internal CAN network interface.
 	can_net_t *net;
 	/// The time at which the next CAN timer will trigger.
 	struct timespec next;
+	/**
+	 * The maximum number of CAN identifier filters, or 0 if filtering is
+	 * disabled.
+	 */
+	size_t nfilter;
+	/// The minimum interval (in milliseconds) between two filter updates.
+	int filter_interval;
+	/// The CAN timer used to schedule filter updates.
+	can_timer_t *filter_timer;
+	/// The time at which the filters were last updated.
+	struct timespec filter_time;
+	/// The buffer used to compute the filters.
+	struct can_net_filter *filters;
+	/// The number of filters for which space has been allocated.
+	size_t maxfilters;
+	/// The number of installed filters at the start of #filters.
+	size_t nfilters;
+	/// A flag indicating whether a filter update has been scheduled.
+	unsigned filter_pending : 1;
 };
 
 static void io_can_net_wait_next_func(struct ev_task *task);
 static void io_can_net_wait_confirm_func(struct ev_task *task);
 static void io_can_net_read_func(struct ev_task *task);
+
+/**
+ * Completes a read operation when the receive queue is used. This function
+ * stores the result in the receive queue and submits the next read operation,
+ * without locking the mutex protecting the CAN network interface.
+ */
+static void io_can_net_rx_read_func(io_can_net_t *net);
+
+/**
+ * Prepares the next read operation to store its result in the receive queue.
+ * This function MUST be invoked with #rx_mtx locked.
+ *
+ * @returns 1 if the read operation can be submitted, and 0 if not. In the latter
+ * case, the operation is submitted once the consumer makes room in the queue,
+ * unless the CAN network interface is shut down.
+ */
+static int io_can_net_rx_do_alloc(io_can_net_t *net);
+
+static void io_can_net_rx_p_wait_func(struct spscring *ring, void *arg);
+static void io_can_net_rx_c_wait_func(struct spscring *ring, void *arg);
+static void io_can_net_rx_task_func(struct ev_task *task);
+
+/**
+ * Processes the result of a read operation. This function MUST be invoked with
+ * the mutex locked.
+ */
+static void io_can_net_do_read(io_can_net_t *net, int result, int errc,
+		const struct can_msg *msg, const struct can_err *err,
+		const struct timespec *ts);
+
+/**
+ * Converts the receive timestamp of a CAN frame to the clock used by a CAN
+ * network interface. The timestamp reported by a CAN channel is taken either
+ * from the same clock as the network interface (e.g., for virtual CAN
+ * channels), or from the system clock. In the latter case, the age of the frame
+ * is subtracted from the current time of the network interface.
+ *
+ * @returns 0 on success, or -1 if the timestamp is not available or invalid.
+ */
+static int io_can_net_read_time(io_can_net_t *net, const struct timespec *ts,
+		struct timespec *tp);
 static void io_can_net_write_func(struct ev_task *task);
 
+/**
+ * Updates the statistics after a write operation. This function MUST be invoked
+ * with the mutex locked.
+ *
+ * @param net   a pointer to a CAN network interface.
+ * @param nmsgs the number of frames successfully written.
+ * @param n     the number of frames removed from the transmit queue.
+ */
+static void io_can_net_write_stats(io_can_net_t *net, size_t nmsgs, size_t n);
+
 static int io_can_net_next_func(const struct timespec *tp, void *data);
 static int io_can_net_send_func(const struct can_msg *msg, void *data);
+static void io_can_net_filter_func(
+		const struct can_net_filter *filter, int add, void *data);
+static int io_can_net_filter_timer(const struct timespec *tp, void *data);
+
+/**
+ * Computes the CAN identifier filters from the registered receivers and
+ * installs them in the CAN channel. This function MUST be invoked with the mutex
+ * locked.
+ *
+ * @returns 0 on success, or -1 on error. In the latter case, the error number
+ * can be obtained with get_errc().
+ */
+static int io_can_net_do_filter(io_can_net_t *net);
 
-static void io_can_net_c_wait_func(struct spscring *ring, void *arg);
+/**
+ * Returns 1 if the filters installed in the CAN channel accept all CAN
+ * identifiers matching the specified filter, and 0 if not.
+ */
+static int io_can_net_filter_covers(
+		const io_can_net_t *net, const struct can_net_filter *filter);
 
 static inline io_can_net_t *io_can_net_from_svc(const struct io_svc *svc);
 
@@ -198,6 +445,7 @@ static void default_on_queue_error_func(int errc, size_t errcnt, void *arg);
 static void default_on_write_error_func(int errc, size_t errcnt, void *arg);
 static void default_on_can_state_func(int new_state, int old_state, void *arg);
 static void default_on_can_error_func(int error, void *arg);
+static int default_tx_class_func(const struct can_msg *msg, void *arg);
 
 void *
 io_can_net_alloc(void)
@@ -256,28 +504,74 @@ io_can_net_init(io_can_net_t *net, ev_exec_t *exec, io_timer_t *timer,
 
 	net->read_msg = (struct can_msg)CAN_MSG_INIT;
 	net->read_err = (struct can_err)CAN_ERR_INIT;
+	net->read_tp = (struct timespec){ 0, 0 };
 	net->read = (struct io_can_chan_read)IO_CAN_CHAN_READ_INIT(
-			&net->read_msg, &net->read_err, NULL, NULL,
+			&net->read_msg, &net->read_err, &net->read_tp, NULL,
 			&io_can_net_read_func);
 	net->read_errc = 0;
 	net->read_errcnt = 0;
 
 	net->state = CAN_STATE_ACTIVE;
 
-	net->write_msg = (struct can_msg)CAN_MSG_INIT;
-	net->write = (struct io_can_chan_write)IO_CAN_CHAN_WRITE_INIT(
-			&net->write_msg, NULL, &io_can_net_write_func);
+	net->write = (struct io_can_chan_write_vec)IO_CAN_CHAN_WRITE_VEC_INIT(
+			NULL, 0, NULL, &io_can_net_write_func);
 	net->write_errc = 0;
 	net->write_errcnt = 0;
 
-	spscring_init(&net->tx_ring, txlen);
-	net->tx_buf = calloc(txlen, sizeof(struct can_msg));
+	net->rx_buf = NULL;
+	spscring_init(&net->rx_ring, 1);
+	net->rx_i = 0;
+	net->rx_task = (struct ev_task)EV_TASK_INIT(
+			net->exec, &io_can_net_rx_task_func);
+#if !LELY_NO_THREADS
+	if (mtx_init(&net->rx_mtx, mtx_plain) != thrd_success) {
+		errc = get_errc();
+		goto error_init_rx_mtx;
+	}
+#endif
+	net->rx_submitted = 0;
+	net->rx_shutdown = 0;
+
+	net->tx_buf = calloc(txlen, IO_CAN_NET_NCLASS * sizeof(struct can_msg));
 	if (!net->tx_buf) {
 		errc = get_errc();
 		goto error_alloc_tx_buf;
 	}
+	// clang-format off
+	net->tx_time = calloc(txlen,
+			IO_CAN_NET_NCLASS * sizeof(struct timespec));
+	// clang-format on
+	if (!net->tx_time) {
+		errc = get_errc();
+		goto error_alloc_tx_time;
+	}
+	for (int i = 0; i < IO_CAN_NET_NCLASS; i++) {
+		struct io_can_net_txq *txq = &net->txq[i];
+		spscring_init(&txq->ring, txlen);
+		txq->buf = net->tx_buf + i * txlen;
+		txq->time = net->tx_time + i * txlen;
+	}
+	net->tx_class = 0;
 	net->tx_errcnt = 0;
 
+	io_can_net_cnt_init(&net->cnt.rx_frames);
+	io_can_net_cnt_init(&net->cnt.rx_bits);
+	io_can_net_cnt_init(&net->cnt.rx_errors);
+	io_can_net_cnt_init(&net->cnt.rx_queue_max);
+	io_can_net_cnt_init(&net->cnt.tx_frames);
+	io_can_net_cnt_init(&net->cnt.tx_bits);
+	io_can_net_cnt_init(&net->cnt.tx_errors);
+	io_can_net_cnt_init(&net->cnt.tx_dropped);
+	io_can_net_cnt_init(&net->cnt.tx_queue_max);
+	for (int i = 0; i < IO_CAN_NET_NCLASS; i++) {
+		io_can_net_cnt_init(&net->cnt.tx_class_depth[i]);
+		io_can_net_cnt_init(&net->cnt.tx_class_max[i]);
+	}
+	for (int i = 0; i < IO_CAN_NET_NHIST; i++) {
+		io_can_net_cnt_init(&net->cnt.rx_latency[i]);
+		io_can_net_cnt_init(&net->cnt.tx_latency[i]);
+	}
+
 #if !LELY_NO_THREADS
 	if (mtx_init(&net->mtx, mtx_plain) != thrd_success) {
 		errc = get_errc();
@@ -289,8 +583,12 @@ io_can_net_init(io_can_net_t *net, ev_exec_t *exec, io_timer_t *timer,
 	net->on_read_error_arg = NULL;
 	net->on_queue_error_func = &default_on_queue_error_func;
 	net->on_queue_error_arg = NULL;
+	net->tx_class_func = &default_tx_class_func;
+	net->tx_class_arg = NULL;
 	net->on_write_error_func = &default_on_write_error_func;
 	net->on_write_error_arg = NULL;
+	net->on_confirm_func = NULL;
+	net->on_confirm_arg = NULL;
 	net->on_can_state_func = &default_on_can_state_func;
 	net->on_can_state_arg = NULL;
 	net->on_can_error_func = &default_on_can_error_func;
@@ -302,6 +600,8 @@ io_can_net_init(io_can_net_t *net, ev_exec_t *exec, io_timer_t *timer,
 	net->wait_confirm_submitted = 0;
 	net->read_submitted = 0;
 	net->write_submitted = 0;
+	net->tx_wait = 0;
+	net->rx_wait_submitted = 0;
 
 	if (!(net->net = can_net_create())) {
 		errc = get_errc();
@@ -309,6 +609,19 @@ io_can_net_init(io_can_net_t *net, ev_exec_t *exec, io_timer_t *timer,
 	}
 	net->next = (struct timespec){ 0, 0 };
 
+	net->nfilter = 0;
+	net->filter_interval = LELY_IO_CAN_NET_FILTER_INTERVAL;
+	if (!(net->filter_timer = can_timer_create())) {
+		errc = get_errc();
+		goto error_create_filter_timer;
+	}
+	can_timer_set_func(net->filter_timer, &io_can_net_filter_timer, net);
+	net->filter_time = (struct timespec){ 0, 0 };
+	net->filters = NULL;
+	net->maxfilters = 0;
+	net->nfilters = 0;
+	net->filter_pending = 0;
+
 	// Initialize the CAN network clock with the current time.
 	if (io_can_net_set_time(net) == -1) {
 		errc = get_errc();
@@ -327,14 +640,22 @@ io_can_net_init(io_can_net_t *net, ev_exec_t *exec, io_timer_t *timer,
 	return net;
 
 error_set_time:
+	can_timer_destroy(net->filter_timer);
+error_create_filter_timer:
 	can_net_destroy(net->net);
 error_create_net:
 #if !LELY_NO_THREADS
 	mtx_destroy(&net->mtx);
 error_init_mtx:
 #endif
+	free(net->tx_time);
+error_alloc_tx_time:
 	free(net->tx_buf);
 error_alloc_tx_buf:
+#if !LELY_NO_THREADS
+	mtx_destroy(&net->rx_mtx);
+error_init_rx_mtx:
+#endif
 	io_tqueue_destroy(net->tq);
 error_create_tq:
 	set_errc(errc);
@@ -352,10 +673,33 @@ io_can_net_fini(io_can_net_t *net)
 
 #if !LELY_NO_THREADS
 	int warning = 0;
+	mtx_lock(&net->rx_mtx);
+	// If necessary, busy-wait until the read operation feeding the receive
+	// queue completes.
+	while (net->rx_submitted) {
+		// The read operation is either submitted to the CAN channel or
+		// waiting for room in the receive queue.
+		if (io_can_chan_abort_read(net->chan, &net->read)
+				|| spscring_p_abort_wait(&net->rx_ring)) {
+			net->rx_submitted = 0;
+			continue;
+		}
+		mtx_unlock(&net->rx_mtx);
+		if (!warning) {
+			warning = 1;
+			diag(DIAG_WARNING, 0,
+					"io_can_net_fini() invoked with pending operations");
+		}
+		thrd_yield();
+		mtx_lock(&net->rx_mtx);
+	}
+	mtx_unlock(&net->rx_mtx);
+
 	mtx_lock(&net->mtx);
 	// If necessary, busy-wait until all submitted operations complete.
 	while (net->wait_next_submitted || net->wait_confirm_submitted
-			|| net->read_submitted || net->write_submitted) {
+			|| net->read_submitted || net->write_submitted
+			|| net->rx_wait_submitted) {
 		if (io_can_net_do_abort_tasks(net))
 			continue;
 		mtx_unlock(&net->mtx);
@@ -370,11 +714,18 @@ io_can_net_fini(io_can_net_t *net)
 	mtx_unlock(&net->mtx);
 #endif
 
+	free(net->filters);
+	can_timer_destroy(net->filter_timer);
 	can_net_destroy(net->net);
 #if !LELY_NO_THREADS
 	mtx_destroy(&net->mtx);
 #endif
+	free(net->tx_time);
 	free(net->tx_buf);
+	free(net->rx_buf);
+#if !LELY_NO_THREADS
+	mtx_destroy(&net->rx_mtx);
+#endif
 	io_tqueue_destroy(net->tq);
 }
 
@@ -428,17 +779,85 @@ io_can_net_start(io_can_net_t *net)
 		net->started = 1;
 
 		// Start waiting for CAN frames to be put into the transmit
-		// queue.
-		io_can_net_do_wait(net);
+		// queue, or write them if they were queued before the CAN
+		// network interface was started.
+		if (!io_can_net_do_wait(net))
+			io_can_net_do_write(net);
+
+		if (net->rx_buf) {
+			// Start waiting for CAN frames to be put into the
+			// receive queue.
+			assert(!net->rx_wait_submitted);
+			net->rx_wait_submitted = 1;
+			// clang-format off
+			if (!spscring_c_submit_wait(&net->rx_ring, 1,
+					&io_can_net_rx_c_wait_func, net))
+				// clang-format on
+				ev_exec_post(net->rx_task.exec, &net->rx_task);
 
-		assert(!net->read_submitted);
-		net->read_submitted = 1;
-		// Start receiving CAN frames.
-		io_can_chan_submit_read(net->chan, &net->read);
+#if !LELY_NO_THREADS
+			mtx_lock(&net->rx_mtx);
+#endif
+			assert(!net->rx_submitted);
+			net->rx_submitted = 1;
+			int submit_read = io_can_net_rx_do_alloc(net);
+#if !LELY_NO_THREADS
+			mtx_unlock(&net->rx_mtx);
+#endif
+			// Start receiving CAN frames.
+			if (submit_read)
+				io_can_chan_submit_read(net->chan, &net->read);
+		} else {
+			assert(!net->read_submitted);
+			net->read_submitted = 1;
+			// Start receiving CAN frames.
+			io_can_chan_submit_read(net->chan, &net->read);
+		}
+	}
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->mtx);
+#endif
+}
+
+int
+io_can_net_set_rxlen(io_can_net_t *net, size_t rxlen)
+{
+	assert(net);
+
+	int result = -1;
+	int errc = 0;
+
+#if !LELY_NO_THREADS
+	mtx_lock(&net->mtx);
+#endif
+	if (net->started || net->shutdown) {
+		errc = errnum2c(ERRNUM_INVAL);
+		goto error;
+	}
+
+	struct io_can_net_rx *rx_buf = NULL;
+	if (rxlen) {
+		rx_buf = calloc(rxlen, sizeof(*rx_buf));
+		if (!rx_buf) {
+			errc = get_errc();
+			goto error;
+		}
 	}
+
+	free(net->rx_buf);
+	net->rx_buf = rx_buf;
+	spscring_init(&net->rx_ring, rxlen ? rxlen : 1);
+	net->rx_i = 0;
+
+	result = 0;
+
+error:
 #if !LELY_NO_THREADS
 	mtx_unlock(&net->mtx);
 #endif
+	if (result == -1)
+		set_errc(errc);
+	return result;
 }
 
 io_ctx_t *
@@ -541,6 +960,40 @@ io_can_net_set_on_queue_error_func(
 #endif
 }
 
+void
+io_can_net_get_tx_class_func(const io_can_net_t *net,
+		io_can_net_tx_class_func_t **pfunc, void **parg)
+{
+	assert(net);
+
+#if !LELY_NO_THREADS
+	mtx_lock((mtx_t *)&net->mtx);
+#endif
+	if (pfunc)
+		*pfunc = net->tx_class_func;
+	if (parg)
+		*parg = net->tx_class_arg;
+#if !LELY_NO_THREADS
+	mtx_unlock((mtx_t *)&net->mtx);
+#endif
+}
+
+void
+io_can_net_set_tx_class_func(
+		io_can_net_t *net, io_can_net_tx_class_func_t *func, void *arg)
+{
+	assert(net);
+
+#if !LELY_NO_THREADS
+	mtx_lock(&net->mtx);
+#endif
+	net->tx_class_func = func ? func : &default_tx_class_func;
+	net->tx_class_arg = func ? arg : NULL;
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->mtx);
+#endif
+}
+
 void
 io_can_net_get_on_write_error_func(const io_can_net_t *net,
 		io_can_net_on_error_func_t **pfunc, void **parg)
@@ -575,6 +1028,40 @@ io_can_net_set_on_write_error_func(
 #endif
 }
 
+void
+io_can_net_get_on_confirm_func(const io_can_net_t *net,
+		io_can_net_on_confirm_func_t **pfunc, void **parg)
+{
+	assert(net);
+
+#if !LELY_NO_THREADS
+	mtx_lock((mtx_t *)&net->mtx);
+#endif
+	if (pfunc)
+		*pfunc = net->on_confirm_func;
+	if (parg)
+		*parg = net->on_confirm_arg;
+#if !LELY_NO_THREADS
+	mtx_unlock((mtx_t *)&net->mtx);
+#endif
+}
+
+void
+io_can_net_set_on_confirm_func(io_can_net_t *net,
+		io_can_net_on_confirm_func_t *func, void *arg)
+{
+	assert(net);
+
+#if !LELY_NO_THREADS
+	mtx_lock(&net->mtx);
+#endif
+	net->on_confirm_func = func;
+	net->on_confirm_arg = func ? arg : NULL;
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->mtx);
+#endif
+}
+
 void
 io_can_net_get_on_can_state_func(const io_can_net_t *net,
 		io_can_net_on_can_state_func_t **pfunc, void **parg)
@@ -689,6 +1176,99 @@ io_can_net_set_time(io_can_net_t *net)
 	return can_net_set_time(io_can_net_get_net(net), &now);
 }
 
+int
+io_can_net_set_filter(io_can_net_t *net, size_t nfilter, int interval)
+{
+	assert(net);
+
+	if (!interval)
+		interval = LELY_IO_CAN_NET_FILTER_INTERVAL;
+
+	int result = 0;
+#if !LELY_NO_THREADS
+	mtx_lock(&net->mtx);
+#endif
+	net->nfilter = nfilter;
+	net->filter_interval = interval;
+	if (nfilter) {
+		can_net_set_filter_func(
+				net->net, &io_can_net_filter_func, net);
+		can_timer_stop(net->filter_timer);
+		net->filter_pending = 0;
+		result = io_can_net_do_filter(net);
+	}
+	if (!nfilter || result == -1) {
+		net->nfilter = 0;
+		can_net_set_filter_func(net->net, NULL, NULL);
+		can_timer_stop(net->filter_timer);
+		net->filter_pending = 0;
+		// Accept all CAN frames. On error, preserve the error number of
+		// the failed update.
+		int errc = get_errc();
+		if (io_can_chan_set_filter(net->chan, NULL, 0) == -1)
+			result = -1;
+		else if (result == -1)
+			set_errc(errc);
+	}
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->mtx);
+#endif
+
+	return result;
+}
+
+int
+io_can_net_get_stats(const io_can_net_t *net, struct io_can_net_stats *stats)
+{
+	assert(net);
+	assert(stats);
+
+	if (io_clock_gettime(io_can_net_get_clock(net), &stats->time) == -1)
+		return -1;
+
+	const struct io_can_net_cnt *cnt = &net->cnt;
+	stats->rx_frames = io_can_net_cnt_get(&cnt->rx_frames);
+	stats->rx_bits = io_can_net_cnt_get(&cnt->rx_bits);
+	stats->rx_errors = io_can_net_cnt_get(&cnt->rx_errors);
+	stats->rx_queue_max = io_can_net_cnt_get(&cnt->rx_queue_max);
+	stats->tx_frames = io_can_net_cnt_get(&cnt->tx_frames);
+	stats->tx_bits = io_can_net_cnt_get(&cnt->tx_bits);
+	stats->tx_errors = io_can_net_cnt_get(&cnt->tx_errors);
+	stats->tx_dropped = io_can_net_cnt_get(&cnt->tx_dropped);
+	stats->tx_queue_max = io_can_net_cnt_get(&cnt->tx_queue_max);
+	for (int i = 0; i < IO_CAN_NET_NCLASS; i++) {
+		// clang-format off
+		stats->tx_class_depth[i] =
+				io_can_net_cnt_get(&cnt->tx_class_depth[i]);
+		stats->tx_class_max[i] =
+				io_can_net_cnt_get(&cnt->tx_class_max[i]);
+		// clang-format on
+	}
+	for (int i = 0; i < IO_CAN_NET_NHIST; i++) {
+		stats->rx_latency[i] = io_can_net_cnt_get(&cnt->rx_latency[i]);
+		stats->tx_latency[i] = io_can_net_cnt_get(&cnt->tx_latency[i]);
+	}
+
+	return 0;
+}
+
+double
+io_can_net_stats_load(const struct io_can_net_stats *prev,
+		const struct io_can_net_stats *next, int bitrate)
+{
+	assert(prev);
+	assert(next);
+
+	int_least64_t nsec = timespec_diff_nsec(&next->time, &prev->time);
+	if (nsec <= 0 || bitrate <= 0)
+		return 0;
+
+	// Unsigned arithmetic takes care of counters wrapping around.
+	size_t bits = (next->rx_bits - prev->rx_bits)
+			+ (next->tx_bits - prev->tx_bits);
+	return 100.0 * bits / ((double)nsec * 1e-9 * bitrate);
+}
+
 static void
 io_can_net_svc_shutdown(struct io_svc *svc)
 {
@@ -699,12 +1279,28 @@ io_can_net_svc_shutdown(struct io_svc *svc)
 #endif
 	int shutdown = !net->shutdown;
 	net->shutdown = 1;
+	// Stop waiting for CAN frames to be put into the transmit queue.
+	net->tx_wait = 0;
+	// Stop waiting for CAN frames to be put into the receive queue.
+	if (shutdown && net->rx_wait_submitted
+			&& spscring_c_abort_wait(&net->rx_ring))
+		net->rx_wait_submitted = 0;
 #if !LELY_NO_THREADS
 	mtx_unlock(&net->mtx);
 #endif
 
-	if (shutdown)
-		spscring_c_abort_wait(&net->tx_ring);
+	if (shutdown) {
+#if !LELY_NO_THREADS
+		mtx_lock(&net->rx_mtx);
+#endif
+		net->rx_shutdown = 1;
+		// Do not wait for room in the receive queue.
+		if (net->rx_submitted && spscring_p_abort_wait(&net->rx_ring))
+			net->rx_submitted = 0;
+#if !LELY_NO_THREADS
+		mtx_unlock(&net->rx_mtx);
+#endif
+	}
 }
 
 static void
@@ -762,7 +1358,7 @@ io_can_net_wait_confirm_func(struct ev_task *task)
 
 	// No confirmation message was received; cancel the ongoing write
 	// operation.
-	io_can_chan_cancel_write(net->chan, &net->write);
+	io_can_chan_cancel_write_vec(net->chan, &net->write);
 }
 
 static void
@@ -772,20 +1368,197 @@ io_can_net_read_func(struct ev_task *task)
 	struct io_can_chan_read *read = io_can_chan_read_from_task(task);
 	io_can_net_t *net = structof(read, io_can_net_t, read);
 
+	if (net->rx_buf) {
+		io_can_net_rx_read_func(net);
+		return;
+	}
+
 #if !LELY_NO_THREADS
 	mtx_lock(&net->mtx);
 #endif
 
-	if (read->r.errc && errc2num(read->r.errc) != ERRNUM_CANCELED) {
+	// Update the internal clock before processing an incoming CAN frame.
+	if (read->r.result == 1)
+		io_can_net_set_time(net);
+	io_can_net_do_read(net, read->r.result, read->r.errc, &net->read_msg,
+			&net->read_err, &net->read_tp);
+
+	int submit_read = net->read_submitted = !net->shutdown;
+
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->mtx);
+#endif
+
+	if (submit_read)
+		io_can_chan_submit_read(net->chan, &net->read);
+}
+
+static void
+io_can_net_rx_read_func(io_can_net_t *net)
+{
+	assert(net);
+	assert(net->rx_buf);
+
+#if !LELY_NO_THREADS
+	mtx_lock(&net->rx_mtx);
+#endif
+	assert(net->rx_submitted);
+	// Store the result of the read operation with the frame and hand it to
+	// the consumer. This may post io_can_net_rx_task_func().
+	struct io_can_net_rx *rx = &net->rx_buf[net->rx_i];
+	rx->result = net->read.r.result;
+	rx->errc = net->read.r.errc;
+	spscring_p_commit(&net->rx_ring, 1);
+	io_can_net_cnt_max(&net->cnt.rx_queue_max,
+			spscring_size(&net->rx_ring)
+					- spscring_p_capacity(&net->rx_ring));
+
+	int submit_read = io_can_net_rx_do_alloc(net);
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->rx_mtx);
+#endif
+
+	if (submit_read)
+		io_can_chan_submit_read(net->chan, &net->read);
+}
+
+static int
+io_can_net_rx_do_alloc(io_can_net_t *net)
+{
+	assert(net);
+	assert(net->rx_buf);
+	assert(net->rx_submitted);
+
+	for (;;) {
+		if (net->rx_shutdown) {
+			net->rx_submitted = 0;
+			return 0;
+		}
+
+		size_t n = 1;
+		size_t i = spscring_p_alloc(&net->rx_ring, &n);
+		if (n) {
+			// Read the next frame directly into the receive queue.
+			struct io_can_net_rx *rx = &net->rx_buf[i];
+			net->rx_i = i;
+			net->read.msg = &rx->msg;
+			net->read.err = &rx->err;
+			net->read.tp = &rx->tp;
+			rx->tp = (struct timespec){ 0, 0 };
+			return 1;
+		}
+
+		// Wait for the consumer to make room in the receive queue
+		// before reading the next frame.
+		// clang-format off
+		if (spscring_p_submit_wait(&net->rx_ring, 1,
+				&io_can_net_rx_p_wait_func, net))
+			// clang-format on
+			return 0;
+	}
+}
+
+static void
+io_can_net_rx_p_wait_func(struct spscring *ring, void *arg)
+{
+	(void)ring;
+	io_can_net_t *net = arg;
+	assert(net);
+
+#if !LELY_NO_THREADS
+	mtx_lock(&net->rx_mtx);
+#endif
+	int submit_read = io_can_net_rx_do_alloc(net);
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->rx_mtx);
+#endif
+
+	if (submit_read)
+		io_can_chan_submit_read(net->chan, &net->read);
+}
+
+static void
+io_can_net_rx_c_wait_func(struct spscring *ring, void *arg)
+{
+	(void)ring;
+	io_can_net_t *net = arg;
+	assert(net);
+
+	// Process the received frames in the executor of the CAN network
+	// interface.
+	ev_exec_post(net->rx_task.exec, &net->rx_task);
+}
+
+static void
+io_can_net_rx_task_func(struct ev_task *task)
+{
+	assert(task);
+	io_can_net_t *net = structof(task, io_can_net_t, rx_task);
+	assert(net->rx_buf);
+
+#if !LELY_NO_THREADS
+	mtx_lock(&net->mtx);
+#endif
+	assert(net->rx_wait_submitted);
+
+	// Update the internal clock once for the entire batch of frames.
+	io_can_net_set_time(net);
+
+	// Process all frames that are currently available, but not the ones
+	// arriving in the meantime, to give other tasks a chance to run.
+	size_t capacity = spscring_c_capacity(&net->rx_ring);
+	while (capacity) {
+		size_t n = capacity;
+		size_t i = spscring_c_alloc_no_wrap(&net->rx_ring, &n);
+		for (size_t k = 0; k < n; k++) {
+			struct io_can_net_rx *rx = &net->rx_buf[i + k];
+			io_can_net_do_read(net, rx->result, rx->errc, &rx->msg,
+					&rx->err, &rx->tp);
+		}
+		// This may resume a reader waiting for room in the queue.
+		spscring_c_commit(&net->rx_ring, n);
+		capacity -= n;
+	}
+
+	int post_rx = 0;
+	if (net->shutdown) {
+		net->rx_wait_submitted = 0;
+	} else {
+		// clang-format off
+		post_rx = !spscring_c_submit_wait(&net->rx_ring, 1,
+				&io_can_net_rx_c_wait_func, net);
+		// clang-format on
+	}
+
+#if !LELY_NO_THREADS
+	mtx_unlock(&net->mtx);
+#endif
+
+	if (post_rx)
+		ev_exec_post(net->rx_task.exec, &net->rx_task);
+}
+
+static void
+io_can_net_do_read(io_can_net_t *net, int result, int errc,
+		const struct can_msg *msg, const struct can_err *err,
+		const struct timespec *ts)
+{
+	assert(net);
+	assert(msg);
+	assert(err);
+	assert(ts);
+
+	if (errc && errc2num(errc) != ERRNUM_CANCELED) {
+		io_can_net_cnt_add(&net->cnt.rx_errors, 1);
 		net->read_errcnt += net->read_errcnt < SIZE_MAX;
-		if (read->r.errc != net->read_errc) {
-			net->read_errc = read->r.errc;
+		if (errc != net->read_errc) {
+			net->read_errc = errc;
 			// Only invoke the callback for unique read errors.
 			assert(net->on_read_error_func);
 			net->on_read_error_func(net->read_errc, net->read_errc,
 					net->on_read_error_arg);
 		}
-	} else if (!read->r.errc && net->read_errc) {
+	} else if (!errc && net->read_errc) {
 		assert(net->on_read_error_func);
 		net->on_read_error_func(
 				0, net->read_errc, net->on_read_error_arg);
@@ -793,21 +1566,30 @@ io_can_net_read_func(struct ev_task *task)
 		net->read_errcnt = 0;
 	}
 
-	if (read->r.result == 1) {
-		// Update the internal clock before processing the incoming CAN
-		// frame.
-		io_can_net_set_time(net);
-		can_net_recv(net->net, &net->read_msg);
-	} else if (read->r.result == 0) {
-		if (net->read_err.state != net->state) {
-			int new_state = net->read_err.state;
+	if (result == 1) {
+		io_can_net_cnt_add(&net->cnt.rx_frames, 1);
+		int bits = can_msg_bits(msg, CAN_MSG_BITS_MODE_NO_STUFF);
+		if (bits > 0)
+			io_can_net_cnt_add(&net->cnt.rx_bits, bits);
+
+		struct timespec tp = { 0, 0 };
+		int has_tp = !io_can_net_read_time(net, ts, &tp);
+		if (has_tp) {
+			struct timespec now = { 0, 0 };
+			can_net_get_time(net->net, &now);
+			io_can_net_hist_add(net->cnt.rx_latency, &tp, &now);
+		}
+		can_net_recv_at(net->net, msg, has_tp ? &tp : NULL);
+	} else if (result == 0) {
+		if (err->state != net->state) {
+			int new_state = err->state;
 			int old_state = net->state;
-			net->state = net->read_err.state;
+			net->state = err->state;
 
 			if (old_state == CAN_STATE_BUSOFF)
 				// Cancel the ongoing write operation if we just
 				// recovered from bus off.
-				io_can_chan_cancel_write(
+				io_can_chan_cancel_write_vec(
 						net->chan, &net->write);
 
 			assert(net->on_can_state_func);
@@ -815,28 +1597,55 @@ io_can_net_read_func(struct ev_task *task)
 					net->on_can_state_arg);
 		}
 
-		if (net->read_err.error) {
+		if (err->error) {
 			assert(net->on_can_error_func);
-			net->on_can_error_func(net->read_err.error,
-					net->on_can_error_arg);
+			net->on_can_error_func(
+					err->error, net->on_can_error_arg);
 		}
 	}
+}
 
-	int submit_read = net->read_submitted = !net->shutdown;
+static int
+io_can_net_read_time(io_can_net_t *net, const struct timespec *ts,
+		struct timespec *tp)
+{
+	assert(net);
+	assert(ts);
+	assert(tp);
 
-#if !LELY_NO_THREADS
-	mtx_unlock(&net->mtx);
-#endif
+	if (!ts->tv_sec && !ts->tv_nsec)
+		return -1;
 
-	if (submit_read)
-		io_can_chan_submit_read(net->chan, &net->read);
+	struct timespec now = { 0, 0 };
+	can_net_get_time(net->net, &now);
+
+	// Check if the timestamp was obtained from the same clock as the one
+	// used by the CAN network interface.
+	int_least64_t age = timespec_diff_msec(&now, ts);
+	if (age >= 0 && age <= LELY_IO_CAN_NET_RXAGE) {
+		*tp = *ts;
+		return 0;
+	}
+
+	// Otherwise, determine the age of the frame with respect to the system
+	// clock.
+	struct timespec sys = { 0, 0 };
+	if (!timespec_get(&sys, TIME_UTC))
+		return -1;
+	int_least64_t nsec = timespec_diff_nsec(&sys, ts);
+	if (nsec < 0 || nsec > (int_least64_t)LELY_IO_CAN_NET_RXAGE * 1000000)
+		return -1;
+	*tp = now;
+	timespec_sub_nsec(tp, nsec);
+	return 0;
 }
 
 static void
 io_can_net_write_func(struct ev_task *task)
 {
 	assert(task);
-	struct io_can_chan_write *write = io_can_chan_write_from_task(task);
+	struct io_can_chan_write_vec *write =
+			io_can_chan_write_vec_from_task(task);
 	io_can_net_t *net = structof(write, io_can_net_t, write);
 
 #if !LELY_NO_THREADS
@@ -860,17 +1669,51 @@ io_can_net_write_func(struct ev_task *task)
 		net->write_errcnt = 0;
 	}
 
-	// Remove the frame from the transmit queue, unless the write operation
-	// was canceled, in which we discard the entire queue.
-	assert(spscring_c_capacity(&net->tx_ring) >= 1);
-	size_t n = 1;
-	if (errc2num(write->errc) == ERRNUM_CANCELED) {
-		n = spscring_c_capacity(&net->tx_ring);
+	// Remove the written frames from the transmit queue. On error, only
+	// the frame that could not be written is dropped; the remaining frames
+	// stay queued. If the write operation was canceled, we discard the
+	// entire queue.
+	struct io_can_net_txq *txq = &net->txq[net->tx_class];
+	assert(spscring_c_capacity(&txq->ring) >= write->nmsgs);
+	size_t n = write->nmsgs;
+	int canceled = errc2num(write->errc) == ERRNUM_CANCELED;
+	if (canceled) {
+		n = spscring_c_capacity(&txq->ring);
 		// Track the number of dropped frames. The first frame has
 		// already been accounted for.
-		net->write_errcnt += n - 1;
+		assert(write->n < n);
+		net->write_errcnt += n - write->n - 1;
+	} else if (write->errc) {
+		assert(write->n < n);
+		n = write->n + 1;
+	}
+	io_can_net_write_stats(net, write->errc ? write->n : write->nmsgs, n);
+	if (net->on_confirm_func) {
+		// Report the successfully written frames before they are
+		// removed from the transmit queue.
+		struct timespec now = { 0, 0 };
+		io_clock_gettime(io_can_net_get_clock(net), &now);
+		size_t nmsgs = write->errc ? write->n : write->nmsgs;
+		for (size_t k = 0; k < nmsgs; k++)
+			net->on_confirm_func(&write->msgs[k], &now,
+					net->on_confirm_arg);
+	}
+	spscring_c_commit(&txq->ring, n);
+	io_can_net_cnt_set(&net->cnt.tx_class_depth[net->tx_class],
+			spscring_c_capacity(&txq->ring));
+	if (canceled) {
+		// Discard the frames of the other priority classes as well.
+		for (int i = 0; i < IO_CAN_NET_NCLASS; i++) {
+			if (i == net->tx_class)
+				continue;
+			txq = &net->txq[i];
+			n = spscring_c_capacity(&txq->ring);
+			net->write_errcnt += n;
+			io_can_net_cnt_add(&net->cnt.tx_errors, n);
+			spscring_c_commit(&txq->ring, n);
+			io_can_net_cnt_set(&net->cnt.tx_class_depth[i], 0);
+		}
 	}
-	spscring_c_commit(&net->tx_ring, n);
 
 	// Stop the timeout after receiving a write confirmation (or write
 	// error).
@@ -888,6 +1731,35 @@ io_can_net_write_func(struct ev_task *task)
 #endif
 }
 
+static void
+io_can_net_write_stats(io_can_net_t *net, size_t nmsgs, size_t n)
+{
+	assert(net);
+	assert(nmsgs <= n);
+
+	if (nmsgs) {
+		struct timespec now = { 0, 0 };
+		io_clock_gettime(io_can_net_get_clock(net), &now);
+
+		const struct io_can_net_txq *txq = &net->txq[net->tx_class];
+		size_t i = net->write.msgs - txq->buf;
+		size_t bits = 0;
+		for (size_t k = 0; k < nmsgs; k++) {
+			int b = can_msg_bits(&txq->buf[i + k],
+					CAN_MSG_BITS_MODE_NO_STUFF);
+			if (b > 0)
+				bits += b;
+			io_can_net_hist_add(net->cnt.tx_latency,
+					&txq->time[i + k], &now);
+		}
+		io_can_net_cnt_add(&net->cnt.tx_frames, nmsgs);
+		io_can_net_cnt_add(&net->cnt.tx_bits, bits);
+	}
+
+	if (n > nmsgs)
+		io_can_net_cnt_add(&net->cnt.tx_errors, n - nmsgs);
+}
+
 static int
 io_can_net_next_func(const struct timespec *tp, void *data)
 {
@@ -926,20 +1798,49 @@ io_can_net_send_func(const struct can_msg *msg, void *data)
 	io_can_net_t *net = data;
 	assert(net);
 
+	// Determine the priority class of the frame.
+	assert(net->tx_class_func);
+	int c = net->tx_class_func(msg, net->tx_class_arg);
+	c = MAX(0, MIN(c, IO_CAN_NET_NCLASS - 1));
+	struct io_can_net_txq *txq = &net->txq[c];
+
 	size_t n = 1;
-	size_t i = spscring_p_alloc(&net->tx_ring, &n);
+	size_t i = spscring_p_alloc(&txq->ring, &n);
 	if (n) {
-		net->tx_buf[i] = *msg;
-		spscring_p_commit(&net->tx_ring, n);
+		txq->buf[i] = *msg;
+		// Record the time at which the frame was queued for the latency
+		// statistics.
+		io_clock_gettime(io_can_net_get_clock(net), &txq->time[i]);
+		spscring_p_commit(&txq->ring, n);
+
+		size_t depth = spscring_size(&txq->ring)
+				- spscring_p_capacity(&txq->ring);
+		io_can_net_cnt_set(&net->cnt.tx_class_depth[c], depth);
+		io_can_net_cnt_max(&net->cnt.tx_class_max[c], depth);
+		for (int k = 0; k < IO_CAN_NET_NCLASS; k++) {
+			if (k != c)
+				depth += io_can_net_cnt_get(
+						&net->cnt.tx_class_depth[k]);
+		}
+		io_can_net_cnt_max(&net->cnt.tx_queue_max, depth);
+
 		if (net->tx_errcnt) {
 			assert(net->on_queue_error_func);
 			net->on_queue_error_func(0, net->tx_errcnt,
 					net->on_queue_error_arg);
 			net->tx_errcnt = 0;
 		}
+
+		// A frame was just added to the transmit queue; try to send it.
+		if (net->tx_wait) {
+			net->tx_wait = 0;
+			if (!io_can_net_do_wait(net))
+				io_can_net_do_write(net);
+		}
 		return 0;
 	} else {
 		set_errnum(ERRNUM_AGAIN);
+		io_can_net_cnt_add(&net->cnt.tx_dropped, 1);
 		net->tx_errcnt += net->tx_errcnt < SIZE_MAX;
 		if (net->tx_errcnt == 1) {
 			// Only invoke the callback for the first transmission
@@ -953,15 +1854,114 @@ io_can_net_send_func(const struct can_msg *msg, void *data)
 }
 
 static void
-io_can_net_c_wait_func(struct spscring *ring, void *arg)
+io_can_net_filter_func(
+		const struct can_net_filter *filter, int add, void *data)
 {
-	(void)ring;
-	io_can_net_t *net = arg;
+	assert(filter);
+	io_can_net_t *net = data;
 	assert(net);
 
-	// A frame was just added to the transmit queue; try to send it.
-	if (!io_can_net_do_wait(net))
-		io_can_net_do_write(net);
+	if (!net->nfilter)
+		return;
+
+	// Apply an update that widens the filters immediately, so frames for
+	// newly registered receivers are not dropped. If the installed filters
+	// were invalidated by a failed update, retry it.
+	if (!net->nfilters || (add && !io_can_net_filter_covers(net, filter))) {
+		can_timer_stop(net->filter_timer);
+		net->filter_pending = 0;
+		if (io_can_net_do_filter(net) == -1)
+			diag(DIAG_WARNING, get_errc(),
+					"unable to update CAN identifier filters");
+		return;
+	}
+
+	// A receiver for identifiers that are already accepted does not
+	// require an update.
+	if (add || net->filter_pending)
+		return;
+
+	// Postpone an update that only narrows the filters until the minimum
+	// interval since the previous update has elapsed. This allows receivers
+	// that are started or stopped in quick succession to be processed with
+	// a single update.
+	struct timespec start = { 0, 0 };
+	can_net_get_time(net->net, &start);
+	if (net->filter_interval > 0) {
+		struct timespec next = net->filter_time;
+		timespec_add_msec(&next, net->filter_interval);
+		if (timespec_cmp(&next, &start) > 0)
+			start = next;
+	}
+	net->filter_pending = 1;
+	can_timer_start(net->filter_timer, net->net, &start, NULL);
+}
+
+static int
+io_can_net_filter_timer(const struct timespec *tp, void *data)
+{
+	(void)tp;
+	io_can_net_t *net = data;
+	assert(net);
+	assert(net->filter_pending);
+
+	net->filter_pending = 0;
+	if (io_can_net_do_filter(net) == -1)
+		diag(DIAG_WARNING, get_errc(),
+				"unable to update CAN identifier filters");
+
+	return 0;
+}
+
+static int
+io_can_net_do_filter(io_can_net_t *net)
+{
+	assert(net);
+	assert(net->nfilter);
+
+	can_net_get_time(net->net, &net->filter_time);
+
+	size_t n = can_net_get_filter(net->net, NULL, 0);
+	if (n > net->maxfilters) {
+		struct can_net_filter *filters = realloc(
+				net->filters, n * sizeof(*filters));
+		if (!filters) {
+#if !LELY_NO_ERRNO
+			set_errc(errno2c(errno));
+#endif
+			return -1;
+		}
+		net->filters = filters;
+		net->maxfilters = n;
+	}
+	can_net_get_filter(net->net, net->filters, n);
+	n = can_net_filter_merge(net->filters, n, net->nfilter);
+
+	// Invalidate the installed filters until the update succeeds.
+	net->nfilters = 0;
+	if (io_can_chan_set_filter(net->chan, net->filters, n) == -1)
+		return -1;
+	net->nfilters = n;
+	return 0;
+}
+
+static int
+io_can_net_filter_covers(
+		const io_can_net_t *net, const struct can_net_filter *filter)
+{
+	assert(net);
+	assert(filter);
+
+	for (size_t i = 0; i < net->nfilters; i++) {
+		const struct can_net_filter *f = &net->filters[i];
+		// f covers the filter if every identifier matching the filter
+		// also matches f.
+		if (!((filter->flags ^ f->flags) & CAN_FLAG_IDE)
+				&& !(f->mask & ~filter->mask)
+				&& !((filter->id ^ f->id) & f->mask))
+			return 1;
+	}
+	return 0;
 }
 
 static inline io_can_net_t *
@@ -976,33 +1976,46 @@ int
 io_can_net_do_wait(io_can_net_t *net)
 {
 	assert(net);
+	assert(!net->tx_wait);
 
-	// Wait for next frame to become available.
-	// clang-format off
-	if (spscring_c_submit_wait(
-			&net->tx_ring, 1, &io_can_net_c_wait_func, net))
-		// clang-format on
-		return 1;
+	// Find the highest-priority class with frames waiting to be sent.
+	for (int c = 0; c < IO_CAN_NET_NCLASS; c++) {
+		struct io_can_net_txq *txq = &net->txq[c];
+		if (!spscring_c_capacity(&txq->ring))
+			continue;
 
-	// Extract the frame from the transmit queue.
-	size_t n = 1;
-	size_t i = spscring_c_alloc(&net->tx_ring, &n);
-	assert(n == 1);
-	net->write_msg = net->tx_buf[i];
+		// Write all frames of this class that are stored consecutively
+		// in the transmit queue at once, but limit the number of
+		// low-priority frames, so that high-priority frames do not
+		// have to wait too long. The frames remain in the queue until
+		// the write operation completes.
+		size_t n = c == IO_CAN_NET_CLASS_NMT ? SIZE_MAX
+						     : LELY_IO_CAN_NET_TXBURST;
+		size_t i = spscring_c_alloc_no_wrap(&txq->ring, &n);
+		assert(n >= 1);
+		net->tx_class = c;
+		net->write.msgs = &txq->buf[i];
+		net->write.nmsgs = n;
 
-	return 0;
+		return 0;
+	}
+
+	// Wait for next frame to become available. This flag is checked by
+	// io_can_net_send_func().
+	net->tx_wait = !net->shutdown;
+	return 1;
 }
 
 void
 io_can_net_do_write(io_can_net_t *net)
 {
 	assert(net);
-	assert(spscring_c_capacity(&net->tx_ring) >= 1);
+	assert(spscring_c_capacity(&net->txq[net->tx_class].ring) >= 1);
 	assert(!net->write_submitted);
 
-	// Send the frame.
+	// Send the frames.
 	net->write_submitted = 1;
-	io_can_chan_submit_write(net->chan, &net->write);
+	io_can_chan_submit_write_vec(net->chan, &net->write);
 
 	// Register a timeout for the write confirmation, if necessary.
 	if (net->txtimeo >= 0
@@ -1043,11 +2056,19 @@ io_can_net_do_abort_tasks(io_can_net_t *net)
 	}
 
 	if (net->write_submitted
-			&& io_can_chan_abort_write(net->chan, &net->write)) {
+			&& io_can_chan_abort_write_vec(net->chan, &net->write)) {
 		net->write_submitted = 0;
 		n++;
 	}
 
+	if (net->rx_wait_submitted
+			&& (spscring_c_abort_wait(&net->rx_ring)
+					|| ev_exec_abort(net->rx_task.exec,
+							&net->rx_task))) {
+		net->rx_wait_submitted = 0;
+		n++;
+	}
+
 	return 0;
 }
 
@@ -1137,4 +2158,95 @@ default_on_can_error_func(int error, void *arg)
 				"one or more unknown errors detected on CAN bus");
 }
 
+static int
+default_tx_class_func(const struct can_msg *msg, void *arg)
+{
+	assert(msg);
+	(void)arg;
+
+	if (msg->flags & CAN_FLAG_IDE)
+		return IO_CAN_NET_CLASS_SDO;
+	// NMT (0x000), SYNC and EMCY (0x080..0x0ff) and TIME (0x100).
+	if (msg->id <= 0x100)
+		return IO_CAN_NET_CLASS_NMT;
+	// PDOs (0x180..0x57f).
+	if (msg->id >= 0x180 && msg->id <= 0x57f)
+		return IO_CAN_NET_CLASS_PDO;
+	return IO_CAN_NET_CLASS_SDO;
+}
+
+static void
+io_can_net_cnt_init(io_can_net_cnt_t *cnt)
+{
+#if LELY_NO_THREADS
+	*cnt = 0;
+#else
+	atomic_init(cnt, 0);
+#endif
+}
+
+static inline size_t
+io_can_net_cnt_get(const io_can_net_cnt_t *cnt)
+{
+#if LELY_NO_THREADS
+	return *cnt;
+#else
+	return atomic_load_explicit(
+			(io_can_net_cnt_t *)cnt, memory_order_relaxed);
+#endif
+}
+
+static inline void
+io_can_net_cnt_set(io_can_net_cnt_t *cnt, size_t n)
+{
+#if LELY_NO_THREADS
+	*cnt = n;
+#else
+	atomic_store_explicit(cnt, n, memory_order_relaxed);
+#endif
+}
+
+static inline void
+io_can_net_cnt_add(io_can_net_cnt_t *cnt, size_t n)
+{
+#if LELY_NO_THREADS
+	*cnt += n;
+#else
+	// Since there is only a single writer, a read-modify-write operation is
+	// not necessary.
+	atomic_store_explicit(cnt,
+			atomic_load_explicit(cnt, memory_order_relaxed) + n,
+			memory_order_relaxed);
+#endif
+}
+
+static inline void
+io_can_net_cnt_max(io_can_net_cnt_t *cnt, size_t n)
+{
+#if LELY_NO_THREADS
+	if (*cnt < n)
+		*cnt = n;
+#else
+	if (atomic_load_explicit(cnt, memory_order_relaxed) < n)
+		atomic_store_explicit(cnt, n, memory_order_relaxed);
+#endif
+}
+
+static void
+io_can_net_hist_add(io_can_net_cnt_t *hist, const struct timespec *t0,
+		const struct timespec *t1)
+{
+	assert(hist);
+	assert(t0);
+	assert(t1);
+
+	int_least64_t usec = timespec_diff_usec(t1, t0);
+	int i = 0;
+	while (usec > 0 && i < IO_CAN_NET_NHIST - 1) {
+		usec >>= 1;
+		i++;
+	}
+	io_can_net_cnt_add(&hist[i], 1);
+}
+
 #endif // !LELY_NO_MALLOC
@@ -26,6 +26,7 @@
 #if !LELY_NO_STDIO && defined(__linux__)
 
 #include "../can.h"
+#include <lely/can/net.h>
 #include <lely/io2/ctx.h>
 #include <lely/io2/linux/can.h>
 #include <lely/io2/posix/poll.h>
@@ -37,6 +38,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if !LELY_NO_THREADS
 #include <pthread.h>
@@ -57,6 +59,22 @@
 #define LELY_IO_CAN_RXLEN 1024
 #endif
 
+#ifndef LELY_IO_CAN_RXBATCH
+/**
+ * The default, and maximum, number of CAN frames read from a SocketCAN socket
+ * with a single system call.
+ */
+#define LELY_IO_CAN_RXBATCH 32
+#endif
+
+#ifndef LELY_IO_CAN_TXBATCH
+/**
+ * The maximum number of CAN frames written to a SocketCAN socket with a single
+ * system call.
+ */
+#define LELY_IO_CAN_TXBATCH 32
+#endif
+
 struct io_can_frame {
 #if LELY_NO_CANFD
 	struct can_frame frame;
@@ -64,17 +82,14 @@ struct io_can_frame {
 	struct canfd_frame frame;
 #endif
 	size_t nbytes;
+	/// The message flags (`MSG_CONFIRM` indicates a write confirmation).
+	int flags;
 	struct timespec ts;
 };
 
 static int io_can_fd_set_default(int fd);
-#if LELY_NO_CANFD
-static int io_can_fd_read(int fd, struct can_frame *frame, size_t *pnbytes,
-		int *pflags, struct timespec *tp, int timeout);
-#else
-static int io_can_fd_read(int fd, struct canfd_frame *frame, size_t *pnbytes,
-		int *pflags, struct timespec *tp, int timeout);
-#endif
+static ssize_t io_can_fd_read(
+		int fd, struct io_can_frame *frames, size_t n, int timeout);
 #if LELY_NO_CANFD
 static int io_can_fd_write(int fd, const struct can_frame *frame, size_t nbytes,
 		int dontwait);
@@ -83,6 +98,18 @@ static int io_can_fd_write(int fd, const struct canfd_frame *frame,
 		size_t nbytes, int timeout);
 #endif
 static int io_can_fd_write_msg(int fd, const struct can_msg *msg, int timeout);
+static ssize_t io_can_fd_write_vec(
+		int fd, const struct can_msg *msgs, size_t n, int timeout);
+
+static int io_can_frame_from_msg(
+		struct io_can_frame *frame, const struct can_msg *msg);
+
+/**
+ * Sets the CAN identifier filters of a SocketCAN socket. If <b>filters</b> is
+ * NULL, all frames are accepted.
+ */
+static int io_can_fd_set_filter(
+		int fd, const struct can_filter *filters, size_t n);
 
 static io_ctx_t *io_can_chan_impl_dev_get_ctx(const io_dev_t *dev);
 static ev_exec_t *io_can_chan_impl_dev_get_exec(const io_dev_t *dev);
@@ -108,6 +135,10 @@ static int io_can_chan_impl_write(
 		io_can_chan_t *chan, const struct can_msg *msg, int timeout);
 static void io_can_chan_impl_submit_write(
 		io_can_chan_t *chan, struct io_can_chan_write *write);
+static void io_can_chan_impl_submit_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write);
+static int io_can_chan_impl_set_filter(io_can_chan_t *chan,
+		const struct can_net_filter *filters, size_t n);
 
 // clang-format off
 static const struct io_can_chan_vtbl io_can_chan_impl_vtbl = {
@@ -116,7 +147,9 @@ static const struct io_can_chan_vtbl io_can_chan_impl_vtbl = {
 	&io_can_chan_impl_read,
 	&io_can_chan_impl_submit_read,
 	&io_can_chan_impl_write,
-	&io_can_chan_impl_submit_write
+	&io_can_chan_impl_submit_write,
+	&io_can_chan_impl_submit_write_vec,
+	&io_can_chan_impl_set_filter
 };
 // clang-format on
 
@@ -163,6 +196,11 @@ struct io_can_chan_impl {
 	struct spscring rxring;
 	/// The receive queue.
 	struct io_can_frame *rxbuf;
+	/**
+	 * The maximum number of CAN frames read into the receive queue with a
+	 * single system call.
+	 */
+	size_t rxbatch;
 #if !LELY_NO_THREADS
 	/**
 	 * The mutex protecting the file descriptor, the flags and the queues of
@@ -176,6 +214,12 @@ struct io_can_chan_impl {
 	int flags;
 	/// The I/O events currently being monitored by #poll for #fd.
 	int events;
+	/// The CAN identifier filters installed on #fd, if #filtered is set.
+	struct can_filter *filters;
+	/// The number of filters at #filters.
+	size_t nfilters;
+	/// The number of filters for which space has been allocated.
+	size_t maxfilters;
 	/// A flag indicating whether the I/O service has been shut down.
 	unsigned shutdown : 1;
 	/// A flag indicating whether #rxbuf_task has been posted to #exec.
@@ -184,9 +228,16 @@ struct io_can_chan_impl {
 	unsigned read_posted : 1;
 	/// A flag indicating whether #write_task has been posted to #exec.
 	unsigned write_posted : 1;
+	/// A flag indicating whether the filters at #filters are installed.
+	unsigned filtered : 1;
 	/// The queue containing pending read operations.
 	struct sllist read_queue;
-	/// The queue containing pending write operations.
+	/**
+	 * The queue containing pending write operations. The <b>_data</b>
+	 * member of the task of a vectored write operation points to
+	 * #io_can_chan_impl_write_vec_tag; for single-frame write operations it
+	 * is NULL.
+	 */
 	struct sllist write_queue;
 	/// The queue containing write operations waiting to be confirmed.
 	struct sllist confirm_queue;
@@ -209,12 +260,39 @@ static inline struct io_can_chan_impl *io_can_chan_impl_from_svc(
 
 static void io_can_chan_impl_c_signal(struct spscring *ring, void *arg);
 
+/**
+ * The tag stored in the <b>_data</b> member of the task of a vectored write
+ * operation to distinguish it from a single-frame write operation.
+ */
+static char io_can_chan_impl_write_vec_tag;
+
+/**
+ * Returns a pointer to the vectored write operation containing the specified
+ * task, or NULL if the task belongs to a single-frame write operation.
+ */
+static inline struct io_can_chan_write_vec *io_can_chan_impl_write_vec_from_task(
+		struct ev_task *task);
+static void io_can_chan_impl_write_set_errc(struct ev_task *task, int errc);
+static void io_can_chan_impl_write_post(struct ev_task *task, int errc);
+static size_t io_can_chan_impl_write_queue_post(
+		struct sllist *queue, int errc);
+static int io_can_chan_impl_write_cmp(
+		struct ev_task *task, const struct can_msg *msg);
+
 static void io_can_chan_impl_do_pop(struct io_can_chan_impl *impl,
 		struct sllist *read_queue, struct sllist *write_queue,
 		struct sllist *confirm_queue, struct ev_task *task);
 
 static void io_can_chan_impl_do_read(struct io_can_chan_impl *impl,
 		struct sllist *queue, int *pwouldblock);
+/**
+ * Extends the CAN identifier filters of a CAN channel, if necessary, so the
+ * write confirmations of the specified CAN frames are received. This function
+ * MUST be invoked with the mutex locked.
+ */
+static void io_can_chan_impl_filter_msgs(struct io_can_chan_impl *impl,
+		const struct can_msg *msgs, size_t n);
+
 static void io_can_chan_impl_do_confirm(struct io_can_chan_impl *impl,
 		struct sllist *queue, const struct can_msg *msg);
 
@@ -281,6 +359,7 @@ io_can_chan_init(io_can_chan_t *chan, io_poll_t *poll, ev_exec_t *exec,
 		errsv = errno;
 		goto error_alloc_rxbuf;
 	}
+	impl->rxbatch = LELY_IO_CAN_RXBATCH;
 
 #if !LELY_NO_THREADS
 	if ((errsv = pthread_mutex_init(&impl->mtx, NULL)))
@@ -291,10 +370,15 @@ io_can_chan_init(io_can_chan_t *chan, io_poll_t *poll, ev_exec_t *exec,
 	impl->flags = 0;
 	impl->events = 0;
 
+	impl->filters = NULL;
+	impl->nfilters = 0;
+	impl->maxfilters = 0;
+
 	impl->shutdown = 0;
 	impl->rxbuf_posted = 0;
 	impl->read_posted = 0;
 	impl->write_posted = 0;
+	impl->filtered = 0;
 
 	sllist_init(&impl->read_queue);
 	sllist_init(&impl->write_queue);
@@ -367,6 +451,8 @@ io_can_chan_fini(io_can_chan_t *chan)
 	pthread_mutex_destroy(&impl->mtx);
 #endif
 
+	free(impl->filters);
+
 	free(impl->rxbuf);
 
 #if !LELY_NO_THREADS
@@ -574,6 +660,45 @@ io_can_chan_close(io_can_chan_t *chan)
 	return fd != -1 ? close(fd) : 0;
 }
 
+size_t
+io_can_chan_get_rxbatch(const io_can_chan_t *chan)
+{
+	const struct io_can_chan_impl *impl = io_can_chan_impl_from_chan(chan);
+
+#if !LELY_NO_THREADS
+	pthread_mutex_lock((pthread_mutex_t *)&impl->mtx);
+#endif
+	size_t rxbatch = impl->rxbatch;
+#if !LELY_NO_THREADS
+	pthread_mutex_unlock((pthread_mutex_t *)&impl->mtx);
+#endif
+	return rxbatch;
+}
+
+int
+io_can_chan_set_rxbatch(io_can_chan_t *chan, size_t rxbatch)
+{
+	struct io_can_chan_impl *impl = io_can_chan_impl_from_chan(chan);
+
+	if (rxbatch > LELY_IO_CAN_RXBATCH) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!rxbatch)
+		rxbatch = LELY_IO_CAN_RXBATCH;
+
+#if !LELY_NO_THREADS
+	pthread_mutex_lock(&impl->mtx);
+#endif
+	impl->rxbatch = rxbatch;
+#if !LELY_NO_THREADS
+	pthread_mutex_unlock(&impl->mtx);
+#endif
+
+	return 0;
+}
+
 static int
 io_can_fd_set_default(int fd)
 {
@@ -596,6 +721,15 @@ io_can_fd_set_default(int fd)
 		// clang-format on
 		return -1;
 
+	// Receive a timestamp with every CAN frame, so we do not need an
+	// additional system call to obtain it.
+	optval = 1;
+	// clang-format off
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &optval, sizeof(optval))
+			== -1)
+		// clang-format on
+		return -1;
+
 	// Set the size of the send buffer to its minimum value. This causes
 	// write operations to block (or return EAGAIN) instead of returning
 	// ENOBUFS.
@@ -610,53 +744,94 @@ io_can_fd_set_default(int fd)
 }
 
 static int
-#if LELY_NO_CANFD
-io_can_fd_read(int fd, struct can_frame *frame, size_t *pnbytes, int *pflags,
-		struct timespec *tp, int timeout)
-#else
-io_can_fd_read(int fd, struct canfd_frame *frame, size_t *pnbytes, int *pflags,
-		struct timespec *tp, int timeout)
-#endif
+io_can_fd_set_filter(int fd, const struct can_filter *filters, size_t n)
 {
-	struct iovec iov = { .iov_base = (void *)frame,
-		.iov_len = sizeof(*frame) };
-	struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+	// Accept all CAN frames if no filters are specified.
+	struct can_filter filter = { 0, 0 };
+	if (!filters) {
+		filters = &filter;
+		n = 1;
+	}
 
-	ssize_t result;
-	for (;;) {
-		result = io_fd_recvmsg(fd, &msg, 0, timeout);
+	// clang-format off
+	return setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, n ? filters : NULL,
+			n * sizeof(*filters));
+	// clang-format on
+}
+
+static ssize_t
+io_can_fd_read(int fd, struct io_can_frame *frames, size_t n, int timeout)
+{
+	assert(frames);
+	assert(n && n <= LELY_IO_CAN_RXBATCH);
+
+	struct iovec iov[LELY_IO_CAN_RXBATCH];
+	struct mmsghdr msgvec[LELY_IO_CAN_RXBATCH];
+	// The control buffers MUST be suitably aligned for struct cmsghdr, which
+	// consists of size_t and int members.
+	union {
+		size_t align;
+		char buf[CMSG_SPACE(sizeof(struct timespec))];
+	} control[LELY_IO_CAN_RXBATCH];
+
+	size_t nframes = 0;
+	while (!nframes) {
+		for (size_t i = 0; i < n; i++) {
+			iov[i] = (struct iovec){ .iov_base = &frames[i].frame,
+				.iov_len = sizeof(frames[i].frame) };
+			msgvec[i] = (struct mmsghdr){ .msg_hdr = {
+					.msg_iov = &iov[i],
+					.msg_iovlen = 1,
+					.msg_control = &control[i],
+					.msg_controllen = sizeof(control[i]) } };
+		}
+
+		int result = io_fd_recvmmsg(fd, msgvec, n, 0, timeout);
 		if (result < 0)
-			return result;
+			return -1;
+
+		// Discard messages that are not CAN or CAN FD frames and move
+		// the remaining frames to the front.
+		for (size_t i = 0; i < (size_t)result; i++) {
+			struct msghdr *msg = &msgvec[i].msg_hdr;
+			size_t nbytes = msgvec[i].msg_len;
 #if LELY_NO_CANFD
-		if (result == CAN_MTU)
+			if (nbytes != CAN_MTU)
 #else
-		if (result == CAN_MTU || result == CANFD_MTU)
+			if (nbytes != CAN_MTU && nbytes != CANFD_MTU)
 #endif
-			break;
-		if (timeout > 0)
-			timeout = 0;
-	}
+				continue;
 
-	if (pnbytes)
-		*pnbytes = result;
+			struct io_can_frame *frame = &frames[nframes++];
+			if (frame != &frames[i])
+				frame->frame = frames[i].frame;
+			frame->nbytes = nbytes;
+			frame->flags = msg->msg_flags;
 
-	if (pflags)
-		*pflags = msg.msg_flags;
-
-	if (tp) {
-		if (msg.msg_flags & MSG_CONFIRM) {
 			// Ignore the timestamp for write confirmations.
-			*tp = (struct timespec){ 0, 0 };
-		} else {
-			struct timeval tv = { 0, 0 };
-			if (ioctl(fd, SIOCGSTAMP, &tv) == -1)
-				return -1;
-			tp->tv_sec = tv.tv_sec;
-			tp->tv_nsec = tv.tv_usec * 1000;
+			frame->ts = (struct timespec){ 0, 0 };
+			if (msg->msg_flags & MSG_CONFIRM)
+				continue;
+			struct cmsghdr *cmsg;
+			for (cmsg = CMSG_FIRSTHDR(msg); cmsg;
+					cmsg = CMSG_NXTHDR(msg, cmsg)) {
+				if (cmsg->cmsg_level == SOL_SOCKET
+						&& cmsg->cmsg_type
+								== SCM_TIMESTAMPNS) {
+					memcpy(&frame->ts, CMSG_DATA(cmsg),
+							sizeof(frame->ts));
+					break;
+				}
+			}
 		}
+
+		// Since the timeout is relative, we can only use a positive
+		// value once.
+		if (timeout > 0)
+			timeout = 0;
 	}
 
-	return 0;
+	return nframes;
 }
 
 static int
@@ -681,26 +856,68 @@ io_can_fd_write_msg(int fd, const struct can_msg *msg, int timeout)
 
 	// Convert the frame to the SocketCAN format.
 	struct io_can_frame frame;
+	if (io_can_frame_from_msg(&frame, msg) == -1)
+		return -1;
+
+	return io_can_fd_write(fd, &frame.frame, frame.nbytes, timeout);
+}
+
+static ssize_t
+io_can_fd_write_vec(int fd, const struct can_msg *msgs, size_t n, int timeout)
+{
+	assert(msgs);
+	assert(n);
+
+	if (n > LELY_IO_CAN_TXBATCH)
+		n = LELY_IO_CAN_TXBATCH;
+
+	struct io_can_frame frames[LELY_IO_CAN_TXBATCH];
+	struct iovec iov[LELY_IO_CAN_TXBATCH];
+	struct mmsghdr msgvec[LELY_IO_CAN_TXBATCH];
+	for (size_t i = 0; i < n; i++) {
+		// Convert the frame to the SocketCAN format. If the conversion
+		// fails, only write the preceding frames.
+		if (io_can_frame_from_msg(&frames[i], &msgs[i]) == -1) {
+			if (!i)
+				return -1;
+			n = i;
+			break;
+		}
+		iov[i] = (struct iovec){ .iov_base = &frames[i].frame,
+			.iov_len = frames[i].nbytes };
+		msgvec[i] = (struct mmsghdr){ .msg_hdr = {
+				.msg_iov = &iov[i], .msg_iovlen = 1 } };
+	}
+
+	return io_fd_sendmmsg(fd, msgvec, n, 0, timeout);
+}
+
+static int
+io_can_frame_from_msg(struct io_can_frame *frame, const struct can_msg *msg)
+{
+	assert(frame);
+	assert(msg);
+
 #if !LELY_NO_CANFD
 	if (msg->flags & CAN_FLAG_FDF) {
-		if (can_msg2canfd_frame(msg, &frame.frame) == -1) {
+		if (can_msg2canfd_frame(msg, &frame->frame) == -1) {
 			errno = EINVAL;
 			return -1;
 		}
-		frame.nbytes = CANFD_MTU;
+		frame->nbytes = CANFD_MTU;
 	} else {
 #endif
-		if (can_msg2can_frame(msg, (struct can_frame *)&frame.frame)
+		if (can_msg2can_frame(msg, (struct can_frame *)&frame->frame)
 				== -1) {
 			errno = EINVAL;
 			return -1;
 		}
-		frame.nbytes = CAN_MTU;
+		frame->nbytes = CAN_MTU;
 #if !LELY_NO_CANFD
 	}
 #endif
 
-	return io_can_fd_write(fd, &frame.frame, frame.nbytes, timeout);
+	return 0;
 }
 
 static io_ctx_t *
@@ -747,10 +964,11 @@ io_can_chan_impl_dev_cancel(io_dev_t *dev, struct ev_task *task)
 
 	size_t nread = io_can_chan_read_queue_post(&read_queue, -1, ECANCELED);
 	n = n < SIZE_MAX - nread ? n + nread : SIZE_MAX;
-	size_t nwrite = io_can_chan_write_queue_post(&write_queue, ECANCELED);
+	size_t nwrite = io_can_chan_impl_write_queue_post(
+			&write_queue, ECANCELED);
 	n = n < SIZE_MAX - nwrite ? n + nwrite : SIZE_MAX;
-	size_t nconfirm =
-			io_can_chan_write_queue_post(&confirm_queue, ECANCELED);
+	size_t nconfirm = io_can_chan_impl_write_queue_post(
+			&confirm_queue, ECANCELED);
 	n = n < SIZE_MAX - nconfirm ? n + nconfirm : SIZE_MAX;
 
 	return n;
@@ -826,14 +1044,10 @@ io_can_chan_impl_read(io_can_chan_t *chan, struct can_msg *msg,
 #if !LELY_NO_THREADS
 		pthread_mutex_unlock(&impl->mtx);
 #endif
-		int flags = 0;
-		// clang-format off
-		if (io_can_fd_read(fd, &frame->frame, &frame->nbytes, &flags,
-				&frame->ts, timeout) < 0)
-			// clang-format on
+		if (io_can_fd_read(fd, frame, 1, timeout) < 0)
 			return -1;
 		// Process the frame unless it is a write confirmation.
-		if (!(flags & MSG_CONFIRM))
+		if (!(frame->flags & MSG_CONFIRM))
 			break;
 		// Convert the frame from the SocketCAN format.
 		void *src = &frame->frame;
@@ -949,6 +1163,7 @@ io_can_chan_impl_write(
 	}
 #endif
 	int fd = impl->fd;
+	io_can_chan_impl_filter_msgs(impl, msg, 1);
 #if !LELY_NO_THREADS
 	pthread_mutex_unlock(&impl->mtx);
 #endif
@@ -978,6 +1193,9 @@ io_can_chan_impl_submit_write(
 	assert(task->exec);
 	ev_exec_on_task_init(task->exec);
 
+	// Mark the task as a single-frame write operation.
+	task->_data = NULL;
+
 #if !LELY_NO_THREADS
 	pthread_mutex_lock(&impl->mtx);
 #endif
@@ -1008,6 +1226,135 @@ io_can_chan_impl_submit_write(
 	}
 }
 
+static void
+io_can_chan_impl_submit_write_vec(
+		io_can_chan_t *chan, struct io_can_chan_write_vec *write)
+{
+	struct io_can_chan_impl *impl = io_can_chan_impl_from_chan(chan);
+	assert(write);
+	assert(write->msgs || !write->nmsgs);
+	struct ev_task *task = &write->task;
+
+#if !LELY_NO_CANFD
+	int flags = 0;
+	for (size_t i = 0; i < write->nmsgs; i++) {
+		if (write->msgs[i].flags & CAN_FLAG_FDF)
+			flags |= IO_CAN_BUS_FLAG_FDF;
+		if (write->msgs[i].flags & CAN_FLAG_BRS)
+			flags |= IO_CAN_BUS_FLAG_BRS;
+	}
+#endif
+
+	if (!task->exec)
+		task->exec = impl->exec;
+	assert(task->exec);
+	ev_exec_on_task_init(task->exec);
+
+	// Mark the task as a vectored write operation.
+	task->_data = &io_can_chan_impl_write_vec_tag;
+
+	write->n = 0;
+	write->_i = 0;
+
+#if !LELY_NO_THREADS
+	pthread_mutex_lock(&impl->mtx);
+#endif
+	if (impl->shutdown) {
+#if !LELY_NO_THREADS
+		pthread_mutex_unlock(&impl->mtx);
+#endif
+		io_can_chan_impl_write_post(task, ECANCELED);
+#if !LELY_NO_CANFD
+	} else if ((flags & impl->flags) != flags) {
+#if !LELY_NO_THREADS
+		pthread_mutex_unlock(&impl->mtx);
+#endif
+		io_can_chan_impl_write_post(task, EINVAL);
+#endif
+	} else if (!write->nmsgs) {
+#if !LELY_NO_THREADS
+		pthread_mutex_unlock(&impl->mtx);
+#endif
+		io_can_chan_impl_write_post(task, 0);
+	} else {
+		int post_write = !impl->write_posted
+				&& sllist_empty(&impl->write_queue);
+		sllist_push_back(&impl->write_queue, &task->_node);
+		if (post_write)
+			impl->write_posted = 1;
+#if !LELY_NO_THREADS
+		pthread_mutex_unlock(&impl->mtx);
+#endif
+		assert(impl->write_task.exec);
+		if (post_write)
+			ev_exec_post(impl->write_task.exec, &impl->write_task);
+	}
+}
+
+static int
+io_can_chan_impl_set_filter(io_can_chan_t *chan,
+		const struct can_net_filter *filters, size_t n)
+{
+	struct io_can_chan_impl *impl = io_can_chan_impl_from_chan(chan);
+
+	if (!filters)
+		n = 0;
+	if (n > CAN_RAW_FILTER_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+#if !LELY_NO_THREADS
+	pthread_mutex_lock(&impl->mtx);
+#endif
+	// Reserve some space for the filters added by
+	// io_can_chan_impl_filter_msgs().
+	if (filters && n + 8 > impl->maxfilters) {
+		size_t maxfilters = MIN(n + 8, CAN_RAW_FILTER_MAX);
+		struct can_filter *tmp = realloc(impl->filters,
+				maxfilters * sizeof(struct can_filter));
+		if (!tmp) {
+#if !LELY_NO_THREADS
+			pthread_mutex_unlock(&impl->mtx);
+#endif
+			return -1;
+		}
+		impl->filters = tmp;
+		impl->maxfilters = maxfilters;
+	}
+
+	// Convert the filters to the SocketCAN format.
+	for (size_t i = 0; i < n; i++) {
+		struct can_filter *filter = &impl->filters[i];
+		if (filters[i].flags & CAN_FLAG_IDE) {
+			filter->can_id = (filters[i].id & CAN_EFF_MASK)
+					| CAN_EFF_FLAG;
+			filter->can_mask = (filters[i].mask & CAN_EFF_MASK)
+					| CAN_EFF_FLAG;
+		} else {
+			filter->can_id = filters[i].id & CAN_SFF_MASK;
+			filter->can_mask = (filters[i].mask & CAN_SFF_MASK)
+					| CAN_EFF_FLAG;
+		}
+	}
+
+	int result = -1;
+	if (impl->fd == -1)
+		errno = EBADF;
+	else
+		result = io_can_fd_set_filter(impl->fd,
+				filters ? impl->filters : NULL, n);
+	if (!result) {
+		impl->nfilters = n;
+		impl->filtered = filters != NULL;
+	}
+#if !LELY_NO_THREADS
+	pthread_mutex_unlock(&impl->mtx);
+#endif
+
+	return result;
+}
+
 static void
 io_can_chan_impl_svc_shutdown(struct io_svc *svc)
 {
@@ -1118,49 +1465,61 @@ io_can_chan_impl_rxbuf_task_func(struct ev_task *task)
 			|| !sllist_empty(&impl->confirm_queue)) {
 		// clang-format on
 		int fd = impl->fd;
+		size_t n = impl->rxbatch;
 #if !LELY_NO_THREADS
 		pthread_mutex_unlock(&impl->mtx);
 #endif
 
 		struct io_can_frame frame_;
 		struct io_can_frame *frame = &frame_;
-		// Try to obtain an empty slot in the receive queue.
-		size_t n = 1;
-		size_t i = spscring_p_alloc(&impl->rxring, &n);
+		// Try to obtain a consecutive range of empty slots in the
+		// receive queue. The range MUST NOT wrap, since the frames are
+		// read directly into the buffer. If the queue is full, we only
+		// read a single frame, to check for write confirmations.
+		size_t i = spscring_p_alloc_no_wrap(&impl->rxring, &n);
 		if (n)
 			frame = &impl->rxbuf[i];
 
-		// Try to read a CAN or CAN FD format frame from the CAN bus.
-		int flags = 0;
-		result = io_can_fd_read(fd, &frame->frame, &frame->nbytes,
-				&flags, &frame->ts,
+		// Try to read a batch of CAN or CAN FD format frames from the
+		// CAN bus.
+		ssize_t nframes = io_can_fd_read(fd, frame, n ? n : 1,
 				impl->poll ? 0 : LELY_IO_RX_TIMEOUT);
+		result = nframes < 0 ? -1 : 0;
 		errc = !result ? 0 : errno;
 		wouldblock = errc == EAGAIN || errc == EWOULDBLOCK;
 
-		// Convert the frame from the SocketCAN format if it is a write
-		// confirmation.
-		struct can_msg msg;
-		if (!result && (flags & MSG_CONFIRM)) {
-			void *src = &frame->frame;
+		// Convert the write confirmations from the SocketCAN format and
+		// move the remaining frames to the front.
+		struct can_msg msg[LELY_IO_CAN_RXBATCH];
+		size_t nmsg = 0;
+		size_t nrecv = 0;
+		for (ssize_t j = 0; j < nframes; j++) {
+			if (!(frame[j].flags & MSG_CONFIRM)) {
+				if (nrecv != (size_t)j)
+					frame[nrecv] = frame[j];
+				nrecv++;
+				continue;
+			}
+			void *src = &frame[j].frame;
 #if !LELY_NO_CANFD
-			if (frame->nbytes == CANFD_MTU)
-				canfd_frame2can_msg(src, &msg);
+			if (frame[j].nbytes == CANFD_MTU)
+				canfd_frame2can_msg(src, &msg[nmsg]);
 			else
 #endif
-				can_frame2can_msg(src, &msg);
+				can_frame2can_msg(src, &msg[nmsg]);
+			nmsg++;
 		}
 
-		// Make the frame available for reading.
-		if (!result && !(flags & MSG_CONFIRM))
-			spscring_p_commit(&impl->rxring, n);
+		// Make the frames available for reading.
+		if (n && nrecv)
+			spscring_p_commit(&impl->rxring, nrecv);
 
 #if !LELY_NO_THREADS
 		pthread_mutex_lock(&impl->mtx);
 #endif
-		// Process the write confirmation, if any.
-		if (!result && flags & MSG_CONFIRM)
-			io_can_chan_impl_do_confirm(impl, &queue, &msg);
+		// Process the write confirmations, if any.
+		for (size_t j = 0; j < nmsg; j++)
+			io_can_chan_impl_do_confirm(impl, &queue, &msg[j]);
 
 		// Stop if the operation did or would block, or if an error
 		// occurred.
@@ -1276,6 +1635,9 @@ io_can_chan_impl_write_task_func(struct ev_task *task)
 
 	int errsv = errno;
 
+	struct sllist queue;
+	sllist_init(&queue);
+
 	int wouldblock = 0;
 
 #if !LELY_NO_THREADS
@@ -1286,33 +1648,76 @@ io_can_chan_impl_write_task_func(struct ev_task *task)
 	while ((task = impl->current_write = ev_task_from_node(
 				sllist_pop_front(&impl->write_queue)))) {
 		int fd = impl->fd;
+		struct io_can_chan_write_vec *write_vec =
+				io_can_chan_impl_write_vec_from_task(task);
+		size_t i = write_vec ? write_vec->_i : 0;
+		if (write_vec)
+			io_can_chan_impl_filter_msgs(impl, write_vec->msgs + i,
+					write_vec->nmsgs - i);
+		else
+			io_can_chan_impl_filter_msgs(impl,
+					io_can_chan_write_from_task(task)->msg,
+					1);
 #if !LELY_NO_THREADS
 		pthread_mutex_unlock(&impl->mtx);
 #endif
-		struct io_can_chan_write *write =
-				io_can_chan_write_from_task(task);
-		int result = io_can_fd_write_msg(fd, write->msg,
-				impl->poll ? 0 : LELY_IO_TX_TIMEOUT);
-		int errc = !result ? 0 : errno;
+		int timeout = impl->poll ? 0 : LELY_IO_TX_TIMEOUT;
+		int errc = 0;
+		// A flag indicating whether only some of the frames of a
+		// vectored write operation were written.
+		int partial = 0;
+		if (write_vec) {
+			// Write as many of the remaining frames as possible
+			// with a single system call.
+			ssize_t result = io_can_fd_write_vec(fd,
+					write_vec->msgs + i,
+					write_vec->nmsgs - i, timeout);
+			if (result < 0) {
+				errc = errno;
+			} else {
+				i += result;
+				partial = i < write_vec->nmsgs;
+			}
+		} else {
+			struct io_can_chan_write *write =
+					io_can_chan_write_from_task(task);
+			if (io_can_fd_write_msg(fd, write->msg, timeout) == -1)
+				errc = errno;
+		}
 		wouldblock = errc == EAGAIN || errc == EWOULDBLOCK;
 		if (!wouldblock && errc)
 			// The operation failed immediately.
-			io_can_chan_write_post(write, errc);
+			io_can_chan_impl_write_post(task, errc);
 #if !LELY_NO_THREADS
 		pthread_mutex_lock(&impl->mtx);
 #endif
-		if (!errc)
-			// Wait for the write confirmation.
-			sllist_push_back(&impl->confirm_queue, &task->_node);
+		if (write_vec)
+			write_vec->_i = i;
+		if (!errc && !partial) {
+			if (write_vec && write_vec->n == write_vec->nmsgs) {
+				// All frames were confirmed while we were
+				// writing the last ones.
+				io_can_chan_impl_write_set_errc(task, 0);
+				sllist_push_back(&queue, &task->_node);
+			} else {
+				// Wait for the write confirmation.
+				sllist_push_back(&impl->confirm_queue,
+						&task->_node);
+			}
+		}
 		if (task == impl->current_write) {
 			// Put the write operation back on the queue if it would
-			// block, unless it was canceled.
-			if (wouldblock) {
+			// block or was only partially written, unless it was
+			// canceled.
+			if (wouldblock || partial)
 				sllist_push_front(&impl->write_queue,
 						&task->_node);
-				task = NULL;
-			}
 			impl->current_write = NULL;
+		} else if (wouldblock || partial) {
+			// The operation was canceled before it could be
+			// requeued.
+			io_can_chan_impl_write_set_errc(task, ECANCELED);
+			sllist_push_back(&queue, &task->_node);
 		}
 		assert(!impl->current_write);
 		// Stop if the operation did or would block.
@@ -1349,11 +1754,7 @@ io_can_chan_impl_write_task_func(struct ev_task *task)
 	pthread_mutex_unlock(&impl->mtx);
 #endif
 
-	if (task && wouldblock)
-		// The operation would block but was canceled before it could be
-		// requeued.
-		io_can_chan_write_post(
-				io_can_chan_write_from_task(task), ECANCELED);
+	ev_task_queue_post(&queue);
 
 	if (post_rxbuf)
 		ev_exec_post(impl->rxbuf_task.exec, &impl->rxbuf_task);
@@ -1410,6 +1811,72 @@ io_can_chan_impl_c_signal(struct spscring *ring, void *arg)
 		ev_exec_post(impl->read_task.exec, &impl->read_task);
 }
 
+static inline struct io_can_chan_write_vec *
+io_can_chan_impl_write_vec_from_task(struct ev_task *task)
+{
+	assert(task);
+
+	if (task->_data != &io_can_chan_impl_write_vec_tag)
+		return NULL;
+	return io_can_chan_write_vec_from_task(task);
+}
+
+static void
+io_can_chan_impl_write_set_errc(struct ev_task *task, int errc)
+{
+	assert(task);
+
+	struct io_can_chan_write_vec *write_vec =
+			io_can_chan_impl_write_vec_from_task(task);
+	if (write_vec)
+		write_vec->errc = errc;
+	else
+		io_can_chan_write_from_task(task)->errc = errc;
+}
+
+static void
+io_can_chan_impl_write_post(struct ev_task *task, int errc)
+{
+	assert(task);
+
+	io_can_chan_impl_write_set_errc(task, errc);
+
+	ev_exec_t *exec = task->exec;
+	ev_exec_post(exec, task);
+	ev_exec_on_task_fini(exec);
+}
+
+static size_t
+io_can_chan_impl_write_queue_post(struct sllist *queue, int errc)
+{
+	size_t n = 0;
+
+	struct slnode *node;
+	while ((node = sllist_pop_front(queue))) {
+		io_can_chan_impl_write_post(ev_task_from_node(node), errc);
+		n += n < SIZE_MAX;
+	}
+
+	return n;
+}
+
+static int
+io_can_chan_impl_write_cmp(struct ev_task *task, const struct can_msg *msg)
+{
+	assert(task);
+	assert(msg);
+
+	struct io_can_chan_write_vec *write_vec =
+			io_can_chan_impl_write_vec_from_task(task);
+	if (write_vec) {
+		// Compare the frame with the first unconfirmed frame.
+		if (write_vec->n >= write_vec->nmsgs)
+			return 1;
+		return can_msg_cmp(msg, &write_vec->msgs[write_vec->n]);
+	}
+	return can_msg_cmp(msg, io_can_chan_write_from_task(task)->msg);
+}
+
 static void
 io_can_chan_impl_do_pop(struct io_can_chan_impl *impl,
 		struct sllist *read_queue, struct sllist *write_queue,
@@ -1498,6 +1965,62 @@ io_can_chan_impl_do_read(struct io_can_chan_impl *impl, struct sllist *queue,
 	errno = errsv;
 }
 
+static void
+io_can_chan_impl_filter_msgs(struct io_can_chan_impl *impl,
+		const struct can_msg *msgs, size_t n)
+{
+	assert(impl);
+	assert(msgs || !n);
+
+	if (!impl->filtered || impl->fd == -1)
+		return;
+
+	size_t nfilters = impl->nfilters;
+	for (size_t i = 0; i < n; i++) {
+		canid_t can_id;
+		canid_t can_mask;
+		if (msgs[i].flags & CAN_FLAG_IDE) {
+			can_id = (msgs[i].id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+			can_mask = CAN_EFF_MASK | CAN_EFF_FLAG;
+		} else {
+			can_id = msgs[i].id & CAN_SFF_MASK;
+			can_mask = CAN_SFF_MASK | CAN_EFF_FLAG;
+		}
+
+		int match = 0;
+		for (size_t j = 0; !match && j < nfilters; j++) {
+			const struct can_filter *filter = &impl->filters[j];
+			match = !((can_id ^ filter->can_id) & filter->can_mask);
+		}
+		if (match)
+			continue;
+
+		// If there is no room for another filter, accept all frames.
+		if (nfilters >= impl->maxfilters) {
+			nfilters = 0;
+			break;
+		}
+		impl->filters[nfilters++] =
+				(struct can_filter){ can_id, can_mask };
+	}
+
+	if (nfilters == impl->nfilters)
+		return;
+
+	if (nfilters && !io_can_fd_set_filter(impl->fd, impl->filters,
+					nfilters)) {
+		impl->nfilters = nfilters;
+	} else {
+		// Fall back to accepting all frames, since we cannot afford to
+		// miss the write confirmation.
+		int errsv = errno;
+		io_can_fd_set_filter(impl->fd, NULL, 0);
+		errno = errsv;
+		impl->nfilters = 0;
+		impl->filtered = 0;
+	}
+}
+
 static void
 io_can_chan_impl_do_confirm(struct io_can_chan_impl *impl, struct sllist *queue,
 		const struct can_msg *msg)
@@ -1509,13 +2032,31 @@ io_can_chan_impl_do_confirm(struct io_can_chan_impl *impl, struct sllist *queue,
 	// Find the matching write operation.
 	struct slnode *node = sllist_first(&impl->confirm_queue);
 	while (node) {
-		struct io_can_chan_write *write = io_can_chan_write_from_task(
-				ev_task_from_node(node));
-		if (!can_msg_cmp(msg, write->msg))
+		if (!io_can_chan_impl_write_cmp(ev_task_from_node(node), msg))
 			break;
 		node = node->next;
 	}
-	if (!node)
+	if (!node) {
+		// The frame may have been written by the vectored write
+		// operation that is currently being written, or that is waiting
+		// to write its remaining frames.
+		struct ev_task *task = impl->current_write;
+		if (!task)
+			task = ev_task_from_node(
+					sllist_first(&impl->write_queue));
+		struct io_can_chan_write_vec *write =
+				io_can_chan_impl_write_vec_from_task(task);
+		if (write && !io_can_chan_impl_write_cmp(task, msg))
+			write->n++;
+		return;
+	}
+
+	// A vectored write operation only completes once all its frames have
+	// been confirmed.
+	struct io_can_chan_write_vec *write_vec =
+			io_can_chan_impl_write_vec_from_task(
+					ev_task_from_node(node));
+	if (write_vec && ++write_vec->n < write_vec->nmsgs)
 		return;
 
 	// Complete the matching write operation. Any preceding write operations
@@ -1524,13 +2065,11 @@ io_can_chan_impl_do_confirm(struct io_can_chan_impl *impl, struct sllist *queue,
 	while ((task = ev_task_from_node(
 				sllist_pop_front(&impl->confirm_queue)))) {
 		sllist_push_front(queue, &task->_node);
-		struct io_can_chan_write *write =
-				io_can_chan_write_from_task(task);
 		if (&task->_node == node) {
-			write->errc = 0;
+			io_can_chan_impl_write_set_errc(task, 0);
 			break;
 		} else {
-			write->errc = EIO;
+			io_can_chan_impl_write_set_errc(task, EIO);
 		}
 	}
 }
@@ -1612,6 +2151,10 @@ io_can_chan_impl_set_fd(struct io_can_chan_impl *impl, int fd, int flags)
 
 	impl->flags = flags;
 
+	// A new socket accepts all CAN frames.
+	impl->nfilters = 0;
+	impl->filtered = 0;
+
 	// Cancel pending operations.
 	sllist_append(&read_queue, &impl->read_queue);
 	sllist_append(&write_queue, &impl->write_queue);
@@ -1625,8 +2168,8 @@ io_can_chan_impl_set_fd(struct io_can_chan_impl *impl, int fd, int flags)
 #endif
 
 	io_can_chan_read_queue_post(&read_queue, -1, ECANCELED);
-	io_can_chan_write_queue_post(&write_queue, ECANCELED);
-	io_can_chan_write_queue_post(&confirm_queue, ECANCELED);
+	io_can_chan_impl_write_queue_post(&write_queue, ECANCELED);
+	io_can_chan_impl_write_queue_post(&confirm_queue, ECANCELED);
 
 	return fd;
 }
@@ -25,6 +25,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stddef.h>
 
 #include <fcntl.h>
 #include <poll.h>
@@ -112,6 +113,50 @@ io_fd_recvmsg(int fd, struct msghdr *msg, int flags, int timeout)
 	return result;
 }
 
+#ifdef __linux__
+int
+io_fd_recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags,
+		int timeout)
+{
+	assert(msgvec);
+	assert(vlen);
+
+	// Do not wait for more messages once the first one has been received.
+	flags |= MSG_WAITFORONE;
+#ifdef MSG_DONTWAIT
+	if (timeout >= 0)
+		flags |= MSG_DONTWAIT;
+#endif
+
+	int result = 0;
+	int errsv = errno;
+	for (;;) {
+		errno = errsv;
+		// Try to receive one or more messages.
+		result = recvmmsg(fd, msgvec, vlen, flags, NULL);
+		if (result >= 0)
+			break;
+		if (errno == EINTR)
+			continue;
+		if (!timeout || (errno != EAGAIN && errno != EWOULDBLOCK))
+			return -1;
+		// Wait for a message to arrive.
+		// clang-format off
+		int events = (flags & MSG_OOB)
+				? (POLLRDBAND | POLLPRI) : POLLRDNORM;
+		// clang-format on
+		if (io_fd_wait(fd, &events, timeout) == -1)
+			return -1;
+		// Since the timeout is relative, we can only use a positive
+		// value once.
+		if (timeout > 0)
+			timeout = 0;
+	}
+
+	return result;
+}
+#endif
+
 ssize_t
 io_fd_sendmsg(int fd, const struct msghdr *msg, int flags, int timeout)
 {
@@ -145,4 +190,49 @@ io_fd_sendmsg(int fd, const struct msghdr *msg, int flags, int timeout)
 	return result;
 }
 
+#ifdef __linux__
+int
+io_fd_sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen, int flags,
+		int timeout)
+{
+	assert(msgvec);
+	assert(vlen);
+
+	flags |= MSG_NOSIGNAL;
+#ifdef MSG_DONTWAIT
+	if (timeout >= 0)
+		flags |= MSG_DONTWAIT;
+#endif
+
+	int result = 0;
+	int errsv = errno;
+	for (;;) {
+		errno = errsv;
+		// Try to send one or more messages.
+		result = sendmmsg(fd, msgvec, vlen, flags);
+		if (result > 0)
+			break;
+		if (!result) {
+			// This should not happen, but make sure we do not
+			// report success if no message was sent.
+			errno = EAGAIN;
+		} else if (errno == EINTR) {
+			continue;
+		}
+		if (!timeout || (errno != EAGAIN && errno != EWOULDBLOCK))
+			return -1;
+		// Wait for the socket to become ready.
+		int events = (flags & MSG_OOB) ? POLLWRBAND : POLLWRNORM;
+		if (io_fd_wait(fd, &events, timeout) == -1)
+			return -1;
+		// Since the timeout is relative, we can only use a positive
+		// value once.
+		if (timeout > 0)
+			timeout = 0;
+	}
+
+	return result;
+}
+#endif
+
 #endif // !LELY_NO_STDIO && _POSIX_C_SOURCE >= 200112L
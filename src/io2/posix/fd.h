@@ -66,6 +66,23 @@ int io_fd_wait(int fd, int *events, int timeout);
  */
 ssize_t io_fd_recvmsg(int fd, struct msghdr *msg, int flags, int timeout);
 
+#ifdef __linux__
+/**
+ * Equivalent to Linux `recvmmsg(fd, msgvec, vlen, flags, NULL)`, except that if
+ * <b>fd</b> is non-blocking (or the implementation supports the `MSG_DONTWAIT`
+ * flag) and <b>timeout</b> is non-negative, this function behaves as if
+ * <b>fd</b> is blocking and the `SO_RCVTIMEO` option is set with <b>timeout</b>
+ * milliseconds. Once at least one message has been received, this function
+ * returns the messages that are immediately available, without waiting for
+ * <b>vlen</b> messages to arrive.
+ *
+ * @returns the number of messages received, or -1 on error. In the latter
+ * case, the error number can be obtained from `errno`.
+ */
+int io_fd_recvmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen,
+		int flags, int timeout);
+#endif
+
 /**
  * Equivalent to POSIX `sendmsg(fd, msg, flags | MSG_NOSIGNAL)`, except that if
  * <b>fd</b> is non-blocking (or the implementation supports the `MSG_DONTWAIT`
@@ -76,6 +93,22 @@ ssize_t io_fd_recvmsg(int fd, struct msghdr *msg, int flags, int timeout);
  */
 ssize_t io_fd_sendmsg(int fd, const struct msghdr *msg, int flags, int timeout);
 
+#ifdef __linux__
+/**
+ * Equivalent to Linux `sendmmsg(fd, msgvec, vlen, flags | MSG_NOSIGNAL)`,
+ * except that if <b>fd</b> is non-blocking (or the implementation supports the
+ * `MSG_DONTWAIT` flag) and <b>timeout</b> is non-negative, this function
+ * behaves as if <b>fd</b> is blocking and the `SO_SNDTIMEO` option is set with
+ * <b>timeout</b> milliseconds. This function returns as soon as at least one
+ * message has been sent.
+ *
+ * @returns the number of messages sent, or -1 on error. In the latter case, the
+ * error number can be obtained from `errno`.
+ */
+int io_fd_sendmmsg(int fd, struct mmsghdr *msgvec, unsigned int vlen,
+		int flags, int timeout);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,7 +88,9 @@ static const struct io_can_chan_vtbl io_user_can_chan_vtbl = {
 	&io_user_can_chan_read,
 	&io_user_can_chan_submit_read,
 	&io_user_can_chan_write,
-	&io_user_can_chan_submit_write
+	&io_user_can_chan_submit_write,
+	NULL,
+	NULL
 };
 // clang-format on
 
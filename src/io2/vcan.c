@@ -161,7 +161,9 @@ static const struct io_can_chan_vtbl io_vcan_chan_vtbl = {
 	&io_vcan_chan_read,
 	&io_vcan_chan_submit_read,
 	&io_vcan_chan_write,
-	&io_vcan_chan_submit_write
+	&io_vcan_chan_submit_write,
+	NULL,
+	NULL
 };
 // clang-format on
 
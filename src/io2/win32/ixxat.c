@@ -170,7 +170,9 @@ static const struct io_can_chan_vtbl io_ixxat_chan_vtbl = {
 	&io_ixxat_chan_read,
 	&io_ixxat_chan_submit_read,
 	&io_ixxat_chan_write,
-	&io_ixxat_chan_submit_write
+	&io_ixxat_chan_submit_write,
+	NULL,
+	NULL
 };
 // clang-format on
 
@@ -43,11 +43,32 @@ static size_t skip(const char *begin, const char *end, struct floc *at);
 
 static void membuf_print_chars(struct membuf *buf, const char *s, size_t n);
 
+static void config_parse_ini_func(const char *section, const char *key,
+		const char *value, void *data);
 static void config_print_ini_func(const char *section, const char *key,
 		const char *value, void *data);
 
 size_t
 config_parse_ini_file(config_t *config, const char *filename)
+{
+	assert(config);
+
+	return config_scan_ini_file(filename, &config_parse_ini_func, config);
+}
+
+size_t
+config_parse_ini_text(config_t *config, const char *begin, const char *end,
+		struct floc *at)
+{
+	assert(config);
+
+	return config_scan_ini_text(
+			begin, end, at, &config_parse_ini_func, config);
+}
+
+size_t
+config_scan_ini_file(const char *filename, config_foreach_func_t *func,
+		void *data)
 {
 	frbuf_t *buf = frbuf_create(filename);
 	if (!buf) {
@@ -67,7 +88,7 @@ config_parse_ini_file(config_t *config, const char *filename)
 	const char *begin = map;
 	const char *end = begin + size;
 	struct floc at = { filename, 1, 1 };
-	size_t chars = config_parse_ini_text(config, begin, end, &at);
+	size_t chars = config_scan_ini_text(begin, end, &at, func, data);
 
 	frbuf_destroy(buf);
 
@@ -75,11 +96,11 @@ config_parse_ini_file(config_t *config, const char *filename)
 }
 
 size_t
-config_parse_ini_text(config_t *config, const char *begin, const char *end,
-		struct floc *at)
+config_scan_ini_text(const char *begin, const char *end, struct floc *at,
+		config_foreach_func_t *func, void *data)
 {
-	assert(config);
 	assert(begin);
+	assert(func);
 
 	struct membuf section = MEMBUF_INIT;
 	struct membuf key = MEMBUF_INIT;
@@ -149,9 +170,9 @@ config_parse_ini_text(config_t *config, const char *begin, const char *end,
 					membuf_print_chars(&value, cp, chars);
 					cp += chars;
 				}
-				config_set(config, membuf_begin(&section),
-						membuf_begin(&key),
-						membuf_begin(&value));
+				const char *s = membuf_begin(&section);
+				func(s ? s : "", membuf_begin(&key),
+						membuf_begin(&value), data);
 				membuf_clear(&value);
 			} else {
 				diag_if(DIAG_ERROR, 0, at,
@@ -277,6 +298,16 @@ membuf_print_chars(struct membuf *buf, const char *s, size_t n)
 	membuf_write(buf, "", 1);
 }
 
+static void
+config_parse_ini_func(const char *section, const char *key, const char *value,
+		void *data)
+{
+	config_t *config = data;
+	assert(config);
+
+	config_set(config, section, key, value);
+}
+
 static void
 config_print_ini_func(const char *section, const char *key, const char *value,
 		void *data)
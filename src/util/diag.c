@@ -57,6 +57,11 @@ static void *diag_handle;
 static diag_at_handler_t *diag_at_handler = &default_diag_at_handler;
 static void *diag_at_handle;
 
+static _Thread_local diag_handler_t *diag_thrd_handler;
+static _Thread_local void *diag_thrd_handle;
+static _Thread_local diag_at_handler_t *diag_at_thrd_handler;
+static _Thread_local void *diag_at_thrd_handle;
+
 #endif // !LELY_NO_DIAG
 
 #if !LELY_NO_STDIO
@@ -167,6 +172,38 @@ diag_at_set_handler(diag_at_handler_t *handler, void *handle)
 	diag_at_handle = handle;
 }
 
+void
+diag_get_thrd_handler(diag_handler_t **phandler, void **phandle)
+{
+	if (phandler)
+		*phandler = diag_thrd_handler;
+	if (phandle)
+		*phandle = diag_thrd_handle;
+}
+
+void
+diag_set_thrd_handler(diag_handler_t *handler, void *handle)
+{
+	diag_thrd_handler = handler;
+	diag_thrd_handle = handle;
+}
+
+void
+diag_at_get_thrd_handler(diag_at_handler_t **phandler, void **phandle)
+{
+	if (phandler)
+		*phandler = diag_at_thrd_handler;
+	if (phandle)
+		*phandle = diag_at_thrd_handle;
+}
+
+void
+diag_at_set_thrd_handler(diag_at_handler_t *handler, void *handle)
+{
+	diag_at_thrd_handler = handler;
+	diag_at_thrd_handle = handle;
+}
+
 void
 diag(enum diag_severity severity, int errc, const char *format, ...)
 {
@@ -179,7 +216,9 @@ diag(enum diag_severity severity, int errc, const char *format, ...)
 void
 vdiag(enum diag_severity severity, int errc, const char *format, va_list ap)
 {
-	if (diag_handler)
+	if (diag_thrd_handler)
+		diag_thrd_handler(diag_thrd_handle, severity, errc, format, ap);
+	else if (diag_handler)
 		diag_handler(diag_handle, severity, errc, format, ap);
 }
 
@@ -197,7 +236,10 @@ void
 vdiag_at(enum diag_severity severity, int errc, const struct floc *at,
 		const char *format, va_list ap)
 {
-	if (diag_at_handler)
+	if (diag_at_thrd_handler)
+		diag_at_thrd_handler(diag_at_thrd_handle, severity, errc, at,
+				format, ap);
+	else if (diag_at_handler)
 		diag_at_handler(diag_at_handle, severity, errc, at, format, ap);
 }
 
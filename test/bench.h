@@ -0,0 +1,16 @@
+#ifndef LELY_TEST_INTERN_BENCH_H_
+#define LELY_TEST_INTERN_BENCH_H_
+
+#include "test.h"
+#include <lely/libc/time.h>
+
+/// Returns the value of the monotonic clock (in seconds).
+static inline double
+bench_now(void)
+{
+	struct timespec ts = { 0, 0 };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+#endif // !LELY_TEST_INTERN_BENCH_H_
@@ -0,0 +1,164 @@
+#include "bench.h"
+#include <lely/can/net.h>
+#include <lely/util/time.h>
+
+#include <stdlib.h>
+
+#define NUM_MSG (1024ul * 1024ul)
+
+#define NUM_RESTART (1024ul * 1024ul)
+
+static int can_recv(const struct can_msg *msg, void *data);
+
+static double bench_recv(int flags, size_t n, size_t *pnrecv);
+
+static int can_timer(const struct timespec *tp, void *data);
+
+static double bench_timer(int flags, size_t n, size_t *pntimer);
+
+int
+main(void)
+{
+	static const size_t num_recv[] = { 10, 100, 1000 };
+	const size_t n = sizeof(num_recv) / sizeof(*num_recv);
+
+	static const size_t num_timer[] = { 10, 100, 1000, 10000 };
+	const size_t m = sizeof(num_timer) / sizeof(*num_timer);
+
+	tap_plan(2 * n + 2 * m);
+
+	for (size_t i = 0; i < n; i++) {
+		size_t nrecv = 0;
+		double tree = bench_recv(0, num_recv[i], &nrecv);
+		tap_test(nrecv == NUM_MSG, "tree:  %4zu receivers: %.3g frames/s",
+				num_recv[i], tree);
+
+		nrecv = 0;
+		double table = bench_recv(
+				CAN_NET_RECV_TABLE, num_recv[i], &nrecv);
+		tap_test(nrecv == NUM_MSG, "table: %4zu receivers: %.3g frames/s",
+				num_recv[i], table);
+	}
+
+	for (size_t i = 0; i < m; i++) {
+		size_t ntimer = 0;
+		double heap = bench_timer(0, num_timer[i], &ntimer);
+		tap_pass("heap:  %5zu timers: %.3g restarts/s", num_timer[i],
+				heap);
+
+		size_t nwheel = 0;
+		double wheel = bench_timer(
+				CAN_NET_TIMER_WHEEL, num_timer[i], &nwheel);
+		tap_test(nwheel == ntimer,
+				"wheel: %5zu timers: %.3g restarts/s",
+				num_timer[i], wheel);
+	}
+
+	return 0;
+}
+
+static int
+can_recv(const struct can_msg *msg, void *data)
+{
+	(void)msg;
+	size_t *pnrecv = data;
+
+	(*pnrecv)++;
+
+	return 0;
+}
+
+static double
+bench_recv(int flags, size_t n, size_t *pnrecv)
+{
+	can_net_t *net = can_net_create_with_flags(flags);
+	tap_assert(net);
+
+	// Register the receivers with CAN identifiers spread over the entire
+	// 11-bit range.
+	can_recv_t **recv = calloc(n, sizeof(*recv));
+	tap_assert(recv);
+	uint_least32_t *id = calloc(n, sizeof(*id));
+	tap_assert(id);
+	for (size_t i = 0; i < n; i++) {
+		recv[i] = can_recv_create();
+		tap_assert(recv[i]);
+		can_recv_set_func(recv[i], &can_recv, pnrecv);
+		id[i] = (i * (CAN_MASK_BID + 1) / n) & CAN_MASK_BID;
+		can_recv_start(recv[i], net, id[i], 0);
+	}
+
+	struct can_msg msg = CAN_MSG_INIT;
+	unsigned int rand = 1;
+
+	double start = bench_now();
+	for (size_t i = 0; i < NUM_MSG; i++) {
+		rand = rand * 1103515245ul + 12345;
+		msg.id = id[rand % n];
+		can_net_recv(net, &msg);
+	}
+	double stop = bench_now();
+
+	for (size_t i = 0; i < n; i++)
+		can_recv_destroy(recv[i]);
+	free(id);
+	free(recv);
+
+	can_net_destroy(net);
+
+	return NUM_MSG / (stop - start);
+}
+
+static int
+can_timer(const struct timespec *tp, void *data)
+{
+	(void)tp;
+	size_t *pntimer = data;
+
+	(*pntimer)++;
+
+	return 0;
+}
+
+static double
+bench_timer(int flags, size_t n, size_t *pntimer)
+{
+	can_net_t *net = can_net_create_with_flags(flags);
+	tap_assert(net);
+
+	struct timespec now = { 1000000, 0 };
+	can_net_set_time(net, &now);
+
+	can_timer_t **timer = calloc(n, sizeof(*timer));
+	tap_assert(timer);
+	for (size_t i = 0; i < n; i++) {
+		timer[i] = can_timer_create();
+		tap_assert(timer[i]);
+		can_timer_set_func(timer[i], &can_timer, pntimer);
+	}
+
+	unsigned int rand = 1;
+
+	// Simulate a busy network where every received frame restarts a
+	// timeout between 10 and 1000 ms (like a heartbeat consumer or an SDO
+	// client), and the time advances by 1 ms every 16 frames.
+	double start = bench_now();
+	for (size_t i = 0; i < NUM_RESTART; i++) {
+		rand = rand * 1103515245ul + 12345;
+		can_timer_timeout(timer[(rand >> 8) % n], net,
+				10 + (rand >> 16) % 991);
+		if (!(i % 16)) {
+			timespec_add_msec(&now, 1);
+			can_net_set_time(net, &now);
+		}
+	}
+	double stop = bench_now();
+
+	for (size_t i = 0; i < n; i++)
+		can_timer_destroy(timer[i]);
+	free(timer);
+
+	can_net_destroy(net);
+
+	return NUM_RESTART / (stop - start);
+}
@@ -1,17 +1,91 @@
 #include "test.h"
 #include <lely/can/net.h>
 
+#include <lely/util/time.h>
+
 #define MSG_ID 0x123
 
+#define NUM_TIMER 1000
+
 int can_recv(const struct can_msg *msg, void *data);
 
+static void test_recv(int flags);
+
+int can_recv_count(const struct can_msg *msg, void *data);
+
+static void test_recv_mask(int flags);
+
+struct recv_time_data {
+	can_net_t *net;
+	struct timespec tp;
+};
+
+int can_recv_time(const struct can_msg *msg, void *data);
+
+static void test_recv_time(void);
+
+struct filter_data {
+	int n;
+	int add;
+	struct can_net_filter filter;
+};
+
+void can_filter(const struct can_net_filter *filter, int add, void *data);
+
+static void test_filter(int flags);
+static void test_filter_merge(void);
+
+struct timer_data {
+	can_timer_t *timer;
+	struct timespec start;
+	int n;
+	int err;
+};
+
+static struct timespec prev;
+
+int can_timer(const struct timespec *tp, void *data);
+int can_next(const struct timespec *tp, void *data);
+
+static void test_timer(int flags);
+
 int
 main(void)
 {
-	tap_plan(8);
+	tap_plan(16 + 2 * 3 + 3 + 2 * 3 + 6 + 2 * 5);
 
-	can_net_t *net = can_net_create();
+	test_recv(0);
+	test_recv(CAN_NET_RECV_TABLE);
+
+	test_recv_mask(0);
+	test_recv_mask(CAN_NET_RECV_TABLE);
+
+	test_recv_time();
+
+	test_filter(0);
+	test_filter(CAN_NET_RECV_TABLE);
+	test_filter_merge();
+
+	test_timer(0);
+	test_timer(CAN_NET_TIMER_WHEEL);
+
+	return 0;
+}
+
+int
+can_recv(const struct can_msg *msg, void *data)
+{
+	tap_pass("#%d received 0x%03x", (int)(uintptr_t)data, msg->id);
+
+	return 0;
+}
+
+static void
+test_recv(int flags)
+{
+	can_net_t *net = can_net_create_with_flags(flags);
 	tap_assert(net);
+	tap_assert(can_net_get_flags(net) == flags);
 
 	can_recv_t *r1 = can_recv_create();
 	tap_assert(r1);
@@ -21,6 +95,12 @@ main(void)
 	tap_assert(r2);
 	can_recv_set_func(r2, &can_recv, (void *)(uintptr_t)2);
 
+	// This receiver MUST never be invoked.
+	can_recv_t *r3 = can_recv_create();
+	tap_assert(r3);
+	can_recv_set_func(r3, &can_recv, (void *)(uintptr_t)3);
+	can_recv_start(r3, net, MSG_ID, CAN_FLAG_IDE);
+
 	struct can_msg msg = CAN_MSG_INIT;
 	msg.id = MSG_ID;
 
@@ -48,18 +128,340 @@ main(void)
 	can_recv_stop(r2);
 	can_net_recv(net, &msg);
 
+	can_recv_start(r1, net, MSG_ID, 0);
+
+	can_recv_destroy(r3);
 	can_recv_destroy(r2);
+
+	// Destroying the network interface MUST stop the remaining receivers.
+	can_net_destroy(net);
+
 	can_recv_destroy(r1);
+}
+
+int
+can_recv_count(const struct can_msg *msg, void *data)
+{
+	(void)msg;
+
+	(*(int *)data)++;
+
+	return 0;
+}
+
+static void
+test_recv_mask(int flags)
+{
+	can_net_t *net = can_net_create_with_flags(flags);
+	tap_assert(net);
+
+	int nmask = 0;
+	can_recv_t *r1 = can_recv_create();
+	tap_assert(r1);
+	can_recv_set_func(r1, &can_recv_count, &nmask);
+	can_recv_start_mask(r1, net, 0x700, 0x780, 0);
+
+	int nexact = 0;
+	can_recv_t *r2 = can_recv_create();
+	tap_assert(r2);
+	can_recv_set_func(r2, &can_recv_count, &nexact);
+	can_recv_start(r2, net, 0x701, 0);
+
+	struct can_msg msg = CAN_MSG_INIT;
+	static const uint_least32_t ids[] = { 0x701, 0x77f, 0x781, 0x681 };
+	for (size_t i = 0; i < sizeof(ids) / sizeof(*ids); i++) {
+		msg.id = ids[i];
+		can_net_recv(net, &msg);
+	}
+	msg.id = 0x701;
+	msg.flags = CAN_FLAG_IDE;
+	can_net_recv(net, &msg);
+	msg.flags = 0;
+	tap_test(nmask == 2 && nexact == 1,
+			"masked receiver accepts the matching identifiers");
+
+	struct can_net_filter filters[2];
+	size_t nfilters = can_net_get_filter(net, filters, 2);
+	tap_test(nfilters == 2 && filters[0].id == 0x701
+					&& filters[0].mask == CAN_MASK_BID
+					&& filters[1].id == 0x700
+					&& filters[1].mask == 0x780
+					&& !filters[1].flags,
+			"masked receiver yields a masked filter");
+
+	can_recv_stop(r1);
+	can_net_recv(net, &msg);
+	tap_test(nmask == 2 && nexact == 2
+					&& can_net_get_filter(net, NULL, 0) == 1,
+			"stopped masked receiver is not invoked");
+
+	can_recv_start_mask(r1, net, 0x080, 0x780, 0);
+	can_recv_destroy(r2);
 
+	// Destroying the network interface MUST stop the masked receivers.
 	can_net_destroy(net);
 
+	can_recv_destroy(r1);
+}
+
+int
+can_recv_time(const struct can_msg *msg, void *data)
+{
+	(void)msg;
+	struct recv_time_data *rtd = data;
+
+	can_net_get_recv_time(rtd->net, &rtd->tp);
+
 	return 0;
 }
 
+static void
+test_recv_time(void)
+{
+	can_net_t *net = can_net_create();
+	tap_assert(net);
+
+	struct timespec now = { 10, 0 };
+	can_net_set_time(net, &now);
+
+	struct recv_time_data rtd = { net, { 0, 0 } };
+	can_recv_t *recv = can_recv_create();
+	tap_assert(recv);
+	can_recv_set_func(recv, &can_recv_time, &rtd);
+	can_recv_start(recv, net, MSG_ID, 0);
+
+	struct can_msg msg = CAN_MSG_INIT;
+	msg.id = MSG_ID;
+
+	// Without a timestamp, the frame is received at the current time.
+	can_net_recv(net, &msg);
+	tap_test(!timespec_cmp(&rtd.tp, &now),
+			"receive time defaults to the current time");
+
+	struct timespec tp = { 9, 500000000 };
+	can_net_recv_at(net, &msg, &tp);
+	tap_test(!timespec_cmp(&rtd.tp, &tp),
+			"receive time is the timestamp of the frame");
+
+	// Outside a receiver, the receive time is the current time.
+	can_net_get_recv_time(net, &rtd.tp);
+	tap_test(!timespec_cmp(&rtd.tp, &now),
+			"receive time outside a receiver is the current time");
+
+	can_recv_destroy(recv);
+	can_net_destroy(net);
+}
+
+void
+can_filter(const struct can_net_filter *filter, int add, void *data)
+{
+	struct filter_data *fd = data;
+	tap_assert(fd);
+
+	fd->n++;
+	fd->add = add;
+	fd->filter = *filter;
+}
+
+static void
+test_filter(int flags)
+{
+	can_net_t *net = can_net_create_with_flags(flags);
+	tap_assert(net);
+
+	struct filter_data fd = { 0, 0, { 0, 0, 0 } };
+	can_net_set_filter_func(net, &can_filter, &fd);
+
+	can_recv_t *r1 = can_recv_create();
+	tap_assert(r1);
+	can_recv_t *r2 = can_recv_create();
+	tap_assert(r2);
+	can_recv_t *r3 = can_recv_create();
+	tap_assert(r3);
+
+	// The callback MUST only be invoked when the set of identifiers with
+	// registered receivers changes.
+	can_recv_start(r1, net, MSG_ID, 0);
+	can_recv_start(r2, net, MSG_ID, 0);
+	can_recv_start(r3, net, MSG_ID, CAN_FLAG_IDE);
+	can_recv_stop(r1);
+	tap_test(fd.n == 2 && fd.add,
+			"filter callback invoked for new identifiers only");
+
+	struct can_net_filter filters[2];
+	size_t nfilters = can_net_get_filter(net, filters, 2);
+	tap_test(nfilters == 2 && filters[0].id == MSG_ID
+					&& filters[0].mask == CAN_MASK_BID
+					&& !filters[0].flags
+					&& filters[1].id == MSG_ID
+					&& filters[1].mask == CAN_MASK_EID
+					&& filters[1].flags == CAN_FLAG_IDE,
+			"filters match the registered receivers");
+
+	can_recv_stop(r3);
+	tap_test(fd.n == 3 && !fd.add && fd.filter.id == MSG_ID
+					&& fd.filter.mask == CAN_MASK_EID
+					&& fd.filter.flags == CAN_FLAG_IDE,
+			"filter callback reports the removed identifier");
+
+	can_recv_destroy(r3);
+	can_recv_destroy(r2);
+	can_recv_destroy(r1);
+
+	can_net_destroy(net);
+}
+
+static void
+test_filter_merge(void)
+{
+	struct can_net_filter filters[] = {
+		{ 0x701, CAN_MASK_BID, 0 },
+		{ 0x184, CAN_MASK_BID, 0 },
+		{ 0x181, CAN_MASK_BID, 0 },
+		{ 0x182, CAN_MASK_BID, 0 },
+		{ 0x183, CAN_MASK_BID, 0 },
+		{ 0x183, CAN_MASK_BID, 0 },
+		{ 0x1000, CAN_MASK_EID, CAN_FLAG_IDE },
+	};
+	size_t n = sizeof(filters) / sizeof(*filters);
+
+	n = can_net_filter_merge(filters, n, 3);
+	tap_test(n == 3, "filters merged to the maximum number");
+	tap_test(can_net_filter_match(filters, n, 0x185, 0),
+			"merged filter accepts neighbouring identifiers");
+	tap_test(can_net_filter_match(filters, n, 0x701, 0),
+			"unmerged filter is preserved");
+	tap_test(!can_net_filter_match(filters, n, 0x702, 0),
+			"merged filters reject other identifiers");
+	tap_test(can_net_filter_match(filters, n, 0x1000, CAN_FLAG_IDE)
+					&& !can_net_filter_match(
+							filters, n, 0x000, 0),
+			"filters distinguish 11-bit and 29-bit identifiers");
+
+	n = can_net_filter_merge(filters, n, 1);
+	tap_test(n == 2, "11-bit and 29-bit filters are never merged");
+}
+
 int
-can_recv(const struct can_msg *msg, void *data)
+can_timer(const struct timespec *tp, void *data)
 {
-	tap_pass("#%d received 0x%03x", (int)(uintptr_t)data, msg->id);
+	struct timer_data *td = data;
+
+	// A timer MUST trigger on the first update at or after its start time.
+	if (timespec_cmp(&td->start, tp) > 0
+			|| timespec_cmp(&td->start, &prev) <= 0)
+		td->err++;
+	td->n++;
+
+	// Compute the next start time of periodic timers.
+	timespec_add_msec(&td->start, 7);
+
+	return 0;
+}
+
+int
+can_next(const struct timespec *tp, void *data)
+{
+	*(struct timespec *)data = *tp;
 
 	return 0;
 }
+
+static void
+test_timer(int flags)
+{
+	can_net_t *net = can_net_create_with_flags(flags);
+	tap_assert(net);
+
+	struct timespec next = { 0, 0 };
+	can_net_set_next_func(net, &can_next, &next);
+
+	// Start at a large absolute time, like a monotonic clock would.
+	struct timespec now = { 1000000, 0 };
+	can_net_set_time(net, &now);
+	prev = now;
+
+	static struct timer_data td[NUM_TIMER];
+	unsigned int rand = 1;
+	for (int i = 0; i < NUM_TIMER; i++) {
+		td[i].timer = can_timer_create();
+		tap_assert(td[i].timer);
+		can_timer_set_func(td[i].timer, &can_timer, &td[i]);
+		td[i].start = now;
+		rand = rand * 1103515245ul + 12345;
+		if (i % 100 == 99) {
+			// Start some timers beyond the span of the timer wheel.
+			timespec_add_sec(&td[i].start, 3600 * (5 + i % 7));
+		} else {
+			timespec_add_nsec(&td[i].start,
+					(rand >> 8) % 2000 * 1000000l
+							+ rand % 1000000l);
+		}
+		td[i].n = 0;
+		td[i].err = 0;
+		can_timer_start(td[i].timer, net, &td[i].start, NULL);
+	}
+
+	// Stop every tenth timer before it triggers.
+	for (int i = 0; i < NUM_TIMER; i += 10)
+		can_timer_stop(td[i].timer);
+
+	// Make one timer periodic.
+	struct timespec interval = { 0, 7000000l };
+	can_timer_start(td[1].timer, net, &td[1].start, &interval);
+	struct timespec first = td[1].start;
+
+	// Advance the time with random steps until all non-periodic timers in
+	// the first two seconds have triggered.
+	struct timespec end = now;
+	timespec_add_sec(&end, 3);
+	while (timespec_cmp(&now, &end) < 0) {
+		rand = rand * 1103515245ul + 12345;
+		timespec_add_nsec(&now, (rand >> 8) % 20000000l);
+		can_net_set_time(net, &now);
+		prev = now;
+	}
+	can_timer_stop(td[1].timer);
+
+	int n = 0;
+	int err = 0;
+	for (int i = 2; i < NUM_TIMER; i++) {
+		if (i % 10 && i % 100 != 99) {
+			n += td[i].n == 1;
+			err += td[i].err;
+		}
+	}
+	tap_test(n == NUM_TIMER - 2 - NUM_TIMER / 10 - NUM_TIMER / 100 + 1
+					&& !err,
+			"one-shot timers trigger on time");
+
+	tap_test(td[1].n == timespec_diff_nsec(&now, &first) / 7000000l + 1,
+			"periodic timer triggers %d times", td[1].n);
+	tap_test(!td[1].err, "periodic timer triggers on time");
+
+	// The next timer to trigger is the first of the long-running timers.
+	can_net_set_time(net, &now);
+	struct timespec *min = &td[99].start;
+	for (int i = 199; i < NUM_TIMER; i += 100) {
+		if (timespec_cmp(&td[i].start, min) < 0)
+			min = &td[i].start;
+	}
+	tap_test(timespec_cmp(&next, min) == 0, "next timer triggers at %ld s",
+			(long)next.tv_sec);
+
+	// Skip ahead 12 hours. This triggers all remaining timers.
+	timespec_add_sec(&now, 12 * 3600);
+	can_net_set_time(net, &now);
+	n = 0;
+	err = 0;
+	for (int i = 99; i < NUM_TIMER; i += 100) {
+		n += td[i].n == 1;
+		err += td[i].err;
+	}
+	tap_test(n == NUM_TIMER / 100 && !err, "long-running timers trigger");
+
+	for (int i = 0; i < NUM_TIMER; i++)
+		can_timer_destroy(td[i].timer);
+
+	can_net_destroy(net);
+}
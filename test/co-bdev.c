@@ -0,0 +1,203 @@
+#include "test.h"
+#include <lely/co/bdev.h>
+#include <lely/co/dcf.h>
+#include <lely/co/obj.h>
+#include <lely/co/val.h>
+#include <lely/util/errnum.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static int sub_cmp(const co_sub_t *sub, const co_sub_t *bsub);
+static int str_cmp(const char *s1, const char *s2);
+static int in_buf(const char *s, const uint_least8_t *buf, size_t n);
+
+int
+main(void)
+{
+	tap_plan(18);
+
+	co_dev_t *dev = co_dev_create_from_dcf_file(TEST_SRCDIR "/co-sdev.dcf");
+	tap_assert(dev);
+
+	size_t n = co_dev_write_bin(dev, NULL, NULL);
+	tap_test(n > CO_BDEV_HDR_SIZE, "co_dev_write_bin(<dev>, NULL, NULL)");
+	uint_least8_t *buf = calloc(1, n);
+	tap_assert(buf);
+	tap_test(co_dev_write_bin(dev, buf, buf + n - 1) == n && !*buf,
+			"co_dev_write_bin() does not write to a small buffer");
+	tap_test(co_dev_write_bin(dev, buf, buf + n) == n,
+			"co_dev_write_bin(<dev>, ...)");
+
+	co_dev_t *bdev = co_dev_create_from_bin(buf, n);
+	tap_test(bdev, "co_dev_create_from_bin(...)");
+	tap_assert(bdev);
+
+	int ok = !str_cmp(co_dev_get_name(dev), co_dev_get_name(bdev));
+	ok = ok
+			&& !str_cmp(co_dev_get_vendor_name(dev),
+					co_dev_get_vendor_name(bdev));
+	ok = ok && co_dev_get_id(dev) == co_dev_get_id(bdev);
+	ok = ok && co_dev_get_vendor_id(dev) == co_dev_get_vendor_id(bdev);
+	ok = ok && co_dev_get_baud(dev) == co_dev_get_baud(bdev);
+	tap_test(ok, "device description is preserved");
+
+	ok = co_dev_get_idx(dev, 0, NULL) == co_dev_get_idx(bdev, 0, NULL);
+	for (co_obj_t *obj = co_dev_first_obj(dev); ok && obj;
+			obj = co_obj_next(obj)) {
+		co_obj_t *bobj = co_dev_find_obj(bdev, co_obj_get_idx(obj));
+		ok = bobj && co_obj_get_code(obj) == co_obj_get_code(bobj)
+				&& !str_cmp(co_obj_get_name(obj),
+						co_obj_get_name(bobj));
+		for (co_sub_t *sub = co_obj_first_sub(obj); ok && sub;
+				sub = co_sub_next(sub))
+			ok = !sub_cmp(sub, co_obj_find_sub(bobj,
+							co_sub_get_subidx(sub)));
+	}
+	tap_test(ok, "objects, names, limits and values are preserved");
+
+	void *dev_dom = NULL;
+	void *bdev_dom = NULL;
+	tap_assert(!co_dev_write_dcf(dev, 0, 0xffff, &dev_dom));
+	tap_assert(!co_dev_write_dcf(bdev, 0, 0xffff, &bdev_dom));
+	tap_test(!co_val_cmp(CO_DEFTYPE_DOMAIN, &dev_dom, &bdev_dom),
+			"!co_val_cmp(%04X, <dev>, <bdev>)", CO_DEFTYPE_DOMAIN);
+	co_val_fini(CO_DEFTYPE_DOMAIN, &bdev_dom);
+	co_val_fini(CO_DEFTYPE_DOMAIN, &dev_dom);
+
+	co_dev_destroy(bdev);
+
+	bdev = co_dev_create_from_bin_ref(buf, n);
+	tap_test(bdev, "co_dev_create_from_bin_ref(...)");
+	tap_assert(bdev);
+
+	ok = 1;
+	for (co_obj_t *obj = co_dev_first_obj(dev); ok && obj;
+			obj = co_obj_next(obj)) {
+		co_obj_t *bobj = co_dev_find_obj(bdev, co_obj_get_idx(obj));
+		ok = bobj && !str_cmp(co_obj_get_name(obj),
+					     co_obj_get_name(bobj))
+				&& in_buf(co_obj_get_name(bobj), buf, n);
+		for (co_sub_t *sub = co_obj_first_sub(obj); ok && sub;
+				sub = co_sub_next(sub)) {
+			co_sub_t *bsub = co_obj_find_sub(
+					bobj, co_sub_get_subidx(sub));
+			ok = !sub_cmp(sub, bsub)
+					&& in_buf(co_sub_get_name(bsub), buf,
+							n);
+		}
+	}
+	tap_test(ok, "names are referenced in place");
+
+	co_dev_destroy(bdev);
+
+	tap_test(!co_dev_write_bin_file(dev, "co-bdev.bin"),
+			"co_dev_write_bin_file(<dev>, \"co-bdev.bin\")");
+	bdev = co_dev_create_from_bin_file("co-bdev.bin");
+	tap_test(bdev, "co_dev_create_from_bin_file(\"co-bdev.bin\")");
+	co_dev_destroy(bdev);
+
+	// The device references the names in the mapped file, which is only
+	// unmapped when the device is destroyed.
+	bdev = co_dev_create_from_bin_file_ref("co-bdev.bin");
+	tap_test(bdev, "co_dev_create_from_bin_file_ref(\"co-bdev.bin\")");
+	tap_assert(bdev);
+	ok = 1;
+	for (co_obj_t *obj = co_dev_first_obj(dev); ok && obj;
+			obj = co_obj_next(obj)) {
+		co_obj_t *bobj = co_dev_find_obj(bdev, co_obj_get_idx(obj));
+		ok = bobj && !str_cmp(co_obj_get_name(obj),
+					     co_obj_get_name(bobj));
+		for (co_sub_t *sub = co_obj_first_sub(obj); ok && sub;
+				sub = co_sub_next(sub))
+			ok = !sub_cmp(sub, co_obj_find_sub(bobj,
+							co_sub_get_subidx(sub)));
+	}
+	tap_test(ok, "names in the mapped file remain valid");
+	co_dev_destroy(bdev);
+
+	bdev = co_dev_create_from_bin_arena(buf, n, 1024);
+	tap_test(bdev, "co_dev_create_from_bin_arena(..., 1024)");
+	tap_assert(bdev);
+	ok = 1;
+	for (co_obj_t *obj = co_dev_first_obj(bdev); ok && obj;
+			obj = co_obj_next(obj)) {
+		ok = co_dev_in_arena(bdev, obj);
+		for (co_sub_t *sub = co_obj_first_sub(obj); ok && sub;
+				sub = co_sub_next(sub))
+			ok = co_dev_in_arena(bdev, sub);
+	}
+	tap_assert(!co_dev_write_dcf(bdev, 0, 0xffff, &bdev_dom));
+	tap_assert(!co_dev_write_dcf(dev, 0, 0xffff, &dev_dom));
+	tap_test(ok && !co_val_cmp(CO_DEFTYPE_DOMAIN, &dev_dom, &bdev_dom),
+			"objects are allocated in the arena");
+	co_val_fini(CO_DEFTYPE_DOMAIN, &bdev_dom);
+	co_val_fini(CO_DEFTYPE_DOMAIN, &dev_dom);
+	co_dev_destroy(bdev);
+
+	tap_test(!co_dev_create_from_bin(buf, n - 1)
+					&& get_errnum() == ERRNUM_BADMSG,
+			"a truncated image is rejected");
+
+	buf[n / 2] ^= 0xff;
+	tap_test(!co_dev_create_from_bin(buf, n)
+					&& get_errnum() == ERRNUM_BADMSG,
+			"a corrupt image is rejected");
+	buf[n / 2] ^= 0xff;
+
+	buf[4]++;
+	tap_test(!co_dev_create_from_bin(buf, n)
+					&& get_errnum() == ERRNUM_BADMSG,
+			"an image with an unsupported version is rejected");
+
+	free(buf);
+	co_dev_destroy(dev);
+
+	return 0;
+}
+
+static int
+sub_cmp(const co_sub_t *sub, const co_sub_t *bsub)
+{
+	if (!bsub)
+		return 1;
+
+	co_unsigned16_t type = co_sub_get_type(sub);
+	if (type != co_sub_get_type(bsub))
+		return 1;
+
+	if (co_sub_get_access(sub) != co_sub_get_access(bsub)
+			|| co_sub_get_pdo_mapping(sub)
+					!= co_sub_get_pdo_mapping(bsub)
+			|| co_sub_get_flags(sub) != co_sub_get_flags(bsub))
+		return 1;
+
+	if (str_cmp(co_sub_get_name(sub), co_sub_get_name(bsub)))
+		return 1;
+
+	if (co_val_cmp(type, co_sub_get_min(sub), co_sub_get_min(bsub))
+			|| co_val_cmp(type, co_sub_get_max(sub),
+					co_sub_get_max(bsub))
+			|| co_val_cmp(type, co_sub_get_def(sub),
+					co_sub_get_def(bsub))
+			|| co_val_cmp(type, co_sub_get_val(sub),
+					co_sub_get_val(bsub)))
+		return 1;
+
+	return 0;
+}
+
+static int
+str_cmp(const char *s1, const char *s2)
+{
+	if (!s1 || !s2)
+		return (s2 != NULL) - (s1 != NULL);
+	return strcmp(s1, s2);
+}
+
+static int
+in_buf(const char *s, const uint_least8_t *buf, size_t n)
+{
+	return !s || ((const uint_least8_t *)s >= buf
+			       && (const uint_least8_t *)s < buf + n);
+}
@@ -0,0 +1,86 @@
+#include "bench.h"
+#include <lely/co/crc.h>
+
+#include <stdlib.h>
+
+#define NUM_BYTES (64ul * 1024ul * 1024ul)
+
+static uint_least16_t crc_bytewise(
+		uint_least16_t crc, const uint_least8_t *bp, size_t n);
+
+static double bench_crc(uint_least16_t (*func)(uint_least16_t,
+				const uint_least8_t *, size_t),
+		const uint_least8_t *buf, size_t n, uint_least16_t *pcrc);
+
+static uint_least16_t tab[256];
+
+int
+main(void)
+{
+	// The segment size of an SDO block transfer, the size of a buffer
+	// flushed during an SDO upload and a typical firmware chunk.
+	static const size_t size[] = { 7, 64, 889, 4096 };
+	const size_t n = sizeof(size) / sizeof(*size);
+
+	tap_plan(2 * n);
+
+	for (int i = 0; i < 256; i++) {
+		uint_least16_t crc = i << 8;
+		for (int k = 0; k < 8; k++) {
+			if (crc & 0x8000)
+				crc = (crc << 1) ^ 0x1021;
+			else
+				crc <<= 1;
+		}
+		tab[i] = crc;
+	}
+
+	uint_least8_t *buf = malloc(size[n - 1]);
+	tap_assert(buf);
+	unsigned int rand = 1;
+	for (size_t i = 0; i < size[n - 1]; i++) {
+		rand = rand * 1103515245ul + 12345;
+		buf[i] = (rand >> 16) & 0xff;
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		uint_least16_t crc1 = 0;
+		double bytewise = bench_crc(&crc_bytewise, buf, size[i], &crc1);
+		tap_pass("bytewise: %4zu bytes: %.3g MB/s", size[i],
+				bytewise * 1e-6);
+
+		uint_least16_t crc2 = 0;
+		double sliced = bench_crc(&co_crc, buf, size[i], &crc2);
+		tap_test(crc1 == crc2, "co_crc(): %4zu bytes: %.3g MB/s",
+				size[i], sliced * 1e-6);
+	}
+
+	free(buf);
+
+	return 0;
+}
+
+static uint_least16_t
+crc_bytewise(uint_least16_t crc, const uint_least8_t *bp, size_t n)
+{
+	while (n--)
+		crc = tab[*bp++ ^ (crc >> 8)] ^ (crc << 8);
+	return crc;
+}
+
+static double
+bench_crc(uint_least16_t (*func)(uint_least16_t, const uint_least8_t *,
+				size_t),
+		const uint_least8_t *buf, size_t n, uint_least16_t *pcrc)
+{
+	size_t num_iter = NUM_BYTES / n;
+
+	uint_least16_t crc = 0;
+	double start = bench_now();
+	for (size_t i = 0; i < num_iter; i++)
+		crc = func(crc, buf, n);
+	double stop = bench_now();
+	*pcrc = crc;
+
+	return num_iter * n / (stop - start);
+}
@@ -0,0 +1,71 @@
+#include "test.h"
+#include <lely/co/crc.h>
+
+#include <string.h>
+
+#define MAX_SIZE 1024
+
+static uint_least16_t crc_bitwise(
+		uint_least16_t crc, const uint_least8_t *bp, size_t n);
+
+int
+main(void)
+{
+	tap_plan(4);
+
+	tap_test(co_crc(0, (const uint_least8_t *)"123456789", 9) == 0x31c3,
+			"co_crc(0, \"123456789\", 9) == 0x31c3");
+
+	tap_test(co_crc(0x1234, NULL, 8) == 0x1234,
+			"co_crc(0x1234, NULL, 8) == 0x1234");
+
+	uint_least8_t buf[MAX_SIZE + 8];
+	unsigned int rand = 1;
+	for (size_t i = 0; i < sizeof(buf); i++) {
+		rand = rand * 1103515245ul + 12345;
+		buf[i] = (rand >> 16) & 0xff;
+	}
+
+	// Check every length up to MAX_SIZE, at every alignment, with a
+	// different initial value each time.
+	int ok = 1;
+	for (size_t n = 0; ok && n <= MAX_SIZE; n++) {
+		for (size_t off = 0; ok && off < 8; off++) {
+			rand = rand * 1103515245ul + 12345;
+			uint_least16_t crc = (rand >> 8) & 0xffff;
+			ok = co_crc(crc, buf + off, n)
+					== crc_bitwise(crc, buf + off, n);
+		}
+	}
+	tap_test(ok, "co_crc() matches a bitwise implementation");
+
+	// Check that splitting the input, as is done for the segments of an SDO
+	// block transfer, does not change the result.
+	ok = 1;
+	uint_least16_t crc = co_crc(0, buf, MAX_SIZE);
+	for (size_t k = 1; ok && k <= 16; k++) {
+		uint_least16_t tmp = 0;
+		for (size_t i = 0; i < MAX_SIZE; i += k)
+			tmp = co_crc(tmp, buf + i,
+					i + k <= MAX_SIZE ? k : MAX_SIZE - i);
+		ok = tmp == crc;
+	}
+	tap_test(ok, "co_crc() is independent of the segment size");
+
+	return 0;
+}
+
+static uint_least16_t
+crc_bitwise(uint_least16_t crc, const uint_least8_t *bp, size_t n)
+{
+	while (n--) {
+		crc ^= *bp++ << 8;
+		for (int k = 0; k < 8; k++) {
+			if (crc & 0x8000)
+				crc = (crc << 1) ^ 0x1021;
+			else
+				crc <<= 1;
+		}
+	}
+	return crc;
+}
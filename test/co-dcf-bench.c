@@ -0,0 +1,148 @@
+#include "bench.h"
+#include <lely/co/dcf.h>
+#include <lely/co/obj.h>
+#include <lely/util/config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_SUB 3
+
+#define MAX_OBJ_SIZE 1024
+
+static char *dcf_create(size_t n, size_t *psize);
+
+static double bench_dcf(const char *text, size_t size, size_t n, int *pok);
+
+static double bench_ini(const char *text, size_t size, size_t n, int *pok);
+
+int
+main(void)
+{
+	static const size_t num_obj[] = { 10, 100, 1000, 10000 };
+	const size_t n = sizeof(num_obj) / sizeof(*num_obj);
+
+	tap_plan(2 * n);
+
+	for (size_t i = 0; i < n; i++) {
+		size_t size = 0;
+		char *text = dcf_create(num_obj[i], &size);
+
+		int ok = 0;
+		double dcf = bench_dcf(text, size, num_obj[i], &ok);
+		tap_test(ok, "dcf: %5zu objects: %.3g objects/s (%.3g MB/s)",
+				num_obj[i], dcf * num_obj[i],
+				dcf * size * 1e-6);
+
+		ok = 0;
+		double ini = bench_ini(text, size, num_obj[i], &ok);
+		tap_test(ok, "ini: %5zu objects: %.3g objects/s (%.3g MB/s)",
+				num_obj[i], ini * num_obj[i],
+				ini * size * 1e-6);
+
+		free(text);
+	}
+
+	return 0;
+}
+
+static char *
+dcf_create(size_t n, size_t *psize)
+{
+	char *text = malloc(MAX_OBJ_SIZE * (n + 1));
+	tap_assert(text);
+	char *cp = text;
+
+	cp += sprintf(cp,
+			"[DeviceInfo]\n"
+			"VendorName=Lely Industries N.V.\n"
+			"ProductName=Benchmark\n"
+			"NrOfRXPDO=0\n"
+			"NrOfTXPDO=0\n"
+			"\n"
+			"[DeviceComissioning]\n"
+			"NodeID=0x01\n"
+			"\n"
+			"[ManufacturerObjects]\n"
+			"SupportedObjects=%zu\n",
+			n);
+	for (size_t i = 0; i < n; i++)
+		cp += sprintf(cp, "%zu=0x%04zX\n", i + 1, 0x2000 + i);
+
+	// Each object is a record with a number of UNSIGNED32 sub-objects,
+	// similar to the PDO communication and mapping parameters.
+	for (size_t i = 0; i < n; i++) {
+		size_t idx = 0x2000 + i;
+		cp += sprintf(cp,
+				"\n"
+				"[%zX]\n"
+				"ParameterName=Object %zu\n"
+				"ObjectType=0x09\n"
+				"SubNumber=%d\n"
+				"\n"
+				"[%zXsub0]\n"
+				"ParameterName=Highest sub-index supported\n"
+				"ObjectType=0x07\n"
+				"DataType=0x0005\n"
+				"AccessType=const\n"
+				"DefaultValue=%d\n"
+				"PDOMapping=0\n",
+				idx, i, NUM_SUB, idx, NUM_SUB - 1);
+		for (int j = 1; j < NUM_SUB; j++)
+			cp += sprintf(cp,
+					"\n"
+					"[%zXsub%X]\n"
+					"ParameterName=Sub-object %d\n"
+					"ObjectType=0x07\n"
+					"DataType=0x0007\n"
+					"AccessType=rw\n"
+					"DefaultValue=0x%08zX\n"
+					"PDOMapping=0\n",
+					idx, j, j, (idx << 16) | j);
+	}
+
+	*psize = cp - text;
+	return text;
+}
+
+static double
+bench_dcf(const char *text, size_t size, size_t n, int *pok)
+{
+	size_t num_iter = 10000 / n;
+
+	*pok = 1;
+	double start = bench_now();
+	for (size_t i = 0; i < num_iter; i++) {
+		co_dev_t *dev =
+				co_dev_create_from_dcf_text(text, text + size, NULL);
+		*pok = *pok && dev
+				&& co_dev_get_idx(dev, 0, NULL) == n
+				&& co_dev_get_val_u32(dev, 0x2000 + (n - 1), 1)
+						== (((0x2000 + (n - 1)) << 16) | 1);
+		co_dev_destroy(dev);
+	}
+	double stop = bench_now();
+
+	return num_iter / (stop - start);
+}
+
+static double
+bench_ini(const char *text, size_t size, size_t n, int *pok)
+{
+	size_t num_iter = 10000 / n;
+
+	*pok = 1;
+	double start = bench_now();
+	for (size_t i = 0; i < num_iter; i++) {
+		config_t *config = config_create(CONFIG_CASE);
+		*pok = *pok && config
+				&& config_parse_ini_text(config, text, text + size,
+						NULL) == size
+				&& config_get(config, "ManufacturerObjects",
+						   "SupportedObjects");
+		config_destroy(config);
+	}
+	double stop = bench_now();
+
+	return num_iter / (stop - start);
+}
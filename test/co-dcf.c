@@ -0,0 +1,107 @@
+#include "test.h"
+#include <lely/co/dcf.h>
+#include <lely/co/val.h>
+#include <lely/util/diag.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_THRD 4
+
+static const char *const filenames[] = { TEST_SRCDIR "/co-emcy.dcf",
+	TEST_SRCDIR "/co-nmt-slave.dcf", TEST_SRCDIR "/co-pdo-receive.dcf",
+	TEST_SRCDIR "/co-pdo-transmit.dcf", TEST_SRCDIR "/co-sdev.dcf",
+	TEST_SRCDIR "/co-sdo-client.dcf", TEST_SRCDIR "/co-sdo-server.dcf",
+	TEST_SRCDIR "/co-sync.dcf", TEST_SRCDIR "/co-time.dcf",
+	TEST_SRCDIR "/coapp-fiber-master.dcf",
+	TEST_SRCDIR "/coapp-fiber-slave.dcf" };
+
+#define NUM_FILES (sizeof(filenames) / sizeof(*filenames))
+
+static void count_diag_handler(void *handle, enum diag_severity severity,
+		int errc, const char *format, va_list ap);
+static void count_diag_at_handler(void *handle, enum diag_severity severity,
+		int errc, const struct floc *at, const char *format,
+		va_list ap);
+
+static int dev_cmp(const co_dev_t *dev1, const co_dev_t *dev2);
+
+int
+main(void)
+{
+	tap_plan(5);
+
+	struct co_dcf_file files[NUM_FILES + 1];
+	for (size_t i = 0; i < NUM_FILES; i++)
+		files[i].filename = filenames[i];
+	files[NUM_FILES].filename = "co-dcf-nonexistent.dcf";
+
+	int ndiag = 0;
+	diag_set_handler(&count_diag_handler, &ndiag);
+	diag_at_set_handler(&count_diag_at_handler, &ndiag);
+
+	tap_test(co_dev_create_from_dcf_files(files, NUM_FILES, NUM_THRD) == 0,
+			"co_dev_create_from_dcf_files(<files>, %d, %d)",
+			(int)NUM_FILES, NUM_THRD);
+
+	int ok = 1;
+	for (size_t i = 0; i < NUM_FILES; i++) {
+		co_dev_t *dev = co_dev_create_from_dcf_file(filenames[i]);
+		tap_assert(dev);
+		ok = ok && files[i].dev && !dev_cmp(files[i].dev, dev);
+		co_dev_destroy(dev);
+	}
+	tap_test(ok, "the devices are identical to those loaded sequentially");
+
+	for (size_t i = 0; i < NUM_FILES; i++) {
+		co_dev_destroy(files[i].dev);
+		free(files[i].diag);
+	}
+
+	ndiag = 0;
+	tap_test(co_dev_create_from_dcf_files(files, NUM_FILES + 1, NUM_THRD)
+					== -1,
+			"co_dev_create_from_dcf_files() fails for a nonexistent file");
+	tap_test(!files[NUM_FILES].dev && files[NUM_FILES].errc
+					&& files[NUM_FILES].diag
+					&& strstr(files[NUM_FILES].diag,
+							files[NUM_FILES].filename),
+			"the diagnostic messages are collected per file");
+	tap_test(!ndiag, "the global diagnostic handler is not invoked");
+
+	for (size_t i = 0; i < NUM_FILES + 1; i++) {
+		co_dev_destroy(files[i].dev);
+		free(files[i].diag);
+	}
+
+	return 0;
+}
+
+static void
+count_diag_handler(void *handle, enum diag_severity severity, int errc,
+		const char *format, va_list ap)
+{
+	count_diag_at_handler(handle, severity, errc, NULL, format, ap);
+}
+
+static void
+count_diag_at_handler(void *handle, enum diag_severity severity, int errc,
+		const struct floc *at, const char *format, va_list ap)
+{
+	(*(int *)handle)++;
+
+	default_diag_at_handler(NULL, severity, errc, at, format, ap);
+}
+
+static int
+dev_cmp(const co_dev_t *dev1, const co_dev_t *dev2)
+{
+	void *dom1 = NULL;
+	void *dom2 = NULL;
+	tap_assert(!co_dev_write_dcf(dev1, 0, 0xffff, &dom1));
+	tap_assert(!co_dev_write_dcf(dev2, 0, 0xffff, &dom2));
+	int cmp = co_val_cmp(CO_DEFTYPE_DOMAIN, &dom1, &dom2);
+	co_val_fini(CO_DEFTYPE_DOMAIN, &dom2);
+	co_val_fini(CO_DEFTYPE_DOMAIN, &dom1);
+	return cmp;
+}
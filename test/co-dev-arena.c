@@ -0,0 +1,141 @@
+#include "test.h"
+#include <lely/co/dcf.h>
+#include <lely/co/dev.h>
+#include <lely/co/obj.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define NOBJ 64
+#define NSUB 4
+
+static int co_dev_all_in_arena(const co_dev_t *dev);
+
+int
+main(void)
+{
+	tap_plan(11);
+
+	co_dev_t *dev = co_dev_create(0x01);
+	tap_assert(dev);
+
+	tap_test(!co_dev_get_arena_size(dev), "the arena is disabled by default");
+	// Use small blocks to force the arena to allocate several of them.
+	co_dev_set_arena_size(dev, 256);
+	tap_test(co_dev_get_arena_size(dev) == 256,
+			"co_dev_set_arena_size(<dev>, 256)");
+
+	char name[64];
+	int ok = 1;
+	for (co_unsigned16_t i = 0; i < NOBJ; i++) {
+		co_obj_t *obj = co_obj_create_in(dev, 0x2000 + i);
+		tap_assert(obj);
+		tap_assert(!co_dev_insert_obj(dev, obj));
+		snprintf(name, sizeof(name), "Object %u", i);
+		ok = ok && !co_obj_set_name(obj, name);
+		for (co_unsigned8_t j = 0; j < NSUB; j++) {
+			co_sub_t *sub = co_sub_create_in(
+					dev, j, CO_DEFTYPE_UNSIGNED32);
+			tap_assert(sub);
+			tap_assert(!co_obj_insert_sub(obj, sub));
+			snprintf(name, sizeof(name), "Sub-object %u.%u", i, j);
+			ok = ok && !co_sub_set_name(sub, name);
+			co_sub_set_val_u32(sub, (co_unsigned32_t)i << 8 | j);
+		}
+	}
+	tap_test(ok, "create objects in the arena");
+
+	ok = 1;
+	for (co_unsigned16_t i = 0; i < NOBJ; i++) {
+		co_obj_t *obj = co_dev_find_obj(dev, 0x2000 + i);
+		snprintf(name, sizeof(name), "Object %u", i);
+		ok = ok && obj && !strcmp(co_obj_get_name(obj), name);
+		for (co_unsigned8_t j = 0; obj && j < NSUB; j++) {
+			co_sub_t *sub = co_obj_find_sub(obj, j);
+			snprintf(name, sizeof(name), "Sub-object %u.%u", i, j);
+			co_unsigned32_t val = (co_unsigned32_t)i << 8 | j;
+			ok = ok && sub && !strcmp(co_sub_get_name(sub), name)
+					&& co_sub_get_val_u32(sub) == val;
+		}
+	}
+	tap_test(ok, "objects spanning several blocks are intact");
+
+	// A name larger than the block size gets a block of its own.
+	co_obj_t *obj = co_obj_create_in(dev, 0x3000);
+	tap_assert(obj);
+	tap_assert(!co_dev_insert_obj(dev, obj));
+	char long_name[512];
+	memset(long_name, 'x', sizeof(long_name) - 1);
+	long_name[sizeof(long_name) - 1] = '\0';
+	co_obj_t *first = co_dev_find_obj(dev, 0x2000);
+	tap_assert(first);
+	tap_test(!co_obj_set_name(obj, long_name)
+					&& !strcmp(co_obj_get_name(obj), long_name)
+					&& !strcmp(co_obj_get_name(first), "Object 0"),
+			"an allocation larger than the block size");
+
+	co_sub_t *sub = co_dev_find_sub(dev, 0x2000, 0x00);
+	tap_assert(sub);
+	ok = 1;
+	for (int i = 0; i < 1000; i++) {
+		// The short names fit in the memory of the first name of the
+		// sub-object, the long ones do not.
+		snprintf(name, sizeof(name),
+				i % 2 ? "Renamed sub-object %d" : "R%d", i);
+		ok = ok && !co_sub_set_name(sub, name)
+				&& !strcmp(co_sub_get_name(sub), name);
+		ok = ok && !co_obj_set_name(obj, name)
+				&& !strcmp(co_obj_get_name(obj), name);
+	}
+	tap_test(ok, "rename objects and sub-objects allocated in the arena");
+	tap_test(!co_obj_set_name(obj, NULL) && !co_obj_get_name(obj),
+			"clear the name of an object allocated in the arena");
+
+	// Objects allocated from the arena can be removed and destroyed before
+	// the device.
+	obj = co_dev_find_obj(dev, 0x2001);
+	tap_assert(obj);
+	tap_assert(!co_dev_remove_obj(dev, obj));
+	co_obj_destroy(obj);
+	tap_test(!co_dev_find_obj(dev, 0x2001)
+					&& co_dev_find_obj(dev, 0x2002),
+			"remove and destroy an object allocated in the arena");
+
+	co_dev_destroy(dev);
+
+	dev = co_dev_create_from_dcf_file(TEST_SRCDIR "/co-sdev.dcf");
+	tap_assert(dev);
+	tap_test(!co_dev_get_arena_size(dev) && !co_dev_all_in_arena(dev),
+			"co_dev_create_from_dcf_file() does not use the arena");
+	co_dev_destroy(dev);
+
+	dev = co_dev_create_from_dcf_file_arena(
+			TEST_SRCDIR "/co-sdev.dcf", 1024);
+	tap_test(dev && co_dev_get_arena_size(dev) == 1024,
+			"co_dev_create_from_dcf_file_arena(\"co-sdev.dcf\", "
+			"1024)");
+	tap_assert(dev);
+	tap_test(co_dev_all_in_arena(dev),
+			"objects loaded from a DCF are allocated in the arena");
+	co_dev_destroy(dev);
+
+	return 0;
+}
+
+static int
+co_dev_all_in_arena(const co_dev_t *dev)
+{
+	tap_assert(dev);
+
+	int ok = 0;
+	for (co_obj_t *obj = co_dev_first_obj(dev); obj;
+			obj = co_obj_next(obj)) {
+		ok = co_dev_in_arena(dev, obj);
+		for (co_sub_t *sub = co_obj_first_sub(obj); ok && sub;
+				sub = co_sub_next(sub))
+			ok = co_dev_in_arena(dev, sub);
+		if (!ok)
+			break;
+	}
+	return ok;
+}
@@ -0,0 +1,172 @@
+#include "bench.h"
+#include <lely/co/dev.h>
+#include <lely/co/obj.h>
+#include <lely/co/val.h>
+
+#include <stdlib.h>
+
+#define NUM_LOOKUP (4ul * 1024ul * 1024ul)
+
+#define NUM_SUB 8
+
+#define NUM_DCF 10000
+
+static co_dev_t *dev_create(size_t n);
+
+static double bench_find_sub(const co_dev_t *dev, size_t n, size_t *pnfound);
+
+static double bench_find_obj_sub(
+		const co_dev_t *dev, size_t n, size_t *pnfound);
+
+static double bench_write_dcf(co_dev_t *dev, size_t n, int *pok);
+
+static double bench_dcf_cache(co_dev_t *dev, size_t n, int *pok);
+
+int
+main(void)
+{
+	static const size_t num_obj[] = { 10, 100, 1000, 10000 };
+	const size_t n = sizeof(num_obj) / sizeof(*num_obj);
+
+	tap_plan(5 * n);
+
+	for (size_t i = 0; i < n; i++) {
+		co_dev_t *dev = dev_create(num_obj[i]);
+
+		size_t ntree = 0;
+		double tree = bench_find_sub(dev, num_obj[i], &ntree);
+		tap_test(ntree == NUM_LOOKUP,
+				"tree:   %5zu objects: %.3g co_dev_find_sub()/s",
+				num_obj[i], tree);
+
+		tap_assert(!co_dev_freeze(dev));
+		tap_assert(co_dev_is_frozen(dev));
+
+		size_t nfrozen = 0;
+		double frozen = bench_find_sub(dev, num_obj[i], &nfrozen);
+		tap_test(nfrozen == ntree,
+				"frozen: %5zu objects: %.3g co_dev_find_sub()/s",
+				num_obj[i], frozen);
+
+		nfrozen = 0;
+		frozen = bench_find_obj_sub(dev, num_obj[i], &nfrozen);
+		tap_test(nfrozen == ntree,
+				"frozen: %5zu objects: %.3g co_obj_find_sub()/s",
+				num_obj[i], frozen);
+
+		int ok = 0;
+		double write = bench_write_dcf(dev, num_obj[i], &ok);
+		tap_test(ok, "write:  %5zu objects: %.3g co_dev_write_dcf()/s",
+				num_obj[i], write);
+
+		ok = 0;
+		double cache = bench_dcf_cache(dev, num_obj[i], &ok);
+		tap_test(ok, "cache:  %5zu objects: %.3g co_dcf_cache_get()/s",
+				num_obj[i], cache);
+
+		co_dev_destroy(dev);
+	}
+
+	return 0;
+}
+
+static co_dev_t *
+dev_create(size_t n)
+{
+	co_dev_t *dev = co_dev_create(1);
+	tap_assert(dev);
+
+	// Create objects with indices spread over the manufacturer-specific
+	// range, each with sub-indices 0..NUM_SUB-1.
+	for (size_t i = 0; i < n; i++) {
+		co_obj_t *obj = co_obj_create(0x2000 + (co_unsigned16_t)i);
+		tap_assert(obj);
+		for (co_unsigned8_t j = 0; j < NUM_SUB; j++) {
+			co_sub_t *sub = co_sub_create(j, CO_DEFTYPE_UNSIGNED32);
+			tap_assert(sub);
+			tap_assert(!co_obj_insert_sub(obj, sub));
+		}
+		tap_assert(!co_dev_insert_obj(dev, obj));
+	}
+
+	return dev;
+}
+
+static double
+bench_find_sub(const co_dev_t *dev, size_t n, size_t *pnfound)
+{
+	unsigned int rand = 1;
+
+	double start = bench_now();
+	for (size_t i = 0; i < NUM_LOOKUP; i++) {
+		rand = rand * 1103515245ul + 12345;
+		co_unsigned16_t idx = 0x2000 + (rand >> 8) % n;
+		co_unsigned8_t subidx = rand % NUM_SUB;
+		if (co_dev_find_sub(dev, idx, subidx))
+			(*pnfound)++;
+	}
+	double stop = bench_now();
+
+	return NUM_LOOKUP / (stop - start);
+}
+
+static double
+bench_find_obj_sub(const co_dev_t *dev, size_t n, size_t *pnfound)
+{
+	unsigned int rand = 1;
+
+	double start = bench_now();
+	for (size_t i = 0; i < NUM_LOOKUP; i++) {
+		rand = rand * 1103515245ul + 12345;
+		co_unsigned16_t idx = 0x2000 + (rand >> 8) % n;
+		co_unsigned8_t subidx = rand % NUM_SUB;
+		co_obj_t *obj = co_dev_find_obj(dev, idx);
+		if (obj && co_obj_find_sub(obj, subidx))
+			(*pnfound)++;
+	}
+	double stop = bench_now();
+
+	return NUM_LOOKUP / (stop - start);
+}
+
+static double
+bench_write_dcf(co_dev_t *dev, size_t n, int *pok)
+{
+	size_t num_iter = NUM_DCF * 10 / n;
+
+	*pok = 1;
+	double start = bench_now();
+	for (size_t i = 0; i < num_iter; i++) {
+		// Change a single value between snapshots.
+		co_unsigned16_t idx = 0x2000 + i % n;
+		co_dev_set_val_u32(dev, idx, 1, (co_unsigned32_t)i);
+		void *dom = NULL;
+		*pok = *pok && !co_dev_write_dcf(dev, 0, 0xffff, &dom);
+		co_val_fini(CO_DEFTYPE_DOMAIN, &dom);
+	}
+	double stop = bench_now();
+
+	return num_iter / (stop - start);
+}
+
+static double
+bench_dcf_cache(co_dev_t *dev, size_t n, int *pok)
+{
+	size_t num_iter = NUM_DCF * 10 / n;
+
+	co_dcf_cache_t *cache = co_dcf_cache_create(dev, 0, 0xffff);
+	tap_assert(cache);
+	*pok = co_dcf_cache_get(cache, NULL) != NULL;
+
+	double start = bench_now();
+	for (size_t i = 0; i < num_iter; i++) {
+		co_unsigned16_t idx = 0x2000 + i % n;
+		co_dev_set_val_u32(dev, idx, 1, (co_unsigned32_t)i);
+		*pok = *pok && co_dcf_cache_get(cache, NULL);
+	}
+	double stop = bench_now();
+
+	co_dcf_cache_destroy(cache);
+
+	return num_iter / (stop - start);
+}
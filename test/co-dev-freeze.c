@@ -0,0 +1,84 @@
+#include "test.h"
+#include <lely/co/dcf.h>
+#include <lely/co/obj.h>
+
+static int find_all(const co_dev_t *dev);
+
+int
+main(void)
+{
+	tap_plan(11);
+
+	co_dev_t *dev = co_dev_create_from_dcf_file(TEST_SRCDIR "/co-sdev.dcf");
+	tap_assert(dev);
+
+	tap_test(!co_dev_freeze(dev) && co_dev_is_frozen(dev),
+			"co_dev_freeze(<dev>)");
+	tap_test(!find_all(dev), "all objects are found in the frozen index");
+	tap_test(!co_dev_find_obj(dev, 0x2000)
+					&& !co_dev_find_sub(dev, 0x2000, 0x00)
+					&& !co_dev_find_sub(dev, 0x1000, 0x01),
+			"missing objects are not found in the frozen index");
+
+	// Insert an object whose sub-indices are not contiguous.
+	co_obj_t *obj = co_obj_create(0x2000);
+	tap_assert(obj);
+	co_sub_t *sub_00 = co_sub_create(0x00, CO_DEFTYPE_UNSIGNED8);
+	tap_assert(sub_00);
+	tap_assert(!co_obj_insert_sub(obj, sub_00));
+	co_sub_t *sub_05 = co_sub_create(0x05, CO_DEFTYPE_UNSIGNED32);
+	tap_assert(sub_05);
+	tap_assert(!co_obj_insert_sub(obj, sub_05));
+	tap_assert(!co_dev_insert_obj(dev, obj));
+	tap_test(!co_dev_is_frozen(dev), "inserting an object thaws <dev>");
+	tap_test(co_dev_find_obj(dev, 0x2000) == obj
+					&& co_dev_find_sub(dev, 0x2000, 0x05)
+							== sub_05,
+			"the new object is found after thawing");
+
+	tap_test(!co_dev_freeze(dev), "co_dev_freeze(<dev>) after a thaw");
+	tap_test(!find_all(dev) && co_dev_find_obj(dev, 0x2000) == obj,
+			"the new object is found in the frozen index");
+	tap_test(co_obj_find_sub(obj, 0x05) == sub_05
+					&& !co_obj_find_sub(obj, 0x01)
+					&& !co_obj_find_sub(obj, 0x06),
+			"non-contiguous sub-objects are found in the frozen "
+			"index");
+
+	tap_assert(!co_obj_remove_sub(obj, sub_05));
+	tap_test(!co_dev_is_frozen(dev), "removing a sub-object thaws <dev>");
+	co_sub_destroy(sub_05);
+
+	tap_assert(!co_dev_freeze(dev));
+	tap_assert(!co_dev_remove_obj(dev, obj));
+	tap_test(!co_dev_is_frozen(dev) && !co_dev_find_obj(dev, 0x2000),
+			"removing an object thaws <dev>");
+	co_obj_destroy(obj);
+
+	tap_test(!co_dev_freeze(dev) && !find_all(dev)
+					&& !co_dev_find_obj(dev, 0x2000),
+			"co_dev_freeze(<dev>) after removing an object");
+
+	co_dev_destroy(dev);
+
+	return 0;
+}
+
+static int
+find_all(const co_dev_t *dev)
+{
+	for (co_obj_t *obj = co_dev_first_obj(dev); obj;
+			obj = co_obj_next(obj)) {
+		co_unsigned16_t idx = co_obj_get_idx(obj);
+		if (co_dev_find_obj(dev, idx) != obj)
+			return -1;
+		for (co_sub_t *sub = co_obj_first_sub(obj); sub;
+				sub = co_sub_next(sub)) {
+			co_unsigned8_t subidx = co_sub_get_subidx(sub);
+			if (co_dev_find_sub(dev, idx, subidx) != sub
+					|| co_obj_find_sub(obj, subidx) != sub)
+				return -1;
+		}
+	}
+	return 0;
+}
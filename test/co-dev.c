@@ -0,0 +1,80 @@
+#include "test.h"
+#include <lely/co/dcf.h>
+#include <lely/co/obj.h>
+#include <lely/co/sdo.h>
+#include <lely/co/val.h>
+
+#include <string.h>
+
+static int cache_cmp(co_dcf_cache_t *cache, const co_dev_t *dev);
+
+int
+main(void)
+{
+	tap_plan(8);
+
+	co_dev_t *dev = co_dev_create_from_dcf_file(TEST_SRCDIR "/co-sdev.dcf");
+	tap_assert(dev);
+
+	co_obj_t *obj = co_obj_create(0x2000);
+	tap_assert(obj);
+	co_sub_t *sub_u32 = co_sub_create(0x00, CO_DEFTYPE_UNSIGNED32);
+	tap_assert(sub_u32);
+	tap_assert(!co_obj_insert_sub(obj, sub_u32));
+	co_sub_t *sub_dom = co_sub_create(0x01, CO_DEFTYPE_DOMAIN);
+	tap_assert(sub_dom);
+	tap_assert(!co_obj_insert_sub(obj, sub_dom));
+	tap_assert(!co_dev_insert_obj(dev, obj));
+
+	co_dcf_cache_t *cache = co_dcf_cache_create(dev, 0, 0xffff);
+	tap_test(cache, "co_dcf_cache_create(<dev>, 0, 0xffff)");
+	tap_assert(cache);
+
+	tap_test(!cache_cmp(cache, dev),
+			"the cache is identical to co_dev_write_dcf()");
+
+	co_sub_set_val_u32(sub_u32, 0x12345678);
+	tap_test(!cache_cmp(cache, dev), "a changed value is updated");
+
+	co_sub_set_val(sub_dom, "abcdefgh", 8);
+	co_sub_set_val_u32(sub_u32, 0x87654321);
+	tap_test(!cache_cmp(cache, dev), "a value that grows is updated");
+
+	co_sub_set_val(sub_dom, "ab", 2);
+	tap_test(!cache_cmp(cache, dev), "a value that shrinks is updated");
+
+	co_unsigned32_t val = 0xdeadbeef;
+	tap_test(!co_sub_dn_ind_val(sub_u32, CO_DEFTYPE_UNSIGNED32, &val)
+					&& !cache_cmp(cache, dev),
+			"a value downloaded with an SDO is updated");
+
+	co_sub_t *sub = co_sub_create(0x02, CO_DEFTYPE_UNSIGNED8);
+	tap_assert(sub);
+	tap_assert(!co_obj_insert_sub(obj, sub));
+	co_sub_set_flags(sub, CO_OBJ_FLAGS_VAL_NODEID);
+	co_sub_set_val_u8(sub, 0x42);
+	tap_test(!cache_cmp(cache, dev), "a new sub-object is added");
+
+	tap_assert(!co_dev_set_id(dev, 0x10));
+	tap_test(!cache_cmp(cache, dev), "a change in node-ID is applied");
+
+	co_dcf_cache_destroy(cache);
+	co_dev_destroy(dev);
+
+	return 0;
+}
+
+static int
+cache_cmp(co_dcf_cache_t *cache, const co_dev_t *dev)
+{
+	size_t size = 0;
+	const void *ptr = co_dcf_cache_get(cache, &size);
+	tap_assert(ptr);
+
+	void *dom = NULL;
+	tap_assert(!co_dev_write_dcf(dev, 0, 0xffff, &dom));
+	int cmp = size != co_val_sizeof(CO_DEFTYPE_DOMAIN, &dom)
+			|| memcmp(ptr, dom, size);
+	co_val_fini(CO_DEFTYPE_DOMAIN, &dom);
+	return cmp;
+}
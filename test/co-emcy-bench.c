@@ -0,0 +1,133 @@
+#include "bench.h"
+#include <lely/can/net.h>
+#include <lely/co/dev.h>
+#include <lely/co/emcy.h>
+#include <lely/co/obj.h>
+#include <lely/util/endian.h>
+#include <lely/util/time.h>
+
+/// The number of remote nodes sending EMCY messages.
+#define NUM_NODE 60
+
+/// The number of EMCY messages sent by every node.
+#define NUM_MSG 10000
+
+/// The capacity of the EMCY event ring.
+#define RING_SIZE 256
+
+/// The number of events read from the EMCY event ring at once.
+#define BATCH_SIZE 64
+
+static co_dev_t *dev_create(void);
+
+static int send_func(const struct can_msg *msg, void *data);
+
+int
+main(void)
+{
+	tap_plan(3);
+
+	can_net_t *net = can_net_create();
+	tap_assert(net);
+	can_net_set_send_func(net, &send_func, NULL);
+
+	co_dev_t *dev = dev_create();
+	co_emcy_t *emcy = co_emcy_create(net, dev);
+	tap_assert(emcy);
+	tap_assert(!co_emcy_set_ring_size(emcy, RING_SIZE));
+
+	size_t nfilter = can_net_get_filter(net, NULL, 0);
+
+	// Every node sends a burst of EMCY messages, as it would during a fault
+	// storm. The ring is drained in batches while the messages arrive.
+	struct can_msg msg = CAN_MSG_INIT;
+	msg.len = CAN_MAX_LEN;
+	struct co_emcy_event events[BATCH_SIZE];
+	size_t nevent = 0;
+	int ok = 1;
+	struct timespec now = { 0, 0 };
+	double start = bench_now();
+	for (size_t i = 0; i < NUM_MSG; i++) {
+		for (co_unsigned8_t id = 1; id <= NUM_NODE; id++) {
+			timespec_add_usec(&now, 10);
+			msg.id = CO_EMCY_CANID(id);
+			stle_u16(msg.data, (co_unsigned16_t)i);
+			can_net_recv_at(net, &msg, &now);
+		}
+		size_t n;
+		while ((n = co_emcy_read_ring(emcy, events, BATCH_SIZE))) {
+			for (size_t j = 0; j < n; j++) {
+				co_unsigned8_t id = nevent % NUM_NODE + 1;
+				co_unsigned16_t eec = nevent / NUM_NODE;
+				ok = ok && events[j].id == id
+						&& events[j].eec == eec;
+				nevent++;
+			}
+		}
+	}
+	double stop = bench_now();
+
+	tap_test(nevent == NUM_MSG * NUM_NODE,
+			"%d nodes: %.3g EMCY messages/s, %zu receivers",
+			NUM_NODE, NUM_MSG * NUM_NODE / (stop - start), nfilter);
+	tap_test(ok && !co_emcy_get_ring_dropped(emcy),
+			"every message is read from the ring, in order");
+
+	// Without a reader, the ring overflows and messages are dropped.
+	size_t nsent = (RING_SIZE / NUM_NODE + 1) * NUM_NODE;
+	for (size_t i = 0; i < nsent; i++) {
+		msg.id = CO_EMCY_CANID(i % NUM_NODE + 1);
+		can_net_recv(net, &msg);
+	}
+	size_t ndropped = co_emcy_get_ring_dropped(emcy);
+	tap_test(co_emcy_read_ring(emcy, events, BATCH_SIZE) == BATCH_SIZE
+					&& ndropped == nsent - RING_SIZE,
+			"%zu messages are dropped when the ring is full",
+			ndropped);
+
+	co_emcy_destroy(emcy);
+	co_dev_destroy(dev);
+	can_net_destroy(net);
+
+	return 0;
+}
+
+static co_dev_t *
+dev_create(void)
+{
+	co_dev_t *dev = co_dev_create(CO_NUM_NODES);
+	tap_assert(dev);
+
+	co_obj_t *obj = co_obj_create(0x1001);
+	tap_assert(obj);
+	co_sub_t *sub = co_sub_create(0x00, CO_DEFTYPE_UNSIGNED8);
+	tap_assert(sub);
+	tap_assert(!co_obj_insert_sub(obj, sub));
+	tap_assert(!co_dev_insert_obj(dev, obj));
+
+	obj = co_obj_create(0x1028);
+	tap_assert(obj);
+	co_obj_set_code(obj, CO_OBJECT_ARRAY);
+	sub = co_sub_create(0x00, CO_DEFTYPE_UNSIGNED8);
+	tap_assert(sub);
+	tap_assert(!co_obj_insert_sub(obj, sub));
+	co_sub_set_val_u8(sub, CO_NUM_NODES - 1);
+	for (co_unsigned8_t id = 1; id < CO_NUM_NODES; id++) {
+		sub = co_sub_create(id, CO_DEFTYPE_UNSIGNED32);
+		tap_assert(sub);
+		tap_assert(!co_obj_insert_sub(obj, sub));
+		co_sub_set_val_u32(sub, CO_EMCY_CANID(id));
+	}
+	tap_assert(!co_dev_insert_obj(dev, obj));
+
+	return dev;
+}
+
+static int
+send_func(const struct can_msg *msg, void *data)
+{
+	(void)msg;
+	(void)data;
+
+	return 0;
+}
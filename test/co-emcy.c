@@ -1,14 +1,59 @@
 #include "co-test.h"
+#include <lely/co/csdo.h>
 #include <lely/co/dcf.h>
 #include <lely/co/emcy.h>
+#include <lely/co/sdo.h>
+
+#include <errno.h>
+
+// Allocation failures can only be injected if malloc() can be replaced.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define HAVE_MALLOC_FAIL 1
+
+extern void *__libc_malloc(size_t size);
+
+static int malloc_fail;
+
+void *
+malloc(size_t size)
+{
+	if (malloc_fail) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	return __libc_malloc(size);
+}
+#endif
+
+/// The mask of the masked CAN frame receiver shared by the EMCY consumers.
+#define EMCY_CANID_MASK (CAN_MASK_BID & ~CO_NUM_NODES)
 
 void emcy_ind(co_emcy_t *emcy, co_unsigned8_t id, co_unsigned16_t ec,
 		co_unsigned8_t er, co_unsigned8_t msef[5], void *data);
 
+/// The EMCY messages received since the last call to recv_emcy().
+struct emcy_stats {
+	size_t n;
+	co_unsigned8_t id;
+};
+
+static void emcy_stats_ind(co_emcy_t *emcy, co_unsigned8_t id,
+		co_unsigned16_t ec, co_unsigned8_t er, co_unsigned8_t msef[5],
+		void *data);
+
+static size_t recv_emcy(can_net_t *net, struct emcy_stats *stats,
+		uint_least32_t id);
+static co_unsigned32_t set_1028(
+		co_dev_t *dev, co_unsigned8_t id, co_unsigned32_t cobid);
+static void dn_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		co_unsigned32_t ac, void *data);
+static size_t num_filter(
+		const can_net_t *net, uint_least32_t id, uint_least32_t mask);
+
 int
 main(void)
 {
-	tap_plan(10);
+	tap_plan(19);
 
 #if !LELY_NO_STDIO && !LELY_NO_DIAG
 	diag_set_handler(&co_test_diag_handler, NULL);
@@ -26,6 +71,7 @@ main(void)
 	tap_assert(emcy);
 
 	co_emcy_set_ind(emcy, &emcy_ind, &test);
+	tap_assert(!co_emcy_set_ring_size(emcy, 4));
 
 	co_emcy_push(emcy, 0x1000, 0x00, NULL);
 	co_test_wait(&test);
@@ -49,6 +95,73 @@ main(void)
 	co_emcy_pop(emcy, NULL, NULL);
 	co_test_wait(&test);
 
+	struct co_emcy_event events[5];
+	tap_test(co_emcy_read_ring(emcy, events, 5) == 4
+					&& co_emcy_get_ring_dropped(emcy) == 6
+					&& events[0].id == 1
+					&& events[0].eec == 0x1000
+					&& events[3].eec == 0x4000,
+			"the EMCY ring holds the first 4 messages");
+
+	// Only node 1 uses the pre-defined EMCY COB-ID.
+	struct emcy_stats stats = { 0, 0 };
+	co_emcy_set_ind(emcy, &emcy_stats_ind, &stats);
+	tap_test(num_filter(net, 0x080, EMCY_CANID_MASK) == 1
+					&& recv_emcy(net, &stats, 0x081) == 1
+					&& stats.id == 1,
+			"receive EMCY messages with the shared receiver");
+	tap_test(!recv_emcy(net, &stats, 0x080)
+					&& !recv_emcy(net, &stats, 0x082),
+			"ignore SYNC and nodes without an EMCY consumer");
+
+	// Switch node 2 from the pre-defined COB-ID to a custom one.
+	tap_assert(!set_1028(dev, 2, 0x00000082));
+	tap_test(recv_emcy(net, &stats, 0x082) == 1 && stats.id == 2,
+			"receive the pre-defined COB-ID of a new node");
+	tap_assert(!set_1028(dev, 2, 0x80000082));
+	tap_assert(!set_1028(dev, 2, 0x000001a2));
+	tap_test(num_filter(net, 0x1a2, CAN_MASK_BID) == 1
+					&& recv_emcy(net, &stats, 0x1a2) == 1
+					&& stats.id == 2
+					&& !recv_emcy(net, &stats, 0x082),
+			"move a node with a custom COB-ID to a dedicated "
+			"receiver");
+
+	// And back to the pre-defined COB-ID.
+	tap_assert(!set_1028(dev, 2, 0x800001a2));
+	tap_assert(!set_1028(dev, 2, 0x00000082));
+	tap_test(!num_filter(net, 0x1a2, CAN_MASK_BID)
+					&& recv_emcy(net, &stats, 0x082) == 1
+					&& stats.id == 2
+					&& !recv_emcy(net, &stats, 0x1a2),
+			"move a node back to the shared receiver");
+
+	// The shared receiver is only stopped once no node uses it.
+	tap_assert(!set_1028(dev, 1, 0x80000081));
+	tap_test(num_filter(net, 0x080, EMCY_CANID_MASK) == 1
+					&& !recv_emcy(net, &stats, 0x081)
+					&& recv_emcy(net, &stats, 0x082) == 1,
+			"keep the shared receiver while a node uses it");
+	tap_assert(!set_1028(dev, 2, 0x80000082));
+	tap_test(!num_filter(net, 0x080, EMCY_CANID_MASK),
+			"stop the shared receiver once no node uses it");
+	tap_assert(!set_1028(dev, 1, 0x00000081));
+
+#if HAVE_MALLOC_FAIL
+	// Node 3 has never had a dedicated receiver, so one has to be created.
+	malloc_fail = 1;
+	co_unsigned32_t ac = set_1028(dev, 3, 0x000001a3);
+	malloc_fail = 0;
+	tap_test(ac == CO_SDO_AC_NO_MEM
+					&& co_dev_get_val_u32(dev, 0x1028, 0x03)
+							== 0x80000000
+					&& !recv_emcy(net, &stats, 0x1a3),
+			"abort with CO_SDO_AC_NO_MEM if a receiver cannot be "
+			"created");
+#else
+	tap_skip("unable to inject allocation failures");
+#endif
+
 	co_emcy_destroy(emcy);
 	co_dev_destroy(dev);
 
@@ -70,3 +183,74 @@ emcy_ind(co_emcy_t *emcy, co_unsigned8_t id, co_unsigned16_t ec,
 
 	co_test_done(test);
 }
+
+static void
+emcy_stats_ind(co_emcy_t *emcy, co_unsigned8_t id, co_unsigned16_t ec,
+		co_unsigned8_t er, co_unsigned8_t msef[5], void *data)
+{
+	(void)emcy;
+	(void)ec;
+	(void)er;
+	(void)msef;
+	struct emcy_stats *stats = data;
+	tap_assert(stats);
+
+	stats->n++;
+	stats->id = id;
+}
+
+static size_t
+recv_emcy(can_net_t *net, struct emcy_stats *stats, uint_least32_t id)
+{
+	tap_assert(stats);
+
+	stats->n = 0;
+	stats->id = 0;
+
+	struct can_msg msg = CAN_MSG_INIT;
+	msg.id = id;
+	msg.len = 3;
+	msg.data[0] = 0x00;
+	msg.data[1] = 0x10;
+	msg.data[2] = 0x01;
+	can_net_recv(net, &msg);
+
+	return stats->n;
+}
+
+static co_unsigned32_t
+set_1028(co_dev_t *dev, co_unsigned8_t id, co_unsigned32_t cobid)
+{
+	co_unsigned32_t ac = 0;
+	tap_assert(!co_dev_dn_val_req(dev, 0x1028, id, CO_DEFTYPE_UNSIGNED32,
+			&cobid, &dn_con, &ac));
+	return ac;
+}
+
+static void
+dn_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		co_unsigned32_t ac, void *data)
+{
+	(void)sdo;
+	(void)idx;
+	(void)subidx;
+	co_unsigned32_t *pac = data;
+	tap_assert(pac);
+
+	*pac = ac;
+}
+
+static size_t
+num_filter(const can_net_t *net, uint_least32_t id, uint_least32_t mask)
+{
+	struct can_net_filter filters[16];
+	size_t n = can_net_get_filter(net, filters, 16);
+	tap_assert(n <= 16);
+
+	size_t num = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (filters[i].id == id && filters[i].mask == mask)
+			num++;
+	}
+	return num;
+}
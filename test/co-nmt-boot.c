@@ -0,0 +1,314 @@
+#include "test.h"
+#include <lely/can/buf.h>
+#include <lely/can/net.h>
+#include <lely/co/dcf.h>
+#include <lely/co/nmt.h>
+#include <lely/co/obj.h>
+#include <lely/co/sdo.h>
+#include <lely/co/val.h>
+#include <lely/util/endian.h>
+
+#define NMT_TIMEOUT 1000
+
+#define NUM_SLAVES 3
+
+// The size of a concise DCF containing a single UNSIGNED32 value.
+#define CFG_SIZE (4 + 2 + 1 + 4 + 4)
+
+// The size of the program downloaded to node 2. This is larger than the buffer
+// used by the NMT master to download program data from a source.
+#define PROG_SIZE 4096
+
+#define PROG_SWID 0x12345678u
+
+// Each node has its own CAN network interface, since the receivers of a single
+// interface cannot handle an NMT command that resets more than one node.
+struct bus {
+	can_net_t *net[1 + NUM_SLAVES];
+	struct can_buf buf;
+};
+
+static int bus_send(const struct can_msg *msg, void *data);
+static void bus_step(struct bus *bus);
+
+void boot_ind(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t st, char es,
+		void *data);
+
+static void boot_wait(struct bus *bus, size_t n);
+
+static co_unsigned32_t co_1f51_dn_ind(
+		co_sub_t *sub, struct co_sdo_req *req, void *data);
+
+static uint_least8_t prog_byte(size_t offset);
+
+struct prog_src {
+	size_t num_read;
+	size_t max_read;
+};
+
+static co_unsigned32_t prog_read(co_nmt_t *nmt, co_unsigned8_t id,
+		size_t offset, void *ptr, size_t n, void *data);
+
+static co_unsigned8_t boot_order[NUM_SLAVES];
+static char boot_es[NUM_SLAVES];
+static size_t boot_num;
+
+int
+main(void)
+{
+	tap_plan(8);
+
+	struct bus bus;
+	can_buf_init(&bus.buf, NULL, 0);
+	tap_assert(can_buf_reserve(&bus.buf, 1024) >= 1024);
+	for (size_t i = 0; i < 1 + NUM_SLAVES; i++) {
+		bus.net[i] = can_net_create();
+		tap_assert(bus.net[i]);
+		can_net_set_send_func(bus.net[i], &bus_send, &bus);
+	}
+	bus_step(&bus);
+
+	co_dev_t *mdev = co_dev_create_from_dcf_file(
+			TEST_SRCDIR "/co-nmt-boot-master.dcf");
+	tap_assert(mdev);
+
+	// Create a concise DCF for each slave that sets sub-object 2001:00.
+	uint_least8_t cfg[NUM_SLAVES][CFG_SIZE];
+	for (co_unsigned8_t i = 0; i < NUM_SLAVES; i++) {
+		co_unsigned8_t id = 2 + i;
+		stle_u32(cfg[i], 1);
+		stle_u16(cfg[i] + 4, 0x2001);
+		cfg[i][6] = 0x00;
+		stle_u32(cfg[i] + 7, 4);
+		stle_u32(cfg[i] + 11, 0x1000 + id);
+		tap_assert(co_dev_set_val(mdev, 0x1f22, id, cfg[i], CFG_SIZE)
+				== CFG_SIZE);
+	}
+
+	co_nmt_t *master = co_nmt_create(bus.net[0], mdev);
+	tap_assert(master);
+	co_nmt_set_boot_ind(master, &boot_ind, NULL);
+	co_nmt_set_timeout(master, NMT_TIMEOUT);
+	// Boot one slave at a time, and node 4 before node 3.
+	co_nmt_set_boot_max(master, 1);
+	tap_assert(!co_nmt_set_boot_prio(master, 3, 2));
+	tap_assert(!co_nmt_set_boot_prio(master, 4, 1));
+	co_nmt_set_cfg_hash(master, 0x2000, 0x00);
+
+	co_dev_t *sdev[NUM_SLAVES];
+	co_nmt_t *slave[NUM_SLAVES];
+	for (co_unsigned8_t i = 0; i < NUM_SLAVES; i++) {
+		sdev[i] = co_dev_create_from_dcf_file(
+				TEST_SRCDIR "/co-nmt-boot-slave.dcf");
+		tap_assert(sdev[i]);
+		tap_assert(!co_dev_set_id(sdev[i], 2 + i));
+		slave[i] = co_nmt_create(bus.net[1 + i], sdev[i]);
+		tap_assert(slave[i]);
+		tap_assert(!co_nmt_cs_ind(slave[i], CO_NMT_CS_RESET_NODE));
+	}
+	bus_step(&bus);
+
+	tap_assert(!co_nmt_cs_ind(master, CO_NMT_CS_RESET_NODE));
+	boot_wait(&bus, NUM_SLAVES);
+
+	tap_test(boot_num == NUM_SLAVES && !boot_es[0] && !boot_es[1]
+					&& !boot_es[2],
+			"boot all slaves");
+	tap_test(boot_order[0] == 2 && boot_order[1] == 4
+					&& boot_order[2] == 3,
+			"queued slaves are booted in order of priority");
+
+	int ok = 1;
+	for (co_unsigned8_t i = 0; i < NUM_SLAVES; i++) {
+		struct co_nmt_boot_stats stats;
+		tap_assert(!co_nmt_get_boot_stats(master, 2 + i, &stats));
+		co_unsigned32_t val = co_dev_get_val_u32(sdev[i], 0x2001, 0x00);
+		co_unsigned32_t hash =
+				co_dev_get_val_u32(sdev[i], 0x2000, 0x00);
+		ok = ok && !stats.cfg_skipped && val == 0x1002u + i
+				&& hash == co_nmt_cfg_hash(cfg[i], CFG_SIZE);
+	}
+	tap_test(ok, "the configuration is downloaded and its hash stored");
+
+	// Clear the configuration of nodes 2 and 3, and invalidate the stored
+	// hash of node 3.
+	co_dev_set_val_u32(sdev[0], 0x2001, 0x00, 0);
+	co_dev_set_val_u32(sdev[1], 0x2001, 0x00, 0);
+	co_dev_set_val_u32(sdev[1], 0x2000, 0x00, 0);
+
+	tap_assert(!co_nmt_boot_req(master, 2, NMT_TIMEOUT));
+	tap_assert(!co_nmt_boot_req(master, 3, NMT_TIMEOUT));
+	tap_test(co_nmt_is_booting(master, 3), "a boot request is queued");
+	boot_wait(&bus, 2);
+
+	struct co_nmt_boot_stats stats;
+	tap_assert(!co_nmt_get_boot_stats(master, 2, &stats));
+	co_unsigned32_t val = co_dev_get_val_u32(sdev[0], 0x2001, 0x00);
+	tap_test(!boot_es[0] && stats.cfg_skipped && !val,
+			"the configuration update is skipped if the hash "
+			"matches");
+
+	tap_assert(!co_nmt_get_boot_stats(master, 3, &stats));
+	val = co_dev_get_val_u32(sdev[1], 0x2001, 0x00);
+	co_unsigned32_t hash = co_dev_get_val_u32(sdev[1], 0x2000, 0x00);
+	tap_test(!boot_es[1] && !stats.cfg_skipped && val == 0x1003
+					&& hash == co_nmt_cfg_hash(
+							   cfg[1], CFG_SIZE),
+			"the configuration is updated if the hash differs");
+
+	// Download a program to node 2 from a program data source. The slave
+	// reports the expected software identification once its program has
+	// been cleared.
+	struct prog_src src = { 0, 0 };
+	tap_assert(!co_nmt_set_prog_src(
+			master, 2, PROG_SIZE, &prog_read, &src));
+	co_dev_set_val_u32(mdev, 0x1f55, 2, PROG_SWID);
+	co_dev_set_val_u32(mdev, 0x1f81, 2, 0x00000065);
+	co_obj_t *obj_1f51 = co_dev_find_obj(sdev[0], 0x1f51);
+	tap_assert(obj_1f51);
+	co_obj_set_dn_ind(obj_1f51, &co_1f51_dn_ind, sdev[0]);
+
+	tap_assert(!co_nmt_boot_req(master, 2, NMT_TIMEOUT));
+	boot_wait(&bus, 1);
+
+	co_sub_t *sub_1f50 = co_dev_find_sub(sdev[0], 0x1f50, 0x01);
+	tap_assert(sub_1f50);
+	const uint_least8_t *prog = co_sub_addressof_val(sub_1f50);
+	ok = !boot_es[0] && prog
+			&& co_sub_sizeof_val(sub_1f50) == PROG_SIZE;
+	for (size_t i = 0; ok && i < PROG_SIZE; i++)
+		ok = prog[i] == prog_byte(i);
+	tap_test(ok, "download a program from a program data source");
+	tap_test(src.num_read > 1 && src.max_read < PROG_SIZE,
+			"the program data is read in parts");
+
+	for (co_unsigned8_t i = 0; i < NUM_SLAVES; i++) {
+		co_nmt_destroy(slave[i]);
+		co_dev_destroy(sdev[i]);
+	}
+
+	co_nmt_destroy(master);
+	co_dev_destroy(mdev);
+
+	for (size_t i = 0; i < 1 + NUM_SLAVES; i++)
+		can_net_destroy(bus.net[i]);
+	can_buf_fini(&bus.buf);
+
+	return 0;
+}
+
+void
+boot_ind(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t st, char es,
+		void *data)
+{
+	(void)st;
+	(void)data;
+
+	tap_diag("node %d booted with error status %c", id, es ? es : '0');
+
+	tap_assert(boot_num < NUM_SLAVES);
+	boot_order[boot_num++] = id;
+	tap_assert(id >= 2 && id < 2 + NUM_SLAVES);
+	boot_es[id - 2] = es;
+	tap_assert(!co_nmt_is_booting(nmt, id));
+}
+
+static int
+bus_send(const struct can_msg *msg, void *data)
+{
+	struct bus *bus = data;
+	tap_assert(bus);
+
+	return can_buf_write(&bus->buf, msg, 1) ? 0 : -1;
+}
+
+static void
+bus_step(struct bus *bus)
+{
+	tap_assert(bus);
+
+	struct timespec now = { 0, 0 };
+	timespec_get(&now, TIME_UTC);
+	for (size_t i = 0; i < 1 + NUM_SLAVES; i++)
+		can_net_set_time(bus->net[i], &now);
+
+	// Deliver each frame to all nodes, including the sender.
+	struct can_msg msg;
+	while (can_buf_read(&bus->buf, &msg, 1)) {
+		for (size_t i = 0; i < 1 + NUM_SLAVES; i++)
+			can_net_recv(bus->net[i], &msg);
+	}
+}
+
+static void
+boot_wait(struct bus *bus, size_t n)
+{
+	boot_num = 0;
+	while (boot_num < n)
+		bus_step(bus);
+}
+
+static co_unsigned32_t
+co_1f51_dn_ind(co_sub_t *sub, struct co_sdo_req *req, void *data)
+{
+	tap_assert(sub);
+	tap_assert(co_obj_get_idx(co_sub_get_obj(sub)) == 0x1f51);
+	tap_assert(req);
+	co_dev_t *dev = data;
+	tap_assert(dev);
+
+	co_unsigned32_t ac = 0;
+
+	co_unsigned16_t type = co_sub_get_type(sub);
+	union co_val val;
+	if (co_sdo_req_dn_val(req, type, &val, &ac) == -1)
+		return ac;
+
+	co_unsigned8_t subidx = co_sub_get_subidx(sub);
+	if (!subidx) {
+		ac = CO_SDO_AC_NO_WRITE;
+		goto error;
+	}
+
+	tap_assert(type == CO_DEFTYPE_UNSIGNED8);
+	switch (val.u8) {
+	case 0: break;
+	case 1: break;
+	case 2: break;
+	case 3: co_dev_set_val_u32(dev, 0x1f56, subidx, PROG_SWID); break;
+	default: ac = CO_SDO_AC_PARAM_VAL; break;
+	}
+
+	co_sub_dn(sub, &val);
+error:
+	co_val_fini(type, &val);
+	return ac;
+}
+
+static uint_least8_t
+prog_byte(size_t offset)
+{
+	return (uint_least8_t)((offset * 31 + 7) & 0xff);
+}
+
+static co_unsigned32_t
+prog_read(co_nmt_t *nmt, co_unsigned8_t id, size_t offset, void *ptr,
+		size_t n, void *data)
+{
+	(void)nmt;
+	struct prog_src *src = data;
+	tap_assert(src);
+
+	tap_assert(id == 2);
+	tap_assert(offset + n <= PROG_SIZE);
+
+	src->num_read++;
+	if (n > src->max_read)
+		src->max_read = n;
+
+	uint_least8_t *bp = ptr;
+	for (size_t i = 0; i < n; i++)
+		bp[i] = prog_byte(offset + i);
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+#include "bench.h"
+#include <lely/can/net.h>
+#include <lely/co/dev.h>
+#include <lely/co/nmt.h>
+#include <lely/co/obj.h>
+#include <lely/util/time.h>
+
+#include <stdlib.h>
+
+/// The number of monitored nodes.
+#define NUM_NODE CO_NUM_NODES
+
+/// The heartbeat producer time (in milliseconds).
+#define HB_PERIOD 10
+
+/// The heartbeat consumer time (in milliseconds).
+#define HB_TIMEOUT 25
+
+/// The number of heartbeat periods to simulate.
+#define NUM_PERIOD 10000
+
+static co_dev_t *dev_create(void);
+
+static int send_func(const struct can_msg *msg, void *data);
+static int next_func(const struct timespec *tp, void *data);
+static void hb_ind(co_nmt_t *nmt, co_unsigned8_t id, int state, int reason,
+		void *data);
+
+struct hb_stats {
+	size_t nnext;
+	size_t ntimeout;
+	size_t nresolved;
+};
+
+int
+main(void)
+{
+	tap_plan(3);
+
+	can_net_t *net = can_net_create();
+	tap_assert(net);
+	can_net_set_send_func(net, &send_func, NULL);
+
+	struct hb_stats stats = { 0, 0, 0 };
+	can_net_set_next_func(net, &next_func, &stats);
+
+	co_dev_t *dev = dev_create();
+	co_nmt_t *nmt = co_nmt_create(net, dev);
+	tap_assert(nmt);
+	co_nmt_set_hb_ind(nmt, &hb_ind, &stats);
+	tap_assert(!co_nmt_cs_ind(nmt, CO_NMT_CS_RESET_NODE));
+
+	size_t nfilter = can_net_get_filter(net, NULL, 0);
+
+	// Every node sends a heartbeat message once per period. The messages
+	// are spread evenly over the period.
+	struct can_msg msg = CAN_MSG_INIT;
+	msg.len = 1;
+	msg.data[0] = CO_NMT_ST_PREOP;
+	struct timespec now = { 0, 0 };
+	double start = bench_now();
+	for (size_t i = 0; i < NUM_PERIOD; i++) {
+		for (co_unsigned8_t id = 1; id <= NUM_NODE; id++) {
+			now = (struct timespec){ 0, 0 };
+			timespec_add_usec(&now,
+					(uint_least64_t)(i * NUM_NODE + id - 1)
+							* HB_PERIOD * 1000
+							/ NUM_NODE);
+			can_net_set_time(net, &now);
+			msg.id = CO_NMT_EC_CANID(id);
+			can_net_recv(net, &msg);
+		}
+	}
+	double stop = bench_now();
+
+	// The next-timer callback is invoked once by every call to
+	// can_net_set_time() and once for every timer that is started or
+	// stopped.
+	size_t nupdate = stats.nnext - NUM_PERIOD * NUM_NODE;
+
+	tap_test(!stats.ntimeout,
+			"%d nodes x %d ms: %.3g heartbeats/s, %zu receivers",
+			NUM_NODE, HB_PERIOD,
+			NUM_PERIOD * NUM_NODE / (stop - start), nfilter);
+	tap_test(stats.nnext >= NUM_PERIOD * NUM_NODE,
+			"%.3g timer starts/stops per heartbeat",
+			(double)nupdate / (NUM_PERIOD * NUM_NODE));
+
+	// Stop sending heartbeats; every consumer should time out once.
+	timespec_add_msec(&now, 2 * HB_TIMEOUT);
+	can_net_set_time(net, &now);
+	tap_test(stats.ntimeout == NUM_NODE,
+			"%zu heartbeat timeouts after the producers stop",
+			stats.ntimeout);
+
+	co_nmt_destroy(nmt);
+	co_dev_destroy(dev);
+	can_net_destroy(net);
+
+	return 0;
+}
+
+static co_dev_t *
+dev_create(void)
+{
+	co_dev_t *dev = co_dev_create(1);
+	tap_assert(dev);
+
+	co_obj_t *obj = co_obj_create(0x1016);
+	tap_assert(obj);
+	co_obj_set_code(obj, CO_OBJECT_ARRAY);
+	co_sub_t *sub = co_sub_create(0x00, CO_DEFTYPE_UNSIGNED8);
+	tap_assert(sub);
+	tap_assert(!co_obj_insert_sub(obj, sub));
+	co_sub_set_val_u8(sub, NUM_NODE);
+	for (co_unsigned8_t id = 1; id <= NUM_NODE; id++) {
+		sub = co_sub_create(id, CO_DEFTYPE_UNSIGNED32);
+		tap_assert(sub);
+		tap_assert(!co_obj_insert_sub(obj, sub));
+		co_sub_set_val_u32(sub, ((co_unsigned32_t)id << 16) | HB_TIMEOUT);
+	}
+	tap_assert(!co_dev_insert_obj(dev, obj));
+
+	return dev;
+}
+
+static int
+send_func(const struct can_msg *msg, void *data)
+{
+	(void)msg;
+	(void)data;
+
+	return 0;
+}
+
+static int
+next_func(const struct timespec *tp, void *data)
+{
+	(void)tp;
+	struct hb_stats *stats = data;
+
+	stats->nnext++;
+
+	return 0;
+}
+
+static void
+hb_ind(co_nmt_t *nmt, co_unsigned8_t id, int state, int reason, void *data)
+{
+	(void)nmt;
+	(void)id;
+	struct hb_stats *stats = data;
+
+	if (reason == CO_NMT_EC_TIMEOUT) {
+		if (state == CO_NMT_EC_OCCURRED)
+			stats->ntimeout++;
+		else
+			stats->nresolved++;
+	}
+}
@@ -0,0 +1,175 @@
+#include "test.h"
+#include <lely/can/net.h>
+#include <lely/co/csdo.h>
+#include <lely/co/dev.h>
+#include <lely/co/nmt.h>
+#include <lely/co/obj.h>
+#include <lely/util/time.h>
+
+/// The heartbeat consumer time (in milliseconds).
+#define HB_TIMEOUT 100
+
+static co_dev_t *dev_create(void);
+
+static int send_func(const struct can_msg *msg, void *data);
+
+static void set_time(can_net_t *net, int ms);
+static void send_hb(can_net_t *net, co_unsigned8_t id);
+static void set_1016(co_dev_t *dev, co_unsigned8_t subidx, co_unsigned8_t id,
+		co_unsigned16_t ms);
+
+static void hb_ind(co_nmt_t *nmt, co_unsigned8_t id, int state, int reason,
+		void *data);
+
+/// The number of heartbeat timeout events for each node.
+struct hb_stats {
+	size_t noccurred[CO_NUM_NODES + 1];
+	size_t nresolved[CO_NUM_NODES + 1];
+};
+
+int
+main(void)
+{
+	tap_plan(7);
+
+	can_net_t *net = can_net_create();
+	tap_assert(net);
+	can_net_set_send_func(net, &send_func, NULL);
+	set_time(net, 0);
+
+	// Monitor nodes 2 and 3.
+	co_dev_t *dev = dev_create();
+	co_nmt_t *nmt = co_nmt_create(net, dev);
+	tap_assert(nmt);
+	struct hb_stats stats = { { 0 }, { 0 } };
+	co_nmt_set_hb_ind(nmt, &hb_ind, &stats);
+	tap_assert(!co_nmt_cs_ind(nmt, CO_NMT_CS_RESET_NODE));
+
+	// Node 2 keeps sending heartbeats, node 3 stops after the first one.
+	send_hb(net, 2);
+	send_hb(net, 3);
+	set_time(net, 50);
+	send_hb(net, 2);
+	set_time(net, 100);
+	tap_test(stats.noccurred[3] == 1 && !stats.noccurred[2],
+			"a heartbeat timeout occurs only for the silent node");
+	set_time(net, 120);
+	send_hb(net, 2);
+	set_time(net, 150);
+	tap_test(stats.noccurred[3] == 1 && !stats.noccurred[2],
+			"a heartbeat timeout is reported only once");
+	set_time(net, 160);
+	send_hb(net, 3);
+	tap_test(stats.nresolved[3] == 1 && !stats.nresolved[2],
+			"a heartbeat timeout is resolved by the next heartbeat");
+
+	// The timer is armed for the deadline of node 2 at 220 ms. Disabling
+	// the consumer must not cause a timeout once the timer triggers.
+	set_1016(dev, 0x01, 2, 0);
+	set_time(net, 230);
+	tap_test(!stats.noccurred[2],
+			"no heartbeat timeout for a disabled consumer");
+	send_hb(net, 3);
+	set_time(net, 300);
+	tap_test(stats.noccurred[3] == 1,
+			"no early heartbeat timeout for the other consumer");
+
+	// The timer is armed for the deadline of node 3 at 330 ms. A heartbeat
+	// of node 2, with a shorter consumer time, has an earlier deadline.
+	set_1016(dev, 0x01, 2, HB_TIMEOUT / 5);
+	send_hb(net, 2);
+	set_time(net, 319);
+	tap_test(!stats.noccurred[2],
+			"no heartbeat timeout before the earlier deadline");
+	set_time(net, 320);
+	tap_test(stats.noccurred[2] == 1 && stats.noccurred[3] == 1,
+			"a heartbeat moves the timer to an earlier deadline");
+
+	co_nmt_destroy(nmt);
+	co_dev_destroy(dev);
+	can_net_destroy(net);
+
+	return 0;
+}
+
+static co_dev_t *
+dev_create(void)
+{
+	co_dev_t *dev = co_dev_create(1);
+	tap_assert(dev);
+
+	co_obj_t *obj = co_obj_create(0x1016);
+	tap_assert(obj);
+	co_obj_set_code(obj, CO_OBJECT_ARRAY);
+	co_sub_t *sub = co_sub_create(0x00, CO_DEFTYPE_UNSIGNED8);
+	tap_assert(sub);
+	tap_assert(!co_obj_insert_sub(obj, sub));
+	co_sub_set_val_u8(sub, 2);
+	for (co_unsigned8_t i = 1; i <= 2; i++) {
+		sub = co_sub_create(i, CO_DEFTYPE_UNSIGNED32);
+		tap_assert(sub);
+		tap_assert(!co_obj_insert_sub(obj, sub));
+		co_sub_set_access(sub, CO_ACCESS_RW);
+		co_sub_set_val_u32(sub,
+				((co_unsigned32_t)(1 + i) << 16) | HB_TIMEOUT);
+	}
+	tap_assert(!co_dev_insert_obj(dev, obj));
+
+	return dev;
+}
+
+static int
+send_func(const struct can_msg *msg, void *data)
+{
+	(void)msg;
+	(void)data;
+
+	return 0;
+}
+
+static void
+set_time(can_net_t *net, int ms)
+{
+	struct timespec now = { 0, 0 };
+	timespec_add_msec(&now, ms);
+	can_net_set_time(net, &now);
+}
+
+static void
+send_hb(can_net_t *net, co_unsigned8_t id)
+{
+	struct can_msg msg = CAN_MSG_INIT;
+	msg.id = CO_NMT_EC_CANID(id);
+	msg.len = 1;
+	msg.data[0] = CO_NMT_ST_PREOP;
+	can_net_recv(net, &msg);
+}
+
+static void
+set_1016(co_dev_t *dev, co_unsigned8_t subidx, co_unsigned8_t id,
+		co_unsigned16_t ms)
+{
+	co_unsigned32_t val = ((co_unsigned32_t)id << 16) | ms;
+	tap_assert(!co_dev_dn_val_req(dev, 0x1016, subidx,
+			CO_DEFTYPE_UNSIGNED32, &val, NULL, NULL));
+	tap_assert(co_dev_get_val_u32(dev, 0x1016, subidx) == val);
+}
+
+static void
+hb_ind(co_nmt_t *nmt, co_unsigned8_t id, int state, int reason, void *data)
+{
+	(void)nmt;
+	struct hb_stats *stats = data;
+	tap_assert(stats);
+
+	tap_diag("node %d: heartbeat %s %s", id,
+			reason == CO_NMT_EC_TIMEOUT ? "timeout" : "state change",
+			state == CO_NMT_EC_OCCURRED ? "occurred" : "resolved");
+
+	if (reason == CO_NMT_EC_TIMEOUT) {
+		if (state == CO_NMT_EC_OCCURRED)
+			stats->noccurred[id]++;
+		else
+			stats->nresolved[id]++;
+	}
+}
@@ -8,6 +8,8 @@
 #include <lely/co/sdo.h>
 #include <lely/co/val.h>
 
+#include <inttypes.h>
+
 #define NMT_TIMEOUT 1000
 
 void cs_ind(co_nmt_t *nmt, co_unsigned8_t cs, void *data);
@@ -202,7 +204,6 @@ void
 boot_ind(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t st, char ec,
 		void *data)
 {
-	(void)nmt;
 	(void)st;
 	struct co_test *test = data;
 	tap_assert(test);
@@ -210,6 +211,11 @@ boot_ind(co_nmt_t *nmt, co_unsigned8_t id, co_unsigned8_t st, char ec,
 	tap_test(!ec, "error status %c reported for node %d", ec ? ec : '0',
 			id);
 
+	struct co_nmt_boot_stats stats;
+	tap_assert(!co_nmt_get_boot_stats(nmt, id, &stats));
+	tap_diag("node %d booted in %" PRIu32 " ms (waited %" PRIu32 " ms)", id,
+			stats.total, stats.wait);
+
 	co_test_done(test);
 }
 
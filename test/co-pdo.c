@@ -1,15 +1,22 @@
 #include "co-test.h"
 #include <lely/co/dcf.h>
+#include <lely/co/obj.h>
 #include <lely/co/rpdo.h>
+#include <lely/co/sdo.h>
 #include <lely/co/tpdo.h>
 
 #define VAL_2000 0x01234567u
 #define VAL_2001 0x89abcdefu
 
+static co_unsigned32_t up_ind_2001(
+		const co_sub_t *sub, struct co_sdo_req *req, void *data);
+static co_unsigned32_t dn_ind_2000(
+		co_sub_t *sub, struct co_sdo_req *req, void *data);
+
 int
 main(void)
 {
-	tap_plan(6);
+	tap_plan(13);
 
 #if !LELY_NO_STDIO && !LELY_NO_DIAG
 	diag_set_handler(&co_test_diag_handler, NULL);
@@ -47,6 +54,69 @@ main(void)
 	tap_test(co_dev_get_val_u32(rdev, 0x2001, 0x00) == VAL_2001,
 			"check value of object 2001");
 
+	// Indication functions installed after the PDO mapping has been used
+	// MUST take precedence over copying values directly.
+	co_sub_set_up_ind(co_dev_find_sub(tdev, 0x2001, 0x00), &up_ind_2001,
+			NULL);
+	int n_2000 = 0;
+	co_sub_set_dn_ind(co_dev_find_sub(rdev, 0x2000, 0x00), &dn_ind_2000,
+			&n_2000);
+
+	co_tpdo_sync(tpdo, 0);
+	co_test_step(&test);
+	co_rpdo_sync(rpdo, 0);
+
+	tap_test(n_2000 == 1, "invoke download indication of object 2000");
+	tap_test(co_dev_get_val_u32(rdev, 0x2001, 0x00) == ~VAL_2001,
+			"invoke upload indication of object 2001");
+
+	// Changing the mapping MUST invalidate the precompiled mapping.
+	co_sub_set_access(co_dev_find_sub(tdev, 0x1a00, 0x00), CO_ACCESS_RW);
+	struct co_pdo_comm_par comm = *co_tpdo_get_comm_par(tpdo);
+	struct co_pdo_map_par map = *co_tpdo_get_map_par(tpdo);
+	map.map[0] = 0x2001001cu;
+	map.map[1] = 0x20000020u;
+	tap_test(!co_dev_cfg_tpdo(tdev, 1, &comm, &map), "change TPDO mapping");
+
+	co_tpdo_sync(tpdo, 0);
+	co_test_step(&test);
+	co_rpdo_sync(rpdo, 0);
+
+	tap_test(co_dev_get_val_u32(rdev, 0x2000, 0x00)
+					== (~VAL_2001 & 0x0fffffffu),
+			"check value of object 2000 after remapping");
+	tap_test(co_dev_get_val_u32(rdev, 0x2001, 0x00) == VAL_2000,
+			"check value of object 2001 after remapping");
+
+	// Access changes MUST be honored by the precompiled mapping.
+	co_sub_t *sub_2001 = co_dev_find_sub(rdev, 0x2001, 0x00);
+	co_sub_set_access(sub_2001, CO_ACCESS_RO);
+	co_dev_set_val_u32(tdev, 0x2000, 0x00, VAL_2001);
+	co_tpdo_sync(tpdo, 0);
+	co_test_step(&test);
+	co_rpdo_sync(rpdo, 0);
+	tap_test(co_dev_get_val_u32(rdev, 0x2001, 0x00) == VAL_2000,
+			"do not write a read-only object");
+	co_sub_set_access(sub_2001, CO_ACCESS_RW);
+
+	// Replacing a mapped object MUST invalidate the precompiled mapping.
+	co_obj_t *obj_2001 = co_dev_find_obj(rdev, 0x2001);
+	tap_assert(!co_dev_remove_obj(rdev, obj_2001));
+	co_obj_destroy(obj_2001);
+	obj_2001 = co_obj_create(0x2001);
+	tap_assert(obj_2001);
+	sub_2001 = co_sub_create(0x00, CO_DEFTYPE_UNSIGNED32);
+	tap_assert(sub_2001);
+	co_sub_set_access(sub_2001, CO_ACCESS_RW);
+	co_sub_set_pdo_mapping(sub_2001, 1);
+	tap_assert(!co_obj_insert_sub(obj_2001, sub_2001));
+	tap_assert(!co_dev_insert_obj(rdev, obj_2001));
+	co_tpdo_sync(tpdo, 0);
+	co_test_step(&test);
+	co_rpdo_sync(rpdo, 0);
+	tap_test(co_dev_get_val_u32(rdev, 0x2001, 0x00) == VAL_2001,
+			"check value of object 2001 after replacing it");
+
 	co_tpdo_destroy(tpdo);
 	co_dev_destroy(tdev);
 
@@ -58,3 +128,25 @@ main(void)
 
 	return 0;
 }
+
+static co_unsigned32_t
+up_ind_2001(const co_sub_t *sub, struct co_sdo_req *req, void *data)
+{
+	(void)data;
+
+	co_unsigned32_t ac = 0;
+	co_unsigned32_t val = ~co_sub_get_val_u32(sub);
+	co_sdo_req_up_val(req, CO_DEFTYPE_UNSIGNED32, &val, &ac);
+	return ac;
+}
+
+static co_unsigned32_t
+dn_ind_2000(co_sub_t *sub, struct co_sdo_req *req, void *data)
+{
+	int *pn = data;
+	(*pn)++;
+
+	co_unsigned32_t ac = 0;
+	co_sub_on_dn(sub, req, &ac);
+	return ac;
+}
@@ -10,7 +10,7 @@
 int
 main(void)
 {
-	tap_plan(3 * 25 + 6);
+	tap_plan(3 * 25 + 7);
 
 	co_dev_t *dev = co_dev_create_from_dcf_file(TEST_SRCDIR "/co-sdev.dcf");
 	tap_assert(dev);
@@ -87,8 +87,27 @@ main(void)
 
 	tap_test(!co_val_cmp(CO_DEFTYPE_DOMAIN, &dev_dom, &sdev_dom),
 			"!co_val_cmp(%04X, <dev>, <sdev>)", CO_DEFTYPE_DOMAIN);
-
 	co_val_fini(CO_DEFTYPE_DOMAIN, &sdev_dom);
+
+	// Load the static device description again, with its objects allocated
+	// from an arena.
+	co_dev_t *adev = co_dev_create_from_sdev_arena(&test_co_sdev, 1024);
+	tap_assert(adev);
+	int ok = 1;
+	for (co_obj_t *obj = co_dev_first_obj(adev); ok && obj;
+			obj = co_obj_next(obj)) {
+		ok = co_dev_in_arena(adev, obj);
+		for (co_sub_t *sub = co_obj_first_sub(obj); ok && sub;
+				sub = co_sub_next(sub))
+			ok = co_dev_in_arena(adev, sub);
+	}
+	void *adev_dom = NULL;
+	tap_assert(!co_dev_write_dcf(adev, 0, 0xffff, &adev_dom));
+	tap_test(ok && !co_val_cmp(CO_DEFTYPE_DOMAIN, &dev_dom, &adev_dom),
+			"co_dev_create_from_sdev_arena(...)");
+	co_val_fini(CO_DEFTYPE_DOMAIN, &adev_dom);
+	co_dev_destroy(adev);
+
 	co_val_fini(CO_DEFTYPE_DOMAIN, &dev_dom);
 
 	co_dev_destroy(sdev);
@@ -33,11 +33,28 @@ void dn_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		co_unsigned32_t ac, void *data);
 void up_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 		co_unsigned32_t ac, const void *ptr, size_t n, void *data);
+co_unsigned32_t dn_read(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t offset, void *ptr, size_t n,
+		void *data);
+co_unsigned32_t up_chunk(co_csdo_t *sdo, co_unsigned16_t idx,
+		co_unsigned8_t subidx, size_t offset, const void *ptr, size_t n,
+		void *data);
+void up_chunk_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		co_unsigned32_t ac, const void *ptr, size_t n, void *data);
+void up_no_mem_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		co_unsigned32_t ac, const void *ptr, size_t n, void *data);
+
+// The value read by dn_read().
+static const char *dn_value;
+
+// The buffer in which the chunks of a streamed upload are collected.
+static char chunk_buf[sizeof(BLK_VALUE)];
+static size_t chunk_size;
 
 int
 main(void)
 {
-	tap_plan(12);
+	tap_plan(22);
 
 #if !LELY_NO_STDIO && !LELY_NO_DIAG
 	diag_set_handler(&co_test_diag_handler, NULL);
@@ -94,6 +111,39 @@ main(void)
 			"SDO block upload");
 	co_test_wait(&test);
 
+	// A user-specified buffer smaller than a single block, so the value
+	// has to be streamed.
+	char buf[16];
+
+	dn_value = SEG_VALUE;
+	tap_test(!co_csdo_dn_src_req(csdo, 0x2000, 0x00, strlen(SEG_VALUE),
+				 buf, sizeof(buf), &dn_read, &dn_con, &test),
+			"streamed segmented SDO download");
+	co_test_wait(&test);
+
+	dn_value = BLK_VALUE;
+	tap_test(!co_csdo_blk_dn_src_req(csdo, 0x2000, 0x00, strlen(BLK_VALUE),
+				 buf, sizeof(buf), &dn_read, &dn_con, &test),
+			"streamed SDO block download");
+	co_test_wait(&test);
+
+	chunk_size = 0;
+	tap_test(!co_csdo_blk_up_buf_req(csdo, 0x2000, 0x00, 0, buf,
+				 sizeof(buf), &up_chunk, &up_chunk_con, &test),
+			"streamed SDO block upload");
+	co_test_wait(&test);
+
+	chunk_size = 0;
+	tap_test(!co_csdo_up_buf_req(csdo, 0x2000, 0x00, buf, sizeof(buf),
+				 &up_chunk, &up_chunk_con, &test),
+			"streamed segmented SDO upload");
+	co_test_wait(&test);
+
+	tap_test(!co_csdo_up_buf_req(csdo, 0x2000, 0x00, buf, sizeof(buf),
+				 NULL, &up_no_mem_con, &test),
+			"segmented SDO upload into a buffer that is too small");
+	co_test_wait(&test);
+
 	co_csdo_destroy(csdo);
 	co_dev_destroy(cdev);
 
@@ -147,3 +197,78 @@ up_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
 
 	co_test_done(test);
 }
+
+co_unsigned32_t
+dn_read(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		size_t offset, void *ptr, size_t n, void *data)
+{
+	(void)sdo;
+	(void)idx;
+	(void)subidx;
+	(void)data;
+
+	if (offset + n > strlen(dn_value))
+		return CO_SDO_AC_ERROR;
+
+	memcpy(ptr, dn_value + offset, n);
+
+	return 0;
+}
+
+co_unsigned32_t
+up_chunk(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		size_t offset, const void *ptr, size_t n, void *data)
+{
+	(void)sdo;
+	(void)idx;
+	(void)subidx;
+	(void)data;
+
+	if (offset != chunk_size || offset + n > sizeof(chunk_buf))
+		return CO_SDO_AC_ERROR;
+
+	memcpy(chunk_buf + offset, ptr, n);
+	chunk_size += n;
+
+	return 0;
+}
+
+void
+up_chunk_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		co_unsigned32_t ac, const void *ptr, size_t n, void *data)
+{
+	(void)sdo;
+	struct co_test *test = data;
+
+	if (!ac) {
+		// clang-format off
+		if (!ptr && n == strlen(BLK_VALUE) && chunk_size == n
+				&& !memcmp(chunk_buf, BLK_VALUE, n))
+			// clang-format on
+			tap_pass("value streamed in chunks");
+		else
+			tap_fail("streamed value does not match");
+	} else {
+		tap_fail("received abort code %08X for SDO %Xsub%X: %s", ac,
+				idx, subidx, co_sdo_ac2str(ac));
+	}
+
+	co_test_done(test);
+}
+
+void
+up_no_mem_con(co_csdo_t *sdo, co_unsigned16_t idx, co_unsigned8_t subidx,
+		co_unsigned32_t ac, const void *ptr, size_t n, void *data)
+{
+	(void)sdo;
+	(void)idx;
+	(void)subidx;
+	(void)ptr;
+	(void)n;
+	struct co_test *test = data;
+
+	tap_test(ac == CO_SDO_AC_NO_MEM, "upload aborted: %s",
+			co_sdo_ac2str(ac));
+
+	co_test_done(test);
+}
@@ -2,16 +2,36 @@
 #include <lely/co/dcf.h>
 #include <lely/co/obj.h>
 #include <lely/co/time.h>
+#include <lely/util/endian.h>
+#include <lely/util/time.h>
 
 #define NUM_TEST 8
 #define MSEC 100
 
+/// The simulated transmit delay (in microseconds) of the producer.
+#define TX_DELAY 300
+
+/// The simulated drift (in parts per billion) of the consumer clock.
+#define DRIFT 100000
+
 void time_ind(co_time_t *time, const struct timespec *tp, void *data);
 
+static void test_prod(void);
+static void test_cons(void);
+
+struct prod_test {
+	struct can_msg msg;
+	int sent;
+};
+
+static int prod_send(const struct can_msg *msg, void *data);
+
+static void cons_adj(co_time_t *time, int_least64_t nsec, void *data);
+
 int
 main(void)
 {
-	tap_plan(NUM_TEST);
+	tap_plan(NUM_TEST + 4);
 
 #if !LELY_NO_STDIO && !LELY_NO_DIAG
 	diag_set_handler(&co_test_diag_handler, NULL);
@@ -42,6 +62,9 @@ main(void)
 	co_test_fini(&test);
 	can_net_destroy(net);
 
+	test_prod();
+	test_cons();
+
 	return 0;
 }
 
@@ -56,3 +79,133 @@ time_ind(co_time_t *time, const struct timespec *tp, void *data)
 
 	co_test_done(test);
 }
+
+static void
+test_prod(void)
+{
+	can_net_t *net = can_net_create();
+	tap_assert(net);
+	struct prod_test test = { CAN_MSG_INIT, 0 };
+	can_net_set_send_func(net, &prod_send, &test);
+
+	co_dev_t *dev = co_dev_create_from_dcf_file(TEST_SRCDIR "/co-time.dcf");
+	tap_assert(dev);
+	co_time_t *time = co_time_create(net, dev);
+	tap_assert(time);
+
+	struct timespec now = { 1700000000, 0 };
+	can_net_set_time(net, &now);
+	struct timespec interval = { 0, 10000000 };
+	co_time_start_prod(time, NULL, &interval);
+
+	// Advance the time in steps of 100 us and confirm every time stamp
+	// TX_DELAY us after it was sent.
+	int aligned = 1;
+	struct timespec confirm = { 0, 0 };
+	for (int i = 0; i < 1000; i++) {
+		timespec_add_usec(&now, 100);
+		can_net_set_time(net, &now);
+		if (test.sent) {
+			test.sent = 0;
+			confirm = now;
+			timespec_add_usec(&confirm, TX_DELAY);
+			co_time_of_day_t tod;
+			tod.ms = ldle_u32(test.msg.data);
+			tod.days = ldle_u16(test.msg.data + 4);
+			struct timespec tp;
+			co_time_of_day_get(&tod, &tp);
+			aligned = aligned && !(tp.tv_nsec % 1000000)
+					&& timespec_diff_nsec(&tp, &now) >= 0;
+		}
+		if (confirm.tv_sec && timespec_cmp(&now, &confirm) >= 0) {
+			co_time_confirm(time, &test.msg, &now);
+			confirm = (struct timespec){ 0, 0 };
+		}
+	}
+
+	struct co_time_prod_stats stats;
+	co_time_get_prod_stats(time, &stats);
+	tap_test(aligned && stats.n > 1,
+			"time stamps are sent ahead of time, in whole ms");
+	tap_test(stats.delay == TX_DELAY * 1000 && !stats.error
+					&& stats.error_max == TX_DELAY * 1000,
+			"the transmit delay of %d us is compensated",
+			TX_DELAY);
+
+	co_time_destroy(time);
+	co_dev_destroy(dev);
+	can_net_destroy(net);
+}
+
+static void
+test_cons(void)
+{
+	can_net_t *net = can_net_create();
+	tap_assert(net);
+
+	co_dev_t *dev = co_dev_create_from_dcf_file(TEST_SRCDIR "/co-time.dcf");
+	tap_assert(dev);
+	co_time_t *time = co_time_create(net, dev);
+	tap_assert(time);
+
+	// The local clock starts 5 ms ahead of the producer and runs fast.
+	int_least64_t corr = 5000000;
+	co_time_set_adj_func(time, &cons_adj, &corr);
+
+	struct can_msg msg = CAN_MSG_INIT;
+	msg.id = 0x100;
+	msg.len = 6;
+	struct timespec tp = { 1700000000, 0 };
+	for (int i = 0; i < 100; i++) {
+		timespec_add_msec(&tp, MSEC);
+		co_time_of_day_t tod = { 0, 0 };
+		co_time_of_day_set(&tod, &tp);
+		stle_u32(msg.data, tod.ms);
+		stle_u16(msg.data + 4, tod.days);
+
+		struct timespec local = tp;
+		int_least64_t dt = (int_least64_t)(i + 1) * MSEC * 1000000;
+		int_least64_t nsec = dt * DRIFT / 1000000000 + corr;
+		if (nsec < 0)
+			timespec_sub_nsec(&local, -nsec);
+		else
+			timespec_add_nsec(&local, nsec);
+		can_net_recv_at(net, &msg, &local);
+	}
+
+	struct co_time_cons_stats stats;
+	co_time_get_cons_stats(time, &stats);
+	// After each correction, the offset equals the drift over one period.
+	int_least64_t offset = stats.offset - DRIFT * MSEC / 1000;
+	tap_test(stats.n == 100 && offset > -1000 && offset < 1000
+					&& stats.jitter < 1000,
+			"the consumer clock is disciplined to %lld ns",
+			(long long)offset);
+	tap_test(stats.drift > DRIFT * 99 / 100
+					&& stats.drift < DRIFT * 101 / 100,
+			"a drift of %ld ppb is estimated", (long)stats.drift);
+
+	co_time_destroy(time);
+	co_dev_destroy(dev);
+	can_net_destroy(net);
+}
+
+static int
+prod_send(const struct can_msg *msg, void *data)
+{
+	struct prod_test *test = data;
+
+	test->msg = *msg;
+	test->sent = 1;
+
+	return 0;
+}
+
+static void
+cons_adj(co_time_t *time, int_least64_t nsec, void *data)
+{
+	(void)time;
+	int_least64_t *corr = data;
+
+	*corr += nsec;
+}
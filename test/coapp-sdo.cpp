@@ -0,0 +1,178 @@
+#include "test.h"
+#include <lely/co/type.h>
+#include <lely/coapp/driver.hpp>
+#include <lely/coapp/slave.hpp>
+#include <lely/ev/loop.hpp>
+#if _WIN32
+#include <lely/io2/win32/poll.hpp>
+#elif _POSIX_C_SOURCE >= 200112L
+#include <lely/io2/posix/poll.hpp>
+#else
+#error This file requires Windows or POSIX.
+#endif
+#include <lely/io2/sys/clock.hpp>
+#include <lely/io2/sys/io.hpp>
+#include <lely/io2/sys/timer.hpp>
+#include <lely/io2/vcan.hpp>
+#include <lely/util/endian.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+using namespace lely::ev;
+using namespace lely::io;
+using namespace lely::canopen;
+
+#define NUM_SLAVE 8
+#define NUM_BATCH 4
+
+class MyDriver : public BasicDriver {
+ public:
+  using BasicDriver::BasicDriver;
+
+ private:
+  void
+  OnBoot(NmtState, char es, const ::std::string&) noexcept override {
+    tap_test(!es, "master: slave #%d successfully booted", id());
+
+    // Build a batch of requests for the slaves that are not managed by the
+    // master. Each slave gets the same sequence of requests, so the requests
+    // for different slaves can be processed concurrently.
+    ::std::vector<SdoBatchEntry> batch;
+    for (int i = 0; i < NUM_BATCH; i++) {
+      for (uint8_t id = 2; id < 2 + NUM_SLAVE; id++) {
+        uint32_t val = id * 1000 + i;
+        SdoBatchEntry write;
+        write.id = id;
+        write.idx = 0x2001;
+        write.type = CO_DEFTYPE_UNSIGNED32;
+        write.write = true;
+        write.value = {static_cast<uint8_t>(val),
+                       static_cast<uint8_t>(val >> 8),
+                       static_cast<uint8_t>(val >> 16),
+                       static_cast<uint8_t>(val >> 24)};
+        batch.push_back(write);
+
+        SdoBatchEntry read;
+        read.id = id;
+        read.idx = 0x2001;
+        read.type = CO_DEFTYPE_UNSIGNED32;
+        batch.push_back(read);
+
+        read.idx = 0x1018;
+        read.subidx = 1;
+        batch.push_back(read);
+
+        read.idx = 0x1017;
+        read.subidx = 0;
+        read.type = CO_DEFTYPE_UNSIGNED16;
+        batch.push_back(read);
+      }
+    }
+    // A request with a value of the wrong size.
+    SdoBatchEntry entry;
+    entry.id = 2;
+    entry.idx = 0x2001;
+    entry.type = CO_DEFTYPE_UNSIGNED32;
+    entry.write = true;
+    entry.value = {0x01, 0x02};
+    batch.push_back(entry);
+    // A request for a non-existing object.
+    entry.idx = 0x2fff;
+    entry.type = 0;
+    entry.write = false;
+    batch.push_back(entry);
+    // A request with an invalid node-ID.
+    entry.id = 0;
+    batch.push_back(entry);
+
+    auto n = batch.size();
+    auto start = ::std::chrono::steady_clock::now();
+    master.AsyncBatch(GetExecutor(), ::std::move(batch))
+        .then(GetExecutor(),
+              [this, n, start](SdoFuture<::std::vector<SdoBatchEntry>> f) {
+                auto elapsed = ::std::chrono::steady_clock::now() - start;
+                auto usec =
+                    ::std::chrono::duration_cast<::std::chrono::microseconds>(
+                        elapsed)
+                        .count();
+                tap_diag("master: %d SDO requests in %d us (%.0f requests/s)",
+                         static_cast<int>(n), static_cast<int>(usec),
+                         usec ? 1e6 * n / usec : 0.0);
+                OnBatch(f.get().value());
+              });
+  }
+
+  void
+  OnBatch(const ::std::vector<SdoBatchEntry>& batch) {
+    tap_test(batch.size() == 4 * NUM_BATCH * NUM_SLAVE + 3,
+             "master: batch completed");
+
+    for (uint8_t id = 2; id < 2 + NUM_SLAVE; id++) {
+      bool ok = true;
+      for (int i = 0; i < NUM_BATCH; i++) {
+        uint32_t val = id * 1000 + i;
+        auto entry = &batch[4 * (i * NUM_SLAVE + id - 2)];
+        ok = ok && entry[0].id == id && !entry[0].ec;
+        ok = ok && !entry[1].ec && entry[1].value.size() == 4 &&
+             ldle_u32(entry[1].value.data()) == val;
+        ok = ok && !entry[2].ec && entry[2].value.size() == 4 &&
+             ldle_u32(entry[2].value.data()) == 0x360;
+        ok = ok && !entry[3].ec && entry[3].value.size() == 2;
+      }
+      tap_test(ok, "master: batch requests for slave #%d succeeded", id);
+    }
+
+    auto entry = &batch[4 * NUM_BATCH * NUM_SLAVE];
+    tap_test(entry[0].ec == SdoErrc::TYPE_LEN_LO,
+             "master: value of the wrong size is rejected");
+    tap_test(entry[1].ec == SdoErrc::NO_OBJ,
+             "master: request for non-existing object fails");
+    tap_test(entry[2].ec == SdoErrc::NO_SDO,
+             "master: request for invalid node-ID fails");
+
+    master.GetContext().shutdown();
+  }
+};
+
+int
+main() {
+  tap_plan(1 + 1 + 1 + NUM_SLAVE + 3);
+
+  IoGuard io_guard;
+  Context ctx;
+  lely::io::Poll poll(ctx);
+  Loop loop(poll.get_poll());
+  auto exec = loop.get_executor();
+  VirtualCanController ctrl(clock_monotonic);
+
+  // The slave managed by the master (see coapp-fiber-master.dcf), and the
+  // slaves addressed by the batch.
+  ::std::vector<::std::unique_ptr<Timer>> stimers;
+  ::std::vector<::std::unique_ptr<VirtualCanChannel>> schans;
+  ::std::vector<::std::unique_ptr<BasicSlave>> slaves;
+  for (uint8_t id = 1; id < 2 + NUM_SLAVE; id++) {
+    stimers.emplace_back(new Timer(poll, exec, CLOCK_MONOTONIC));
+    schans.emplace_back(new VirtualCanChannel(ctx, exec));
+    schans.back()->open(ctrl);
+    slaves.emplace_back(new BasicSlave(*stimers.back(), *schans.back(),
+                                       TEST_SRCDIR "/coapp-fiber-slave.dcf",
+                                       "", id == 1 ? 127 : id));
+  }
+
+  Timer mtimer(poll, exec, CLOCK_MONOTONIC);
+  VirtualCanChannel mchan(ctx, exec);
+  mchan.open(ctrl);
+  tap_test(mchan.is_open(), "master: opened virtual CAN channel");
+  AsyncMaster master(mtimer, mchan, TEST_SRCDIR "/coapp-fiber-master.dcf", "",
+                     1);
+  MyDriver driver(exec, master, 127);
+
+  for (auto& slave : slaves) slave->Reset();
+  master.Reset();
+
+  loop.run();
+
+  return 0;
+}
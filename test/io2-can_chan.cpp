@@ -0,0 +1,138 @@
+#include "test.h"
+#include <lely/ev/loop.hpp>
+#include <lely/io2/linux/can.hpp>
+#include <lely/io2/posix/poll.hpp>
+#include <lely/io2/sys/io.hpp>
+
+#include <chrono>
+#include <vector>
+
+#include <cerrno>
+#include <climits>
+
+#include <linux/can.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace lely::ev;
+using namespace lely::io;
+
+// The name of the SocketCAN interface used for the test.
+#define CAN_IFNAME "vcan0"
+
+#define NUM_MSGS 8
+#define MAX_BATCH 3
+
+// The maximum number of frames sent with a single call to sendmmsg().
+static unsigned int sendmmsg_max = UINT_MAX;
+// The number of calls to sendmmsg() after which an error is returned.
+static int sendmmsg_ncall = -1;
+// The identifier of the first frame of each call to sendmmsg().
+static ::std::vector<canid_t> sendmmsg_ids;
+
+// Limits the number of frames handed to the operating system, so vectored
+// write operations are only partially written, and injects write errors.
+extern "C" int
+sendmmsg(int fd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  if (!sendmmsg_ncall) {
+    errno = EIO;
+    return -1;
+  }
+  if (sendmmsg_ncall > 0) sendmmsg_ncall--;
+  sendmmsg_ids.push_back(
+      static_cast<const can_frame*>(msgvec[0].msg_hdr.msg_iov->iov_base)
+          ->can_id);
+  if (vlen > sendmmsg_max) vlen = sendmmsg_max;
+  return syscall(SYS_sendmmsg, fd, msgvec, vlen, flags);
+}
+
+struct WriteVec : io_can_chan_write_vec {
+  explicit WriteVec(ev_exec_t* exec, const can_msg* msgs, ::std::size_t nmsgs)
+      : io_can_chan_write_vec IO_CAN_CHAN_WRITE_VEC_INIT(msgs, nmsgs, exec,
+                                                         &WriteVec::func) {}
+
+  static void
+  func(ev_task* task) noexcept {
+    auto self = static_cast<WriteVec*>(io_can_chan_write_vec_from_task(task));
+    self->done = true;
+  }
+
+  bool done{false};
+};
+
+// Runs the event loop until the write operation completes.
+static void
+run(Loop& loop, WriteVec& write) {
+  auto deadline =
+      ::std::chrono::steady_clock::now() + ::std::chrono::seconds(1);
+  while (!write.done && ::std::chrono::steady_clock::now() < deadline) {
+    loop.restart();
+    loop.run_one_for(::std::chrono::milliseconds(10));
+  }
+}
+
+int
+main() {
+  IoGuard io_guard;
+
+  io_can_ctrl_t* ctrl = io_can_ctrl_create_from_name(CAN_IFNAME, 0);
+  if (!ctrl) {
+    tap_plan(0, "CAN interface " CAN_IFNAME " not available");
+    return 0;
+  }
+
+  tap_plan(5);
+
+  Context ctx;
+  lely::io::Poll poll(ctx);
+  Loop loop(poll.get_poll());
+  auto exec = loop.get_executor();
+
+  CanChannel chan(poll, exec);
+  chan.open(ctrl, CanBusFlag::NONE);
+  tap_assert(chan.is_open());
+
+  can_msg msgs[NUM_MSGS];
+  for (int i = 0; i < NUM_MSGS; i++) {
+    msgs[i] = CAN_MSG_INIT;
+    msgs[i].id = i;
+  }
+
+  // Only hand a few frames at a time to the operating system. The remaining
+  // frames are written by resuming the operation.
+  sendmmsg_max = MAX_BATCH;
+  WriteVec write1(exec, msgs, NUM_MSGS);
+  chan.submit_write_vec(write1);
+  run(loop, write1);
+  tap_test(write1.done && !write1.errc && write1.n == NUM_MSGS &&
+               write1._i == NUM_MSGS,
+           "a partially written operation completes");
+  tap_test(sendmmsg_ids == ::std::vector<canid_t>({0, 3, 6}),
+           "each write resumes with the first unwritten frame");
+
+  // Fail the second system call. The frames of the first call have been
+  // handed to the operating system, but no more.
+  sendmmsg_ids.clear();
+  sendmmsg_ncall = 1;
+  WriteVec write2(exec, msgs, NUM_MSGS);
+  chan.submit_write_vec(write2);
+  run(loop, write2);
+  tap_test(write2.done && write2.errc == EIO,
+           "a write error completes the operation");
+  tap_test(write2._i == MAX_BATCH && write2.n <= MAX_BATCH,
+           "no frames are written after the error");
+  tap_test(sendmmsg_ids == ::std::vector<canid_t>({0}),
+           "the failed frames are not written again");
+
+  sendmmsg_ncall = -1;
+  sendmmsg_max = UINT_MAX;
+
+  ctx.shutdown();
+  loop.restart();
+  loop.poll();
+
+  io_can_ctrl_destroy(ctrl);
+
+  return 0;
+}
@@ -0,0 +1,287 @@
+#include "test.h"
+// Use the C interface of the CAN library.
+#undef LELY_NO_CXX
+#define LELY_NO_CXX 1
+#include <lely/can/net.h>
+#include <lely/ev/loop.hpp>
+#include <lely/io2/can_net.hpp>
+#include <lely/io2/sys/io.hpp>
+#include <lely/io2/user/timer.hpp>
+#include <lely/io2/vcan.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace lely::ev;
+using namespace lely::io;
+
+#define NUM_SDO 4
+
+#define RXLEN 4
+#define NUM_RX (4 * RXLEN)
+
+#define NUM_STATS_TX 5
+#define NUM_STATS_RX 8
+
+// A CAN network interface connected to a peer through a virtual CAN bus.
+struct CanNetEnv {
+  CanNetEnv(io_ctx_t* ctx, ev_exec_t* exec,
+            CanBusFlag flags = CanBusFlag::MASK,
+            ev_exec_t* chan_exec = nullptr)
+      : timer(ctx, exec),
+        ctrl(timer.get_clock(), flags),
+        chan(ctx, chan_exec ? chan_exec : exec),
+        peer(ctx, exec),
+        net(exec, timer, chan, 0, -1) {
+    chan.open(ctrl);
+    peer.open(ctrl);
+  }
+
+  // Sends a CAN frame through the internal CAN network interface.
+  void
+  send(uint_least32_t id, uint_least8_t flags = 0) {
+    can_msg msg = CAN_MSG_INIT;
+    msg.id = id;
+    msg.flags = flags;
+    io_can_net_lock(net);
+    can_net_send(io_can_net_get_net(net), &msg);
+    io_can_net_unlock(net);
+  }
+
+  // Returns the identifiers of the CAN frames received by the peer.
+  ::std::vector<uint_least32_t>
+  recv() {
+    ::std::vector<uint_least32_t> ids;
+    can_msg msg = CAN_MSG_INIT;
+    ::std::error_code ec;
+    while (peer.read(&msg, nullptr, nullptr, 0, ec) == 1)
+      ids.push_back(msg.id);
+    return ids;
+  }
+
+  // Writes a CAN frame from the peer, with the sequence number in the first
+  // data byte.
+  void
+  write(uint_least32_t id, uint_least8_t seq) {
+    can_msg msg = CAN_MSG_INIT;
+    msg.id = id;
+    msg.len = 1;
+    msg.data[0] = seq;
+    peer.write(msg);
+  }
+
+  UserTimer timer;
+  VirtualCanController ctrl;
+  VirtualCanChannel chan;
+  VirtualCanChannel peer;
+  CanNet net;
+};
+
+// The default function used to determine the priority class of a CAN frame.
+static io_can_net_tx_class_func_t* default_tx_class_func;
+
+// Assigns heartbeat messages to the NMT priority class as well.
+static int
+tx_class_func(const can_msg* msg, void* arg) {
+  if (!(msg->flags & CAN_FLAG_IDE) && (msg->id & ~0x7fu) == 0x700)
+    return IO_CAN_NET_CLASS_NMT;
+  return default_tx_class_func(msg, arg);
+}
+
+// Returns the total number of entries in a latency histogram.
+static size_t
+hist_total(const size_t* hist) {
+  size_t n = 0;
+  for (int i = 0; i < IO_CAN_NET_NHIST; i++) n += hist[i];
+  return n;
+}
+
+// Records the sequence numbers of the CAN frames received through the internal
+// CAN network interface.
+static int
+recv_func(const can_msg* msg, void* data) {
+  static_cast<::std::vector<uint_least8_t>*>(data)->push_back(msg->data[0]);
+  return 0;
+}
+
+int
+main() {
+  tap_plan(6 + 2 + 4);
+
+  IoGuard io_guard;
+  Loop loop;
+  auto exec = loop.get_executor();
+
+  {
+    Context ctx;
+    // Frames of a higher priority class overtake queued SDOs. The controller
+    // does not support CAN FD frames, so writing the second SDO fails.
+    CanNetEnv env(ctx, exec, CanBusFlag::NONE);
+    io_can_net_get_tx_class_func(env.net, &default_tx_class_func, nullptr);
+    io_can_net_set_tx_class_func(env.net, &tx_class_func, nullptr);
+
+    // Queue the frames before the interface is started, so none of them is
+    // written yet.
+    for (uint_least32_t i = 0; i < NUM_SDO; i++)
+#if LELY_NO_CANFD
+      env.send(0x600 + i);
+#else
+      env.send(0x600 + i, i == 1 ? CAN_FLAG_FDF : 0);
+#endif
+    env.send(0x080);
+    env.send(0x701);
+
+    auto stats = env.net.get_stats();
+    tap_test(stats.tx_class_depth[IO_CAN_NET_CLASS_NMT] == 2 &&
+                 stats.tx_class_depth[IO_CAN_NET_CLASS_PDO] == 0 &&
+                 stats.tx_class_depth[IO_CAN_NET_CLASS_SDO] == NUM_SDO,
+             "frames are queued per priority class");
+    tap_test(stats.tx_class_max[IO_CAN_NET_CLASS_NMT] == 2 &&
+                 stats.tx_class_max[IO_CAN_NET_CLASS_SDO] == NUM_SDO &&
+                 stats.tx_queue_max == NUM_SDO + 2,
+             "the maximum queue depth is recorded");
+
+    env.net.start();
+    loop.poll();
+
+    auto ids = env.recv();
+    tap_test(ids.size() >= 2 && ids[0] == 0x080 && ids[1] == 0x701,
+             "frames of a higher priority class are written first");
+#if LELY_NO_CANFD
+    tap_skip("CAN FD frames are not supported");
+#else
+    tap_test(ids == ::std::vector<uint_least32_t>({0x080, 0x701, 0x600, 0x602,
+                                                   0x603}),
+             "a failed write drops only the frame that could not be written");
+#endif
+
+    stats = env.net.get_stats();
+    tap_test(stats.tx_class_depth[IO_CAN_NET_CLASS_NMT] == 0 &&
+                 stats.tx_class_depth[IO_CAN_NET_CLASS_SDO] == 0,
+             "the transmit queues are empty");
+#if LELY_NO_CANFD
+    tap_skip("CAN FD frames are not supported");
+#else
+    tap_test(stats.tx_frames == NUM_SDO + 1 && stats.tx_errors == 1,
+             "one frame could not be written");
+#endif
+
+    ctx.shutdown();
+    loop.poll();
+  }
+
+  {
+    // The frames are read by a separate thread with the receive queue
+    // enabled and processed by this thread.
+    Context ctx;
+    Loop rloop;
+    CanNetEnv env(ctx, exec, CanBusFlag::MASK, rloop.get_executor());
+    env.net.set_rxlen(RXLEN);
+
+    ::std::vector<uint_least8_t> seqs;
+    io_can_net_lock(env.net);
+    can_recv_t* recv = can_recv_create();
+    tap_assert(recv);
+    can_recv_set_func(recv, &recv_func, &seqs);
+    can_recv_start(recv, io_can_net_get_net(env.net), 0x181, 0);
+    io_can_net_unlock(env.net);
+
+    // Send a burst larger than the receive queue.
+    for (int i = 0; i < NUM_RX; i++) env.write(0x181, i);
+
+    env.net.start();
+    ::std::atomic<bool> done{false};
+    ::std::thread thr([&]() {
+      // The loop stops whenever it runs out of tasks, e.g., when the reader
+      // waits for room in the receive queue.
+      while (!done) {
+        rloop.restart();
+        rloop.run_for(::std::chrono::milliseconds(1));
+      }
+    });
+
+    // While this thread holds the mutex of the interface, the reader can
+    // still fill the receive queue.
+    io_can_net_lock(env.net);
+    auto deadline =
+        ::std::chrono::steady_clock::now() + ::std::chrono::seconds(1);
+    while (env.net.get_stats().rx_queue_max < RXLEN &&
+           ::std::chrono::steady_clock::now() < deadline)
+      ::std::this_thread::yield();
+    tap_test(env.net.get_stats().rx_queue_max == RXLEN,
+             "the reader fills the receive queue without the mutex");
+    io_can_net_unlock(env.net);
+
+    deadline = ::std::chrono::steady_clock::now() + ::std::chrono::seconds(1);
+    for (;;) {
+      io_can_net_lock(env.net);
+      auto n = seqs.size();
+      io_can_net_unlock(env.net);
+      if (n >= NUM_RX || ::std::chrono::steady_clock::now() >= deadline)
+        break;
+      loop.restart();
+      loop.run_for(::std::chrono::milliseconds(1));
+    }
+    bool ordered = seqs.size() == NUM_RX;
+    for (size_t i = 0; ordered && i < seqs.size(); i++)
+      ordered = seqs[i] == i;
+    tap_test(ordered, "all frames reach the receivers in order");
+
+    done = true;
+    thr.join();
+
+    io_can_net_lock(env.net);
+    can_recv_destroy(recv);
+    io_can_net_unlock(env.net);
+
+    ctx.shutdown();
+    rloop.restart();
+    rloop.poll();
+    loop.poll();
+  }
+
+  {
+    Context ctx;
+    CanNetEnv env(ctx, exec);
+    // The receive timestamps are taken from the clock of the interface. A
+    // zero timestamp is considered invalid, so start the clock at 1 s.
+    const timespec ts = {1, 0};
+    io_clock_settime(io_timer_get_clock(env.timer), &ts);
+
+    for (int i = 0; i < NUM_STATS_TX; i++) env.send(0x601);
+    for (int i = 0; i < NUM_STATS_RX; i++) env.write(0x581, i);
+
+    env.net.start();
+    loop.restart();
+    loop.poll();
+    tap_assert(env.recv().size() == NUM_STATS_TX);
+
+    auto stats = env.net.get_stats();
+    tap_test(stats.rx_frames == NUM_STATS_RX && stats.rx_bits > 0 &&
+                 !stats.rx_errors && stats.tx_frames == NUM_STATS_TX &&
+                 stats.tx_bits > 0 && !stats.tx_errors && !stats.tx_dropped,
+             "the frame counters match the number of frames");
+    tap_test(stats.tx_queue_max == NUM_STATS_TX &&
+                 stats.tx_class_max[IO_CAN_NET_CLASS_SDO] == NUM_STATS_TX,
+             "the transmit queue high-water mark is recorded");
+    tap_test(hist_total(stats.rx_latency) == stats.rx_frames &&
+                 hist_total(stats.tx_latency) == stats.tx_frames,
+             "the latency histograms account for every frame");
+
+    io_can_net_stats cstats;
+    tap_assert(!io_can_net_get_stats(env.net, &cstats));
+    tap_test(cstats.rx_frames == stats.rx_frames &&
+                 cstats.tx_frames == stats.tx_frames &&
+                 cstats.tx_queue_max == stats.tx_queue_max &&
+                 hist_total(cstats.rx_latency) == stats.rx_frames &&
+                 hist_total(cstats.tx_latency) == stats.tx_frames,
+             "CanNet::get_stats() returns the counters of the interface");
+
+    ctx.shutdown();
+    loop.poll();
+  }
+
+  return 0;
+}